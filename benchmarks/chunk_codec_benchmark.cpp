@@ -0,0 +1,233 @@
+#include <lit/engine/utilities/chunk_codec.hpp>
+#include <lit/engine/utilities/world_file.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/systems/voxels/voxel_grid_lod_manager.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <cstring>
+#include <functional>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = ChunkCodec::VoxelGrid;
+using VoxelGridLod = VoxelGridSparseLodDataT<uint32_t>;
+
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+const size_t CHUNK_BYTES = ChunkCodec::CHUNK_VOXELS * sizeof(uint32_t);
+const int REPEATS = 5;
+
+/**
+ * Plain LZ77 compressor in the spirit of LZ4: greedy matches found through a hash of 4 bytes, sequences of
+ * (literals count, literals, match length, 16-bit offset). Baseline without any knowledge of voxels.
+ */
+class LzCodec {
+public:
+    void Encode(const uint8_t *data, size_t size, std::vector<uint8_t> &out) {
+        std::fill(std::begin(m_table), std::end(m_table), UINT32_MAX);
+        size_t anchor = 0;
+        size_t i = 0;
+        while (i + 4 <= size) {
+            uint32_t word = Read32(data + i);
+            uint32_t &slot = m_table[(word * 2654435761u) >> (32 - HASH_LOG)];
+            size_t candidate = slot;
+            slot = (uint32_t) i;
+            if (candidate == UINT32_MAX || i - candidate > UINT16_MAX || Read32(data + candidate) != word) {
+                i++;
+                continue;
+            }
+            size_t length = 4;
+            while (i + length < size && data[candidate + length] == data[i + length]) {
+                length++;
+            }
+            WriteSequence(data + anchor, i - anchor, length, i - candidate, out);
+            i += length;
+            anchor = i;
+        }
+        WriteSequence(data + anchor, size - anchor, 0, 0, out);
+    }
+
+    static void Decode(const uint8_t *payload, uint8_t *data, size_t size) {
+        uint8_t *end = data + size;
+        while (true) {
+            size_t literals = ReadLength(payload);
+            std::memcpy(data, payload, literals);
+            data += literals;
+            payload += literals;
+            if (data >= end) {
+                return;
+            }
+            size_t length = ReadLength(payload) + 4;
+            uint16_t offset;
+            std::memcpy(&offset, payload, sizeof(offset));
+            payload += sizeof(offset);
+            // The copied part repeats with the period of the offset, so it can be copied in growing pieces
+            const uint8_t *source = data - offset;
+            uint8_t *target_end = data + length;
+            while (data < target_end) {
+                size_t piece = std::min<size_t>(target_end - data, data - source);
+                std::memcpy(data, source, piece);
+                data += piece;
+            }
+        }
+    }
+
+private:
+    static const int HASH_LOG = 12;
+
+    static uint32_t Read32(const uint8_t *p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static void WriteLength(size_t length, std::vector<uint8_t> &out) {
+        for (; length >= 0x80; length >>= 7) {
+            out.push_back((uint8_t) (length | 0x80));
+        }
+        out.push_back((uint8_t) length);
+    }
+
+    static size_t ReadLength(const uint8_t *&payload) {
+        size_t length = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t byte = *payload++;
+            length |= (size_t) (byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return length;
+            }
+        }
+    }
+
+    static void WriteSequence(const uint8_t *literals, size_t count, size_t length, size_t offset,
+                              std::vector<uint8_t> &out) {
+        WriteLength(count, out);
+        out.insert(out.end(), literals, literals + count);
+        if (length > 0) {
+            WriteLength(length - 4, out);
+            auto offset16 = (uint16_t) offset;
+            out.insert(out.end(), reinterpret_cast<uint8_t *>(&offset16), reinterpret_cast<uint8_t *>(&offset16) + 2);
+        }
+    }
+
+    uint32_t m_table[1 << HASH_LOG];
+};
+
+struct Method {
+    std::string name;
+    // Appends the encoded chunk to the buffer
+    std::function<void(VoxelGrid::ChunkIndexType, std::vector<uint8_t> &)> encode;
+    // Decodes the chunk from the pointer, returns the number of bytes consumed
+    std::function<size_t(VoxelGrid::ChunkIndexType, const uint8_t *, size_t, VoxelGrid::ChunkData &)> decode;
+};
+
+/**
+ * Encodes all chunks of a world from WorldGen into one stream and decodes them back with every method,
+ * reports the compression ratio and time per chunk and fails if any chunk doesn't survive the round trip.
+ */
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    entt::registry registry;
+    auto ent = registry.create();
+    auto &world = registry.emplace<VoxelGrid>(ent, WORLD_SIZE, glm::dvec3(0.0));
+    WorldGen().Generate(world, *logger);
+    auto &lod = registry.emplace<VoxelGridLod>(ent);
+    VoxelGridLodManager<uint32_t>(registry).CommitChanges();
+
+    std::vector<VoxelGrid::ChunkIndexType> chunks;
+    world.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        chunks.push_back(chunk.GetIndex());
+    });
+    auto parent_of = [&](VoxelGrid::ChunkIndexType index) {
+        return &lod.GetChunkViewAtLod(index, 1).At(0, 0, 0);
+    };
+
+    ChunkCodec codec;
+    LzCodec lz;
+    std::vector<uint8_t> payload;
+    std::vector<Method> methods = {
+            {"run-length", [&](auto index, auto &out) {
+                WorldFile::Encode(&world.GetChunkData(index)[0][0][0], ChunkCodec::CHUNK_VOXELS,
+                                  ChunkEncoding::RunLength, payload);
+                uint32_t size = (uint32_t) payload.size();
+                out.insert(out.end(), reinterpret_cast<uint8_t *>(&size), reinterpret_cast<uint8_t *>(&size) + 4);
+                out.insert(out.end(), payload.begin(), payload.end());
+            }, [&](auto, const uint8_t *payload, size_t, auto &data) {
+                uint32_t size;
+                std::memcpy(&size, payload, sizeof(size));
+                WorldFile::Decode(payload + 4, size, ChunkEncoding::RunLength, &data[0][0][0], ChunkCodec::CHUNK_VOXELS);
+                return size + 4;
+            }},
+            {"lz", [&](auto index, auto &out) {
+                lz.Encode(reinterpret_cast<const uint8_t *>(&world.GetChunkData(index)), CHUNK_BYTES, out);
+            }, [&](auto, const uint8_t *payload, size_t, auto &data) {
+                LzCodec::Decode(payload, reinterpret_cast<uint8_t *>(&data), CHUNK_BYTES);
+                // The format doesn't record the size of the payload
+                return (size_t) 0;
+            }},
+            {"palette", [&](auto index, auto &out) {
+                codec.Encode(world.GetChunkData(index), nullptr, out);
+            }, [&](auto, const uint8_t *payload, size_t size, auto &data) {
+                return ChunkCodec::Decode(payload, size, nullptr, data);
+            }},
+            {"palette + parent", [&](auto index, auto &out) {
+                codec.Encode(world.GetChunkData(index), parent_of(index), out);
+            }, [&](auto index, const uint8_t *payload, size_t size, auto &data) {
+                return ChunkCodec::Decode(payload, size, parent_of(index), data);
+            }},
+    };
+
+    logger->info("{} chunks, {:.1f} MB", chunks.size(), chunks.size() * CHUNK_BYTES / 1048576.0);
+    auto decoded = std::make_unique<VoxelGrid::ChunkData>();
+    bool success = true;
+    for (auto &method: methods) {
+        // Chunks go one after another into one stream, offsets are kept to check the sizes reported by decoders
+        std::vector<uint8_t> stream;
+        std::vector<size_t> offsets;
+        double encode_time = 1e9;
+        for (int r = 0; r < REPEATS; r++) {
+            stream.clear();
+            offsets.clear();
+            Timer timer;
+            for (auto index: chunks) {
+                offsets.push_back(stream.size());
+                method.encode(index, stream);
+            }
+            encode_time = std::min(encode_time, timer.GetTime());
+        }
+        offsets.push_back(stream.size());
+
+        double decode_time = 1e9;
+        for (int r = 0; r < REPEATS; r++) {
+            Timer timer;
+            for (size_t i = 0; i < chunks.size(); i++) {
+                size_t consumed = method.decode(chunks[i], stream.data() + offsets[i], stream.size() - offsets[i],
+                                                *decoded);
+                if (consumed != 0 && consumed != offsets[i + 1] - offsets[i]) {
+                    logger->error("{}: chunk {} consumed {} bytes of {}", method.name, i, consumed,
+                                  offsets[i + 1] - offsets[i]);
+                    success = false;
+                }
+            }
+            decode_time = std::min(decode_time, timer.GetTime());
+        }
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            method.decode(chunks[i], stream.data() + offsets[i], stream.size() - offsets[i], *decoded);
+            if (*decoded != world.GetChunkData(chunks[i])) {
+                logger->error("{}: chunk {} differs after decoding", method.name, i);
+                success = false;
+                break;
+            }
+        }
+
+        double raw_bytes = (double) chunks.size() * CHUNK_BYTES;
+        logger->info("{:>16}: {:9} bytes, ratio {:7.1f}, encode {:6.1f}us/chunk ({:6.0f} MB/s), "
+                     "decode {:6.1f}us/chunk ({:6.0f} MB/s)", method.name, stream.size(), raw_bytes / stream.size(),
+                     encode_time / chunks.size() * 1e6, raw_bytes / encode_time / 1048576.0,
+                     decode_time / chunks.size() * 1e6, raw_bytes / decode_time / 1048576.0);
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
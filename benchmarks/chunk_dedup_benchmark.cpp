@@ -0,0 +1,126 @@
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <map>
+#include <set>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = VoxelGridSparseT<uint32_t>;
+using ChunkMap = std::map<glm::ivec3, VoxelGrid::ChunkData, glm_ext::vec3_comparator<int>>;
+
+const glm::ivec3 TEST_WORLD_SIZE = glm::ivec3(1024, 64, 1024);
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+
+ChunkMap TakeSnapshot(VoxelGrid &grid) {
+    ChunkMap chunks;
+    grid.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        chunks[chunk.GetChunkGridPosition()] = grid.GetChunkData(chunk.GetIndex());
+    });
+    return chunks;
+}
+
+size_t CountStorages(VoxelGrid &grid) {
+    std::set<const VoxelGrid::ChunkData *> storages;
+    grid.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        storages.insert(grid.GetChunkStorage(chunk.GetIndex()));
+    });
+    return storages.size();
+}
+
+/**
+ * Deduplicates @world and checks that the voxels stay the same, then edits shared chunks in different ways and
+ * checks that only the edited chunks change.
+ */
+bool CheckWorld(VoxelGrid &world, const char *name, const std::shared_ptr<spdlog::logger> &logger) {
+    ChunkMap before = TakeSnapshot(world);
+    size_t size_before = world.GetSizeBytes();
+
+    Timer timer;
+    world.SetDeduplication(true);
+    double time = timer.GetTime();
+    size_t stored = world.GetStoredChunksNum();
+    logger->info("{}: {} chunks stored as {} in {:.1f}ms, {:.1f} MB -> {:.1f} MB", name, before.size(), stored,
+                 time * 1e3, size_before / 1048576.0, world.GetSizeBytes() / 1048576.0);
+    // The grid also stores its empty chunk
+    if (TakeSnapshot(world) != before || CountStorages(world) + 1 != stored) {
+        logger->error("{}: deduplication changed the world", name);
+        return false;
+    }
+
+    // Copy on write: every kind of edit changes one chunk only
+    auto shared = std::find_if(before.begin(), before.end(), [&](auto &chunk) {
+        auto index = world.GetChunkGridView().At(chunk.first);
+        return std::count_if(before.begin(), before.end(), [&](auto &other) {
+            return world.GetChunkStorage(world.GetChunkGridView().At(other.first)) == world.GetChunkStorage(index);
+        }) > 1;
+    });
+    if (shared == before.end()) {
+        return true;
+    }
+    glm::ivec3 origin = shared->first * VoxelGrid::CHUNK_SIZE;
+    VoxelGrid::ChunkData original = shared->second;
+    world.SetVoxel(origin + glm::ivec3(1, 2, 3), 0x123456u);
+    world.FillColumn(origin + glm::ivec3(5, 0, 5), 7, 0x654321u);
+    before[shared->first][1][2][3] = 0x123456u;
+    VoxelGrid::FillChunkColumn(before[shared->first], {5, 0, 5}, 7, 0x654321u);
+    if (TakeSnapshot(world) != before || world.GetStoredChunksNum() != stored + 1) {
+        logger->error("{}: edit of a shared chunk changed other chunks", name);
+        return false;
+    }
+
+    // Batches are merged before listeners see them, an update that restores the voxels shares them again
+    world.UpdateChunks({shared->first}, [&](const std::vector<VoxelGrid::ChunkIndexType> &indices) {
+        world.GetChunkData(indices[0]) = original;
+    });
+    before[shared->first] = original;
+    if (TakeSnapshot(world) != before || world.GetStoredChunksNum() != stored) {
+        logger->error("{}: updated chunk was not merged, {} chunks stored", name, world.GetStoredChunksNum());
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    VoxelGrid test_world(TEST_WORLD_SIZE, glm::dvec3(0.0));
+    WorldGen().ResetTestWorld(test_world);
+    if (!CheckWorld(test_world, "Test world", logger) || test_world.GetStoredChunksNum() > 2) {
+        return EXIT_FAILURE;
+    }
+
+    VoxelGrid world(WORLD_SIZE, glm::dvec3(0.0));
+    WorldGen().Generate(world, *logger);
+    if (!CheckWorld(world, "Generated world", logger)) {
+        return EXIT_FAILURE;
+    }
+
+    // Chunks created in a batch take the voxels of identical ones
+    size_t stored = world.GetStoredChunksNum();
+    std::vector<glm::ivec3> positions;
+    for (int x = 0; x < 16; x++) {
+        positions.emplace_back(x, 7, 31);
+    }
+    world.CreateChunks(positions, [&](const std::vector<VoxelGrid::ChunkIndexType> &indices) {
+        for (auto index: indices) {
+            VoxelGrid::FillChunkColumn(world.GetChunkData(index), {3, 0, 5}, 20, 0x00ff00u);
+        }
+    });
+    if (world.GetStoredChunksNum() != stored + 1) {
+        logger->error("Created chunks were not merged, {} new chunks stored", world.GetStoredChunksNum() - stored);
+        return EXIT_FAILURE;
+    }
+
+    // Deleted chunks release their voxels
+    for (auto &position: positions) {
+        world.DeleteChunk(position);
+    }
+    if (world.GetStoredChunksNum() != stored) {
+        logger->error("Deleted chunks kept their voxels, {} chunks stored", world.GetStoredChunksNum());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+#include <lit/engine/systems/voxels/chunk_provider.hpp>
+#include <lit/engine/components/transform.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = VoxelGridSparseT<uint32_t>;
+
+// Window of 16x16 columns, the provider recenters it when the observer is 4 columns away from the center
+const glm::ivec3 WINDOW_SIZE = glm::ivec3(512, 256, 512);
+const char *SAVE_DIRECTORY = "chunk_streaming_benchmark";
+const uint32_t EDIT_VALUE = 0xff00ffu;
+
+ChunkProviderSettings MakeSettings() {
+    ChunkProviderSettings settings;
+    settings.load_radius = 4;
+    settings.unload_radius = 6;
+    settings.save_directory = SAVE_DIRECTORY;
+    return settings;
+}
+
+void MoveObserver(entt::registry &registry, entt::entity observer, glm::ivec2 columns) {
+    registry.get<TransformComponent>(observer).translation +=
+            glm::dvec3(columns.x, 0, columns.y) * (double) VoxelGrid::CHUNK_SIZE * ChunkProvider::VOXEL_SIZE;
+}
+
+/**
+ * Position of the top chunk of the world @column in the grid, y is negative if the column has no chunks.
+ */
+glm::ivec3 FindTopChunk(VoxelGrid &world, glm::ivec2 origin, glm::ivec2 column) {
+    glm::ivec3 position(column.x - origin.x, -1, column.y - origin.y);
+    for (int y = 0; y < world.GetChunkGridDimensions().y; y++) {
+        if (world.GetChunkGridView().At(position.x, y, position.z) != VoxelGrid::CHUNK_EMPTY) {
+            position.y = y;
+        }
+    }
+    return position;
+}
+
+size_t CountSavedColumns() {
+    size_t count = 0;
+    for (auto &entry: std::filesystem::directory_iterator(SAVE_DIRECTORY)) {
+        count += entry.is_regular_file();
+    }
+    return count;
+}
+
+/**
+ * Streams the area around the observer, edits a column on the edge of the window and moves the observer until
+ * the window is recentered past that column, then moves it back. The edited column must be saved on the way out
+ * (and be the only saved one) and come back with the edit.
+ */
+bool RunBenchmark(const std::shared_ptr<spdlog::logger> &logger) {
+    entt::registry registry;
+    auto world_entity = registry.create();
+    auto &world = registry.emplace<VoxelGrid>(world_entity, WINDOW_SIZE, glm::dvec3(0.0));
+    auto observer = registry.create();
+    registry.emplace<TransformComponent>(observer);
+
+    // Observer starts in the world column (8, 5), near the center of the window and above the terrain
+    MoveObserver(registry, observer, glm::ivec2(0, -3));
+    ChunkProvider provider(registry, observer, MakeSettings());
+    Timer timer;
+    provider.Flush();
+    logger->info("{} columns streamed in {:.1f}ms", provider.GetLoadedColumnsCount(), timer.GetTime() * 1e3);
+
+    // The column leaves the window when the observer moves 5 columns along x and the window follows
+    const glm::ivec2 edit_column(4, 5);
+    glm::ivec3 edit_chunk = FindTopChunk(world, provider.GetOrigin(), edit_column);
+    if (provider.GetOrigin() != glm::ivec2(0) || edit_chunk.y < 0) {
+        logger->error("Column ({}, {}) was not streamed", edit_column.x, edit_column.y);
+        return false;
+    }
+    VoxelGrid::ChunkData expected = world.GetChunkData(world.GetChunkGridView().At(edit_chunk));
+    expected[1][2][3] = EDIT_VALUE;
+    world.SetVoxel(edit_chunk * VoxelGrid::CHUNK_SIZE + glm::ivec3(1, 2, 3), EDIT_VALUE);
+
+    timer.Reset();
+    MoveObserver(registry, observer, glm::ivec2(5, 0));
+    provider.Flush();
+    logger->info("Window recentered to ({}, {}) in {:.1f}ms, {} columns loaded", provider.GetOrigin().x,
+                 provider.GetOrigin().y, timer.GetTime() * 1e3, provider.GetLoadedColumnsCount());
+    if (provider.GetOrigin().x != 5 || CountSavedColumns() != 1) {
+        logger->error("Edited column was not saved on recentering, {} columns saved", CountSavedColumns());
+        return false;
+    }
+
+    timer.Reset();
+    MoveObserver(registry, observer, glm::ivec2(-5, 0));
+    provider.Flush();
+    logger->info("Window recentered back to ({}, {}) in {:.1f}ms", provider.GetOrigin().x, provider.GetOrigin().y,
+                 timer.GetTime() * 1e3);
+    edit_chunk = FindTopChunk(world, provider.GetOrigin(), edit_column);
+    if (provider.GetOrigin().x != 0 || edit_chunk.y < 0 ||
+        world.GetChunkData(world.GetChunkGridView().At(edit_chunk)) != expected) {
+        logger->error("Edited column was not loaded back");
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **) {
+    std::filesystem::remove_all(SAVE_DIRECTORY);
+    bool passed = RunBenchmark(spdlog::default_logger());
+    std::filesystem::remove_all(SAVE_DIRECTORY);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,125 @@
+#include <lit/engine/utilities/cone_voxelizer.hpp>
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <random>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+const int WORLD_SIZE = 512;
+const int WORLD_HEIGHT = 128;
+const int TREES_COUNT = 64;
+const int MAX_DEPTH = 4;
+const double MAX_MISMATCH_FRACTION = 1e-3;
+
+/**
+ * Branch, its three children and so on, similar to the graphs of TreeGen.
+ */
+void AddBranch(std::mt19937 &rng, glm::dvec3 origin, glm::dvec3 direction, double length, double radius, int depth,
+               std::vector<RoundCone> &cones) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> normal;
+
+    glm::dvec3 end = origin + direction * length;
+    cones.push_back(RoundCone{origin, end, (float) radius, (float) (radius * 0.8), 0x4a301a + (uint32_t) depth});
+    if (depth == MAX_DEPTH) {
+        return;
+    }
+    for (int i = 0; i < 3; i++) {
+        glm::dvec3 child = glm::normalize(direction + glm::dvec3(normal(rng), normal(rng), normal(rng)) * 0.7);
+        AddBranch(rng, origin + direction * length * (0.5 + 0.5 * uniform(rng)), child, length * 0.7, radius * 0.6,
+                  depth + 1, cones);
+    }
+}
+
+/**
+ * Previous TreeGen::PlaceBranch: tests every voxel of the bounding box of the cone in double precision.
+ */
+void PlaceBranch(const RoundCone &cone, VoxelGridBaseT<uint32_t> &grid) {
+    auto dims = grid.GetDimensions();
+    auto anchor = grid.GetAnchor();
+    glm::dvec3 origin = cone.begin;
+    double length = glm::length(glm::dvec3(cone.end) - origin);
+    glm::dvec3 direction = (glm::dvec3(cone.end) - origin) / length;
+    double radius = std::max(cone.radius_begin, cone.radius_end);
+
+    glm::ivec3 min = glm::ivec3(glm::min(glm::dvec3(cone.end), origin) + anchor - (radius + 2));
+    glm::ivec3 max = glm::ivec3(glm::max(glm::dvec3(cone.end), origin) + anchor + (radius + 2));
+
+    for (int i = std::max(0, min.x); i < std::min(dims.x, max.x); i++) {
+        for (int j = std::max(0, min.y); j < std::min(dims.y, max.y); j++) {
+            for (int k = std::max(0, min.z); k < std::min(dims.z, max.z); k++) {
+                glm::dvec3 v = glm::dvec3{i + 0.5, j + 0.5, k + 0.5} - anchor;
+
+                double dotA = glm::dot(v - origin, direction);
+                double dotB = glm::dot(v - direction * length - origin, -direction);
+                bool inside;
+                if (dotA >= 0 && dotB >= 0) {
+                    double dist = glm::length(glm::cross(v - origin, direction));
+                    inside = dist <= cone.radius_begin * (1 - dotA / length) + cone.radius_end * dotA / length;
+                } else if (dotA < 0) {
+                    inside = glm::length(v - origin) <= cone.radius_begin;
+                } else {
+                    inside = glm::length(v - direction * length - origin) <= cone.radius_end;
+                }
+                if (inside) {
+                    grid.SetVoxel({i, j, k}, cone.value);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Voxelizes a forest cone by cone and with ConeVoxelizer, reports the speedup
+ * and fails if more than MAX_MISMATCH_FRACTION of voxels differ (float and double disagree on the boundary).
+ */
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> position(-WORLD_SIZE * 0.45, WORLD_SIZE * 0.45);
+    std::normal_distribution<double> normal;
+    std::vector<RoundCone> cones;
+    for (int i = 0; i < TREES_COUNT; i++) {
+        glm::dvec3 direction = glm::normalize(glm::dvec3(normal(rng) * 0.1, 1.0, normal(rng) * 0.1));
+        AddBranch(rng, glm::dvec3(position(rng), 0, position(rng)), direction, 40.0, 5.0, 0, cones);
+    }
+    logger->info("{} trees, {} branches", TREES_COUNT, cones.size());
+
+    glm::dvec3 anchor(WORLD_SIZE / 2, 0, WORLD_SIZE / 2);
+    VoxelGridSparseT<uint32_t> expected(glm::ivec3(WORLD_SIZE, WORLD_HEIGHT, WORLD_SIZE), anchor);
+    VoxelGridSparseT<uint32_t> actual(glm::ivec3(WORLD_SIZE, WORLD_HEIGHT, WORLD_SIZE), anchor);
+
+    Timer timer;
+    for (auto &cone: cones) {
+        PlaceBranch(cone, expected);
+    }
+    double reference_time = timer.GetTimeAndReset();
+    ConeVoxelizer voxelizer(cones);
+    voxelizer.Voxelize(actual);
+    double voxelizer_time = timer.GetTimeAndReset();
+
+    size_t filled = 0;
+    size_t mismatches = 0;
+    for (int i = 0; i < WORLD_SIZE; i++) {
+        for (int j = 0; j < WORLD_HEIGHT; j++) {
+            for (int k = 0; k < WORLD_SIZE; k++) {
+                uint32_t a = expected.GetVoxel({i, j, k});
+                filled += a != 0;
+                mismatches += a != actual.GetVoxel({i, j, k});
+            }
+        }
+    }
+
+    logger->info("Cone by cone {:.1f}ms, voxelizer {:.1f}ms ({:.1f}x{}), {} voxels, {} mismatches",
+                 reference_time * 1e3, voxelizer_time * 1e3, reference_time / voxelizer_time,
+                 ConeVoxelizer::IsVectorized() ? "" : ", not vectorized", filled, mismatches);
+
+    if ((double) mismatches > (double) filled * MAX_MISMATCH_FRACTION) {
+        logger->error("Voxelizer differs from the reference in {} voxels", mismatches);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/systems/voxels/voxel_grid_lod_manager.hpp>
+#include <lit/engine/utilities/voxel_ray_caster.hpp>
+#include <lit/engine/utilities/voxel_ray_packet_caster.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using RayCastResult = VoxelRayCaster::RayCastResult;
+
+const int WORLD_SIZE = 512;
+const int RAYS_COUNT = 1 << 19;
+const int MAX_ITERATIONS = 1024;
+
+struct Rays {
+    std::vector<glm::vec3> origins;
+    std::vector<glm::vec3> dirs;
+};
+
+struct RunResult {
+    std::vector<RayCastResult> results;
+    size_t iterations = 0;
+    double single_time = 0.0;
+    double packet_time = 0.0;
+};
+
+/**
+ * Rays from random points above the terrain in random directions, most of them cross large empty regions.
+ */
+Rays GenerateRays() {
+    std::mt19937 rng(0);
+    float half_size = WORLD_SIZE * VoxelRayCaster::VOXEL_SIZE * 0.5f;
+    std::uniform_real_distribution<float> coordinate(-half_size, half_size);
+    std::uniform_real_distribution<float> height(0.0f, half_size);
+    std::normal_distribution<float> direction;
+
+    Rays rays;
+    for (int i = 0; i < RAYS_COUNT; i++) {
+        rays.origins.emplace_back(coordinate(rng), height(rng), coordinate(rng));
+        rays.dirs.push_back(glm::normalize(glm::vec3(direction(rng), direction(rng), direction(rng))));
+    }
+    return rays;
+}
+
+RunResult Run(const VoxelRayCaster &caster, const Rays &rays) {
+    VoxelRayPacketCaster packet_caster(caster);
+
+    RunResult run;
+    size_t count = rays.origins.size();
+    run.results.resize(count);
+    std::vector<RayCastResult> packet_results(count);
+
+    Timer timer;
+    for (size_t i = 0; i < count; i++) {
+        run.results[i] = caster.WorldRayCast(rays.origins[i], rays.dirs[i], MAX_ITERATIONS);
+    }
+    run.single_time = timer.GetTimeAndReset();
+
+    packet_caster.WorldRayCast(rays.origins.data(), rays.dirs.data(), count, MAX_ITERATIONS, packet_results.data());
+    run.packet_time = timer.GetTimeAndReset();
+
+    for (auto &res: run.results) {
+        run.iterations += res.iterations;
+    }
+    return run;
+}
+
+void LogRun(const std::string &name, const RunResult &run, spdlog::logger &logger) {
+    double count = (double) run.results.size();
+    logger.info("{}: {:.2f} iterations per ray, single {:.2f} Mrays/s, packet {:.2f} Mrays/s", name,
+                (double) run.iterations / count, count / run.single_time * 1e-6, count / run.packet_time * 1e-6);
+}
+
+/**
+ * Deletes a column of chunks and creates a chunk in the sky, then deletes that chunk again. After every commit the
+ * incrementally updated chunk grid distance field must equal the one computed for the whole grid.
+ */
+bool CheckIncrementalUpdate(VoxelGridSparseT<uint32_t> &world, VoxelGridSparseLodDataT<uint32_t> &grid_lod,
+                            VoxelGridLodManager<uint32_t> &lod_manager, spdlog::logger &logger) {
+    using VoxelGrid = VoxelGridSparseT<uint32_t>;
+    using VoxelGridLod = VoxelGridSparseLodDataT<uint32_t>;
+
+    glm::ivec3 dims = world.GetChunkGridDimensions();
+    glm::ivec3 sky_chunk = glm::ivec3(1, dims.y - 1, 1);
+    std::vector<std::function<void()>> edits = {
+            [&]() {
+                for (int y = 0; y < dims.y; y++) {
+                    world.DeleteChunk(glm::ivec3(dims.x / 2, y, dims.z / 2));
+                }
+                world.SetVoxel(sky_chunk * VoxelGrid::CHUNK_SIZE, 0xffffffu);
+            },
+            [&]() { world.DeleteChunk(sky_chunk); }
+    };
+
+    Timer timer;
+    for (auto &edit: edits) {
+        edit();
+        timer.Reset();
+        lod_manager.CommitChanges();
+        double time = timer.GetTimeAndReset();
+
+        std::vector<uint8_t> expected(grid_lod.m_grid_distance_data.size());
+        Array3DView grid_view = grid_lod.GetChunkGridViewAtLod(0);
+        ComputeChebyshevDistance(Array3DView(dims, expected.data(), expected.data() + expected.size()),
+                                 [&grid_view](int i, int j, int k) {
+                                     return grid_view.At(i, j, k) != VoxelGrid::CHUNK_EMPTY;
+                                 }, VoxelGridLod::DISTANCE_FIELD_MAX);
+        logger.info("Changes committed in {:.2f}ms, full recompute of the chunk grid distance field takes {:.2f}ms",
+                    time * 1e3, timer.GetTimeAndReset() * 1e3);
+        if (expected != grid_lod.m_grid_distance_data) {
+            logger.error("Incrementally updated distance field differs");
+            return false;
+        }
+        for (int value = 0; value <= VoxelGridLod::DISTANCE_FIELD_MAX; value++) {
+            if (grid_lod.m_grid_distance_counts[value] != (size_t) std::count(expected.begin(), expected.end(), value)) {
+                logger.error("Wrong number of cells with distance {}", value);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Compares ray traversal with and without distance fields on the same rays.
+ * Hits should be the same, only the number of iterations changes.
+ */
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    entt::registry registry;
+    auto ent = registry.create();
+    auto &world = registry.emplace<VoxelGridSparseT<uint32_t>>(ent, glm::ivec3(WORLD_SIZE), glm::dvec3(0.0));
+    auto &grid_lod = registry.emplace<VoxelGridSparseLodDataT<uint32_t>>(ent);
+    grid_lod.m_distance_field_enabled = true;
+
+    Timer timer;
+    WorldGen().Generate(world, *logger);
+    logger->info("World generated in {:.2f}s", timer.GetTimeAndReset());
+
+    VoxelGridLodManager<uint32_t> lod_manager(registry);
+    lod_manager.CommitChanges();
+    logger->info("LODs and distance fields built in {:.2f}s", timer.GetTimeAndReset());
+
+    VoxelRayCaster caster(world, grid_lod);
+    Rays rays = GenerateRays();
+
+    caster.SetUseDistanceField(false);
+    RunResult plain = Run(caster, rays);
+    LogRun("Without distance field", plain, *logger);
+
+    caster.SetUseDistanceField(true);
+    RunResult skipping = Run(caster, rays);
+    LogRun("With distance field", skipping, *logger);
+
+    // Rays that graze an edge of a voxel can hit its neighbour at the same depth, count only different depths
+    size_t mismatches = 0;
+    for (size_t i = 0; i < plain.results.size(); i++) {
+        auto &a = plain.results[i];
+        auto &b = skipping.results[i];
+        mismatches += a.hit != b.hit || (a.hit && std::abs(a.depth - b.depth) > VoxelRayCaster::VOXEL_SIZE);
+    }
+    logger->info("Iterations: {:.2f}x fewer, mismatches: {}",
+                 (double) plain.iterations / (double) std::max<size_t>(skipping.iterations, 1), mismatches);
+
+    return CheckIncrementalUpdate(world, grid_lod, lod_manager, *logger) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,190 @@
+#include <lit/engine/utilities/edit_history.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <map>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = EditHistory::VoxelGrid;
+using ChunkMap = std::map<glm::ivec3, VoxelGrid::ChunkData, glm_ext::vec3_comparator<int>>;
+
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+const size_t MEMORY_BUDGET = 64 << 20;
+const int SPHERE_RADIUS = 40;
+const size_t SMALL_BUDGET = 16 << 10;
+const int SMALL_EDITS = 200;
+
+ChunkMap TakeSnapshot(VoxelGrid &grid) {
+    ChunkMap chunks;
+    grid.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        chunks[chunk.GetChunkGridPosition()] = grid.GetChunkData(chunk.GetIndex());
+    });
+    return chunks;
+}
+
+/**
+ * Surface height of the column, or 0 if it is empty.
+ */
+int GetSurface(VoxelGrid &grid, int x, int z) {
+    for (int y = WORLD_SIZE.y - 1; y >= 0; y--) {
+        if (grid.GetVoxel({x, y, z})) {
+            return y + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Point on the highest surface of a coarse grid of columns, terrain does not cover the whole world.
+ */
+glm::ivec3 FindSurfacePoint(VoxelGrid &grid) {
+    glm::ivec3 best(0);
+    for (int x = 0; x < WORLD_SIZE.x; x += VoxelGrid::CHUNK_SIZE) {
+        for (int z = 0; z < WORLD_SIZE.z; z += VoxelGrid::CHUNK_SIZE) {
+            int surface = GetSurface(grid, x, z);
+            if (surface > best.y) {
+                best = glm::ivec3(x, surface, z);
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * Edits of different kinds: a sphere carved voxel by voxel, pillars of FillColumn runs, a chunk deleted and
+ * new chunks created in a batch.
+ */
+void Edit(VoxelGrid &grid, int kind) {
+    glm::ivec3 center = FindSurfacePoint(grid);
+    switch (kind) {
+        case 0:
+            for (int x = -SPHERE_RADIUS; x <= SPHERE_RADIUS; x++) {
+                for (int y = -SPHERE_RADIUS; y <= SPHERE_RADIUS; y++) {
+                    for (int z = -SPHERE_RADIUS; z <= SPHERE_RADIUS; z++) {
+                        if (x * x + y * y + z * z <= SPHERE_RADIUS * SPHERE_RADIUS) {
+                            grid.SetVoxel(center + glm::ivec3(x, y, z), 0);
+                        }
+                    }
+                }
+            }
+            break;
+        case 1:
+            for (int x = 0; x < WORLD_SIZE.x; x += 16) {
+                for (int z = 0; z < WORLD_SIZE.z; z += 16) {
+                    grid.FillColumn({x, 0, z}, 120, 0xff8000u);
+                }
+            }
+            break;
+        default: {
+            grid.DeleteChunk((center - 1) / VoxelGrid::CHUNK_SIZE);
+            std::vector<glm::ivec3> positions;
+            for (int x = 0; x < 4; x++) {
+                positions.emplace_back(x, 6, 0);
+            }
+            grid.CreateChunks(positions, [&](const std::vector<VoxelGrid::ChunkIndexType> &indices) {
+                for (auto index: indices) {
+                    VoxelGrid::FillChunkColumn(grid.GetChunkData(index), {3, 0, 5}, 20, 0x00ff00u);
+                }
+            });
+        }
+    }
+}
+
+/**
+ * Records three transactions on a generated world, undoes and redoes them and compares the chunks with
+ * snapshots of every state. Counts chunk notifications to check that every chunk changes once per undo,
+ * and checks that a small budget drops the oldest transactions.
+ */
+bool RunBenchmark(const std::shared_ptr<spdlog::logger> &logger) {
+    VoxelGrid world(WORLD_SIZE, glm::dvec3(0.0));
+    WorldGen().Generate(world, *logger);
+
+    std::map<VoxelGrid::ChunkIndexType, int> notifications;
+    world.AddOnChunkAnyChangeCallback([&](const auto &args) {
+        std::visit([&](const auto &change) { notifications[change.index]++; }, args);
+    });
+
+    EditHistory history(world, MEMORY_BUDGET);
+    std::vector<ChunkMap> states = {TakeSnapshot(world)};
+    Timer timer;
+    for (int kind = 0; kind < 3; kind++) {
+        Edit(world, kind);
+        history.Commit();
+        states.push_back(TakeSnapshot(world));
+        if (history.GetUndoCount() != (size_t) (kind + 1)) {
+            logger->error("Edit {} was not recorded", kind);
+            return false;
+        }
+    }
+    double record_time = timer.GetTimeAndReset();
+    logger->info("3 transactions recorded in {:.1f}ms, {:.1f} KB of deltas", record_time * 1e3,
+                 history.GetMemoryUsage() / 1024.0);
+
+    for (int i = 2; i >= 0; i--) {
+        notifications.clear();
+        timer.Reset();
+        history.Undo();
+        double undo_time = timer.GetTime();
+        auto most = std::max_element(notifications.begin(), notifications.end(),
+                                     [](auto &a, auto &b) { return a.second < b.second; });
+        logger->info("Transaction {} undone in {:.2f}ms, {} chunks notified", i, undo_time * 1e3,
+                     notifications.size());
+        if (TakeSnapshot(world) != states[i]) {
+            logger->error("World differs after undoing transaction {}", i);
+            return false;
+        }
+        // A chunk deleted and created at the same index is reported twice
+        if (most != notifications.end() && most->second > 2) {
+            logger->error("Chunk notified {} times by one undo", most->second);
+            return false;
+        }
+    }
+    if (history.Undo()) {
+        logger->error("Undo beyond the first transaction");
+        return false;
+    }
+
+    timer.Reset();
+    while (history.Redo()) {}
+    logger->info("3 transactions redone in {:.2f}ms", timer.GetTime() * 1e3);
+    if (TakeSnapshot(world) != states.back()) {
+        logger->error("World differs after redoing the transactions");
+        return false;
+    }
+
+    // A new edit after an undo drops the redo list
+    history.Undo();
+    world.SetVoxel({1, 1, 1}, 0x123456u);
+    if (history.Redo() || history.GetRedoCount() != 0) {
+        logger->error("Redo after a new edit");
+        return false;
+    }
+
+    // The budget keeps only the last transactions, undoing all of them leaves the oldest edits
+    EditHistory small_history(world, SMALL_BUDGET);
+    for (int i = 0; i < SMALL_EDITS; i++) {
+        world.FillColumn({i, 0, i}, WORLD_SIZE.y, 0x0000ffu + i);
+        small_history.Commit();
+    }
+    if (small_history.GetMemoryUsage() > SMALL_BUDGET || small_history.GetUndoCount() >= SMALL_EDITS) {
+        logger->error("History exceeds its budget: {} transactions, {} bytes", small_history.GetUndoCount(),
+                      small_history.GetMemoryUsage());
+        return false;
+    }
+    size_t kept = small_history.GetUndoCount();
+    while (small_history.Undo()) {}
+    int oldest_kept = SMALL_EDITS - (int) kept;
+    if (kept == 0 || world.GetVoxel({oldest_kept - 1, 0, oldest_kept - 1}) != 0x0000ffu + oldest_kept - 1 ||
+        world.GetVoxel({oldest_kept, 0, oldest_kept}) == 0x0000ffu + oldest_kept) {
+        logger->error("Wrong transactions were dropped");
+        return false;
+    }
+    logger->info("{} of {} transactions kept within {} KB", kept, SMALL_EDITS, SMALL_BUDGET / 1024);
+    return true;
+}
+
+int main(int, char **) {
+    return RunBenchmark(spdlog::default_logger()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
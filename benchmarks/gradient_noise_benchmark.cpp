@@ -0,0 +1,72 @@
+#include <lit/engine/generators/gradient_noise.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <cmath>
+#include <vector>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+const int CHUNK_SIZE = 32;
+const int CHUNKS_COUNT = 64;
+const float TOLERANCE = 1e-5f;
+
+struct Case {
+    float wavelength;
+    int levels;
+};
+
+/**
+ * Evaluates chunks of fractal noise point by point and with GetFractalNoiseGrid, reports the speedup
+ * and fails if any value differs by more than TOLERANCE.
+ */
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+    GradientNoise noise(0);
+
+    // Colour noises of VoxelWorldGenerator
+    std::vector<Case> cases = {{4.3f, 3}, {3.4f, 3}, {13.3f, 3}, {16.4f, 3}, {400.0f, 3}, {1900.0f, 3}};
+
+    std::vector<glm::ivec3> origins;
+    for (int i = 0; i < CHUNKS_COUNT; i++) {
+        // Negative coordinates and the wrap of the period are covered as well
+        origins.push_back(glm::ivec3(i % 4 - 2, i / 4 % 4 - 2, i / 16 - 2) * CHUNK_SIZE * 67);
+    }
+
+    size_t voxels = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+    std::vector<float> expected(voxels);
+    std::vector<float> actual(voxels);
+    int result = EXIT_SUCCESS;
+    for (auto &c: cases) {
+        double point_time = 0.0;
+        double grid_time = 0.0;
+        float max_error = 0.0f;
+        for (auto &origin: origins) {
+            Timer timer;
+            for (int i = 0; i < CHUNK_SIZE; i++) {
+                for (int j = 0; j < CHUNK_SIZE; j++) {
+                    for (int k = 0; k < CHUNK_SIZE; k++) {
+                        expected[(i * CHUNK_SIZE + j) * CHUNK_SIZE + k] =
+                                noise.GetFractalNoise(glm::vec3(origin + glm::ivec3(i, j, k)), c.wavelength, c.levels);
+                    }
+                }
+            }
+            point_time += timer.GetTimeAndReset();
+            noise.GetFractalNoiseGrid(origin, glm::ivec3(CHUNK_SIZE), c.wavelength, c.levels, actual.data());
+            grid_time += timer.GetTimeAndReset();
+
+            for (size_t i = 0; i < voxels; i++) {
+                max_error = std::max(max_error, std::abs(expected[i] - actual[i]));
+            }
+        }
+
+        logger->info("Wavelength {} x{}: points {:.1f}ms, grid {:.1f}ms ({:.1f}x), max error {}", c.wavelength,
+                     c.levels, point_time * 1e3, grid_time * 1e3, point_time / grid_time, max_error);
+        if (max_error > TOLERANCE) {
+            logger->error("Grid differs from the point by point noise");
+            result = EXIT_FAILURE;
+        }
+    }
+    logger->info("Gradient tables: {} bytes", sizeof(GradientNoise));
+    return result;
+}
@@ -0,0 +1,117 @@
+#include <lit/engine/utilities/min_max_filter.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <deque>
+#include <random>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+const int MAP_SIZE = 2048;
+
+/**
+ * Previous implementation from WorldGen: monotonic deque per column and one more per row.
+ */
+Array2D<int> computeMinOrMaxInWindow(const Array2D<int> &height, int windowRadius, bool computeMin) {
+    auto res = height;
+    std::vector<std::deque<std::pair<int, int>>> queues(height.GetWidth());
+
+    auto compare = [&computeMin](int a, int b) {
+        return computeMin ? a < b : a > b;
+    };
+
+    auto push = [&compare](std::deque<std::pair<int, int>> &q, int index, int value) {
+        while (!q.empty() && !compare(q.back().second, value)) {
+            q.pop_back();
+        }
+        q.emplace_back(index, value);
+    };
+
+    auto pop = [](std::deque<std::pair<int, int>> &q, int index) {
+        while (!q.empty() && q.front().first <= index) {
+            q.pop_front();
+        }
+    };
+
+    int width = (int) height.GetWidth();
+    int rows = (int) height.GetHeight();
+    for (int i = 0; i < width; i++) {
+        for (int j = 0; j < windowRadius; j++) {
+            push(queues[i], j, height.at(i, j));
+        }
+    }
+
+    for (int j = 0; j < rows; j++) {
+        for (int i = 0; i < width; i++) {
+            if (j + windowRadius < rows) {
+                push(queues[i], j + windowRadius, height.at(i, j + windowRadius));
+            }
+            pop(queues[i], j - windowRadius - 1);
+        }
+        std::deque<std::pair<int, int>> q;
+        for (int i = 0; i < windowRadius; i++) {
+            push(q, i, queues[i].front().second);
+        }
+
+        for (int i = 0; i < width; i++) {
+            if (i + windowRadius < width) {
+                push(q, i + windowRadius, queues[i + windowRadius].front().second);
+            }
+            pop(q, i - windowRadius - 1);
+            res.at(i, j) = q.front().second;
+        }
+    }
+
+    return res;
+}
+
+bool Equal(const Array2D<int> &a, const Array2D<int> &b) {
+    return std::equal(a.data(), a.data() + a.GetWidth() * a.GetHeight(), b.data());
+}
+
+/**
+ * Compares the deque filter with van Herk/Gil-Werman filter (single threaded and on the pool)
+ * on a random height map, fails if the results differ.
+ */
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    // Random walk along both axes, so the map has slopes like a height map and not only noise
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> step(-3, 3);
+    Array2D<int> heights(MAP_SIZE, MAP_SIZE);
+    for (int i = 0; i < MAP_SIZE; i++) {
+        for (int j = 0; j < MAP_SIZE; j++) {
+            int prev = i > 0 ? heights.at(i - 1, j) : (j > 0 ? heights.at(i, j - 1) : 0);
+            heights.at(i, j) = prev + step(rng);
+        }
+    }
+
+    ThreadPool pool;
+    bool ok = true;
+    for (int radius: {1, 12, 64}) {
+        for (bool compute_min: {true, false}) {
+            Timer timer;
+            auto expected = computeMinOrMaxInWindow(heights, radius, compute_min);
+            double deque_time = timer.GetTimeAndReset();
+            auto single = compute_min ? SlidingWindowMin(heights, radius) : SlidingWindowMax(heights, radius);
+            double single_time = timer.GetTimeAndReset();
+            auto parallel = compute_min ? SlidingWindowMin(heights, radius, &pool)
+                                        : SlidingWindowMax(heights, radius, &pool);
+            double parallel_time = timer.GetTimeAndReset();
+
+            bool equal = Equal(expected, single) && Equal(expected, parallel);
+            logger->info("{} radius {}: deque {:.1f}ms, vHGW {:.1f}ms ({:.1f}x), {} threads {:.1f}ms ({:.1f}x){}",
+                         compute_min ? "min" : "max", radius, deque_time * 1e3, single_time * 1e3,
+                         deque_time / single_time, pool.GetThreadsCount(), parallel_time * 1e3,
+                         deque_time / parallel_time, equal ? "" : ", MISMATCH");
+            ok = ok && equal;
+        }
+    }
+
+    if (!ok) {
+        logger->error("van Herk/Gil-Werman filter differs from the deque filter");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include <lit/engine/generators/fnl_batch.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <random>
+#include <vector>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+const int TILE_SIZE = 256;
+const int POINTS_COUNT = 1 << 16;
+const float TOLERANCE = 1e-4f;
+
+struct Case {
+    std::string name;
+    FastNoiseLite::NoiseType noise_type;
+    FastNoiseLite::FractalType fractal_type;
+    int octaves;
+    float wavelength;
+};
+
+/**
+ * Evaluates the same points with FastNoiseLite::GetNoise and with FastNoiseLiteBatch, reports the speedup
+ * and fails if any value differs by more than TOLERANCE.
+ */
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    std::vector<Case> cases = {
+            {"OpenSimplex2",           FastNoiseLite::NoiseType_OpenSimplex2, FastNoiseLite::FractalType_None, 1,  64.0f},
+            {"OpenSimplex2 FBm x10",   FastNoiseLite::NoiseType_OpenSimplex2, FastNoiseLite::FractalType_FBm,  10, 8192.0f},
+            {"Perlin",                 FastNoiseLite::NoiseType_Perlin,       FastNoiseLite::FractalType_None, 1,  64.0f},
+            {"Perlin FBm x6",          FastNoiseLite::NoiseType_Perlin,       FastNoiseLite::FractalType_FBm,  6,  3192.0f},
+    };
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> coordinate(-100000.0f, 100000.0f);
+    std::vector<float> xs(POINTS_COUNT);
+    std::vector<float> ys(POINTS_COUNT);
+    for (int i = 0; i < POINTS_COUNT; i++) {
+        xs[i] = coordinate(rng);
+        ys[i] = coordinate(rng);
+    }
+
+    float max_error = 0.0f;
+    for (auto &c: cases) {
+        FastNoiseLite noise(1337);
+        noise.SetNoiseType(c.noise_type);
+        noise.SetFractalType(c.fractal_type);
+        noise.SetFractalOctaves(c.octaves);
+        noise.SetFrequency(1.0f / c.wavelength);
+
+        if (!FastNoiseLiteBatch::IsVectorized(noise)) {
+            logger->warn("{}: not vectorized in this build", c.name);
+        }
+
+        // Tile of the height map, as used by WorldGen
+        std::vector<float> scalar(TILE_SIZE * TILE_SIZE);
+        std::vector<float> batch(TILE_SIZE * TILE_SIZE);
+        const float x0 = 1024.0f;
+        const float y0 = -512.0f;
+
+        Timer timer;
+        for (int i = 0; i < TILE_SIZE; i++) {
+            for (int j = 0; j < TILE_SIZE; j++) {
+                scalar[i * TILE_SIZE + j] = noise.GetNoise(x0 + (float) i, y0 + (float) j);
+            }
+        }
+        double scalar_time = timer.GetTimeAndReset();
+        FastNoiseLiteBatch::GetNoiseGrid(noise, x0, y0, 1.0f, TILE_SIZE, TILE_SIZE, batch.data());
+        double batch_time = timer.GetTimeAndReset();
+
+        float error = 0.0f;
+        for (size_t i = 0; i < scalar.size(); i++) {
+            error = std::max(error, std::abs(scalar[i] - batch[i]));
+        }
+
+        // Scattered points, also covers negative coordinates
+        std::vector<float> scattered_scalar(POINTS_COUNT);
+        std::vector<float> scattered_batch(POINTS_COUNT);
+        for (int i = 0; i < POINTS_COUNT; i++) {
+            scattered_scalar[i] = noise.GetNoise(xs[i], ys[i]);
+        }
+        FastNoiseLiteBatch::GetNoise(noise, xs.data(), ys.data(), POINTS_COUNT, scattered_batch.data());
+        for (int i = 0; i < POINTS_COUNT; i++) {
+            error = std::max(error, std::abs(scattered_scalar[i] - scattered_batch[i]));
+        }
+
+        double points = (double) scalar.size();
+        logger->info("{}: scalar {:.2f} Msamples/s, batch {:.2f} Msamples/s, speedup {:.2f}x, max error {}", c.name,
+                     points / scalar_time * 1e-6, points / batch_time * 1e-6, scalar_time / batch_time, error);
+        max_error = std::max(max_error, error);
+    }
+
+    if (max_error > TOLERANCE) {
+        logger->error("Batch noise differs from GetNoise by {}", max_error);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
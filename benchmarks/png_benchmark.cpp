@@ -0,0 +1,241 @@
+#include <lit/common/images/images.hpp>
+#include <lit/common/images/lodepng.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <cstdio>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = VoxelGridSparseT<uint32_t>;
+
+const char *TEST_PATH = "png_benchmark_test.png";
+const char *LARGE_PATH = "png_benchmark_large.png";
+const char *HEIGHT_MAP_PATH = "png_benchmark_heights.png";
+const unsigned LARGE_SIZE = 4096;
+const int FILES_COUNT = 6;
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+const int MAX_HEIGHT = 300;
+
+struct Format {
+    const char *name;
+    LodePNGColorType color_type;
+    unsigned bit_depth;
+    bool interlaced;
+};
+
+/**
+ * RGBA 16-bit pixels with gradients and noise, so all filter types are used. Formats with fewer colors
+ * get the colors of a small palette.
+ */
+std::vector<unsigned char> MakePixels(unsigned width, unsigned height, bool few_colors) {
+    std::vector<unsigned char> pixels((size_t) width * height * 8);
+    uint32_t state = 12345;
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x++) {
+            state = state * 1664525u + 1013904223u;
+            uint16_t values[4] = {uint16_t(x * 65535 / width + (state >> 24)), uint16_t(y * 65535 / height),
+                                  uint16_t(state >> 8), uint16_t(state >> 16 | 0x8000)};
+            if (few_colors) {
+                int color = (x / 7 + y / 5 + (state >> 30)) % 5;
+                values[0] = values[1] = values[2] = uint16_t(color * 0x3333);
+                values[3] = color == 4 ? 0 : 0xffff;
+            }
+            for (int c = 0; c < 4; c++) {
+                pixels[((size_t) y * width + x) * 8 + 2 * c] = uint8_t(values[c] >> 8);
+                pixels[((size_t) y * width + x) * 8 + 2 * c + 1] = uint8_t(values[c]);
+            }
+        }
+    }
+    return pixels;
+}
+
+bool Encode(const std::string &path, const std::vector<unsigned char> &pixels, unsigned width, unsigned height,
+            const Format &format) {
+    lodepng::State state;
+    state.info_raw.colortype = LCT_RGBA;
+    state.info_raw.bitdepth = 16;
+    state.encoder.auto_convert = 0;
+    state.info_png.color.colortype = format.color_type;
+    state.info_png.color.bitdepth = format.bit_depth;
+    state.info_png.interlace_method = format.interlaced ? 1 : 0;
+    if (format.color_type == LCT_PALETTE) {
+        for (int color = 0; color < 5; color++) {
+            auto value = (unsigned char) (color * 0x33);
+            lodepng_palette_add(&state.info_png.color, value, value, value, color == 4 ? 0 : 255);
+        }
+    }
+    std::vector<unsigned char> file;
+    return lodepng::encode(file, pixels, width, height, state) == 0 && lodepng::save_file(file, path) == 0;
+}
+
+/**
+ * Every format is decoded by ReadPNG_RGBA, ReadPNG_RGB and 16-bit rows of PngReader and compared with lodepng.
+ */
+bool CheckFormats(const std::shared_ptr<spdlog::logger> &logger) {
+    const Format formats[] = {
+            {"gray 1",          LCT_GREY,       1,  false},
+            {"gray 4",          LCT_GREY,       4,  false},
+            {"gray 8",          LCT_GREY,       8,  false},
+            {"gray 16",         LCT_GREY,       16, false},
+            {"gray alpha 8",    LCT_GREY_ALPHA, 8,  false},
+            {"RGB 8",           LCT_RGB,        8,  false},
+            {"RGB 16",          LCT_RGB,        16, false},
+            {"RGBA 8",          LCT_RGBA,       8,  false},
+            {"RGBA 16",         LCT_RGBA,       16, false},
+            {"palette 4",       LCT_PALETTE,    4,  false},
+            {"palette 8",       LCT_PALETTE,    8,  false},
+            {"RGBA 8 Adam7",    LCT_RGBA,       8,  true},
+    };
+    const unsigned width = 301;
+    const unsigned height = 97;
+
+    for (auto &format: formats) {
+        bool few_colors = format.color_type == LCT_PALETTE || format.bit_depth < 8;
+        if (!Encode(TEST_PATH, MakePixels(width, height, few_colors), width, height, format)) {
+            logger->error("Can't encode {} image", format.name);
+            return false;
+        }
+
+        std::vector<unsigned char> expected_rgba, expected_rgb, expected_rgba16;
+        unsigned w, h;
+        lodepng::decode(expected_rgba, w, h, TEST_PATH, LCT_RGBA, 8);
+        lodepng::decode(expected_rgb, w, h, TEST_PATH, LCT_RGB, 8);
+        lodepng::decode(expected_rgba16, w, h, TEST_PATH, LCT_RGBA, 16);
+
+        auto rgba = ReadPNG_RGBA(TEST_PATH);
+        auto rgb = ReadPNG_RGB(TEST_PATH);
+        bool same = rgba.GetWidth() == width && rgba.GetHeight() == height && rgb.GetWidth() == width &&
+                    std::equal(expected_rgba.begin(), expected_rgba.end(), rgba.GetDataPointer()) &&
+                    std::equal(expected_rgb.begin(), expected_rgb.end(), rgb.GetDataPointer());
+
+        if (!format.interlaced) {
+            PngReader reader(TEST_PATH);
+            std::vector<uint16_t> row(width * 4);
+            for (unsigned y = 0; y < height && same; y++) {
+                same = reader.ReadRow(row.data(), 4);
+                for (unsigned i = 0; i < width * 4 && same; i++) {
+                    size_t offset = ((size_t) y * width * 4 + i) * 2;
+                    same = row[i] == (expected_rgba16[offset] << 8 | expected_rgba16[offset + 1]);
+                }
+            }
+            same = same && !reader.ReadRow(row.data(), 4);
+        }
+
+        if (!same) {
+            logger->error("Decoded {} image differs from lodepng", format.name);
+            return false;
+        }
+    }
+    logger->info("{} formats decoded as by lodepng", std::size(formats));
+    return true;
+}
+
+/**
+ * Surface of every column of the height map: stone up to the height, the voxel above it is empty.
+ */
+bool CheckHeightMapWorld(VoxelGrid &world, const std::vector<unsigned char> &heights, unsigned size) {
+    for (int x = 0; x < WORLD_SIZE.x; x += 7) {
+        for (int z = 0; z < WORLD_SIZE.z; z += 5) {
+            // Gray values of the file are the red values of the 16-bit RGBA pixels
+            size_t offset = ((size_t) z * size + x) * 8;
+            int value = heights[offset] << 8 | heights[offset + 1];
+            int height = (value * MAX_HEIGHT + 32767) / 65535;
+            if (height > 0 && height <= WORLD_SIZE.y && world.GetVoxel({x, height - 1, z}) == 0) {
+                return false;
+            }
+            if (height + 1 < WORLD_SIZE.y && world.GetVoxel({x, std::max(height + 1, 0), z}) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks the decoder against lodepng for all color types, compares the load time with the previous path
+ * (decode to a vector and copy pixel by pixel), decodes a set of images in parallel and generates terrain
+ * from a height map decoded by bands.
+ */
+bool RunBenchmark(const std::shared_ptr<spdlog::logger> &logger) {
+    if (!CheckFormats(logger)) {
+        return false;
+    }
+
+    if (!Encode(LARGE_PATH, MakePixels(LARGE_SIZE, LARGE_SIZE, false), LARGE_SIZE, LARGE_SIZE,
+                {"RGBA 8", LCT_RGBA, 8, false})) {
+        logger->error("Can't encode the large image");
+        return false;
+    }
+
+    Timer timer;
+    std::vector<unsigned char> data;
+    unsigned width, height;
+    lodepng::decode(data, width, height, LARGE_PATH);
+    Image<uint8_t, 4> copied(width, height);
+    for (unsigned x = 0; x < width; x++) {
+        for (unsigned y = 0; y < height; y++) {
+            size_t offset = 4 * ((size_t) y * width + x);
+            copied.SetPixel(x, y, {data[offset], data[offset + 1], data[offset + 2], data[offset + 3]});
+        }
+    }
+    double copy_time = timer.GetTimeAndReset();
+    auto image = ReadPNG_RGBA(LARGE_PATH);
+    double direct_time = timer.GetTimeAndReset();
+    logger->info("{}x{} RGBA: decoded and copied in {:.1f}ms, decoded into the image in {:.1f}ms",
+                 width, height, copy_time * 1e3, direct_time * 1e3);
+    if (!std::equal(data.begin(), data.end(), image.GetDataPointer())) {
+        logger->error("Large image differs from lodepng");
+        return false;
+    }
+    data = {};
+    copied = {};
+
+    std::vector<std::string> paths(FILES_COUNT, LARGE_PATH);
+    timer.Reset();
+    for (auto &path: paths) {
+        ReadPNG_RGBA(path);
+    }
+    double serial_time = timer.GetTimeAndReset();
+    auto images = ReadPNGs_RGBA(paths);
+    double parallel_time = timer.GetTimeAndReset();
+    logger->info("{} images decoded one by one in {:.1f}ms, in parallel in {:.1f}ms", FILES_COUNT,
+                 serial_time * 1e3, parallel_time * 1e3);
+    for (auto &decoded: images) {
+        if (!std::equal(decoded.GetDataPointer(), decoded.GetDataPointer() + (size_t) LARGE_SIZE * LARGE_SIZE * 4,
+                        image.GetDataPointer())) {
+            logger->error("Image decoded in parallel differs");
+            return false;
+        }
+    }
+    images = {};
+    image = {};
+
+    // Height map larger than the world, the part outside of it is dropped
+    unsigned map_size = WORLD_SIZE.x + 100;
+    auto heights = MakePixels(map_size, map_size, false);
+    if (!Encode(HEIGHT_MAP_PATH, heights, map_size, map_size, {"gray 16", LCT_GREY, 16, false})) {
+        logger->error("Can't encode the height map");
+        return false;
+    }
+    ThreadPool pool;
+    VoxelGrid world(WORLD_SIZE, glm::dvec3(0.0));
+    timer.Reset();
+    WorldGen().GenerateFromHeightMap(world, HEIGHT_MAP_PATH, MAX_HEIGHT, *logger, pool);
+    logger->info("{}x{} height map: {} chunks generated in {:.1f}ms", map_size, map_size, world.GetChunksNum(),
+                 timer.GetTime() * 1e3);
+    if (!CheckHeightMapWorld(world, heights, map_size)) {
+        logger->error("Terrain differs from the height map");
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **) {
+    bool success = RunBenchmark(spdlog::default_logger());
+    std::remove(TEST_PATH);
+    std::remove(LARGE_PATH);
+    std::remove(HEIGHT_MAP_PATH);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+#include <lit/engine/utilities/point_grid.hpp>
+#include <lit/engine/generators/treegen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <cmath>
+#include <random>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+// Cell size of the branch end index of TreeGen
+const double CELL_SIZE = 8.0;
+// Average number of points per cell, points of every size are spread with the same density
+const double POINTS_PER_CELL = 2.0;
+const size_t POINT_COUNTS[] = {1000, 4000, 16000, 64000};
+const int QUERIES_COUNT = 4096;
+const size_t TREES_COUNT = 32;
+
+/**
+ * Previous TreeGen::FindNearest (as it was meant to work): the nearest of all points, the first one if several
+ * are at the same distance.
+ */
+uint32_t FindNearestBruteForce(const std::vector<glm::dvec3> &points, const glm::dvec3 &point) {
+    uint32_t best = 0;
+    double best_distance = std::numeric_limits<double>::max();
+    for (uint32_t i = 0; i < points.size(); i++) {
+        double distance = glm::length(points[i] - point);
+        if (distance < best_distance) {
+            best = i;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+/**
+ * Indexes @count random points and compares nearest point queries with brute force. The cube of the points grows
+ * with their number, so the cost of a grid query should stay about the same while brute force grows linearly.
+ */
+bool CheckPointGrid(size_t count, std::mt19937 &rng, spdlog::logger &logger) {
+    double side = std::cbrt((double) count / POINTS_PER_CELL) * CELL_SIZE;
+    std::uniform_real_distribution<double> coordinate(0.0, side);
+    auto random_point = [&]() { return glm::dvec3(coordinate(rng), coordinate(rng), coordinate(rng)); };
+
+    std::vector<glm::dvec3> points(count);
+    for (auto &point: points) {
+        point = random_point();
+    }
+    std::vector<glm::dvec3> queries(QUERIES_COUNT);
+    for (auto &query: queries) {
+        query = random_point();
+    }
+
+    Timer timer;
+    PointGrid grid(CELL_SIZE);
+    for (auto &point: points) {
+        grid.Insert(point);
+    }
+    double insert_time = timer.GetTimeAndReset();
+
+    std::vector<uint32_t> nearest(QUERIES_COUNT);
+    for (int i = 0; i < QUERIES_COUNT; i++) {
+        nearest[i] = *grid.FindNearest(queries[i]);
+    }
+    double grid_time = timer.GetTimeAndReset();
+
+    size_t mismatches = 0;
+    for (int i = 0; i < QUERIES_COUNT; i++) {
+        mismatches += nearest[i] != FindNearestBruteForce(points, queries[i]);
+    }
+    double brute_force_time = timer.GetTime();
+
+    logger.info("{} points: inserted in {:.2f}ms, query {:.2f}us, brute force {:.2f}us, mismatches: {}", count,
+                insert_time * 1e3, grid_time / QUERIES_COUNT * 1e6, brute_force_time / QUERIES_COUNT * 1e6,
+                mismatches);
+    return mismatches == 0;
+}
+
+/**
+ * Generates the same trees with one and with several threads, every tree has its own random stream,
+ * so the voxels must be identical.
+ */
+bool CheckTrees(spdlog::logger &logger) {
+    Timer timer;
+    ThreadPool single_thread_pool(1);
+    auto expected = TreeGen::GenerateTrees(1, TREES_COUNT, single_thread_pool);
+    double single_thread_time = timer.GetTimeAndReset();
+
+    ThreadPool pool(4);
+    auto trees = TreeGen::GenerateTrees(1, TREES_COUNT, pool);
+    logger.info("{} trees generated in {:.1f}ms with 1 thread, {:.1f}ms with {} threads", TREES_COUNT,
+                single_thread_time * 1e3, timer.GetTime() * 1e3, pool.GetThreadsCount());
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < TREES_COUNT; i++) {
+        glm::ivec3 dims = trees[i]->GetDimensions();
+        for (int x = 0; x < dims.x; x++) {
+            for (int y = 0; y < dims.y; y++) {
+                for (int z = 0; z < dims.z; z++) {
+                    mismatches += trees[i]->GetVoxel({x, y, z}) != expected[i]->GetVoxel({x, y, z});
+                }
+            }
+        }
+    }
+    if (mismatches > 0) {
+        logger.error("{} voxels differ between thread counts", mismatches);
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    std::mt19937 rng(0);
+    bool ok = true;
+    for (size_t count: POINT_COUNTS) {
+        ok = CheckPointGrid(count, rng, *logger) && ok;
+    }
+    ok = CheckTrees(*logger) && ok;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,138 @@
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/systems/voxels/voxel_grid_lod_manager.hpp>
+#include <lit/engine/utilities/voxel_ray_caster.hpp>
+#include <lit/engine/utilities/voxel_ray_packet_caster.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using RayCastResult = VoxelRayCaster::RayCastResult;
+
+const int WORLD_SIZE = 512;
+const int VIEWPORT_WIDTH = 1024;
+const int VIEWPORT_HEIGHT = 512;
+const int MAX_ITERATIONS = 200;
+
+struct Rays {
+    std::vector<glm::vec3> origins;
+    std::vector<glm::vec3> dirs;
+};
+
+/**
+ * Primary rays of a pinhole camera (same as GetCameraRayDirection in camera.glsl) looking at the terrain.
+ * Rays are ordered by 4x2 pixel tiles, so every packet covers neighbouring pixels.
+ */
+Rays GeneratePrimaryRays(const VoxelRayCaster &caster) {
+    Rays rays;
+    const glm::vec3 origin = glm::vec3(0.0f, 6.0f, -18.0f);
+    const float pitch = 0.45f;
+
+    for (int tile_y = 0; tile_y < VIEWPORT_HEIGHT; tile_y += 2) {
+        for (int tile_x = 0; tile_x < VIEWPORT_WIDTH; tile_x += 4) {
+            for (int lane = 0; lane < VoxelRayPacketCaster::PACKET_SIZE; lane++) {
+                int x = tile_x + (lane & 3);
+                int y = tile_y + (lane >> 2);
+                glm::vec2 normalized_coords = (2.0f * glm::vec2(x, y) - glm::vec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT) + 1.0f) /
+                                              (float) VIEWPORT_HEIGHT;
+                glm::vec3 dir = glm::normalize(glm::vec3(normalized_coords, 1.0f));
+                dir = glm::vec3(dir.x,
+                                dir.y * std::cos(pitch) - dir.z * std::sin(pitch),
+                                dir.y * std::sin(pitch) + dir.z * std::cos(pitch));
+
+                float distance;
+                if (!caster.WorldHitBox(origin, dir, distance)) {
+                    distance = 0.0f;
+                }
+                rays.origins.push_back(origin + dir * (distance + 1e-6f));
+                rays.dirs.push_back(dir);
+            }
+        }
+    }
+    return rays;
+}
+
+/**
+ * Shadow rays from every primary hit towards the light, as in SampleColor from main.glsl.
+ */
+Rays GenerateShadowRays(const std::vector<RayCastResult> &primary) {
+    Rays rays;
+    const glm::vec3 light = glm::normalize(glm::vec3(1.3f, 1.0f, 0.35f));
+    for (auto &res: primary) {
+        if (res.hit) {
+            rays.origins.push_back(res.position + glm::vec3(res.normal) * 1e-5f);
+            rays.dirs.push_back(light);
+        }
+    }
+    return rays;
+}
+
+bool RunBenchmark(const std::string &name, const VoxelRayCaster &caster, const Rays &rays,
+                  std::vector<RayCastResult> &results, spdlog::logger &logger) {
+    VoxelRayPacketCaster packet_caster(caster);
+
+    size_t count = rays.origins.size();
+    results.assign(count, RayCastResult());
+    std::vector<RayCastResult> packet_results(count);
+
+    Timer timer;
+    for (size_t i = 0; i < count; i++) {
+        results[i] = caster.WorldRayCast(rays.origins[i], rays.dirs[i], MAX_ITERATIONS);
+    }
+    double single_time = timer.GetTimeAndReset();
+
+    packet_caster.WorldRayCast(rays.origins.data(), rays.dirs.data(), count, MAX_ITERATIONS, packet_results.data());
+    double packet_time = timer.GetTimeAndReset();
+
+    size_t hits = 0;
+    size_t iterations = 0;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        hits += results[i].hit;
+        iterations += results[i].iterations;
+        if (results[i].hit != packet_results[i].hit || results[i].cell != packet_results[i].cell) {
+            mismatches++;
+        }
+    }
+
+    logger.info("{}: {} rays, {} hits, {:.2f} iterations per ray", name, count, hits,
+                (double) iterations / (double) std::max<size_t>(count, 1));
+    logger.info("{}: single {:.2f} Mrays/s, packet {:.2f} Mrays/s, mismatches: {}", name,
+                (double) count / single_time * 1e-6, (double) count / packet_time * 1e-6, mismatches);
+    if (mismatches != 0) {
+        logger.error("{}: packet caster differs from the single ray caster", name);
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    entt::registry registry;
+    auto ent = registry.create();
+    auto &world = registry.emplace<VoxelGridSparseT<uint32_t>>(ent, glm::ivec3(WORLD_SIZE), glm::dvec3(0.0));
+    registry.emplace<VoxelGridSparseLodDataT<uint32_t>>(ent);
+
+    Timer timer;
+    WorldGen().Generate(world, *logger);
+    logger->info("World generated in {:.2f}s", timer.GetTimeAndReset());
+
+    VoxelGridLodManager<uint32_t> lod_manager(registry);
+    lod_manager.CommitChanges();
+    logger->info("LODs built in {:.2f}s", timer.GetTimeAndReset());
+
+    VoxelRayCaster caster(world, registry.get<VoxelGridSparseLodDataT<uint32_t>>(ent));
+
+    std::vector<RayCastResult> primary_results;
+    if (!RunBenchmark("Primary rays", caster, GeneratePrimaryRays(caster), primary_results, *logger)) {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<RayCastResult> shadow_results;
+    if (!RunBenchmark("Shadow rays", caster, GenerateShadowRays(primary_results), shadow_results, *logger)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
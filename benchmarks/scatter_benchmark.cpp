@@ -0,0 +1,112 @@
+#include <lit/engine/generators/scatter.hpp>
+#include <lit/common/random.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <glm/geometric.hpp>
+#include <cmath>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+const int MAP_SIZE = 2048;
+const double MIN_DISTANCE = 24.0;
+const int REJECTION_ATTEMPTS = 200000;
+
+/**
+ * Rolling hills, the slope goes above 1 on the steep sides.
+ */
+Array2D<int> createHeights() {
+    Array2D<int> heights(MAP_SIZE, MAP_SIZE);
+    for (int x = 0; x < MAP_SIZE; x++) {
+        for (int z = 0; z < MAP_SIZE; z++) {
+            heights.at(x, z) = (int) (std::sin(x * 0.02) * std::cos(z * 0.015) * 80.0 + 100.0);
+        }
+    }
+    return heights;
+}
+
+/**
+ * Previous crown placement: random points, every one checked against all accepted ones.
+ */
+std::vector<glm::dvec2> rejectionSampling(RandomGen &rng) {
+    std::vector<glm::dvec2> points;
+    for (int i = 0; i < REJECTION_ATTEMPTS; i++) {
+        glm::dvec2 p(rng.get_double(0, MAP_SIZE), rng.get_double(0, MAP_SIZE));
+        bool fits = true;
+        for (auto &other: points) {
+            if (glm::distance(other, p) < MIN_DISTANCE) {
+                fits = false;
+                break;
+            }
+        }
+        if (fits) {
+            points.push_back(p);
+        }
+    }
+    return points;
+}
+
+bool samePlacements(const std::vector<ScatterPlacement> &a, const std::vector<ScatterPlacement> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].position != b[i].position || a[i].variant != b[i].variant) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Scatters props with one and with all threads, fails if the results differ or two placements are closer
+ * than the minimum distance (positions are rounded to voxels, so up to sqrt(2) closer), reports the time
+ * against the O(n^2) rejection sampling.
+ */
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+    auto heights = createHeights();
+
+    ScatterSettings settings;
+    settings.min_distance = MIN_DISTANCE;
+    settings.seed = 42;
+    auto mask = [](int x, int) {
+        return x < MAP_SIZE / 2 ? 1.0 : 0.5;
+    };
+
+    Timer timer;
+    RandomGen rng(42);
+    auto reference = rejectionSampling(rng);
+    double reference_time = timer.GetTimeAndReset();
+
+    ThreadPool single(1);
+    auto expected = PoissonScatter::Scatter(heights, settings, mask, single);
+    double single_time = timer.GetTimeAndReset();
+
+    ThreadPool pool;
+    auto actual = PoissonScatter::Scatter(heights, settings, mask, pool);
+    double pool_time = timer.GetTimeAndReset();
+
+    logger->info("Rejection sampling {:.1f}ms ({} points), Poisson-disk {:.1f}ms, {} threads {:.1f}ms ({} placements)",
+                 reference_time * 1e3, reference.size(), single_time * 1e3, pool.GetThreadsCount(), pool_time * 1e3,
+                 actual.size());
+
+    if (!samePlacements(expected, actual)) {
+        logger->error("Placements depend on the number of threads");
+        return EXIT_FAILURE;
+    }
+
+    // All placements are checked against each other, the same O(n^2) as the rejection sampling.
+    double min_distance = MIN_DISTANCE - std::sqrt(2.0);
+    for (size_t i = 0; i < actual.size(); i++) {
+        for (size_t j = i + 1; j < actual.size(); j++) {
+            glm::dvec2 a(actual[i].position.x, actual[i].position.z);
+            glm::dvec2 b(actual[j].position.x, actual[j].position.z);
+            if (glm::distance(a, b) < min_distance) {
+                logger->error("Placements {} and {} are {:.1f} apart", i, j, glm::distance(a, b));
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+#include <lit/engine/utilities/scene_snapshot.hpp>
+#include <lit/engine/utilities/world_file.hpp>
+#include <lit/engine/components/tag.hpp>
+#include <lit/engine/components/world_reference.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <map>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = WorldFile::VoxelGrid;
+
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+const char *WORLD_PATH = "scene_snapshot_benchmark.litw";
+const char *SCENE_PATH = "scene_snapshot_benchmark.lits";
+const int ENTITIES_COUNT = 10000;
+
+/**
+ * Fills @registry with a generated world saved to WORLD_PATH and ENTITIES_COUNT tagged entities.
+ */
+void MakeScene(entt::registry &registry, const std::shared_ptr<spdlog::logger> &logger) {
+    auto world = registry.create();
+    registry.emplace<TagComponent>(world, TagComponent{"world"});
+    registry.emplace<TransformComponent>(world);
+    auto &grid = registry.emplace<VoxelGrid>(world, WORLD_SIZE, glm::dvec3(0.5));
+    WorldGen().Generate(grid, *logger);
+    WorldFile::Save(WORLD_PATH, grid);
+    registry.emplace<WorldReferenceComponent>(world, WorldReferenceComponent{WORLD_PATH});
+
+    for (int i = 0; i < ENTITIES_COUNT; i++) {
+        auto entity = registry.create();
+        registry.emplace<TagComponent>(entity, TagComponent{"entity " + std::to_string(i)});
+        auto &transform = registry.emplace<TransformComponent>(entity);
+        transform.translation = glm::dvec3(i, i * 0.5, -i);
+        transform.rotation = glm::normalize(glm::dquat(1.0, i * 0.01, i * 0.02, 0.0));
+        transform.scale = 1.0 + i * 0.001;
+    }
+}
+
+bool SameGrids(VoxelGrid &expected, VoxelGrid &actual) {
+    if (expected.GetDimensions() != actual.GetDimensions() || expected.GetAnchor() != actual.GetAnchor()) {
+        return false;
+    }
+    auto dims = expected.GetChunkGridDimensions();
+    for (int i = 0; i < dims.x; i++) {
+        for (int j = 0; j < dims.y; j++) {
+            for (int k = 0; k < dims.z; k++) {
+                auto a = expected.GetChunkGridView().At(i, j, k);
+                auto b = actual.GetChunkGridView().At(i, j, k);
+                if ((a == VoxelGrid::CHUNK_EMPTY) != (b == VoxelGrid::CHUNK_EMPTY)) {
+                    return false;
+                }
+                if (a != VoxelGrid::CHUNK_EMPTY && expected.GetChunkData(a) != actual.GetChunkData(b)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Compares the entities of @original with the restored ones, entities with the same tag must have the same
+ * transform and grid.
+ */
+bool SameScenes(entt::registry &original, entt::registry &restored, const std::vector<entt::entity> &entities) {
+    std::map<std::string, entt::entity> by_tag;
+    for (auto entity: original.view<TagComponent>()) {
+        by_tag[original.get<TagComponent>(entity).tag] = entity;
+    }
+    if (by_tag.size() != entities.size()) {
+        return false;
+    }
+    for (auto entity: entities) {
+        auto found = by_tag.find(restored.get<TagComponent>(entity).tag);
+        if (found == by_tag.end()) {
+            return false;
+        }
+        auto &a = original.get<TransformComponent>(found->second);
+        auto &b = restored.get<TransformComponent>(entity);
+        if (a.translation != b.translation || a.rotation != b.rotation || a.scale != b.scale) {
+            return false;
+        }
+        auto grid = original.try_get<VoxelGrid>(found->second);
+        auto restored_grid = restored.try_get<VoxelGrid>(entity);
+        if ((grid == nullptr) != (restored_grid == nullptr)) {
+            return false;
+        }
+        if (grid && !SameGrids(*grid, *restored_grid)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Generates a scene, as on a cold start, and restores it from a snapshot, as on a warm start. Reports timings and
+ * returns false if the restored scene differs from the original one.
+ */
+bool RunBenchmark(const std::shared_ptr<spdlog::logger> &logger) {
+    entt::registry original;
+    Timer timer;
+    MakeScene(original, logger);
+    logger->info("Cold start: scene generated and saved in {:.1f}ms", timer.GetTime() * 1e3);
+
+    timer.Reset();
+    SceneSnapshot::Capture(original).Save(SCENE_PATH);
+    logger->info("Snapshot of {:.1f} KB saved in {:.1f}ms", std::filesystem::file_size(SCENE_PATH) / 1024.0,
+                 timer.GetTime() * 1e3);
+
+    entt::registry restored;
+    timer.Reset();
+    auto snapshot = SceneSnapshot::Load(SCENE_PATH);
+    double load_time = timer.GetTimeAndReset();
+    auto entities = snapshot.Restore(restored);
+    double restore_time = timer.GetTime();
+    logger->info("Warm start: snapshot loaded in {:.1f}ms, {} entities restored in {:.1f}ms", load_time * 1e3,
+                 entities.size(), restore_time * 1e3);
+
+    bool same = SameScenes(original, restored, entities);
+    if (!same) {
+        logger->error("Restored scene differs");
+    }
+
+    // A grid without a world file can't be captured
+    auto entity = restored.create();
+    restored.emplace<TagComponent>(entity, TagComponent{"unsaved"});
+    restored.emplace<TransformComponent>(entity);
+    restored.emplace<VoxelGrid>(entity, glm::ivec3(64), glm::dvec3(0.0));
+    try {
+        SceneSnapshot::Capture(restored);
+        logger->error("Grid without a world file captured");
+        same = false;
+    } catch (const std::invalid_argument &) {
+    }
+
+    // Grids keep their world files mapped
+    restored.clear();
+    original.clear();
+    std::filesystem::remove(SCENE_PATH);
+    std::filesystem::remove(WORLD_PATH);
+    return same;
+}
+
+int main(int, char **) {
+    return RunBenchmark(spdlog::default_logger()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,197 @@
+#include <lit/rendering/shader_preprocessor.hpp>
+#include <lit/rendering/program_binary_storage.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace lit::rendering;
+using namespace lit::common;
+
+namespace fs = std::filesystem;
+
+const fs::path ROOT = "shader_preprocessor_benchmark";
+const int LINES_COUNT = 2000;
+const int RUNS_COUNT = 1000;
+
+/**
+ * Preprocessor that was used before the cache: reads and concatenates the files line by line on every call.
+ */
+std::string RunReferencePreprocessor(const std::string &shader_path, int depth = 0) {
+    if (depth > 10) {
+        return "";
+    }
+
+    std::ifstream fin(shader_path);
+    std::string shader_sources;
+    std::string root_path = shader_path.substr(0, shader_path.find_last_of('/'));
+
+    std::string line;
+    while (std::getline(fin, line)) {
+        if (line.starts_with("#include")) {
+            std::string path = line.substr(line.find_first_of('"') + 1, line.find_last_of('"') - line.find_first_of('"') - 1);
+            shader_sources += RunReferencePreprocessor(root_path + "/" + path, depth + 1);
+            continue;
+        }
+        if (line.starts_with("#version") && depth > 0) {
+            continue;
+        }
+        shader_sources += line + "\n";
+    }
+    return shader_sources;
+}
+
+/**
+ * Writes @content to @path and moves its modification time forward, so the change is seen on file systems with
+ * coarse timestamps.
+ */
+void WriteFile(const fs::path &path, const std::string &content) {
+    auto time = fs::exists(path) ? fs::last_write_time(path) : fs::file_time_type();
+    std::ofstream(path, std::ios::trunc) << content;
+    fs::last_write_time(path, std::max(fs::last_write_time(path), time + std::chrono::seconds(1)));
+}
+
+std::string MakeFunctions(const std::string &prefix) {
+    std::string text;
+    for (int i = 0; i < LINES_COUNT; i++) {
+        text += "float " + prefix + std::to_string(i) + "(float x) { return x * " + std::to_string(i) + ".0; }\n";
+    }
+    return text;
+}
+
+/**
+ * main.glsl and sky.glsl include lib/camera.glsl, which includes lib/math.glsl, main.glsl also includes
+ * lib/water.glsl.
+ */
+void MakeShaders() {
+    fs::create_directories(ROOT / "lib");
+    WriteFile(ROOT / "lib/math.glsl", "#version 450\nconst float PI = 3.14159;\n" + MakeFunctions("math"));
+    WriteFile(ROOT / "lib/camera.glsl", "#version 450\n#include \"math.glsl\"\n" + MakeFunctions("camera"));
+    WriteFile(ROOT / "lib/water.glsl", "#version 450\r\n" + MakeFunctions("water") + "float last() { return 0.0; }");
+    WriteFile(ROOT / "main.glsl", "#version 450\n\n#include \"lib/camera.glsl\"\n#include \"lib/water.glsl\"\n"
+                                  "void main() {\n}\n");
+    WriteFile(ROOT / "sky.glsl", "#version 450\n#include \"lib/camera.glsl\"\nvoid main() {}\n");
+}
+
+bool CheckSource(ShaderPreprocessor &preprocessor, const std::string &shader,
+                 const std::shared_ptr<spdlog::logger> &logger) {
+    std::string path = (ROOT / shader).generic_string();
+    if (preprocessor.Preprocess(path).text != RunReferencePreprocessor(path)) {
+        logger->error("{} differs from the reference preprocessor", shader);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Compares the output with the reference preprocessor, then changes files and checks that only the changed files
+ * are read and only the sources which include them are rebuilt.
+ */
+bool CheckPreprocessor(const std::shared_ptr<spdlog::logger> &logger) {
+    MakeShaders();
+    ShaderPreprocessor preprocessor;
+    std::string main_path = (ROOT / "main.glsl").generic_string();
+    std::string sky_path = (ROOT / "sky.glsl").generic_string();
+
+    Timer timer;
+    for (int i = 0; i < RUNS_COUNT; i++) {
+        RunReferencePreprocessor(main_path);
+    }
+    double reference_time = timer.GetTimeAndReset();
+    for (int i = 0; i < RUNS_COUNT; i++) {
+        preprocessor.Preprocess(main_path);
+    }
+    double cached_time = timer.GetTime();
+    logger->info("{} KB shader preprocessed {} times: {:.1f}ms without the cache, {:.1f}ms with it",
+                 preprocessor.Preprocess(main_path).text.size() / 1024, RUNS_COUNT, reference_time * 1e3,
+                 cached_time * 1e3);
+
+    if (!CheckSource(preprocessor, "main.glsl", logger) || !CheckSource(preprocessor, "sky.glsl", logger)) {
+        return false;
+    }
+    auto &dependencies = preprocessor.Preprocess(main_path).dependencies;
+    if (dependencies.size() != 4 || dependencies[0] != main_path) {
+        logger->error("main.glsl has {} dependencies", dependencies.size());
+        return false;
+    }
+    // Every file was read once and every shader was built once
+    auto stats = preprocessor.GetStats();
+    if (stats.files_read != 5 || stats.sources_built != 2) {
+        logger->error("Unexpected cache stats: {} files read, {} sources built", stats.files_read, stats.sources_built);
+        return false;
+    }
+
+    // A touched file is read again, but the sources are not rebuilt
+    fs::last_write_time(ROOT / "lib/water.glsl", fs::last_write_time(ROOT / "lib/water.glsl") + std::chrono::seconds(1));
+    uint64_t main_hash = preprocessor.Preprocess(main_path).hash;
+    stats = preprocessor.GetStats();
+    if (stats.files_read != 6 || stats.sources_built != 2) {
+        logger->error("Touched file rebuilt the source");
+        return false;
+    }
+
+    // A changed include rebuilds both shaders, but only the changed file is read
+    WriteFile(ROOT / "lib/math.glsl", "#version 450\nconst float PI = 3.1415926;\n" + MakeFunctions("math"));
+    if (!CheckSource(preprocessor, "main.glsl", logger) || !CheckSource(preprocessor, "sky.glsl", logger)) {
+        return false;
+    }
+    stats = preprocessor.GetStats();
+    if (stats.files_read != 7 || stats.sources_built != 4 || preprocessor.Preprocess(main_path).hash == main_hash) {
+        logger->error("Changed include: {} files read, {} sources built", stats.files_read, stats.sources_built);
+        return false;
+    }
+
+    // A changed shader rebuilds only itself
+    WriteFile(ROOT / "sky.glsl", "#version 450\n#include \"lib/camera.glsl\"\nvoid main() { return; }\n");
+    preprocessor.Preprocess(main_path);
+    if (!CheckSource(preprocessor, "sky.glsl", logger) || preprocessor.GetStats().sources_built != 5) {
+        logger->error("Changed shader rebuilt {} sources", preprocessor.GetStats().sources_built - 4);
+        return false;
+    }
+
+    // Missing and cyclic includes throw
+    WriteFile(ROOT / "sky.glsl", "#version 450\n#include \"lib/missing.glsl\"\n");
+    WriteFile(ROOT / "lib/water.glsl", "#include \"../main.glsl\"\n");
+    for (auto &path: {sky_path, main_path}) {
+        try {
+            preprocessor.Preprocess(path);
+            logger->error("Invalid includes of {} were accepted", path);
+            return false;
+        } catch (const std::runtime_error &e) {
+            logger->info("Expected error: {}", e.what());
+        }
+    }
+    return true;
+}
+
+bool CheckStorage(ProgramBinaryStorage &storage, const char *name, const std::shared_ptr<spdlog::logger> &logger) {
+    std::vector<uint8_t> binary(1000);
+    for (size_t i = 0; i < binary.size(); i++) {
+        binary[i] = (uint8_t) (i * 7);
+    }
+    std::vector<uint8_t> loaded;
+    if (storage.Load("0123456789abcdef", loaded)) {
+        logger->error("{} storage loaded a missing binary", name);
+        return false;
+    }
+    storage.Store("0123456789abcdef", binary);
+    storage.Store("fedcba9876543210", {1, 2, 3});
+    if (!storage.Load("0123456789abcdef", loaded) || loaded != binary) {
+        logger->error("{} storage lost a binary", name);
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+    bool passed = CheckPreprocessor(logger);
+
+    MemoryProgramBinaryStorage memory_storage;
+    DirectoryProgramBinaryStorage directory_storage(ROOT / "binaries");
+    passed = passed && CheckStorage(memory_storage, "Memory", logger) &&
+             CheckStorage(directory_storage, "Directory", logger);
+
+    fs::remove_all(ROOT);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,59 @@
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/systems/voxels/voxel_grid_lod_manager.hpp>
+#include <lit/engine/utilities/software_renderer.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+const int WORLD_SIZE = 512;
+const glm::uvec2 VIEWPORT = glm::uvec2(1280, 720);
+
+/**
+ * Renders generated world on the CPU with a single thread and with all threads, logs the slowest tiles
+ * and writes the image to the PNG file (first argument, "software_render.png" by default).
+ */
+int main(int argc, char **argv) {
+    auto logger = spdlog::default_logger();
+    std::string output_path = argc > 1 ? argv[1] : "software_render.png";
+
+    entt::registry registry;
+    auto ent = registry.create();
+    auto &world = registry.emplace<VoxelGridSparseT<uint32_t>>(ent, glm::ivec3(WORLD_SIZE), glm::dvec3(0.0));
+    registry.emplace<VoxelGridSparseLodDataT<uint32_t>>(ent);
+
+    Timer timer;
+    WorldGen().Generate(world, *logger);
+    logger->info("World generated in {:.2f}s", timer.GetTimeAndReset());
+
+    VoxelGridLodManager<uint32_t> lod_manager(registry);
+    lod_manager.CommitChanges();
+    logger->info("LODs built in {:.2f}s", timer.GetTimeAndReset());
+
+    VoxelRayCaster caster(world, registry.get<VoxelGridSparseLodDataT<uint32_t>>(ent));
+
+    const double pitch = 0.45;
+    TransformComponent camera_transform(glm::dvec3(0.0, 6.0, -18.0),
+                                        glm::dquat(std::cos(pitch * 0.5), std::sin(pitch * 0.5), 0.0, 0.0), 1.0);
+
+    ThreadPool single_thread_pool(1);
+    SoftwareRenderer single_thread_renderer(caster, single_thread_pool);
+    single_thread_renderer.Render(VIEWPORT, camera_transform);
+    logger->info("Single thread: {:.2f} ms", single_thread_renderer.GetRenderTime() * 1000.0);
+
+    ThreadPool pool;
+    SoftwareRenderer renderer(caster, pool);
+    auto image = renderer.Render(VIEWPORT, camera_transform);
+    renderer.LogStats(*logger);
+    logger->info("Speedup with {} threads: {:.2f}x", pool.GetThreadsCount(),
+                 single_thread_renderer.GetRenderTime() / renderer.GetRenderTime());
+
+    if (!WritePNG_RGB(output_path, image)) {
+        logger->error("Failed to write {}", output_path);
+        return EXIT_FAILURE;
+    }
+    logger->info("Image is written to {}", output_path);
+
+    return EXIT_SUCCESS;
+}
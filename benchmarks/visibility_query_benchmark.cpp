@@ -0,0 +1,69 @@
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/systems/voxels/voxel_grid_lod_manager.hpp>
+#include <lit/engine/utilities/visibility_query_batch.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <cmath>
+#include <random>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+const int WORLD_SIZE = 512;
+const int QUERIES_COUNT = 1 << 20;
+
+/**
+ * Line-of-sight checks between random points of the world, as in AI vision checks.
+ * Runs the same batch with one thread and with all threads, and checks that results are identical
+ * and that visible segments report their full length.
+ */
+int main(int, char **) {
+    auto logger = spdlog::default_logger();
+
+    entt::registry registry;
+    auto ent = registry.create();
+    auto &world = registry.emplace<VoxelGridSparseT<uint32_t>>(ent, glm::ivec3(WORLD_SIZE), glm::dvec3(0.0));
+    registry.emplace<VoxelGridSparseLodDataT<uint32_t>>(ent);
+
+    Timer timer;
+    WorldGen().Generate(world, *logger);
+    logger->info("World generated in {:.2f}s", timer.GetTimeAndReset());
+
+    VoxelGridLodManager<uint32_t> lod_manager(registry);
+    lod_manager.CommitChanges();
+    logger->info("LODs built in {:.2f}s", timer.GetTimeAndReset());
+
+    VoxelRayCaster caster(world, registry.get<VoxelGridSparseLodDataT<uint32_t>>(ent));
+
+    std::mt19937 rng(0);
+    float half_size = WORLD_SIZE * VoxelRayCaster::VOXEL_SIZE * 0.5f;
+    std::uniform_real_distribution<float> coordinate(-half_size, half_size);
+    std::vector<glm::vec3> from(QUERIES_COUNT);
+    std::vector<glm::vec3> to(QUERIES_COUNT);
+    for (int i = 0; i < QUERIES_COUNT; i++) {
+        from[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+        to[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+    }
+
+    ThreadPool single_thread_pool(1);
+    VisibilityQueryBatch single_thread_batch(caster, single_thread_pool);
+    auto single_thread_results = single_thread_batch.Execute(from, to);
+    single_thread_batch.LogStats(*logger);
+
+    ThreadPool pool;
+    VisibilityQueryBatch batch(caster, pool);
+    auto results = batch.Execute(from, to);
+    batch.LogStats(*logger);
+
+    size_t mismatches = 0;
+    for (int i = 0; i < QUERIES_COUNT; i++) {
+        mismatches += results[i].visible != single_thread_results[i].visible ||
+                      results[i].iterations != single_thread_results[i].iterations ||
+                      results[i].distance != single_thread_results[i].distance ||
+                      (results[i].visible && std::abs(results[i].distance - glm::length(to[i] - from[i])) > 1e-5f * results[i].distance);
+    }
+    logger->info("Threads: {}, speedup: {:.2f}x, mismatches: {}", pool.GetThreadsCount(),
+                 single_thread_batch.GetStats().time / batch.GetStats().time, mismatches);
+
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+#include <lit/engine/utilities/voxel_import.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = VoxFile::VoxelGrid;
+
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+const char *VOX_PATH = "voxel_import_benchmark.vox";
+const char *RAW_PATH = "voxel_import_benchmark.raw";
+const char *TEXT_PATH = "voxel_import_benchmark.txt";
+const int SPHERE_SIZE = 200;
+
+/**
+ * Palette index of the raw test volume: a sphere with layers of 3 colors.
+ */
+uint8_t GetSphereValue(int x, int y, int z) {
+    glm::ivec3 d = glm::ivec3(x, y, z) - SPHERE_SIZE / 2;
+    int r2 = d.x * d.x + d.y * d.y + d.z * d.z;
+    return r2 < SPHERE_SIZE * SPHERE_SIZE / 4 ? (uint8_t) (1 + r2 / 1000 % 3) : 0;
+}
+
+/**
+ * Exported colors lose at most the low bits that were dropped to fit the palette.
+ */
+bool SameVoxels(VoxelGrid &expected, VoxelGrid &actual, const glm::ivec3 &offset, uint32_t tolerance) {
+    bool same = true;
+    expected.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        glm::ivec3 base = chunk.GetChunkGridPosition() * VoxelGrid::CHUNK_SIZE;
+        for (int x = 0; x < VoxelGrid::CHUNK_SIZE && same; x++) {
+            for (int y = 0; y < VoxelGrid::CHUNK_SIZE && same; y++) {
+                for (int z = 0; z < VoxelGrid::CHUNK_SIZE && same; z++) {
+                    uint32_t a = chunk.GetVoxel({x, y, z});
+                    uint32_t b = actual.GetVoxel(base + glm::ivec3(x, y, z) + offset);
+                    for (int shift = 0; shift < 24 && same; shift += 8) {
+                        int da = (int) ((a >> shift) & 0xFF) - (int) ((b >> shift) & 0xFF);
+                        same = (a == 0) == (b == 0) && (uint32_t) std::abs(da) <= tolerance;
+                    }
+                }
+            }
+        }
+    });
+    return same && expected.GetLoadedChunksNum() == actual.GetLoadedChunksNum();
+}
+
+/**
+ * Exports a world from WorldGen to .vox and imports it back, then imports a raw volume in binary and text form.
+ * Reports timings and sizes and fails if imported voxels differ.
+ */
+bool RunBenchmark(const std::shared_ptr<spdlog::logger> &logger) {
+    VoxelGrid world(WORLD_SIZE, glm::dvec3(0.0));
+    WorldGen().Generate(world, *logger);
+
+    Timer timer;
+    VoxFile::Save(VOX_PATH, world);
+    double save_time = timer.GetTimeAndReset();
+    auto file = VoxFile::Open(VOX_PATH);
+    double open_time = timer.GetTimeAndReset();
+    VoxelGrid imported(WORLD_SIZE, glm::dvec3(0.0));
+    file->Import(imported, file->GetMin());
+    double import_time = timer.GetTimeAndReset();
+
+    size_t file_size = std::ifstream(VOX_PATH, std::ios::binary | std::ios::ate).tellg();
+    logger->info("vox: {} models, {:.1f} MB file, {:.1f} MB of chunks; saved in {:.1f}ms, opened in {:.2f}ms, "
+                 "imported in {:.1f}ms", file->GetModelsCount(), file_size / 1048576.0,
+                 imported.GetLoadedChunksNum() * sizeof(VoxelGrid::ChunkData) / 1048576.0, save_time * 1e3,
+                 open_time * 1e3, import_time * 1e3);
+
+    // Colors of the generated world may be reduced to fit the palette
+    if (!SameVoxels(world, imported, glm::ivec3(0), 127)) {
+        logger->error("Imported vox world differs from the exported one");
+        return false;
+    }
+    file.reset();
+
+    // A second import merges the models into the existing chunks
+    VoxelGrid shifted(WORLD_SIZE, glm::dvec3(0.0));
+    VoxFile::Open(VOX_PATH)->Import(shifted, glm::ivec3(7, 3, 5));
+    VoxFile::Save(VOX_PATH, shifted);
+    VoxelGrid reimported(WORLD_SIZE, glm::dvec3(0.0));
+    auto shifted_file = VoxFile::Open(VOX_PATH);
+    shifted_file->Import(reimported, shifted_file->GetMin());
+    if (!SameVoxels(shifted, reimported, glm::ivec3(0), 0)) {
+        logger->error("Unaligned vox world differs after the second export");
+        return false;
+    }
+    shifted_file.reset();
+
+    // 4096 distinct colors, so the palette is quantized after most of the colors were seen
+    VoxelGrid colorful(WORLD_SIZE, glm::dvec3(0.0));
+    for (uint32_t i = 0; i < 4096; i++) {
+        uint32_t color = 0x010101u + (i * 37 & 0xFE) + ((i * 91 & 0xFE) << 8) + ((i * 13 & 0xFE) << 16);
+        colorful.SetVoxel({(int) (i % 16), (int) (i / 16 % 16), (int) (i / 256)}, color);
+    }
+    VoxFile::Save(VOX_PATH, colorful);
+    VoxelGrid colorful_imported(WORLD_SIZE, glm::dvec3(0.0));
+    auto colorful_file = VoxFile::Open(VOX_PATH);
+    colorful_file->Import(colorful_imported, colorful_file->GetMin());
+    colorful_file.reset();
+    if (!SameVoxels(colorful, colorful_imported, glm::ivec3(0), 127)) {
+        logger->error("Vox world with more than 255 colors differs after the export");
+        return false;
+    }
+
+    RawVolumeFormat format;
+    format.dimensions = glm::ivec3(SPHERE_SIZE);
+    format.palette = {0, 0xFF0000, 0x00FF00, 0x0000FF};
+    {
+        std::ofstream raw(RAW_PATH, std::ios::binary);
+        std::ofstream text(TEXT_PATH);
+        for (int z = 0; z < SPHERE_SIZE; z++) {
+            for (int y = 0; y < SPHERE_SIZE; y++) {
+                for (int x = 0; x < SPHERE_SIZE; x++) {
+                    uint8_t value = GetSphereValue(x, y, z);
+                    raw.put((char) value);
+                    text << (int) value << ' ';
+                }
+            }
+        }
+    }
+
+    glm::ivec3 offset(100, 20, 300);
+    for (int bytes: {1, 0}) {
+        format.bytes_per_voxel = bytes;
+        VoxelGrid volume(WORLD_SIZE, glm::dvec3(0.0));
+        timer.Reset();
+        RawVolume::Import(bytes ? RAW_PATH : TEXT_PATH, format, volume, offset);
+        logger->info("raw {}: {} chunks imported in {:.1f}ms", bytes ? "binary" : "text",
+                     volume.GetLoadedChunksNum() - 1, timer.GetTimeAndReset() * 1e3);
+        for (int x = 0; x < SPHERE_SIZE; x++) {
+            for (int y = 0; y < SPHERE_SIZE; y++) {
+                for (int z = 0; z < SPHERE_SIZE; z++) {
+                    if (volume.GetVoxel(offset + glm::ivec3(x, y, z)) != format.palette[GetSphereValue(x, y, z)]) {
+                        logger->error("Raw volume voxel ({}, {}, {}) differs", x, y, z);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int, char **) {
+    // Vox files stay mapped while they are open, so they are removed at the end
+    bool success = RunBenchmark(spdlog::default_logger());
+    std::remove(VOX_PATH);
+    std::remove(RAW_PATH);
+    std::remove(TEXT_PATH);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
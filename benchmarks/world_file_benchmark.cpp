@@ -0,0 +1,136 @@
+#include <lit/engine/utilities/world_file.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = WorldFile::VoxelGrid;
+
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+const char *WORLD_PATH = "world_file_benchmark.litw";
+const int EDITS_COUNT = 64;
+const char *CORRUPTED_PATH = "world_file_benchmark_corrupted.litw";
+
+bool SameChunks(VoxelGrid &expected, VoxelGrid &actual) {
+    bool same = true;
+    auto dims = expected.GetChunkGridDimensions();
+    for (int i = 0; i < dims.x && same; i++) {
+        for (int j = 0; j < dims.y && same; j++) {
+            for (int k = 0; k < dims.z && same; k++) {
+                auto a = expected.GetChunkGridView().At(i, j, k);
+                auto b = actual.GetChunkGridView().At(i, j, k);
+                if ((a == VoxelGrid::CHUNK_EMPTY) != (b == VoxelGrid::CHUNK_EMPTY)) {
+                    same = false;
+                } else if (a != VoxelGrid::CHUNK_EMPTY) {
+                    same = expected.GetChunkData(a) == actual.GetChunkData(b);
+                }
+            }
+        }
+    }
+    return same;
+}
+
+/**
+ * Saves a world with two chunks and replaces their positions in the directory with (0, 0, 0) and @position,
+ * returns false if the corrupted directory is accepted.
+ */
+bool CheckCorruptedPosition(glm::ivec3 position, const std::shared_ptr<spdlog::logger> &logger) {
+    VoxelGrid world(glm::ivec3(64), glm::dvec3(0.0));
+    world.SetVoxel({0, 0, 0}, 1);
+    world.SetVoxel({63, 63, 63}, 2);
+    WorldFile::Save(CORRUPTED_PATH, world);
+
+    std::fstream file(CORRUPTED_PATH, std::ios::binary | std::ios::in | std::ios::out);
+    WorldFile::Header header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    glm::ivec3 positions[2] = {glm::ivec3(0), position};
+    for (int i = 0; i < 2; i++) {
+        // Position is the first field of the entry
+        file.seekp((std::streamoff) (header.directory_offset + i * sizeof(WorldFile::ChunkEntry)));
+        file.write(reinterpret_cast<const char *>(&positions[i]), sizeof(glm::ivec3));
+    }
+    file.close();
+
+    try {
+        WorldFile::Open(CORRUPTED_PATH);
+        logger->error("Chunk at ({}, {}, {}) was accepted", position.x, position.y, position.z);
+        return false;
+    } catch (const std::runtime_error &e) {
+        logger->info("Expected error: {}", e.what());
+        return true;
+    }
+}
+
+/**
+ * Saves a generated world, opens it with lazy paging, reads a single chunk, then changes some voxels and saves them
+ * incrementally. Reports timings and returns false if a reopened world differs from the saved one.
+ */
+bool RunBenchmark(const std::shared_ptr<spdlog::logger> &logger) {
+    VoxelGrid world(WORLD_SIZE, glm::dvec3(0.0));
+    WorldGen().Generate(world, *logger);
+
+    Timer timer;
+    WorldFile::Save(WORLD_PATH, world);
+    double save_time = timer.GetTimeAndReset();
+
+    auto file = WorldFile::Open(WORLD_PATH);
+    VoxelGrid paged(file->GetDimensions(), file->GetAnchor());
+    file->AttachTo(paged);
+    double open_time = timer.GetTimeAndReset();
+
+    // Top of the terrain in the middle of some chunk
+    auto &entries = file->GetChunks();
+    glm::ivec3 center = entries[entries.size() / 2].position * VoxelGrid::CHUNK_SIZE + VoxelGrid::CHUNK_SIZE / 2;
+    int surface = center.y;
+    while (surface < WORLD_SIZE.y && paged.GetVoxel({center.x, surface, center.z})) {
+        surface++;
+    }
+    double first_access_time = timer.GetTimeAndReset();
+    logger->info("{} chunks: saved in {:.1f}ms, opened in {:.2f}ms, first access {:.3f}ms, {} chunks loaded",
+                 entries.size(), save_time * 1e3, open_time * 1e3, first_access_time * 1e3,
+                 paged.GetLoadedChunksNum() - 1);
+
+    if (!SameChunks(world, paged)) {
+        logger->error("Paged world differs from the saved one");
+        return false;
+    }
+
+    // Edits are tracked on the original world and appended to the file
+    DirtyChunkTracker tracker(world);
+    for (int i = 0; i < EDITS_COUNT; i++) {
+        world.SetVoxel({i * 13 % WORLD_SIZE.x, surface + i % 8, i * 29 % WORLD_SIZE.z}, 0xFF00FFu);
+    }
+    world.DeleteChunk(center / VoxelGrid::CHUNK_SIZE);
+    auto changed = tracker.TakeChanged();
+    timer.Reset();
+    WorldFile::SaveIncremental(WORLD_PATH, world, changed);
+    double incremental_time = timer.GetTimeAndReset();
+
+    auto reopened_file = WorldFile::Open(WORLD_PATH);
+    VoxelGrid reopened(reopened_file->GetDimensions(), reopened_file->GetAnchor());
+    reopened_file->AttachTo(reopened);
+    logger->info("{} changed chunks saved incrementally in {:.2f}ms", changed.size(), incremental_time * 1e3);
+
+    if (!SameChunks(world, reopened)) {
+        logger->error("Reopened world differs after the incremental save");
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **) {
+    // Paged grids keep the file mapped, so it is removed after they are destroyed
+    auto logger = spdlog::default_logger();
+    bool success = RunBenchmark(logger);
+    std::remove(WORLD_PATH);
+
+    // Outside of the 2x2x2 chunk grid and at the position of the first chunk
+    success = success && CheckCorruptedPosition(glm::ivec3(2, 0, 0), logger) &&
+              CheckCorruptedPosition(glm::ivec3(0, -1, 0), logger) && CheckCorruptedPosition(glm::ivec3(0), logger);
+    std::remove(CORRUPTED_PATH);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,243 @@
+#include <lit/engine/utilities/world_patch.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = WorldPatch::VoxelGrid;
+using ChunkMap = std::map<glm::ivec3, VoxelGrid::ChunkData, glm_ext::vec3_comparator<int>>;
+
+// Smaller than the 4096^3 target world, which doesn't fit into memory three times over. Diff and apply times are
+// linear in the number of chunks, so they can be scaled by it.
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+const char *PATCH_PATH = "world_patch_benchmark.litd";
+// Every 100th chunk is changed
+const size_t CHANGE_STEP = 100;
+
+ChunkMap TakeSnapshot(VoxelGrid &grid) {
+    ChunkMap chunks;
+    grid.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        chunks[chunk.GetChunkGridPosition()] = grid.GetChunkData(chunk.GetIndex());
+    });
+    return chunks;
+}
+
+std::unique_ptr<VoxelGrid> MakeGrid(const ChunkMap &chunks) {
+    auto grid = std::make_unique<VoxelGrid>(WORLD_SIZE, glm::dvec3(0.0));
+    std::vector<glm::ivec3> positions;
+    std::vector<std::unique_ptr<VoxelGrid::ChunkData>> data;
+    for (auto &[position, chunk]: chunks) {
+        positions.push_back(position);
+        data.push_back(std::make_unique<VoxelGrid::ChunkData>(chunk));
+    }
+    grid->InsertChunks(positions, std::move(data));
+    return grid;
+}
+
+/**
+ * Changes about 1% of the chunks: a few voxels of every CHANGE_STEP-th chunk, one deleted chunk and a row of new
+ * chunks above the terrain.
+ */
+void Edit(VoxelGrid &grid) {
+    std::vector<glm::ivec3> positions;
+    grid.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        positions.push_back(chunk.GetChunkGridPosition());
+    });
+    for (size_t i = 0; i < positions.size(); i += CHANGE_STEP) {
+        glm::ivec3 origin = positions[i] * VoxelGrid::CHUNK_SIZE;
+        for (int j = 0; j < 8; j++) {
+            grid.SetVoxel(origin + glm::ivec3(j, j * 2, 3), 0x804020u + j);
+        }
+    }
+    grid.DeleteChunk(positions[positions.size() / 2 + 1]);
+
+    std::vector<glm::ivec3> created;
+    glm::ivec3 dimensions = grid.GetChunkGridDimensions();
+    for (int x = 0; x < dimensions.x; x += 4) {
+        created.emplace_back(x, dimensions.y - 1, 0);
+    }
+    grid.CreateChunks(created, [&](const std::vector<VoxelGrid::ChunkIndexType> &indices) {
+        for (auto index: indices) {
+            VoxelGrid::FillChunkColumn(grid.GetChunkData(index), {3, 0, 5}, 20, 0x00ff00u);
+        }
+    });
+}
+
+/**
+ * Writes @entries as a patch file in the layout of WorldPatch::Save, for patches that Diff never produces.
+ */
+void WritePatch(const char *path, const glm::ivec3 &dimensions, const std::vector<WorldPatch::Entry> &entries) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    WorldPatch::Header header{{'L', 'I', 'T', 'D'}, WorldPatch::VERSION, dimensions, 0, entries.size()};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (auto &entry: entries) {
+        WorldPatch::EntryHeader entry_header{entry.position, entry.change, (uint32_t) entry.payload.size(), 0,
+                                             entry.base_hash, entry.hash};
+        file.write(reinterpret_cast<const char *>(&entry_header), sizeof(entry_header));
+        file.write(reinterpret_cast<const char *>(entry.payload.data()), (std::streamsize) entry.payload.size());
+    }
+}
+
+/**
+ * Applies @entries written as a patch file to a copy of @original, it must throw without changing the copy.
+ */
+bool CheckRejected(const std::vector<WorldPatch::Entry> &entries, const ChunkMap &original, ThreadPool &pool,
+                   const char *name, const std::shared_ptr<spdlog::logger> &logger) {
+    WritePatch(PATCH_PATH, WORLD_SIZE, entries);
+    WorldPatch patch = WorldPatch::Load(PATCH_PATH);
+    std::filesystem::remove(PATCH_PATH);
+    auto grid = MakeGrid(original);
+    try {
+        patch.Apply(*grid, pool);
+        logger->error("Patch with {} applied", name);
+        return false;
+    } catch (const std::runtime_error &) {
+    }
+    if (TakeSnapshot(*grid) != original) {
+        logger->error("Rejected patch with {} changed the world", name);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Diffs a generated world with an edited copy, with hashes computed by the diff and with cached hashes, then
+ * applies the patch from memory and from a file to copies of the original world and compares them with the
+ * edited one. A patch applied to a different world, with two entries for one chunk or with a malformed payload in
+ * its last batch must throw without changing the world.
+ */
+bool RunBenchmark(const std::shared_ptr<spdlog::logger> &logger) {
+    ThreadPool pool;
+    VoxelGrid world(WORLD_SIZE, glm::dvec3(0.0));
+    WorldGen().Generate(world, *logger);
+    ChunkMap original = TakeSnapshot(world);
+
+    auto edited = MakeGrid(original);
+    Edit(*edited);
+    ChunkMap target = TakeSnapshot(*edited);
+
+    Timer timer;
+    WorldPatch patch = WorldPatch::Diff(world, *edited, pool);
+    double cold_time = timer.GetTimeAndReset();
+    patch = WorldPatch::Diff(world, *edited, pool);
+    double warm_time = timer.GetTimeAndReset();
+    logger->info("{} of {} chunks differ, {:.1f} KB of payload", patch.GetEntries().size(), original.size(),
+                 patch.GetPayloadSize() / 1024.0);
+    logger->info("Diff in {:.1f}ms with hashing, {:.1f}ms with cached hashes", cold_time * 1e3, warm_time * 1e3);
+
+    size_t expected = original.size() / CHANGE_STEP;
+    if (patch.GetEntries().size() < expected || patch.GetEntries().size() > 2 * expected + 64) {
+        logger->error("Unexpected number of changed chunks");
+        return false;
+    }
+
+    auto patched = MakeGrid(original);
+    std::map<VoxelGrid::ChunkIndexType, int> notifications;
+    patched->AddOnChunkAnyChangeCallback([&](const auto &args) {
+        std::visit([&](const auto &change) { notifications[change.index]++; }, args);
+    });
+    timer.Reset();
+    patch.Apply(*patched, pool);
+    logger->info("Patch applied in {:.1f}ms, {} chunks notified", timer.GetTime() * 1e3, notifications.size());
+    if (TakeSnapshot(*patched) != target) {
+        logger->error("World differs after applying the patch");
+        return false;
+    }
+    for (auto &[index, count]: notifications) {
+        if (count > 2) {
+            logger->error("Chunk {} notified {} times", index, count);
+            return false;
+        }
+    }
+
+    patch.Save(PATCH_PATH);
+    if (WorldPatch::Load(PATCH_PATH).GetPayloadSize() != patch.GetPayloadSize()) {
+        logger->error("Loaded patch differs");
+        return false;
+    }
+    auto streamed = MakeGrid(original);
+    timer.Reset();
+    WorldPatch::ApplyFile(PATCH_PATH, *streamed, pool);
+    logger->info("Patch file of {:.1f} KB applied in {:.1f}ms", std::filesystem::file_size(PATCH_PATH) / 1024.0,
+                 timer.GetTime() * 1e3);
+    bool streamed_equal = TakeSnapshot(*streamed) == target;
+    if (!streamed_equal) {
+        std::filesystem::remove(PATCH_PATH);
+        logger->error("World differs after applying the patch file");
+        return false;
+    }
+
+    // Payload size of the first entry is larger than the file
+    {
+        std::fstream file(PATCH_PATH, std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t payload_size = 0xffffffffu;
+        file.seekp((std::streamoff) (sizeof(WorldPatch::Header) + offsetof(WorldPatch::EntryHeader, payload_size)));
+        file.write(reinterpret_cast<const char *>(&payload_size), sizeof(payload_size));
+    }
+    bool truncated_rejected = false;
+    try {
+        WorldPatch::Load(PATCH_PATH);
+    } catch (const std::runtime_error &) {
+        truncated_rejected = true;
+    }
+    std::filesystem::remove(PATCH_PATH);
+    if (!truncated_rejected) {
+        logger->error("Patch with a payload past the end of the file was loaded");
+        return false;
+    }
+
+    // The edited world is not the version the patch was computed from
+    try {
+        patch.Apply(*edited, pool);
+        logger->error("Patch applied to a wrong world");
+        return false;
+    } catch (const std::runtime_error &) {
+    }
+    if (TakeSnapshot(*edited) != target) {
+        logger->error("Rejected patch changed the world");
+        return false;
+    }
+
+    auto duplicated = patch.GetEntries();
+    auto created = std::find_if(duplicated.begin(), duplicated.end(), [](const WorldPatch::Entry &entry) {
+        return entry.change == WorldPatch::ChunkChange::Created;
+    });
+    duplicated.push_back(*created);
+    if (!CheckRejected(duplicated, original, pool, "a repeated chunk", logger)) {
+        return false;
+    }
+
+    // Patch of several batches: a layer of new chunks
+    auto grown = MakeGrid(original);
+    std::vector<glm::ivec3> layer;
+    glm::ivec3 dimensions = grown->GetChunkGridDimensions();
+    for (int x = 0; x < dimensions.x; x++) {
+        for (int z = 0; z < dimensions.z; z++) {
+            if (grown->GetChunkGridView().At(x, dimensions.y - 1, z) == VoxelGrid::CHUNK_EMPTY) {
+                layer.emplace_back(x, dimensions.y - 1, z);
+            }
+        }
+    }
+    grown->CreateChunks(layer, [&](const std::vector<VoxelGrid::ChunkIndexType> &indices) {
+        for (auto index: indices) {
+            VoxelGrid::FillChunkColumn(grown->GetChunkData(index), {1, 0, 1}, 4, 0x0000ffu);
+        }
+    });
+    auto malformed = WorldPatch::Diff(world, *grown, pool).GetEntries();
+    auto last = std::find_if(malformed.rbegin(), malformed.rend(), [](const WorldPatch::Entry &entry) {
+        return entry.change != WorldPatch::ChunkChange::Deleted;
+    });
+    last->payload.push_back(0);
+    return CheckRejected(malformed, original, pool, "a malformed payload", logger);
+}
+
+int main(int, char **) {
+    return RunBenchmark(spdlog::default_logger()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+#include <lit/engine/utilities/world_persistence.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdio>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = WorldPersistence::VoxelGrid;
+
+const glm::ivec3 WORLD_SIZE = glm::ivec3(1024, 256, 1024);
+const char *BLOCKING_PATH = "world_persistence_blocking.litw";
+const char *ASYNC_PATH = "world_persistence_async.litw";
+const int EDITS_COUNT = 64;
+
+bool SameChunks(VoxelGrid &expected, VoxelGrid &actual) {
+    bool same = true;
+    auto dims = expected.GetChunkGridDimensions();
+    for (int i = 0; i < dims.x && same; i++) {
+        for (int j = 0; j < dims.y && same; j++) {
+            for (int k = 0; k < dims.z && same; k++) {
+                auto a = expected.GetChunkGridView().At(i, j, k);
+                auto b = actual.GetChunkGridView().At(i, j, k);
+                if ((a == VoxelGrid::CHUNK_EMPTY) != (b == VoxelGrid::CHUNK_EMPTY)) {
+                    same = false;
+                } else if (a != VoxelGrid::CHUNK_EMPTY) {
+                    same = expected.GetChunkData(a) == actual.GetChunkData(b);
+                }
+            }
+        }
+    }
+    return same;
+}
+
+/**
+ * Calls Update as a frame loop would until all jobs are reported, returns the longest Update.
+ */
+double RunFrames(WorldPersistence &persistence) {
+    double longest_update = 0.0;
+    while (persistence.IsBusy()) {
+        Timer timer;
+        persistence.Update();
+        longest_update = std::max(longest_update, timer.GetTime());
+    }
+    return longest_update;
+}
+
+/**
+ * Compares the time the calling thread is blocked by WorldFile::Save and by WorldPersistence, then loads the world
+ * back asynchronously and saves some edits incrementally. Fails if a loaded world differs from the saved one.
+ */
+bool RunBenchmark(const std::shared_ptr<spdlog::logger> &logger) {
+    VoxelGrid world(WORLD_SIZE, glm::dvec3(0.0));
+    WorldGen().Generate(world, *logger);
+    logger->info("{} chunks", world.GetLoadedChunksNum() - 1);
+
+    Timer timer;
+    WorldFile::Save(BLOCKING_PATH, world);
+    double blocking_save_time = timer.GetTimeAndReset();
+
+    WorldPersistence persistence;
+    std::string error;
+    auto on_done = [&](const std::string &e) {
+        if (!e.empty()) {
+            error = e;
+        }
+    };
+    persistence.SaveAsync(ASYNC_PATH, world, nullptr, on_done);
+    double snapshot_time = timer.GetTime();
+    double longest_update = RunFrames(persistence);
+    double async_save_time = timer.GetTimeAndReset();
+    logger->info("Blocking save {:.1f}ms, async save {:.1f}ms: snapshot {:.1f}ms, longest update {:.3f}ms",
+                 blocking_save_time * 1e3, async_save_time * 1e3, snapshot_time * 1e3, longest_update * 1e3);
+
+    // Later saves reuse the snapshot buffers
+    persistence.SaveAsync(ASYNC_PATH, world, nullptr, on_done);
+    snapshot_time = timer.GetTime();
+    RunFrames(persistence);
+    logger->info("Repeated async save {:.1f}ms: snapshot {:.1f}ms", timer.GetTimeAndReset() * 1e3,
+                 snapshot_time * 1e3);
+
+    VoxelGrid loaded(WORLD_SIZE, glm::dvec3(0.0));
+    persistence.LoadAsync(ASYNC_PATH, loaded, on_done);
+    longest_update = RunFrames(persistence);
+    logger->info("Async load {:.1f}ms, longest update {:.2f}ms", timer.GetTimeAndReset() * 1e3,
+                 longest_update * 1e3);
+
+    if (!error.empty() || !SameChunks(world, loaded)) {
+        logger->error("Loaded world differs from the saved one {}", error);
+        return false;
+    }
+
+    // Edits are appended to the file while the world keeps changing
+    DirtyChunkTracker tracker(world);
+    for (int i = 0; i < EDITS_COUNT; i++) {
+        world.SetVoxel({i * 13 % WORLD_SIZE.x, 64 + i % 8, i * 29 % WORLD_SIZE.z}, 0xFF00FFu);
+    }
+    world.DeleteChunk(world.GetChunkGridDimensions() / 2);
+    timer.Reset();
+    persistence.SaveIncrementalAsync(ASYNC_PATH, world, tracker.TakeChanged(), nullptr, on_done);
+    snapshot_time = timer.GetTime();
+    persistence.Wait();
+    logger->info("Incremental save {:.2f}ms, snapshot {:.3f}ms", timer.GetTimeAndReset() * 1e3, snapshot_time * 1e3);
+
+    VoxelGrid reloaded(WORLD_SIZE, glm::dvec3(0.0));
+    persistence.LoadAsync(ASYNC_PATH, reloaded, on_done);
+    persistence.Wait();
+    if (!error.empty() || !SameChunks(world, reloaded)) {
+        logger->error("Loaded world differs after the incremental save {}", error);
+        return false;
+    }
+
+    // Jobs on one path keep their order: the first load reads the file before the full save rewrites it and the
+    // second one reads the rewritten file
+    VoxelGrid before_save(WORLD_SIZE, glm::dvec3(0.0));
+    VoxelGrid after_save(WORLD_SIZE, glm::dvec3(0.0));
+    persistence.LoadAsync(ASYNC_PATH, before_save, on_done);
+    world.SetVoxel({WORLD_SIZE.x / 2, 100, WORLD_SIZE.z / 2}, 0x00FFFFu);
+    persistence.SaveAsync(ASYNC_PATH, world, nullptr, on_done);
+    persistence.LoadAsync(ASYNC_PATH, after_save, on_done);
+    persistence.Wait();
+    if (!error.empty() || !SameChunks(reloaded, before_save) || !SameChunks(world, after_save)) {
+        logger->error("Jobs on the same file were reordered {}", error);
+        return false;
+    }
+
+    persistence.LoadAsync("missing.litw", reloaded, on_done);
+    persistence.Wait();
+    if (error.empty()) {
+        logger->error("Loading a missing file succeeded");
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **) {
+    bool success = RunBenchmark(spdlog::default_logger());
+    std::remove(BLOCKING_PATH);
+    std::remove(ASYNC_PATH);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -24,6 +24,15 @@ namespace lit::common {
             return m_height;
         }
 
+        /// Elements are stored by columns: (x, y) is at x * GetHeight() + y.
+        T* data() {
+            return m_data.data();
+        }
+
+        const T* data() const {
+            return m_data.data();
+        }
+
     private:
         std::vector<T> m_data;
         size_t m_width;
@@ -3,6 +3,9 @@
 #define GLM_FORCE_SWIZZLE
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <glm/vec4.hpp>
@@ -25,6 +28,12 @@ namespace lit::common {
             m_data.assign(width * height * C, T());
         }
 
+        /**
+         * Takes @data with rows of width * C values from top to bottom.
+         */
+        Image(uint32_t width, uint32_t height, std::vector<T> &&data) : m_width(width), m_height(height),
+                                                                       m_data(std::move(data)) {}
+
         Image() = default;
 
         pixel_t GetPixel(uint32_t row, uint32_t col) const {
@@ -59,6 +68,13 @@ namespace lit::common {
             return m_data.data();
         }
 
+        /**
+         * Values of the row @y (the second coordinate of GetPixel), width * C of them.
+         */
+        T *GetRowPointer(uint32_t y) {
+            return m_data.data() + (size_t) y * m_width * C;
+        }
+
     private:
         inline uint32_t GetIndex(uint32_t row, uint32_t col) const {
             return C * (row + col * m_width);
@@ -144,8 +160,89 @@ namespace lit::common {
         std::vector<T> m_data = {};
     };
 
+    /**
+     * Streaming PNG decoder: rows are decoded one by one from the top and only the current and previous rows
+     * and the 32 KB window of the compressed stream are kept, so images of any size can be read in constant memory.
+     * Interlaced images can't be decoded by rows and are rejected.
+     */
+    class PngReader {
+    public:
+        /**
+         * Opens @filename and reads the chunks before the image data.
+         * Throws std::runtime_error if the file can't be read, is not a PNG or is interlaced.
+         */
+        explicit PngReader(const std::string &filename);
+
+        ~PngReader();
+
+        PngReader(const PngReader &) = delete;
+
+        PngReader &operator=(const PngReader &) = delete;
+
+        uint32_t GetWidth() const;
+
+        uint32_t GetHeight() const;
+
+        /**
+         * Channels of the image: 1 (gray), 2 (gray and alpha), 3 (RGB) or 4 (RGBA), palettes are RGB or RGBA.
+         */
+        uint8_t GetChannels() const;
+
+        /**
+         * Decodes the next row into @pixels: width pixels of @channels values. Gray becomes RGB, missing alpha is
+         * opaque and a single channel is the first one of the image. 8-bit values of 16-bit images are the high bytes.
+         * Throws std::runtime_error if the data is malformed, returns false after the last row.
+         */
+        bool ReadRow(uint8_t *pixels, uint8_t channels);
+
+        bool ReadRow(uint16_t *pixels, uint8_t channels);
+
+    private:
+        struct Decoder;
+
+        std::unique_ptr<Decoder> m_decoder;
+    };
+
+    /**
+     * Decodes @filename in bands of @band_height rows and calls @callback(first_row, band) for every band,
+     * the last band may be shorter. Only one band is held in memory. Throws as <see cref="PngReader"/>.
+     */
+    template<typename T, uint8_t C>
+    void ReadPNG_Rows(const std::string &filename, uint32_t band_height,
+                      const std::function<void(uint32_t first_row, const Image<T, C> &band)> &callback) {
+        PngReader reader(filename);
+        Image<T, C> band(reader.GetWidth(), std::min(band_height, reader.GetHeight()));
+        for (uint32_t first_row = 0; first_row < reader.GetHeight(); first_row += band_height) {
+            uint32_t rows = std::min(band_height, reader.GetHeight() - first_row);
+            if (rows != band.GetHeight()) {
+                band = Image<T, C>(reader.GetWidth(), rows);
+            }
+            for (uint32_t y = 0; y < rows; y++) {
+                reader.ReadRow(band.GetRowPointer(y), C);
+            }
+            callback(first_row, band);
+        }
+    }
+
+    /**
+     * Rows are decoded straight into the image, interlaced images are decoded by lodepng.
+     * Returns an empty image if the file can't be read.
+     */
     Image<uint8_t, 4> ReadPNG_RGBA(const std::string &filename);
 
     Image<uint8_t, 3> ReadPNG_RGB(const std::string &filename);
 
+    /**
+     * Decodes independent images in parallel, at most one thread per hardware thread.
+     */
+    std::vector<Image<uint8_t, 4>> ReadPNGs_RGBA(const std::vector<std::string> &filenames);
+
+    std::vector<Image<uint8_t, 3>> ReadPNGs_RGB(const std::vector<std::string> &filenames);
+
+    /**
+     * Writes image to the PNG file, rows are written from top to bottom (row 0 is the first one).
+     * @return false if the image can't be encoded or written.
+     */
+    bool WritePNG_RGB(const std::string &filename, const Image<uint8_t, 3> &image);
+
 }
@@ -3,36 +3,777 @@
 #include <glm/detail/type_vec4.hpp>
 
 #include <glm/fwd.hpp>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
 
 using namespace lit::common;
 
-Image<uint8_t, 4> lit::common::ReadPNG_RGBA(const std::string &filename) {
-    std::vector<unsigned char> data; //the raw pixels
-    unsigned width, height;
-    unsigned error = lodepng::decode(data, width, height, filename);
+namespace {
+
+    void fail(const std::string &message) {
+        throw std::runtime_error("PNG: " + message);
+    }
+
+    uint32_t readBigEndian32(const uint8_t *bytes) {
+        return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | bytes[3];
+    }
+
+    /**
+     * Concatenated data of the IDAT chunks, read from the file in blocks.
+     */
+    class IdatSource {
+    public:
+        IdatSource(std::ifstream &file, uint32_t first_length) : m_file(file), m_chunk_left(first_length) {}
+
+        /**
+         * Reads up to @capacity bytes into @buffer, returns 0 after the last IDAT chunk.
+         */
+        size_t Read(uint8_t *buffer, size_t capacity) {
+            while (m_chunk_left == 0) {
+                if (m_finished) {
+                    return 0;
+                }
+                // CRC of the previous chunk, then the header of the next one
+                uint8_t header[12];
+                if (!m_file.read((char *) header, sizeof(header))) {
+                    fail("unexpected end of file");
+                }
+                if (std::memcmp(header + 8, "IDAT", 4) != 0) {
+                    m_finished = true;
+                    return 0;
+                }
+                m_chunk_left = readBigEndian32(header + 4);
+            }
+            size_t size = std::min<size_t>(capacity, m_chunk_left);
+            if (!m_file.read((char *) buffer, (std::streamsize) size)) {
+                fail("unexpected end of file");
+            }
+            m_chunk_left -= (uint32_t) size;
+            return size;
+        }
+
+    private:
+        std::ifstream &m_file;
+        uint32_t m_chunk_left;
+        bool m_finished = false;
+    };
+
+    /**
+     * Canonical Huffman code of deflate. Codes up to FAST_BITS long are decoded by one table lookup,
+     * longer ones bit by bit from the counts of the code lengths.
+     */
+    struct Huffman {
+        static const int MAX_BITS = 15;
+        static const int FAST_BITS = 10;
+
+        // Symbol << 4 | code length, zero for prefixes of longer codes
+        std::array<uint16_t, 1 << FAST_BITS> fast{};
+        std::array<uint16_t, MAX_BITS + 1> counts{};
+        std::array<uint16_t, 288> symbols{};
+
+        void Build(const uint8_t *lengths, int symbols_count) {
+            counts.fill(0);
+            fast.fill(0);
+            for (int i = 0; i < symbols_count; i++) {
+                counts[lengths[i]]++;
+            }
+            counts[0] = 0;
+            int left = 1;
+            for (int length = 1; length <= MAX_BITS; length++) {
+                left = (left << 1) - counts[length];
+                if (left < 0) {
+                    fail("over-subscribed Huffman code");
+                }
+            }
+
+            std::array<uint16_t, MAX_BITS + 2> offsets{};
+            std::array<uint32_t, MAX_BITS + 1> next_code{};
+            uint32_t code = 0;
+            for (int length = 1; length <= MAX_BITS; length++) {
+                offsets[length + 1] = offsets[length] + counts[length];
+                code = (code + counts[length - 1]) << 1;
+                next_code[length] = code;
+            }
+            for (int symbol = 0; symbol < symbols_count; symbol++) {
+                int length = lengths[symbol];
+                if (length == 0) {
+                    continue;
+                }
+                symbols[offsets[length]++] = (uint16_t) symbol;
+                if (length > FAST_BITS) {
+                    continue;
+                }
+                // Codes are stored from the most significant bit, the stream is read from the least significant one
+                uint32_t reversed = 0;
+                for (uint32_t c = next_code[length]++, i = 0; i < (uint32_t) length; i++, c >>= 1) {
+                    reversed = (reversed << 1) | (c & 1);
+                }
+                for (uint32_t i = reversed; i < fast.size(); i += 1u << length) {
+                    fast[i] = (uint16_t) (symbol << 4 | length);
+                }
+            }
+        }
+    };
+
+    /**
+     * Resumable zlib decoder: Read produces exactly the requested number of bytes, so image rows are decoded
+     * one by one and only the 32 KB window of back references is kept between them. The Adler-32 checksum
+     * is not verified.
+     */
+    class Inflater {
+    public:
+        explicit Inflater(IdatSource &source) : m_source(source) {
+            uint32_t header = ReadBits(16);
+            uint32_t cmf = header & 0xff;
+            uint32_t flags = header >> 8;
+            if ((cmf & 0x0f) != 8 || (cmf >> 4) > 7 || (cmf * 256 + flags) % 31 != 0 || (flags & 0x20)) {
+                fail("invalid zlib header");
+            }
+        }
+
+        void Read(uint8_t *output, size_t size) {
+            size_t done = 0;
+            while (done < size) {
+                if (m_match_length > 0) {
+                    size_t count = std::min<size_t>(size - done, m_match_length);
+                    for (size_t i = 0; i < count; i++) {
+                        Put(output[done++] = m_window[(m_window_pos - m_match_distance) & WINDOW_MASK]);
+                    }
+                    m_match_length -= (uint32_t) count;
+                } else if (m_block == Block::None) {
+                    if (m_last_block) {
+                        fail("image data is shorter than the image");
+                    }
+                    StartBlock();
+                } else if (m_block == Block::Stored) {
+                    if (m_stored_left == 0) {
+                        m_block = Block::None;
+                        continue;
+                    }
+                    size_t count = std::min<size_t>(size - done, m_stored_left);
+                    for (size_t i = 0; i < count; i++) {
+                        Put(output[done++] = NextStoredByte());
+                    }
+                    m_stored_left -= (uint32_t) count;
+                } else {
+                    int symbol = Decode(m_literals);
+                    if (symbol < 256) {
+                        Put(output[done++] = (uint8_t) symbol);
+                    } else if (symbol == 256) {
+                        m_block = Block::None;
+                    } else {
+                        StartMatch(symbol - 257);
+                    }
+                }
+            }
+        }
+
+    private:
+        enum class Block {
+            None, Stored, Huffman
+        };
+
+        static const uint32_t WINDOW_SIZE = 1u << 15;
+        static const uint32_t WINDOW_MASK = WINDOW_SIZE - 1;
+        // Zero bytes past the end of the data that are still allowed to be peeked
+        static const int MAX_PADDING = 8;
+
+        uint8_t NextByte() {
+            if (m_input_pos == m_input_size) {
+                m_input_size = m_source.Read(m_input.data(), m_input.size());
+                m_input_pos = 0;
+                if (m_input_size == 0) {
+                    if (++m_padding > MAX_PADDING) {
+                        fail("unexpected end of image data");
+                    }
+                    return 0;
+                }
+            }
+            return m_input[m_input_pos++];
+        }
+
+        uint8_t NextStoredByte() {
+            if (m_bits_count >= 8) {
+                // Stored blocks start at a byte boundary, whole bytes may remain in the bit buffer
+                auto byte = (uint8_t) m_bits;
+                m_bits >>= 8;
+                m_bits_count -= 8;
+                return byte;
+            }
+            return NextByte();
+        }
+
+        void Need(int count) {
+            while (m_bits_count < count) {
+                m_bits |= uint64_t(NextByte()) << m_bits_count;
+                m_bits_count += 8;
+            }
+        }
+
+        uint32_t ReadBits(int count) {
+            Need(count);
+            auto value = uint32_t(m_bits & ((1ull << count) - 1));
+            m_bits >>= count;
+            m_bits_count -= count;
+            return value;
+        }
+
+        int Decode(const Huffman &huffman) {
+            Need(Huffman::MAX_BITS);
+            uint16_t entry = huffman.fast[m_bits & ((1u << Huffman::FAST_BITS) - 1)];
+            if (entry != 0) {
+                m_bits >>= entry & 15;
+                m_bits_count -= entry & 15;
+                return entry >> 4;
+            }
+            int code = 0;
+            int first = 0;
+            int index = 0;
+            for (int length = 1; length <= Huffman::MAX_BITS; length++) {
+                code |= (int) ReadBits(1);
+                int count = huffman.counts[length];
+                if (code - count < first) {
+                    return huffman.symbols[index + (code - first)];
+                }
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+            fail("invalid Huffman code");
+            return 0;
+        }
 
-    Image<uint8_t, 4> res(std::max(width, 256u), std::max(height, 256u));
+        void Put(uint8_t byte) {
+            m_window[m_window_pos] = byte;
+            m_window_pos = (m_window_pos + 1) & WINDOW_MASK;
+            m_written++;
+        }
+
+        void StartBlock() {
+            m_last_block = ReadBits(1) != 0;
+            switch (ReadBits(2)) {
+                case 0: {
+                    ReadBits(m_bits_count & 7);
+                    uint32_t length = ReadBits(16);
+                    uint32_t complement = ReadBits(16);
+                    if ((length ^ 0xffff) != complement) {
+                        fail("invalid stored block");
+                    }
+                    m_stored_left = length;
+                    m_block = Block::Stored;
+                    break;
+                }
+                case 1:
+                    BuildFixedCodes();
+                    m_block = Block::Huffman;
+                    break;
+                case 2:
+                    ReadDynamicCodes();
+                    m_block = Block::Huffman;
+                    break;
+                default:
+                    fail("invalid block type");
+            }
+        }
+
+        void BuildFixedCodes() {
+            std::array<uint8_t, 288> lengths{};
+            std::fill(lengths.begin(), lengths.begin() + 144, 8);
+            std::fill(lengths.begin() + 144, lengths.begin() + 256, 9);
+            std::fill(lengths.begin() + 256, lengths.begin() + 280, 7);
+            std::fill(lengths.begin() + 280, lengths.end(), 8);
+            m_literals.Build(lengths.data(), 288);
+            std::fill(lengths.begin(), lengths.begin() + 30, 5);
+            m_distances.Build(lengths.data(), 30);
+        }
+
+        void ReadDynamicCodes() {
+            static const uint8_t ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+            uint32_t literals_count = ReadBits(5) + 257;
+            uint32_t distances_count = ReadBits(5) + 1;
+            uint32_t code_lengths_count = ReadBits(4) + 4;
+            if (literals_count > 286 || distances_count > 30) {
+                fail("invalid dynamic block");
+            }
+
+            std::array<uint8_t, 19> code_lengths{};
+            for (uint32_t i = 0; i < code_lengths_count; i++) {
+                code_lengths[ORDER[i]] = (uint8_t) ReadBits(3);
+            }
+            Huffman code_lengths_code;
+            code_lengths_code.Build(code_lengths.data(), 19);
+
+            std::array<uint8_t, 286 + 30> lengths{};
+            uint32_t total = literals_count + distances_count;
+            for (uint32_t i = 0; i < total;) {
+                int symbol = Decode(code_lengths_code);
+                if (symbol < 16) {
+                    lengths[i++] = (uint8_t) symbol;
+                    continue;
+                }
+                uint8_t value = 0;
+                uint32_t repeat;
+                if (symbol == 16) {
+                    if (i == 0) {
+                        fail("invalid dynamic block");
+                    }
+                    value = lengths[i - 1];
+                    repeat = 3 + ReadBits(2);
+                } else if (symbol == 17) {
+                    repeat = 3 + ReadBits(3);
+                } else {
+                    repeat = 11 + ReadBits(7);
+                }
+                if (i + repeat > total) {
+                    fail("invalid dynamic block");
+                }
+                std::fill_n(lengths.begin() + i, repeat, value);
+                i += repeat;
+            }
+            if (lengths[256] == 0) {
+                fail("missing end of block code");
+            }
+            m_literals.Build(lengths.data(), (int) literals_count);
+            m_distances.Build(lengths.data() + literals_count, (int) distances_count);
+        }
+
+        void StartMatch(int length_symbol) {
+            static const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43,
+                                                     51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+            static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4,
+                                                     4, 4, 5, 5, 5, 5, 0};
+            static const uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257,
+                                                       385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289,
+                                                       16385, 24577};
+            static const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9,
+                                                       9, 10, 10, 11, 11, 12, 12, 13, 13};
+            if (length_symbol >= 29) {
+                fail("invalid length code");
+            }
+            m_match_length = LENGTH_BASE[length_symbol] + ReadBits(LENGTH_EXTRA[length_symbol]);
+            int distance_symbol = Decode(m_distances);
+            if (distance_symbol >= 30) {
+                fail("invalid distance code");
+            }
+            m_match_distance = DISTANCE_BASE[distance_symbol] + ReadBits(DISTANCE_EXTRA[distance_symbol]);
+            if (m_match_distance > std::min<uint64_t>(m_written, WINDOW_SIZE)) {
+                fail("distance is too far back");
+            }
+        }
+
+        IdatSource &m_source;
+        std::array<uint8_t, 1 << 16> m_input{};
+        size_t m_input_pos = 0;
+        size_t m_input_size = 0;
+        int m_padding = 0;
+        uint64_t m_bits = 0;
+        int m_bits_count = 0;
+
+        Block m_block = Block::None;
+        bool m_last_block = false;
+        uint32_t m_stored_left = 0;
+        uint32_t m_match_length = 0;
+        uint32_t m_match_distance = 0;
+        Huffman m_literals;
+        Huffman m_distances;
+
+        std::array<uint8_t, WINDOW_SIZE> m_window{};
+        uint32_t m_window_pos = 0;
+        uint64_t m_written = 0;
+    };
+
+}
+
+struct PngReader::Decoder {
+    std::ifstream file;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t bit_depth = 0;
+    uint8_t color_type = 0;
+    // Values per pixel in the file and channels of the decoded pixels
+    uint8_t samples = 0;
+    uint8_t channels = 0;
+    std::array<std::array<uint16_t, 4>, 256> palette{};
+    // Transparent color of gray and RGB images, in samples of the file
+    bool has_key = false;
+    std::array<uint16_t, 3> key{};
+
+    std::unique_ptr<IdatSource> source;
+    std::unique_ptr<Inflater> inflater;
+    uint32_t row = 0;
+    size_t stride = 0;
+    size_t pixel_bytes = 0;
+    std::vector<uint8_t> current;
+    std::vector<uint8_t> previous;
+
+    explicit Decoder(const std::string &filename) : file(filename, std::ios::binary) {
+        static const uint8_t SIGNATURE[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+        uint8_t signature[8];
+        if (!file.read((char *) signature, 8)) {
+            fail("can't read " + filename);
+        }
+        if (std::memcmp(signature, SIGNATURE, 8) != 0) {
+            fail(filename + " is not a PNG file");
+        }
 
-    for (int x = 0; x < width; x++) {
-        for (int y = 0; y < height; y++) {
-            int offset = 4 * y * (int)width + 4 * x;
-            res.SetPixel(x, y, Image<glm::uint8_t, 4>::pixel_t(data[offset + 0], data[offset + 1], data[offset + 2],
-                                                               data[offset + 3]));
+        bool has_header = false;
+        uint32_t palette_size = 0;
+        while (true) {
+            uint8_t header[8];
+            if (!file.read((char *) header, 8)) {
+                fail("unexpected end of file");
+            }
+            uint32_t length = readBigEndian32(header);
+            if (length > (1u << 31)) {
+                fail("invalid chunk length");
+            }
+            std::string type((char *) header + 4, 4);
+            if (type == "IDAT") {
+                if (!has_header) {
+                    fail("missing IHDR chunk");
+                }
+                if (color_type == 3 && palette_size == 0) {
+                    fail("missing PLTE chunk");
+                }
+                source = std::make_unique<IdatSource>(file, length);
+                break;
+            }
+            if (type == "IEND") {
+                fail("missing IDAT chunk");
+            }
+            if (type != "IHDR" && type != "PLTE" && type != "tRNS") {
+                file.seekg(length + 4, std::ios::cur);
+                continue;
+            }
+
+            std::vector<uint8_t> data(length);
+            if (!file.read((char *) data.data(), length) || !file.seekg(4, std::ios::cur)) {
+                fail("unexpected end of file");
+            }
+            if (type == "IHDR") {
+                if (length != 13) {
+                    fail("invalid IHDR chunk");
+                }
+                ReadHeader(data.data());
+                has_header = true;
+            } else if (type == "PLTE") {
+                palette_size = length / 3;
+                if (palette_size > 256 || length % 3 != 0) {
+                    fail("invalid PLTE chunk");
+                }
+                for (uint32_t i = 0; i < palette_size; i++) {
+                    palette[i] = {uint16_t(data[3 * i] * 257), uint16_t(data[3 * i + 1] * 257),
+                                  uint16_t(data[3 * i + 2] * 257), 0xffff};
+                }
+            } else if (has_header) {
+                ReadTransparency(data);
+            }
         }
+
+        inflater = std::make_unique<Inflater>(*source);
+        stride = ((size_t) width * samples * bit_depth + 7) / 8;
+        pixel_bytes = std::max<size_t>(1, samples * bit_depth / 8);
+        current.resize(stride);
+        previous.resize(stride);
     }
 
-    return res;
+    void ReadHeader(const uint8_t *data) {
+        width = readBigEndian32(data);
+        height = readBigEndian32(data + 4);
+        bit_depth = data[8];
+        color_type = data[9];
+        if (width == 0 || height == 0 || data[10] != 0 || data[11] != 0) {
+            fail("invalid IHDR chunk");
+        }
+        if (data[12] != 0) {
+            fail("interlaced images can't be decoded by rows");
+        }
+        bool valid_depth;
+        switch (color_type) {
+            case 0:
+                samples = 1;
+                valid_depth = bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16;
+                break;
+            case 3:
+                samples = 1;
+                valid_depth = bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8;
+                break;
+            case 2:
+                samples = 3;
+                valid_depth = bit_depth == 8 || bit_depth == 16;
+                break;
+            case 4:
+                samples = 2;
+                valid_depth = bit_depth == 8 || bit_depth == 16;
+                break;
+            case 6:
+                samples = 4;
+                valid_depth = bit_depth == 8 || bit_depth == 16;
+                break;
+            default:
+                valid_depth = false;
+        }
+        if (!valid_depth) {
+            fail("unsupported color type or bit depth");
+        }
+        channels = color_type == 3 ? 3 : samples;
+    }
+
+    void ReadTransparency(const std::vector<uint8_t> &data) {
+        if (color_type == 3) {
+            for (size_t i = 0; i < std::min<size_t>(data.size(), 256); i++) {
+                palette[i][3] = uint16_t(data[i] * 257);
+            }
+            channels = 4;
+        } else if (color_type == 0 && data.size() >= 2) {
+            key[0] = uint16_t(data[0] << 8 | data[1]);
+            has_key = true;
+            channels = 2;
+        } else if (color_type == 2 && data.size() >= 6) {
+            for (int i = 0; i < 3; i++) {
+                key[i] = uint16_t(data[2 * i] << 8 | data[2 * i + 1]);
+            }
+            has_key = true;
+            channels = 4;
+        }
+    }
+
+    bool NextRow() {
+        if (row == height) {
+            return false;
+        }
+        uint8_t filter;
+        inflater->Read(&filter, 1);
+        std::swap(current, previous);
+        inflater->Read(current.data(), stride);
+        Unfilter(filter, row == 0);
+        row++;
+        return true;
+    }
+
+    void Unfilter(uint8_t filter, bool first_row) {
+        uint8_t *c = current.data();
+        const uint8_t *p = previous.data();
+        size_t b = pixel_bytes;
+        switch (filter) {
+            case 0:
+                break;
+            case 1:
+                for (size_t i = b; i < stride; i++) {
+                    c[i] += c[i - b];
+                }
+                break;
+            case 2:
+                if (!first_row) {
+                    for (size_t i = 0; i < stride; i++) {
+                        c[i] += p[i];
+                    }
+                }
+                break;
+            case 3:
+                for (size_t i = 0; i < stride; i++) {
+                    int left = i >= b ? c[i - b] : 0;
+                    int up = first_row ? 0 : p[i];
+                    c[i] += (uint8_t) ((left + up) >> 1);
+                }
+                break;
+            case 4:
+                for (size_t i = 0; i < stride; i++) {
+                    int left = i >= b ? c[i - b] : 0;
+                    int up = first_row ? 0 : p[i];
+                    int up_left = i >= b && !first_row ? p[i - b] : 0;
+                    int estimate = left + up - up_left;
+                    int distance_left = std::abs(estimate - left);
+                    int distance_up = std::abs(estimate - up);
+                    int distance_up_left = std::abs(estimate - up_left);
+                    if (distance_left <= distance_up && distance_left <= distance_up_left) {
+                        c[i] += (uint8_t) left;
+                    } else if (distance_up <= distance_up_left) {
+                        c[i] += (uint8_t) up;
+                    } else {
+                        c[i] += (uint8_t) up_left;
+                    }
+                }
+                break;
+            default:
+                fail("invalid filter type");
+        }
+    }
+
+    /**
+     * Sample @index of the current row, as stored in the file.
+     */
+    uint16_t GetSample(size_t index) const {
+        if (bit_depth == 16) {
+            return uint16_t(current[2 * index] << 8 | current[2 * index + 1]);
+        }
+        if (bit_depth == 8) {
+            return current[index];
+        }
+        size_t bit = index * bit_depth;
+        return uint16_t((current[bit / 8] >> (8 - bit_depth - bit % 8)) & ((1u << bit_depth) - 1));
+    }
+
+    std::array<uint16_t, 4> GetPixel(uint32_t x) const {
+        if (color_type == 3) {
+            return palette[GetSample(x)];
+        }
+        std::array<uint16_t, 4> raw{};
+        for (int i = 0; i < samples; i++) {
+            raw[i] = GetSample((size_t) x * samples + i);
+        }
+        auto scale = [this](uint16_t value) {
+            return bit_depth == 16 ? value : uint16_t(value * 65535u / ((1u << bit_depth) - 1));
+        };
+        uint16_t alpha = 0xffff;
+        if (has_key && raw[0] == key[0] && (color_type == 0 || (raw[1] == key[1] && raw[2] == key[2]))) {
+            alpha = 0;
+        }
+        switch (color_type) {
+            case 0:
+                return {scale(raw[0]), scale(raw[0]), scale(raw[0]), alpha};
+            case 2:
+                return {scale(raw[0]), scale(raw[1]), scale(raw[2]), alpha};
+            case 4:
+                return {scale(raw[0]), scale(raw[0]), scale(raw[0]), scale(raw[1])};
+            default:
+                return {scale(raw[0]), scale(raw[1]), scale(raw[2]), scale(raw[3])};
+        }
+    }
+
+    template<typename T>
+    bool ReadRow(T *pixels, uint8_t output_channels) {
+        if (output_channels < 1 || output_channels > 4) {
+            throw std::invalid_argument("PNG: channels must be from 1 to 4");
+        }
+        if (!NextRow()) {
+            return false;
+        }
+        // Rows that already have the requested layout are copied as they are
+        if (sizeof(T) == 1 && bit_depth == 8 && color_type != 3 && !has_key && output_channels == samples) {
+            std::memcpy(pixels, current.data(), stride);
+            return true;
+        }
+        if (sizeof(T) == 1 && bit_depth == 8 && color_type == 6 && output_channels == 3) {
+            for (uint32_t x = 0; x < width; x++) {
+                std::memcpy((uint8_t *) pixels + 3 * x, current.data() + 4 * x, 3);
+            }
+            return true;
+        }
+        if (sizeof(T) == 1 && bit_depth == 8 && color_type == 2 && !has_key && output_channels == 4) {
+            for (uint32_t x = 0; x < width; x++) {
+                std::memcpy((uint8_t *) pixels + 4 * x, current.data() + 3 * x, 3);
+                pixels[4 * x + 3] = 0xff;
+            }
+            return true;
+        }
+
+        // Gray and alpha pairs keep alpha in the second channel
+        int alpha_channel = output_channels == 2 ? 1 : 3;
+        for (uint32_t x = 0; x < width; x++) {
+            std::array<uint16_t, 4> pixel = GetPixel(x);
+            T *out = pixels + (size_t) x * output_channels;
+            for (int i = 0; i < output_channels; i++) {
+                uint16_t value = i == alpha_channel ? pixel[3] : pixel[i];
+                out[i] = sizeof(T) == 1 ? T(value >> 8) : T(value);
+            }
+        }
+        return true;
+    }
+};
+
+PngReader::PngReader(const std::string &filename) : m_decoder(std::make_unique<Decoder>(filename)) {}
+
+PngReader::~PngReader() = default;
+
+uint32_t PngReader::GetWidth() const {
+    return m_decoder->width;
 }
 
-Image<uint8_t, 3> lit::common::ReadPNG_RGB(const std::string &filename) {
-    Image<uint8_t, 4> image_rgba = ReadPNG_RGBA(filename);
-    auto width = image_rgba.GetWidth();
-    auto height = image_rgba.GetHeight();
-    Image<uint8_t, 3> res(width, height);
-    for(int i = 0; i < width; i++) {
-        for(int j = 0; j < height; j++) {
-            res.SetPixel(i, j, Image<uint8_t, 3>::pixel_t(image_rgba.GetPixel(i, j)));
+uint32_t PngReader::GetHeight() const {
+    return m_decoder->height;
+}
+
+uint8_t PngReader::GetChannels() const {
+    return m_decoder->channels;
+}
+
+bool PngReader::ReadRow(uint8_t *pixels, uint8_t channels) {
+    return m_decoder->ReadRow(pixels, channels);
+}
+
+bool PngReader::ReadRow(uint16_t *pixels, uint8_t channels) {
+    return m_decoder->ReadRow(pixels, channels);
+}
+
+namespace {
+
+    template<uint8_t C>
+    Image<uint8_t, C> readPNG(const std::string &filename) {
+        try {
+            PngReader reader(filename);
+            Image<uint8_t, C> image(reader.GetWidth(), reader.GetHeight());
+            for (uint32_t y = 0; y < image.GetHeight(); y++) {
+                reader.ReadRow(image.GetRowPointer(y), C);
+            }
+            return image;
+        } catch (const std::exception &) {
+            // Interlaced images, lodepng reports the errors of the other files
+        }
+
+        std::vector<unsigned char> data;
+        unsigned width, height;
+        unsigned error = lodepng::decode(data, width, height, filename, C == 4 ? LCT_RGBA : LCT_RGB);
+        if (error != 0) {
+            return {};
+        }
+        return Image<uint8_t, C>(width, height, std::move(data));
+    }
+
+    template<uint8_t C>
+    std::vector<Image<uint8_t, C>> readPNGs(const std::vector<std::string> &filenames) {
+        std::vector<Image<uint8_t, C>> images(filenames.size());
+        std::atomic<size_t> next = 0;
+        auto work = [&]() {
+            for (size_t i = next++; i < filenames.size(); i = next++) {
+                images[i] = readPNG<C>(filenames[i]);
+            }
+        };
+        size_t threads_count = std::min<size_t>(filenames.size(), std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < threads_count; i++) {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto &thread: threads) {
+            thread.join();
         }
+        return images;
     }
-    return res;
-}
\ No newline at end of file
+
+}
+
+Image<uint8_t, 4> lit::common::ReadPNG_RGBA(const std::string &filename) {
+    return readPNG<4>(filename);
+}
+
+Image<uint8_t, 3> lit::common::ReadPNG_RGB(const std::string &filename) {
+    return readPNG<3>(filename);
+}
+
+std::vector<Image<uint8_t, 4>> lit::common::ReadPNGs_RGBA(const std::vector<std::string> &filenames) {
+    return readPNGs<4>(filenames);
+}
+
+std::vector<Image<uint8_t, 3>> lit::common::ReadPNGs_RGB(const std::vector<std::string> &filenames) {
+    return readPNGs<3>(filenames);
+}
+
+bool lit::common::WritePNG_RGB(const std::string &filename, const Image<uint8_t, 3> &image) {
+    unsigned error = lodepng::encode(filename, image.GetDataPointer(), image.GetWidth(), image.GetHeight(), LCT_RGB);
+    return error == 0;
+}
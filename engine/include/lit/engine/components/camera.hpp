@@ -11,8 +11,25 @@ namespace lit::engine {
     public:
         using OpenglFrameBuffer = lit::rendering::opengl::FrameBuffer;
 
+        /// <summary>
+        /// Projection of the camera, everything it has except the frame buffer.
+        /// </summary>
+        struct Settings {
+            double z_near = 0.01f;
+            double z_far = 100.0f;
+            double field_of_view = 90.0f;
+        };
+
         explicit CameraComponent(glm::uvec2 viewport);
 
+        /// <summary>
+        /// Camera without a frame buffer, it is created by the first <see cref="SetViewport"/> (Scene::OnRedraw calls
+        /// it every frame), so cameras can be created before there is a GL context, e.g. from a scene snapshot.
+        /// </summary>
+        explicit CameraComponent(const Settings &settings);
+
+        Settings GetSettings() const;
+
         const OpenglFrameBuffer &GetFrameBuffer() const;
 
         glm::dmat4 GetProjectionMatrix() const;
@@ -24,9 +41,9 @@ namespace lit::engine {
     private:
         OpenglFrameBuffer m_frame_buffer;
 
-        double m_z_near = 0.01f;
-        double m_z_far = 100.0f;
-        double m_field_of_view = 90.0f;
+        double m_z_near = Settings().z_near;
+        double m_z_far = Settings().z_far;
+        double m_field_of_view = Settings().field_of_view;
     };
 
 }
@@ -51,6 +51,15 @@ namespace lit::engine {
          */
         virtual VoxelType GetVoxel(const glm::ivec3 &pos) const = 0;
 
+        /**
+         * Set @height voxels from @pos upwards (along y) to @value
+         */
+        virtual void FillColumn(const glm::ivec3 &pos, int height, VoxelType value) {
+            for (int y = pos.y; y < pos.y + height; y++) {
+                SetVoxel({pos.x, y, pos.z}, value);
+            }
+        }
+
         /**
          * Get grid dimensions
          */
@@ -90,6 +99,15 @@ namespace lit::engine {
 
     protected:
 
+        bool HasVoxelChangedCallbacks() const {
+            for (auto &callback: m_voxel_changed_callbacks) {
+                if (callback) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         // TODO: delete?
         void InvokeOnVoxelChangedCallbacks(const glm::ivec3 &pos, VoxelType value) {
             for (auto &callback: m_voxel_changed_callbacks) {
@@ -6,10 +6,14 @@
 #include <lit/engine/components/voxel_grid/voxel_grid_base.hpp>
 #include <glm/vec3.hpp>
 #include <variant>
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 #include <functional>
 #include <memory>
 #include <array>
+#include <bit>
+#include <cstring>
 #include <deque>
 
 #define PARALLEL_GENERATION
@@ -73,6 +77,11 @@ namespace lit::engine {
 
         ~VoxelGridSparseT() override = default;
 
+        // Chunks are owned by the grid, so it can be moved but not copied
+        VoxelGridSparseT(VoxelGridSparseT&&) = default;
+
+        VoxelGridSparseT& operator=(VoxelGridSparseT&&) = default;
+
         void SetVoxel(const glm::ivec3& position, VoxelType value) override {
             glm::ivec3 chunk_grid_position = position >> CHUNK_SIZE_LOG;
             if (!IsValidChunk(chunk_grid_position)) {
@@ -90,7 +99,7 @@ namespace lit::engine {
                 chunk_index = CreateChunk(chunk_grid_position);
             }
 
-            auto& chunk = m_chunks[chunk_index];
+            auto& chunk = GetChunk(chunk_index);
             glm::ivec3 relative_position = position & (CHUNK_SIZE - 1);
 
             if (chunk[relative_position.x][relative_position.y][relative_position.z] == value) {
@@ -98,7 +107,9 @@ namespace lit::engine {
                 return;
             }
 
-            chunk[relative_position.x][relative_position.y][relative_position.z] = value;
+            // Shared voxels are copied before the change, so the chunk is looked up again
+            BeforeChunkChange(chunk_grid_position);
+            GetChunk(chunk_index)[relative_position.x][relative_position.y][relative_position.z] = value;
             VoxelGridBaseT<VoxelType>::InvokeOnVoxelChangedCallbacks(position, value);
             InvokeOnChunkAnyChangeCallbacks(ChunkChangedArgs{
                 chunk_index,
@@ -119,11 +130,84 @@ namespace lit::engine {
                 return 0;
             }
 
-            auto& chunk = m_chunks[chunk_index];
+            auto& chunk = GetChunk(chunk_index);
             glm::ivec3 relative_position = position & (CHUNK_SIZE - 1);
             return chunk[relative_position.x][relative_position.y][relative_position.z];
         };
 
+        /// <summary>
+        /// Sets a vertical run of voxels, which may cross chunk boundaries. Chunk is looked up once per crossed chunk,
+        /// voxels are written without per-voxel checks, and every changed chunk is reported by a single ChunkChangedArgs
+        /// with its lowest changed voxel. Per-voxel callbacks are invoked only if there are any.
+        /// </summary>
+        void FillColumn(const glm::ivec3& position, int height, VoxelType value) override {
+            auto dimensions = VoxelGridBaseT<VoxelType>::GetDimensions();
+            if (position.x < 0 || position.z < 0 || position.x >= dimensions.x || position.z >= dimensions.z) {
+                return;
+            }
+
+            bool voxel_callbacks = VoxelGridBaseT<VoxelType>::HasVoxelChangedCallbacks();
+            int y_end = std::min(position.y + height, dimensions.y);
+            for (int y = std::max(position.y, 0); y < y_end;) {
+                glm::ivec3 chunk_grid_position = glm::ivec3(position.x, y, position.z) >> CHUNK_SIZE_LOG;
+                int chunk_end = std::min(y_end, (chunk_grid_position.y + 1) << CHUNK_SIZE_LOG);
+                glm::ivec3 relative_position = glm::ivec3(position.x, y, position.z) & (CHUNK_SIZE - 1);
+                int count = chunk_end - y;
+                y = chunk_end;
+
+                ChunkIndexType chunk_index = m_chunk_grid.At(chunk_grid_position);
+                if (chunk_index == CHUNK_EMPTY && value == 0) {
+                    continue;
+                }
+                if (chunk_index == CHUNK_EMPTY) {
+                    chunk_index = CreateChunk(chunk_grid_position);
+                }
+
+                auto& chunk = GetChunk(chunk_index);
+                int first = relative_position.y;
+                while (first < relative_position.y + count && chunk[relative_position.x][first][relative_position.z] == value) {
+                    first++;
+                }
+                if (first == relative_position.y + count) {
+                    // Value was already there, nothing changed.
+                    continue;
+                }
+
+                BeforeChunkChange(chunk_grid_position);
+                auto& target = GetChunk(chunk_index);
+                glm::ivec3 first_position = (chunk_grid_position << CHUNK_SIZE_LOG) + glm::ivec3(relative_position.x, first, relative_position.z);
+                if (voxel_callbacks) {
+                    for (int j = first; j < relative_position.y + count; j++) {
+                        if (target[relative_position.x][j][relative_position.z] != value) {
+                            target[relative_position.x][j][relative_position.z] = value;
+                            VoxelGridBaseT<VoxelType>::InvokeOnVoxelChangedCallbacks(first_position + glm::ivec3(0, j - first, 0), value);
+                        }
+                    }
+                } else {
+                    FillChunkColumn(target, glm::ivec3(relative_position.x, first, relative_position.z), relative_position.y + count - first, value);
+                }
+
+                InvokeOnChunkAnyChangeCallbacks(ChunkChangedArgs{
+                    chunk_index,
+                    chunk_grid_position,
+                    first_position,
+                    glm::ivec3(relative_position.x, first, relative_position.z),
+                    value });
+            }
+        }
+
+        /// <summary>
+        /// Sets @height voxels of @chunk from @relative_position upwards, the run must stay inside of the chunk.
+        /// Writes directly to the chunk data, so no callbacks are invoked.
+        /// </summary>
+        static void FillChunkColumn(ChunkData& chunk, const glm::ivec3& relative_position, int height, VoxelType value) {
+            // Voxels of a column are CHUNK_SIZE apart
+            VoxelType* voxel = &chunk[relative_position.x][relative_position.y][relative_position.z];
+            for (int j = 0; j < height; j++) {
+                voxel[j * CHUNK_SIZE] = value;
+            }
+        }
+
         struct ChunkCreatedArgs {
             ChunkIndexType index;
             glm::ivec3 chunk_grid_position;
@@ -160,19 +244,36 @@ namespace lit::engine {
             OnChunkAnyChangeCallback().swap(m_chunk_callbacks[index]);
         }
 
+        /// <summary>
+        /// Called with the position of a chunk right before its voxels are changed, it is created or deleted, so the
+        /// previous state can still be read (e.g. by an edit history). May be called several times for the same change.
+        /// Writes through <see cref="GetChunkData"/> and <see cref="ShiftChunks"/> are not reported.
+        /// </summary>
+        using OnChunkBeforeChangeCallback = std::function<void(const glm::ivec3& chunk_grid_position)>;
+
+        size_t AddOnChunkBeforeChangeCallback(OnChunkBeforeChangeCallback callback) {
+            m_chunk_before_change_callbacks.emplace_back(std::move(callback));
+            return m_chunk_before_change_callbacks.size() - 1;
+        }
+
+        void RemoveOnChunkBeforeChangeCallback(size_t index) {
+            OnChunkBeforeChangeCallback().swap(m_chunk_before_change_callbacks[index]);
+        }
+
         class ChunkView {
         public:
             void SetVoxel(const glm::ivec3& relative_position, VoxelType value) {
-                auto& chunk = m_owner.m_chunks[m_index];
+                auto& chunk = m_owner.GetChunk(m_index);
 
                 if (chunk[relative_position.x][relative_position.y][relative_position.z] == value) {
                     // Value was already there, nothin changed.
                     return;
                 }
 
-                chunk[relative_position.x][relative_position.y][relative_position.z] = value;
-
                 glm::ivec3 chunk_grid_position = GetChunkGridPosition();
+                m_owner.BeforeChunkChange(chunk_grid_position);
+                m_owner.GetChunk(m_index)[relative_position.x][relative_position.y][relative_position.z] = value;
+
                 glm::ivec3 position = (chunk_grid_position << CHUNK_SIZE_LOG) + relative_position;
                 m_owner.InvokeOnVoxelChangedCallbacks(position, value);
                 m_owner.InvokeOnChunkAnyChangeCallbacks(ChunkChangedArgs{
@@ -184,7 +285,7 @@ namespace lit::engine {
             }
 
             VoxelType GetVoxel(const glm::ivec3& relative_position) const {
-                return m_owner.m_chunks[m_index][relative_position.x][relative_position.y][relative_position.z];
+                return m_owner.GetChunk(m_index)[relative_position.x][relative_position.y][relative_position.z];
             }
 
             glm::ivec3 GetChunkGridPosition() const {
@@ -221,9 +322,15 @@ namespace lit::engine {
             return VoxelGridBaseT<VoxelType>::GetSizeBytes() - sizeof(VoxelGridBaseT<VoxelType>) +
                 sizeof(VoxelGridSparseT<VoxelType>) +
                 m_chunk_callbacks.capacity() * sizeof(OnChunkAnyChangeCallback) +
+                m_chunk_before_change_callbacks.capacity() * sizeof(OnChunkBeforeChangeCallback) +
                 m_chunk_index_allocator.GetSizeBytes() - sizeof(ContiguousAllocator) +
-                m_chunks.size() * sizeof(ChunkData) +
+                GetStoredChunksNum() * sizeof(ChunkData) +
+                m_chunks.size() * sizeof(std::shared_ptr<ChunkData>) +
+                m_paged_chunks.capacity() * sizeof(PagedChunk) +
+                m_chunk_loaders.capacity() * sizeof(ChunkLoader) +
                 m_positions.capacity() * sizeof(glm::ivec3) +
+                m_chunk_hashes.capacity() * sizeof(uint64_t) +
+                m_dedup_table.size() * (sizeof(uint64_t) + sizeof(std::weak_ptr<ChunkData>) + 2 * sizeof(void*)) +
                 m_chunk_grid_data.capacity() * sizeof(ChunkIndexType);
         }
 
@@ -232,13 +339,337 @@ namespace lit::engine {
         }
 
         const Array3DView<VoxelType> GetChunkViewAsArray(ChunkIndexType index) const {
-            return Array3DView<VoxelType>(GetChunkDimensions(), (VoxelType*)(m_chunks[index].data()), (VoxelType*)(m_chunks[index].data() + m_chunks[index].size()));
+            auto& chunk = GetChunk(index);
+            return Array3DView<VoxelType>(GetChunkDimensions(), (VoxelType*)(chunk.data()), (VoxelType*)(chunk.data() + chunk.size()));
         }
 
         size_t GetChunksNum() {
             return m_chunks.size();
         }
 
+        /// <summary>
+        /// Number of chunks whose voxels are in memory, paged chunks that were never accessed are not counted.
+        /// </summary>
+        size_t GetLoadedChunksNum() const {
+            return std::count_if(m_chunks.begin(), m_chunks.end(), [](const auto& chunk) { return chunk != nullptr; });
+        }
+
+        /// <summary>
+        /// Number of voxel arrays in memory, chunks that share voxels (see <see cref="SetDeduplication"/>) are counted once.
+        /// </summary>
+        size_t GetStoredChunksNum() const {
+            std::unordered_set<const ChunkData*> shared;
+            size_t unique = 0;
+            for (auto& chunk : m_chunks) {
+                if (chunk.use_count() == 1) {
+                    unique++;
+                } else if (chunk) {
+                    shared.insert(chunk.get());
+                }
+            }
+            return unique + shared.size();
+        }
+
+        /// <summary>
+        /// Direct access to the voxels of a chunk. Writes through it do not invoke any callbacks.
+        /// With deduplication they are only allowed in CreateChunks and UpdateChunks, otherwise they would change
+        /// all chunks that share the voxels.
+        /// </summary>
+        ChunkData& GetChunkData(ChunkIndexType index) {
+            return GetChunk(index);
+        }
+
+        /// <summary>
+        /// Voxels of the chunk, the same for chunks that share them, so consumers (e.g. GPU data) can keep a single
+        /// copy of them. Paged chunks are loaded.
+        /// </summary>
+        const ChunkData* GetChunkStorage(ChunkIndexType index) const {
+            return &GetChunk(index);
+        }
+
+        /// <summary>
+        /// Deduplication mode: identical chunks share their voxels and a shared chunk gets its own copy right before
+        /// it is changed (copy on write). Chunks written by CreateChunks, InsertChunks and UpdateChunks are merged with
+        /// identical chunks before listeners are notified, chunks created by single voxel edits are merged only by
+        /// <see cref="DeduplicateChunks"/>, which is also called when the mode is enabled.
+        /// </summary>
+        void SetDeduplication(bool enabled) {
+            m_deduplication = enabled;
+            if (enabled) {
+                DeduplicateChunks();
+            } else {
+                m_dedup_table.clear();
+            }
+        }
+
+        bool IsDeduplicationEnabled() const {
+            return m_deduplication;
+        }
+
+        /// <summary>
+        /// Makes every loaded chunk share the voxels of an identical chunk, paged chunks that were not accessed are skipped.
+        /// Chunks are found by <see cref="GetChunkHash"/> and compared voxel by voxel. Merged chunks are reported by
+        /// ChunkChangedArgs (their voxels stay the same), so listeners can share their data too.
+        /// Returns the number of merged chunks.
+        /// </summary>
+        size_t DeduplicateChunks() {
+            std::vector<ChunkIndexType> merged;
+            auto grid_dims = GetChunkGridDimensions();
+            for (int i = 0; i < grid_dims.x; i++) {
+                for (int j = 0; j < grid_dims.y; j++) {
+                    for (int k = 0; k < grid_dims.z; k++) {
+                        ChunkIndexType index = m_chunk_grid.At(i, j, k);
+                        if (index != CHUNK_EMPTY && IsChunkLoaded(index) && ShareChunk(index)) {
+                            merged.push_back(index);
+                        }
+                    }
+                }
+            }
+            if (!m_deduplication) {
+                m_dedup_table.clear();
+            }
+
+            for (auto index : merged) {
+                InvokeOnChunkAnyChangeCallbacks(ChunkChangedArgs{
+                    index,
+                    m_positions[index],
+                    m_positions[index] << CHUNK_SIZE_LOG,
+                    glm::ivec3(0),
+                    GetChunk(index)[0][0][0] });
+            }
+            return merged.size();
+        }
+
+        /// <summary>
+        /// Fills a paged chunk: @key is the value given to <see cref="AddPagedChunks"/>.
+        /// </summary>
+        using ChunkLoader = std::function<void(uint64_t key, ChunkData& data)>;
+
+        /// <summary>
+        /// Adds chunks at @chunk_grid_positions whose voxels are not in memory yet: @loader(@keys[i], data) fills a chunk
+        /// on its first access (any read or write, including <see cref="GetChunkData"/>), so chunks that are never touched
+        /// take no memory. Positions must be valid, unique and not occupied by other chunks.
+        /// Chunk created callbacks are invoked as for other chunks (and consumers that read voxels page the chunks in).
+        /// Paging in is not synchronized, a chunk must not be accessed for the first time from several threads at once.
+        /// </summary>
+        std::vector<ChunkIndexType> AddPagedChunks(const std::vector<glm::ivec3>& chunk_grid_positions,
+                                                   const std::vector<uint64_t>& keys, ChunkLoader loader) {
+            for (auto& chunk_grid_position : chunk_grid_positions) {
+                BeforeChunkChange(chunk_grid_position);
+            }
+            auto loader_index = (uint32_t) m_chunk_loaders.size();
+            m_chunk_loaders.push_back(std::move(loader));
+
+            std::vector<ChunkIndexType> indices;
+            indices.reserve(chunk_grid_positions.size());
+            for (size_t i = 0; i < chunk_grid_positions.size(); i++) {
+                ChunkIndexType index = m_chunk_index_allocator.Allocate();
+                if (index >= m_chunks.size()) {
+                    m_chunks.emplace_back();
+                    m_positions.emplace_back(chunk_grid_positions[i]);
+                } else {
+                    m_chunks[index].reset();
+                    m_positions[index] = chunk_grid_positions[i];
+                }
+                if (m_paged_chunks.size() < m_chunks.size()) {
+                    m_paged_chunks.resize(m_chunks.size());
+                }
+                m_paged_chunks[index] = PagedChunk{loader_index, keys[i]};
+                ResetChunkHash(index);
+                m_chunk_grid.At(chunk_grid_positions[i]) = index;
+                indices.push_back(index);
+            }
+
+            for (size_t i = 0; i < indices.size(); i++) {
+                InvokeOnChunkAnyChangeCallbacks(ChunkCreatedArgs{ indices[i], chunk_grid_positions[i] });
+            }
+            return indices;
+        }
+
+        /// <summary>
+        /// False for paged chunks that were not accessed yet.
+        /// </summary>
+        bool IsChunkLoaded(ChunkIndexType index) const {
+            return m_chunks[index] != nullptr;
+        }
+
+        /// <summary>
+        /// 64-bit content hash of the chunk voxels (never zero), equal chunks have equal hashes.
+        /// It is kept until the chunk is changed through the grid and computed again on the next call, writes through
+        /// <see cref="GetChunkData"/> outside of CreateChunks and UpdateChunks are not noticed.
+        /// Different chunks may be hashed in parallel, paged chunks are loaded.
+        /// </summary>
+        uint64_t GetChunkHash(ChunkIndexType index) const {
+            uint64_t& hash = m_chunk_hashes[index];
+            if (hash == 0) {
+                hash = std::max<uint64_t>(HashChunk(GetChunk(index)), 1);
+            }
+            return hash;
+        }
+
+        /// <summary>
+        /// Hash of 4 interleaved lanes of 64-bit words, fast enough to hash chunks at memory bandwidth.
+        /// </summary>
+        static uint64_t HashChunk(const ChunkData& chunk) {
+            const uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+            const uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+            static_assert(sizeof(ChunkData) % (4 * sizeof(uint64_t)) == 0);
+
+            auto bytes = reinterpret_cast<const uint8_t*>(&chunk);
+            uint64_t lanes[4] = { PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1 };
+            for (size_t offset = 0; offset < sizeof(ChunkData); offset += 4 * sizeof(uint64_t)) {
+                for (int i = 0; i < 4; i++) {
+                    uint64_t word;
+                    std::memcpy(&word, bytes + offset + i * sizeof(uint64_t), sizeof(word));
+                    lanes[i] = std::rotl(lanes[i] + word * PRIME_2, 31) * PRIME_1;
+                }
+            }
+            uint64_t hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+            hash ^= hash >> 33;
+            hash *= PRIME_2;
+            hash ^= hash >> 29;
+            hash *= PRIME_1;
+            return hash ^ (hash >> 32);
+        }
+
+        /// <summary>
+        /// Creates chunks at @chunk_grid_positions in one batch, much faster than filling them with SetVoxel.
+        /// Positions must be valid, unique and not occupied by other chunks.
+        /// @fill is called once with the indices of the new zeroed chunks (in the order of positions) and should write
+        /// their voxels with <see cref="GetChunkData"/>, chunks are independent, so it is safe to fill them in parallel.
+        /// Chunk created callbacks are invoked after @fill, per-voxel callbacks are not invoked.
+        /// </summary>
+        template<typename Fill>
+        std::vector<ChunkIndexType> CreateChunks(const std::vector<glm::ivec3>& chunk_grid_positions, Fill&& fill) {
+            std::vector<ChunkIndexType> indices;
+            indices.reserve(chunk_grid_positions.size());
+            for (auto& chunk_grid_position : chunk_grid_positions) {
+                BeforeChunkChange(chunk_grid_position);
+                ChunkIndexType index = m_chunk_index_allocator.Allocate();
+                InitChunk(index, chunk_grid_position);
+                m_chunk_grid.At(chunk_grid_position) = index;
+                indices.push_back(index);
+            }
+
+            fill(indices);
+            ShareChunks(indices);
+
+            for (size_t i = 0; i < indices.size(); i++) {
+                InvokeOnChunkAnyChangeCallbacks(ChunkCreatedArgs{ indices[i], chunk_grid_positions[i] });
+            }
+            return indices;
+        }
+
+        /// <summary>
+        /// Creates chunks at @chunk_grid_positions that take the voxels of @chunks_data without copying them,
+        /// e.g. chunks decoded on other threads. Positions must be valid, unique and not occupied by other chunks.
+        /// Chunk created callbacks are invoked as in <see cref="CreateChunks"/>.
+        /// </summary>
+        std::vector<ChunkIndexType> InsertChunks(const std::vector<glm::ivec3>& chunk_grid_positions,
+                                                 std::vector<std::unique_ptr<ChunkData>>&& chunks_data) {
+            std::vector<ChunkIndexType> indices;
+            indices.reserve(chunk_grid_positions.size());
+            for (size_t i = 0; i < chunk_grid_positions.size(); i++) {
+                BeforeChunkChange(chunk_grid_positions[i]);
+                ChunkIndexType index = m_chunk_index_allocator.Allocate();
+                if (index >= m_chunks.size()) {
+                    m_chunks.emplace_back(std::move(chunks_data[i]));
+                    m_positions.emplace_back(chunk_grid_positions[i]);
+                } else {
+                    m_chunks[index] = std::move(chunks_data[i]);
+                    m_positions[index] = chunk_grid_positions[i];
+                }
+                ResetChunkHash(index);
+                m_chunk_grid.At(chunk_grid_positions[i]) = index;
+                indices.push_back(index);
+            }
+            ShareChunks(indices);
+
+            for (size_t i = 0; i < indices.size(); i++) {
+                InvokeOnChunkAnyChangeCallbacks(ChunkCreatedArgs{ indices[i], chunk_grid_positions[i] });
+            }
+            return indices;
+        }
+
+        /// <summary>
+        /// Changes the chunks at @chunk_grid_positions in one batch, positions must hold chunks.
+        /// @update is called once with their indices (in the order of positions) and should write their voxels with
+        /// <see cref="GetChunkData"/>, it is safe to write them in parallel. Every chunk is then reported by a single
+        /// ChunkChangedArgs with its corner as the changed voxel, per-voxel callbacks are not invoked.
+        /// </summary>
+        template<typename Update>
+        std::vector<ChunkIndexType> UpdateChunks(const std::vector<glm::ivec3>& chunk_grid_positions, Update&& update) {
+            std::vector<ChunkIndexType> indices;
+            indices.reserve(chunk_grid_positions.size());
+            for (auto& chunk_grid_position : chunk_grid_positions) {
+                BeforeChunkChange(chunk_grid_position);
+                indices.push_back(m_chunk_grid.At(chunk_grid_position));
+            }
+
+            update(indices);
+            ShareChunks(indices);
+
+            for (size_t i = 0; i < indices.size(); i++) {
+                InvokeOnChunkAnyChangeCallbacks(ChunkChangedArgs{
+                    indices[i],
+                    chunk_grid_positions[i],
+                    chunk_grid_positions[i] << CHUNK_SIZE_LOG,
+                    glm::ivec3(0),
+                    GetChunk(indices[i])[0][0][0] });
+            }
+            return indices;
+        }
+
+        /// <summary>
+        /// Removes the chunk at @chunk_grid_position (if there is one) and releases its voxels,
+        /// its index may be reused by new chunks.
+        /// </summary>
+        void DeleteChunk(const glm::ivec3& chunk_grid_position) {
+            if (!IsValidChunk(chunk_grid_position)) {
+                return;
+            }
+            ChunkIndexType index = m_chunk_grid.At(chunk_grid_position);
+            if (index == CHUNK_EMPTY) {
+                return;
+            }
+            BeforeChunkChange(chunk_grid_position);
+            m_chunk_grid.At(chunk_grid_position) = CHUNK_EMPTY;
+            FreeChunk(index);
+            InvokeOnChunkAnyChangeCallbacks(ChunkDeletedArgs{ index, chunk_grid_position });
+        }
+
+        /// <summary>
+        /// Moves every chunk by @delta positions of the chunk grid, chunks that leave the grid are deleted.
+        /// Chunks keep their indices, every moved chunk is reported as deleted from the old position and created at the new one.
+        /// </summary>
+        void ShiftChunks(const glm::ivec3& delta) {
+            std::vector<std::pair<ChunkIndexType, glm::ivec3>> chunks;
+            auto grid_dims = GetChunkGridDimensions();
+            for (int i = 0; i < grid_dims.x; i++) {
+                for (int j = 0; j < grid_dims.y; j++) {
+                    for (int k = 0; k < grid_dims.z; k++) {
+                        if (m_chunk_grid.At(i, j, k) != CHUNK_EMPTY) {
+                            chunks.emplace_back(m_chunk_grid.At(i, j, k), glm::ivec3(i, j, k));
+                        }
+                    }
+                }
+            }
+
+            m_chunk_grid.Fill(CHUNK_EMPTY);
+            for (auto& [index, position] : chunks) {
+                InvokeOnChunkAnyChangeCallbacks(ChunkDeletedArgs{ index, position });
+
+                glm::ivec3 new_position = position + delta;
+                if (IsValidChunk(new_position)) {
+                    m_chunk_grid.At(new_position) = index;
+                    m_positions[index] = new_position;
+                    InvokeOnChunkAnyChangeCallbacks(ChunkCreatedArgs{ index, new_position });
+                } else {
+                    FreeChunk(index);
+                }
+            }
+        }
+
     private:
 
         bool IsEmptyChunk(glm::ivec3 chunk_grid_position) const {
@@ -258,24 +689,119 @@ namespace lit::engine {
             }
         }
 
-        // Important: There is no check if chunk was already created!
-        ChunkIndexType CreateChunk(const glm::ivec3& chunk_grid_position) {
-            ChunkIndexType index = m_chunk_index_allocator.Allocate();
+        // Drops the content hash of the chunk, copies its voxels if they are shared
+        // and notifies listeners that want the previous voxels
+        void BeforeChunkChange(const glm::ivec3& chunk_grid_position) {
+            ChunkIndexType index = m_chunk_grid.At(chunk_grid_position);
+            if (index != CHUNK_EMPTY) {
+                m_chunk_hashes[index] = 0;
+                auto& chunk = m_chunks[index];
+                if (chunk.use_count() > 1) {
+                    chunk = std::shared_ptr<ChunkData>(new ChunkData(*chunk));
+                }
+            }
+            for (auto& callback : m_chunk_before_change_callbacks) {
+                if (callback) {
+                    callback(chunk_grid_position);
+                }
+            }
+        }
+
+        // Zeroed chunk at the index, which is new or reused after a deleted chunk
+        void InitChunk(ChunkIndexType index, const glm::ivec3& chunk_grid_position) {
+            ResetChunkHash(index);
             if (index >= m_chunks.size()) {
-                m_chunks.emplace_back();
+                m_chunks.emplace_back(new ChunkData());
                 m_positions.emplace_back(chunk_grid_position);
+                return;
             }
+            m_chunks[index] = std::shared_ptr<ChunkData>(new ChunkData());
+            m_positions[index] = chunk_grid_position;
+        }
+
+        // Releases the voxels of a deleted chunk (or its reference to shared voxels) together with its index
+        void FreeChunk(ChunkIndexType index) {
+            m_chunks[index].reset();
+            m_chunk_index_allocator.Free(index);
+        }
+
+        void ResetChunkHash(ChunkIndexType index) {
+            if (index >= m_chunk_hashes.size()) {
+                m_chunk_hashes.resize(index + 1);
+            }
+            m_chunk_hashes[index] = 0;
+        }
+
+        // In the deduplication mode chunks take the voxels of identical chunks before listeners are notified
+        void ShareChunks(const std::vector<ChunkIndexType>& indices) {
+            if (m_deduplication) {
+                for (auto index : indices) {
+                    ShareChunk(index);
+                }
+            }
+        }
+
+        // Points the chunk to the voxels remembered for its hash if they are identical, otherwise remembers its own
+        // voxels for the hash. Returns true if the chunk was merged.
+        bool ShareChunk(ChunkIndexType index) {
+            auto& entry = m_dedup_table[GetChunkHash(index)];
+            std::shared_ptr<ChunkData> voxels = entry.lock();
+            if (voxels == m_chunks[index]) {
+                return false;
+            }
+            // The remembered voxels may have been freed or changed by their only chunk since
+            if (!voxels || std::memcmp(voxels.get(), m_chunks[index].get(), sizeof(ChunkData)) != 0) {
+                entry = m_chunks[index];
+                return false;
+            }
+            m_chunks[index] = std::move(voxels);
+            return true;
+        }
+
+        ChunkData& GetChunk(ChunkIndexType index) const {
+            auto& chunk = m_chunks[index];
+            if (!chunk) {
+                // Paged chunk, loaded on the first access
+                chunk = std::shared_ptr<ChunkData>(new ChunkData);
+                const PagedChunk& paged = m_paged_chunks[index];
+                m_chunk_loaders[paged.loader](paged.key, *chunk);
+            }
+            return *chunk;
+        }
+
+        // Important: There is no check if chunk was already created!
+        ChunkIndexType CreateChunk(const glm::ivec3& chunk_grid_position) {
+            BeforeChunkChange(chunk_grid_position);
+            ChunkIndexType index = m_chunk_index_allocator.Allocate();
+            InitChunk(index, chunk_grid_position);
             m_chunk_grid.At(chunk_grid_position) = index;
             InvokeOnChunkAnyChangeCallbacks(ChunkCreatedArgs{ index, chunk_grid_position });
             return index;
         }
 
         std::vector<OnChunkAnyChangeCallback> m_chunk_callbacks;
+        std::vector<OnChunkBeforeChangeCallback> m_chunk_before_change_callbacks;
 
         ContiguousAllocator m_chunk_index_allocator = ContiguousAllocator(0);
 
-        std::deque<ChunkData> m_chunks;
+        struct PagedChunk {
+            uint32_t loader;
+            uint64_t key;
+        };
+
+        // Chunks are allocated one by one, paged chunks are null until the first access,
+        // identical chunks may share voxels in the deduplication mode.
+        // Voxels are allocated apart from their reference counts (no make_shared), so weak references in the
+        // dedup table do not keep freed voxels in memory.
+        mutable std::deque<std::shared_ptr<ChunkData>> m_chunks;
+        std::vector<PagedChunk> m_paged_chunks;
+        std::vector<ChunkLoader> m_chunk_loaders;
         std::vector<glm::ivec3> m_positions;
+        // Content hashes by chunk index, zero until computed
+        mutable std::vector<uint64_t> m_chunk_hashes;
+        bool m_deduplication = false;
+        // Voxels to share for every content hash, they are compared with the chunk before sharing
+        std::unordered_map<uint64_t, std::weak_ptr<ChunkData>> m_dedup_table;
         std::vector<ChunkIndexType> m_chunk_grid_data;
         Array3DView<ChunkIndexType> m_chunk_grid;
     };
@@ -31,6 +31,11 @@ namespace lit::engine {
             m_total_lod = m_max_grid_lod + VoxelGrid::CHUNK_SIZE_LOG;
             m_chunk_grid_dimensions = chunk_grid_dimensions;
             m_grid_lod_data.assign(GetLodTotalSize(chunk_grid_dimensions, 0, m_max_grid_lod), VoxelGrid::CHUNK_EMPTY);
+            if (m_distance_field_enabled) {
+                m_grid_distance_data.assign(glm::compMul(chunk_grid_dimensions), DISTANCE_FIELD_MAX);
+                m_grid_distance_counts.assign(DISTANCE_FIELD_MAX + 1, 0);
+                m_grid_distance_counts[DISTANCE_FIELD_MAX] = m_grid_distance_data.size();
+            }
         }
 
         Array3DView<ChunkIndexType> GetChunkGridViewAtLod(int lod) {
@@ -49,9 +54,43 @@ namespace lit::engine {
             return Array3DViewBool<uint32_t>(VoxelGrid::GetChunkDimensions() >> lod, m_chunk_binary_lod_data.data(), m_chunk_binary_lod_data.data() + m_chunk_binary_lod_data.size(), offset);
         }
 
+        /// <summary>
+        /// Chebyshev distance (in chunks) from every chunk of the chunk grid to the nearest non-empty chunk.
+        /// </summary>
+        Array3DView<uint8_t> GetGridDistanceView() {
+            return Array3DView(m_chunk_grid_dimensions, m_grid_distance_data.data(), m_grid_distance_data.data() + m_grid_distance_data.size());
+        }
+
+        /// <summary>
+        /// Chebyshev distance (in cells of LOD <see cref="DISTANCE_FIELD_LOD"/>) from every cell of the chunk
+        /// to the nearest non-empty cell of the same chunk.
+        /// </summary>
+        Array3DView<uint8_t> GetChunkDistanceView(ChunkIndexType index) {
+            size_t offset = index * GetChunkDistanceSize();
+            return Array3DView(VoxelGrid::GetChunkDimensions() >> DISTANCE_FIELD_LOD, m_chunk_distance_data.data() + offset, m_chunk_distance_data.data() + m_chunk_distance_data.size());
+        }
+
+        static constexpr size_t GetChunkDistanceSize() {
+            return (size_t) 1 << (3 * (VoxelGrid::CHUNK_SIZE_LOG - DISTANCE_FIELD_LOD));
+        }
+
+        /// <summary>
+        /// Chunk distance field is stored for LOD 1 cells, so it is 8 times smaller than the chunk
+        /// and is still exact for the chunks that are rendered with full or half resolution.
+        /// </summary>
+        inline static const int DISTANCE_FIELD_LOD = 1;
+
+        inline static const int DISTANCE_FIELD_MAX = 255;
+
         std::vector<ChunkIndexType> m_grid_lod_data;
         std::vector<VoxelType> m_chunk_lod_data;
         std::vector<uint32_t> m_chunk_binary_lod_data;
+        // Distance fields are built by VoxelGridLodManager only if enabled before the first commit
+        bool m_distance_field_enabled = false;
+        std::vector<uint8_t> m_grid_distance_data;
+        // Number of chunk grid cells with every distance, gives the largest distance without a scan of the grid
+        std::vector<size_t> m_grid_distance_counts;
+        std::vector<uint8_t> m_chunk_distance_data;
         glm::ivec3 m_chunk_grid_dimensions;
         int m_total_lod = 0;
         int m_max_grid_lod = 0;
@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+namespace lit::engine {
+    /// <summary>
+    /// World file of the voxel grid of the entity, scene snapshots keep the path instead of the voxels.
+    /// </summary>
+    struct WorldReferenceComponent {
+        std::string path{};
+    };
+}
@@ -52,7 +52,13 @@
 
 #include <cmath>
 
+namespace lit::engine {
+    class FastNoiseLiteBatch;
+}
+
 class FastNoiseLite {
+    friend class lit::engine::FastNoiseLiteBatch;
+
 public:
     enum NoiseType {
         NoiseType_OpenSimplex2,
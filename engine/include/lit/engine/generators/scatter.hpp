@@ -0,0 +1,70 @@
+#pragma once
+
+#include <lit/common/array.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lit::engine {
+
+    struct ScatterSettings {
+        /// <summary>
+        /// Minimum distance between two placements in the (x, z) plane, in voxels.
+        /// </summary>
+        double min_distance = 16.0;
+
+        /// <summary>
+        /// Candidates generated around every active point (k in Bridson's algorithm).
+        /// </summary>
+        int attempts = 30;
+
+        /// <summary>
+        /// Placements on steeper terrain (height difference per voxel) are dropped.
+        /// </summary>
+        double max_slope = 1.0;
+
+        /// <summary>
+        /// Side of the tiles that are sampled in parallel, it is raised to at least 3 * min_distance.
+        /// </summary>
+        int tile_size = 128;
+
+        uint64_t seed = 0;
+    };
+
+    struct ScatterPlacement {
+        /// <summary>
+        /// Voxel on the surface: (x, height(x, z), z).
+        /// </summary>
+        glm::ivec3 position;
+
+        /// <summary>
+        /// Random number of the placement, e.g. to choose a model or its rotation.
+        /// </summary>
+        uint32_t variant;
+    };
+
+    /// <summary>
+    /// Scatters props (trees, rocks) over a height map with Bridson's Poisson-disk sampling.
+    /// The map is split into tiles, the tiles are sampled in 4 phases like a 2x2 checkerboard, so tiles of one phase
+    /// are never neighbours and run in parallel, and every tile sees the points of its neighbours from the previous phases.
+    /// Every tile has its own random stream, so the result depends only on the settings, not on the number of threads.
+    /// </summary>
+    class PoissonScatter {
+    public:
+        /// <summary>
+        /// Probability in [0, 1] to keep a placement at (x, z), e.g. a biome mask.
+        /// </summary>
+        using Mask = std::function<double(int x, int z)>;
+
+        /// <summary>
+        /// Placements over @heights (indexed by (x, z)), ordered by tile and then by the order of sampling.
+        /// Points are sampled over the whole map and then filtered by the slope and @mask (if any),
+        /// so filtered out areas do not change the distribution around them.
+        /// </summary>
+        static std::vector<ScatterPlacement> Scatter(const common::Array2D<int> &heights, const ScatterSettings &settings,
+                                                     const Mask &mask, ThreadPool &pool);
+    };
+
+}
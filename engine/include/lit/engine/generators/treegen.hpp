@@ -2,16 +2,25 @@
 
 #include <lit/common/random.hpp>
 #include <lit/engine/components/voxel_grid/voxel_grid.hpp>
+#include <lit/engine/utilities/cone_voxelizer.hpp>
+#include <lit/engine/utilities/point_grid.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
 #include <lit/common/random.hpp>
 #include <spdlog/spdlog.h>
 
 namespace lit::engine {
     class TreeGen {
     public:
-        TreeGen(int seed = 0);
+        TreeGen(uint64_t seed = 0);
 
         VoxelGridPtr GenerateTreeAny();
 
+        /// <summary>
+        /// Generates @count trees on @pool. Tree i uses its own random stream derived from @seed and i,
+        /// so the result does not depend on the number of threads.
+        /// </summary>
+        static std::vector<VoxelGridPtr> GenerateTrees(uint64_t seed, size_t count, ThreadPool &pool);
+
     private:
 
         struct Branch {
@@ -30,12 +39,20 @@ namespace lit::engine {
 
         Branch GenerateTreeGraphAny();
 
-        void GenerateTreeGraphRecursive(Branch &root, Branch &branch, int depth = 0);
+        void GenerateTreeGraphRecursive(Branch &branch, int depth = 0);
+
+        /// <summary>
+        /// End of the branch of the current tree whose end is the nearest to the end of @branch.
+        /// </summary>
+        glm::dvec3 FindNearest(const Branch &branch) const;
 
-        Branch &FindNearest(Branch &root, Branch &branch);
+        void AddBranch(Branch &parent, const Branch &branch);
 
-        void PlaceBranch(const Branch &branch, const VoxelGridPtr &grid);
+        void CollectBranches(const Branch &branch, std::vector<RoundCone> &cones);
 
         RandomGen rng;
+
+        // Ends of all branches of the current tree
+        PointGrid branchEnds;
     };
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <lit/engine/components/voxel_grid/voxel_grid_base.hpp>
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/engine/generators/scatter.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
 
 #include <lit/common/random.hpp>
 #include <spdlog/spdlog.h>
@@ -10,15 +13,84 @@ namespace lit::engine {
     public:
         WorldGen() = default;
 
+        /// <summary>
+        /// Terrain depends only on @seed (and the size of the world), seed 0 is the default terrain.
+        /// </summary>
+        explicit WorldGen(int seed) : m_seed(seed) {}
+
+        /// <summary>
+        /// Duration of the stages of the last <see cref="Generate"/> and <see cref="ScatterTrees"/> calls, in seconds.
+        /// </summary>
+        struct Timings {
+            double height_map = 0.0;
+            double terrain_columns = 0.0;
+            double voxels = 0.0;
+            double trees_scatter = 0.0;
+            double trees_placement = 0.0;
+        };
+
+        const Timings &GetTimings() const {
+            return m_timings;
+        }
+
         void Generate(lit::engine::VoxelGridBaseT<uint32_t> &world, spdlog::logger &logger);
 
+        /// <summary>
+        /// Terrain is generated by independent jobs, one per column of chunks, so the result does not depend on
+        /// the number of threads in @pool. Sparse grids get whole chunks in one batch, other grids are filled voxel by voxel.
+        /// </summary>
+        void Generate(lit::engine::VoxelGridBaseT<uint32_t> &world, spdlog::logger &logger, ThreadPool &pool);
+
+        /// <summary>
+        /// Terrain from the height map PNG at @path (the first channel, the full range is [0, @max_height]):
+        /// image x goes to world x and image rows to world z, the part outside of the world is dropped.
+        /// Rows are decoded in bands of one chunk row, so only the band and the halo of the flatness filter
+        /// are held in memory, and every band is turned into chunks before the next one is read.
+        /// Throws std::runtime_error if the image can't be decoded.
+        /// </summary>
+        void GenerateFromHeightMap(VoxelGridSparseT<uint32_t> &world, const std::string &path, int max_height,
+                                   spdlog::logger &logger, ThreadPool &pool);
+
+        using ChunkData = VoxelGridSparseT<uint32_t>::ChunkData;
+
+        struct GeneratedChunk {
+            int y;
+            std::unique_ptr<ChunkData> data;
+        };
+
+        /// <summary>
+        /// Terrain of a single column of chunks of an unbounded world (the same terrain without the island border).
+        /// @column is the chunk position in (x, z), only non-empty chunks with y in [0, @world_height / CHUNK_SIZE) are returned.
+        /// Thread-safe, the result depends only on the arguments.
+        /// </summary>
+        std::vector<GeneratedChunk> GenerateChunkColumn(glm::ivec2 column, int world_height) const;
+
+        /// <summary>
+        /// Scatters trees over the terrain of <see cref="Generate"/> (the height map is computed again from the seed)
+        /// with <see cref="PoissonScatter"/> and copies them into @world with <see cref="PlaceObjects"/>.
+        /// @variants different trees are generated with the seed of @settings, every placement takes one of them.
+        /// </summary>
+        void ScatterTrees(lit::engine::VoxelGridBaseT<uint32_t> &world, const ScatterSettings &settings, size_t variants,
+                          spdlog::logger &logger, ThreadPool &pool);
+
         void ResetTestWorld(lit::engine::VoxelGridBaseT<uint32_t> &world);
 
         void
         PlaceObject(lit::engine::VoxelGridBaseT<uint32_t> &world, const lit::engine::VoxelGridBaseT<uint32_t> &object);
 
+        /// <summary>
+        /// Copies objects[variant % objects.size()] to every placement, the anchor of the object lands on its position.
+        /// Non-empty voxels of every object are collected into vertical runs once, then every placement is
+        /// a few <see cref="VoxelGridBaseT::FillColumn"/> calls clipped to the world instead of a voxel by voxel copy.
+        /// </summary>
+        void PlaceObjects(lit::engine::VoxelGridBaseT<uint32_t> &world,
+                          const std::vector<std::shared_ptr<lit::engine::VoxelGridBaseT<uint32_t>>> &objects,
+                          const std::vector<ScatterPlacement> &placements);
+
         std::shared_ptr<lit::engine::VoxelGridBaseT<uint32_t>> GenerateTree(RandomGen & rng);
 
     private:
+        int m_seed = 0;
+        Timings m_timings;
     };
 }
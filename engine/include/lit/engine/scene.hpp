@@ -44,6 +44,15 @@ namespace lit::engine {
 
         EntityView CreteEntity(const std::string& name);
 
+        /// <summary>
+        /// First entity with the tag @name, or an empty view if there is none.
+        /// </summary>
+        EntityView FindEntity(const std::string& name);
+
+        entt::registry& GetRegistry() {
+            return m_registry;
+        }
+
     protected:
         friend class EntityView;
 
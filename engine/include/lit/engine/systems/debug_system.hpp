@@ -1,6 +1,8 @@
 #pragma once
 
 #include <lit/engine/systems/system.hpp>
+#include <lit/engine/utilities/edit_history.hpp>
+#include <memory>
 
 namespace lit::engine {
     class DebugSystem : public BasicSystem {
@@ -12,5 +14,7 @@ namespace lit::engine {
         void Update(double dt) override;
 
     private:
+        // Tree regenerations and world loads, one transaction per frame
+        std::unique_ptr<EditHistory> m_history;
     };
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <lit/engine/systems/system.hpp>
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <glm/vec2.hpp>
+#include <future>
+#include <map>
+#include <set>
+#include <string>
+
+namespace lit::engine {
+
+    struct ChunkProviderSettings {
+        /// <summary>
+        /// Columns of chunks closer than this (in chunks) to the observer are loaded.
+        /// </summary>
+        int load_radius = 8;
+
+        /// <summary>
+        /// Columns farther than this are evicted, keep it larger than load_radius to avoid reloading on the border.
+        /// </summary>
+        int unload_radius = 10;
+
+        /// <summary>
+        /// Maximum number of columns being generated or loaded at the same time.
+        /// </summary>
+        size_t max_pending_jobs = 32;
+
+        /// <summary>
+        /// Columns straight behind the observer wait (1 + view_direction_weight) times longer than ones at the same distance ahead.
+        /// </summary>
+        double view_direction_weight = 0.5;
+
+        /// <summary>
+        /// Evicted columns with edits are saved to this directory and loaded back instead of being generated again.
+        /// If empty, edits of evicted columns are dropped.
+        /// </summary>
+        std::string save_directory;
+
+        /// <summary>
+        /// Number of background threads, 0 means hardware concurrency.
+        /// </summary>
+        size_t threads_count = 0;
+    };
+
+    /// <summary>
+    /// Pages columns of chunks of an unbounded world in and out of the sparse voxel grid around the observer.
+    /// The grid is a window of the world, its chunk (0, 0) is the world column <see cref="GetOrigin"/>.
+    /// When the observer moves far from the center of the window, the window is moved with it
+    /// (chunks are shifted in the grid and the observer is moved back by the same distance).
+    /// Columns are generated by <see cref="WorldGen::GenerateChunkColumn"/> or loaded on background threads,
+    /// finished columns are inserted into the grid in one batch per update, so the LOD manager sees regular chunk events.
+    /// </summary>
+    class ChunkProvider : public BasicSystem {
+    public:
+        ChunkProvider(entt::registry &registry, entt::entity observer, ChunkProviderSettings settings = {});
+
+        /// <summary>
+        /// Waits for background jobs and saves edited columns.
+        /// </summary>
+        ~ChunkProvider() override;
+
+        void Update(double dt) override;
+
+        /// <summary>
+        /// Waits until all requested columns are inserted (and evicted columns are saved, so they are loaded back
+        /// with their edits), useful for tools that need a complete area.
+        /// </summary>
+        void Flush();
+
+        /// <summary>
+        /// World column of the chunk (0, y, 0) of the grid.
+        /// </summary>
+        glm::ivec2 GetOrigin() const;
+
+        size_t GetLoadedColumnsCount() const;
+
+        size_t GetPendingJobsCount() const;
+
+        /// <summary>
+        /// Size of the world in voxels is the size of the grid, so both use the same voxel size.
+        /// Same as VOXEL_SIZE in ray_tracing_voxel_world.glsl.
+        /// </summary>
+        static constexpr double VOXEL_SIZE = 1.0 / 16.0;
+
+    private:
+        using VoxelGrid = VoxelGridSparseT<uint32_t>;
+        using ColumnChunks = std::vector<WorldGen::GeneratedChunk>;
+
+        struct ColumnComparator {
+            bool operator()(const glm::ivec2 &lhs, const glm::ivec2 &rhs) const {
+                return lhs.x != rhs.x ? lhs.x < rhs.x : lhs.y < rhs.y;
+            }
+        };
+
+        VoxelGrid &GetWorld();
+
+        glm::ivec2 GetObserverColumn();
+
+        void Recenter(glm::ivec2 observer_column);
+
+        void EvictDistantColumns(glm::ivec2 observer_column);
+
+        void EvictColumn(glm::ivec2 column);
+
+        void InsertFinishedColumns(bool wait);
+
+        void RequestColumns(glm::ivec2 observer_column);
+
+        bool IsInsideWindow(glm::ivec2 column);
+
+        /// <summary>
+        /// Whether @column is inside the window with the chunk (0, 0) at the world column @origin.
+        /// </summary>
+        bool IsInsideWindow(glm::ivec2 column, glm::ivec2 origin);
+
+        std::string GetColumnPath(glm::ivec2 column) const;
+
+        static ColumnChunks LoadColumn(const std::string &path);
+
+        static void SaveColumn(const std::string &path, const ColumnChunks &chunks);
+
+        entt::entity m_observer;
+        ChunkProviderSettings m_settings;
+        WorldGen m_generator;
+
+        glm::ivec2 m_origin = glm::ivec2(0);
+
+        std::set<glm::ivec2, ColumnComparator> m_loaded;
+        std::set<glm::ivec2, ColumnComparator> m_edited;
+        std::map<glm::ivec2, std::future<ColumnChunks>, ColumnComparator> m_pending;
+        std::map<glm::ivec2, std::future<void>, ColumnComparator> m_saving;
+
+        entt::entity m_world = entt::null;
+        size_t m_callback_handle = 0;
+
+        // Declared last, so jobs are finished before the rest of the state is destroyed.
+        ThreadPool m_pool;
+    };
+}
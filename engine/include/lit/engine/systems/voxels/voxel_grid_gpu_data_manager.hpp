@@ -8,6 +8,7 @@
 #include <unordered_set>
 #include <array>
 #include <map>
+#include <optional>
 #include <thread>
 
 namespace lit::engine {
@@ -34,6 +35,15 @@ namespace lit::engine {
 
         UniformBuffer & GetChunkInfoBuffer();
 
+        /// <summary>
+        /// Null until a grid with the distance field enabled is processed.
+        /// </summary>
+        UniformBuffer * GetGridDistanceBuffer();
+
+        UniformBuffer * GetChunkDistanceBuffer();
+
+        bool IsDistanceFieldEnabled() const;
+
         uint64_t GetWorldLodOffsetDword(int lod) const;
 
         uint64_t GetWorldLodSizeDword(int lod) const;
@@ -54,6 +64,27 @@ namespace lit::engine {
 
         uint32_t GetGlobalAddress(uint32_t index) const;
 
+        /// <summary>
+        /// Gives the chunk GPU data for @storage: the allocation of another chunk with the same voxels, or a new one.
+        /// </summary>
+        void AcquireChunkData(uint32_t index, const VoxelGrid::ChunkData *storage);
+
+        /// <summary>
+        /// Frees the GPU data of the chunk, or passes it to another chunk that shares it.
+        /// </summary>
+        void ReleaseChunkData(uint32_t index);
+
+        /// <summary>
+        /// Copies the voxels of the chunk at the detail of its bucket and points the info of all chunks sharing them there.
+        /// </summary>
+        void UploadChunkData(VoxelGrid &grid, VoxelGridLod &grid_lod, uint32_t index);
+
+        /// <summary>
+        /// Creates the distance buffers on the first use and grows the chunk one with the number of chunks,
+        /// a new chunk buffer gets the distances of all chunks.
+        /// </summary>
+        void ReserveDistanceBuffers(const VoxelGridLod &grid_lod);
+
         static inline const uint64_t MEGABYTE = 1024ll * 1024ll;
         static inline const uint64_t GIGABYTE = MEGABYTE * 1024ll;
 
@@ -61,6 +92,7 @@ namespace lit::engine {
         static inline const uint64_t CHUNK_BUFFER_SIZE_BYTES = 2 * GIGABYTE;
         static inline const uint64_t CHUNK_BIT_BUFFER_SIZE_BYTES = 2 * GIGABYTE;
         static inline const uint64_t INFO_BUFFER_SIZE_BYTES = 2 * MEGABYTE;
+        static inline const uint64_t CHUNK_DISTANCE_BUFFER_MAX_SIZE_BYTES = 2 * GIGABYTE;
 
         static inline const int BUCKET_NUM = 3;
         static inline const int BUCKET_SIZE_BYTES[] = {
@@ -85,10 +117,22 @@ namespace lit::engine {
         // Chunks
         std::vector<uint32_t> m_chunk_bucket;
         std::vector<uint32_t> m_chunk_address; // relative address, inside bucket
+
+        // Chunks that share voxels (see VoxelGridSparseT::SetDeduplication) are uploaded once: the owner holds the
+        // allocation, sorted and moved between buckets, the info of the other chunks points to it
+        std::vector<uint32_t> m_chunk_owner;
+        std::vector<const VoxelGrid::ChunkData *> m_chunk_storage; // null for chunks without data
+        std::unordered_map<const VoxelGrid::ChunkData *, uint32_t> m_storage_owner;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> m_chunk_members;
         UniformBuffer m_chunk_data_buffer;
         UniformBuffer m_chunk_info_buffer;
         UniformBuffer m_chunk_bit_data_buffer;
 
+        // Distance fields, see VoxelGridSparseLodDataT::m_distance_field_enabled, created only for grids that use them
+        bool m_distance_field_enabled = false;
+        std::optional<UniformBuffer> m_grid_distance_buffer;
+        std::optional<UniformBuffer> m_chunk_distance_buffer;
+
         ContiguousAllocator m_allocator[BUCKET_NUM];
 
         std::vector<uint32_t> m_sorted_chunk_indices;
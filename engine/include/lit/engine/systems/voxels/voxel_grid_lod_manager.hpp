@@ -3,6 +3,7 @@
 #include <lit/engine/systems/system.hpp>
 #include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
 #include <lit/engine/components/voxel_grid/voxel_grid_sparse_lod_data.hpp>
+#include <lit/engine/utilities/distance_field.hpp>
 #include <entt/entt.hpp>
 
 namespace lit::engine {
@@ -102,6 +103,10 @@ namespace lit::engine {
                         }
                     }
                 }
+
+                if (grid_lod.m_distance_field_enabled) {
+                    UpdateGridDistance(grid_lod, changes);
+                }
             }
 
             std::unordered_set<VoxelGrid::ChunkIndexType> chunks_to_update;
@@ -132,6 +137,10 @@ namespace lit::engine {
             size_t target_size_compressed = (max_index + 1) * (GetLodTotalSize(VoxelGrid::GetChunkDimensions(), 0, VoxelGrid::CHUNK_SIZE_LOG) + 31) / 32;
             ExpandVectorToSize(grid_lod.m_chunk_binary_lod_data, target_size_compressed);
 
+            if (grid_lod.m_distance_field_enabled) {
+                ExpandVectorToSize(grid_lod.m_chunk_distance_data, (max_index + 1) * VoxelGridLod::GetChunkDistanceSize());
+            }
+
 
             // Combine data as colors todo: generalize
             auto combine = [](uint32_t x, uint32_t y) {
@@ -181,9 +190,65 @@ namespace lit::engine {
                         }
                     }
                 }
+
+                // update distance field of the chunk
+                if (grid_lod.m_distance_field_enabled) {
+                    Array3DViewBool view_binary = grid_lod.GetBinaryChunkAtLod(index, VoxelGridLod::DISTANCE_FIELD_LOD);
+                    ComputeChebyshevDistance(grid_lod.GetChunkDistanceView(index), [&view_binary](int i, int j, int k) {
+                        return view_binary.Get(i, j, k);
+                    }, VoxelGridLod::DISTANCE_FIELD_MAX);
+                }
             }
         }
 
+        // Recomputes the chunk grid distance field around created and deleted chunks. A cell can only get another
+        // distance if one of them is not farther from it than its previous distance, so the box around them is
+        // extended by the largest distance of the field. The first commit creates every chunk of the grid, cells
+        // farther than DISTANCE_FIELD_MAX from all of them keep the initial distance.
+        void UpdateGridDistance(VoxelGridLod& grid_lod, const std::vector<ChunkAnyChangeArgs>& changes) {
+            auto& counts = grid_lod.m_grid_distance_counts;
+            int radius = VoxelGridLod::DISTANCE_FIELD_MAX;
+            while (radius > 0 && counts[radius] == 0) {
+                radius--;
+            }
+
+            Array3DView distance = grid_lod.GetGridDistanceView();
+            glm::ivec3 dims = distance.GetDimensions();
+            glm::ivec3 begin = dims;
+            glm::ivec3 end = glm::ivec3(0);
+            for (auto& change : changes) {
+                glm::ivec3 position;
+                if (auto created = std::get_if<ChunkCreatedArgs>(&change)) {
+                    position = created->chunk_grid_position;
+                } else if (auto deleted = std::get_if<ChunkDeletedArgs>(&change)) {
+                    position = deleted->chunk_grid_position;
+                } else {
+                    continue;
+                }
+                begin = glm::min(begin, glm::max(position - radius, glm::ivec3(0)));
+                end = glm::max(end, glm::min(position + radius + 1, dims));
+            }
+            if (glm::any(glm::greaterThanEqual(begin, end))) {
+                return;
+            }
+
+            auto for_each_cell = [&](auto&& func) {
+                for (int i = begin.x; i < end.x; i++) {
+                    for (int j = begin.y; j < end.y; j++) {
+                        for (int k = begin.z; k < end.z; k++) {
+                            func(distance.At(i, j, k));
+                        }
+                    }
+                }
+            };
+            for_each_cell([&counts](uint8_t value) { counts[value]--; });
+            Array3DView grid_view = grid_lod.GetChunkGridViewAtLod(0);
+            UpdateChebyshevDistance(distance, [&grid_view](int i, int j, int k) {
+                return grid_view.At(i, j, k) != VoxelGrid::CHUNK_EMPTY;
+            }, VoxelGridLod::DISTANCE_FIELD_MAX, begin, end);
+            for_each_cell([&counts](uint8_t value) { counts[value]++; });
+        }
+
         std::unordered_map<entt::entity, std::vector<ChunkAnyChangeArgs>> m_changes;
 
         std::unordered_map<entt::entity, size_t> m_callback_handle;
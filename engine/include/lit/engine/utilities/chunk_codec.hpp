@@ -0,0 +1,76 @@
+#pragma once
+
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Compression of voxel chunks. A chunk is stored as a palette of its distinct values and a bit stream of palette
+    /// indices in Morton order, so nearby voxels (which are usually equal) are next to each other in the stream.
+    /// The stream is either run-length coded (index and Exp-Golomb length of every run) or plain bit-packed,
+    /// whichever is smaller. Optionally voxels are predicted from the parent LOD (LOD 1 of the same chunk,
+    /// as in VoxelGridSparseLodDataT): a voxel equal to its parent cell takes a reserved palette index,
+    /// the same parent must be given to decode it.
+    /// Encoded chunks can be concatenated: decoding reports how many bytes it consumed.
+    /// </summary>
+    class ChunkCodec {
+    public:
+        using VoxelGrid = VoxelGridSparseT<uint32_t>;
+        using ChunkData = VoxelGrid::ChunkData;
+
+        inline static const size_t CHUNK_VOXELS = (size_t) 1 << (3 * VoxelGrid::CHUNK_SIZE_LOG);
+
+        inline static const size_t PARENT_VOXELS = CHUNK_VOXELS / 8;
+
+        /// <summary>
+        /// Appends the encoded chunk to @out. @parent is null or (CHUNK_SIZE / 2)^3 values of the parent LOD.
+        /// </summary>
+        void Encode(const ChunkData &data, const uint32_t *parent, std::vector<uint8_t> &out);
+
+        /// <summary>
+        /// Appends @count values (at most CHUNK_VOXELS) encoded in their memory order to @out, for data that is not
+        /// a chunk (e.g. LOD blocks).
+        /// </summary>
+        void EncodeValues(const uint32_t *values, size_t count, std::vector<uint8_t> &out);
+
+        /// <summary>
+        /// Decodes a chunk from the beginning of @payload, returns the number of bytes consumed.
+        /// Throws std::runtime_error on malformed payloads or if the chunk needs @parent and it is null.
+        /// </summary>
+        static size_t Decode(const uint8_t *payload, size_t size, const uint32_t *parent, ChunkData &data);
+
+        /// <summary>
+        /// Decodes exactly @count values written by EncodeValues, returns the number of bytes consumed.
+        /// </summary>
+        static size_t DecodeValues(const uint8_t *payload, size_t size, uint32_t *values, size_t count);
+
+    private:
+        /// <summary>
+        /// Encodes @values in their order, @parent is null or the prediction of every 8 consecutive values.
+        /// </summary>
+        void EncodeSymbols(const uint32_t *values, const uint32_t *parent, size_t count, std::vector<uint8_t> &out);
+
+        uint32_t GetPaletteIndex(uint32_t value);
+
+        struct Run {
+            uint16_t symbol;
+            uint32_t length;
+        };
+
+        // Values and parent values in the encoding order
+        std::vector<uint32_t> m_values;
+        std::vector<uint32_t> m_parent;
+        std::vector<Run> m_runs;
+        std::vector<uint32_t> m_palette;
+
+        // Open addressing table from values to palette indices, entries of previous calls have older stamps
+        std::vector<uint32_t> m_lookup_keys;
+        std::vector<uint16_t> m_lookup_indices;
+        std::vector<uint32_t> m_lookup_stamps;
+        uint32_t m_stamp = 0;
+    };
+
+}
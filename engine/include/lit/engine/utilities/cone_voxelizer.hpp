@@ -0,0 +1,86 @@
+#pragma once
+
+#include <lit/engine/components/voxel_grid/voxel_grid_base.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Branch shape used by the tree generators: a cone from @begin to @end whose radius (measured from the axis)
+    /// changes linearly from @radius_begin to @radius_end, capped with spheres of these radii at both ends.
+    /// </summary>
+    struct RoundCone {
+        glm::vec3 begin;
+        glm::vec3 end;
+        float radius_begin;
+        float radius_end;
+        uint32_t value;
+    };
+
+    /// <summary>
+    /// Voxelizes a set of round cones (all branches of a tree) in one pass.
+    /// A BVH over the cones finds the ones that cross a tile of columns of voxels, in every column the cone is clipped
+    /// analytically to its bounding capsule and only the voxels of this span are tested, 8 at a time with AVX2.
+    /// Where cones overlap, the one added later wins, the same as setting voxels cone by cone.
+    /// </summary>
+    class ConeVoxelizer {
+    public:
+        explicit ConeVoxelizer(std::vector<RoundCone> cones);
+
+        /// <summary>
+        /// Sets voxels of @grid whose centers are inside of any cone, other voxels are not changed.
+        /// Center of voxel (i, j, k) is (i + 0.5, j + 0.5, k + 0.5) - anchor of the grid in the coordinates of the cones.
+        /// Voxels are written with <see cref="VoxelGridBaseT::FillColumn"/>, one call per run of equal values.
+        /// </summary>
+        void Voxelize(VoxelGridBaseT<uint32_t> &grid) const;
+
+        static bool IsVectorized();
+
+    private:
+        static const int LEAF_SIZE = 4;
+        static const int TILE_SIZE = 8;
+
+        // Cone with the values that do not depend on the voxel and its bounding box
+        struct Shape {
+            glm::vec3 begin;
+            glm::vec3 end;
+            glm::vec3 direction;
+            float length;
+            float radius_begin;
+            float radius_end;
+            float slope;
+            float bounding_radius;
+            uint32_t value;
+            glm::vec3 min;
+            glm::vec3 max;
+        };
+
+        struct Node {
+            glm::vec3 min;
+            glm::vec3 max;
+            // Leaf: shapes [first, first + count) of m_order. Inner node: left child is the next node, right is first.
+            uint32_t first;
+            uint32_t count;
+        };
+
+        uint32_t Build(uint32_t begin, uint32_t end);
+
+        void QueryTile(glm::vec2 min, glm::vec2 max, std::vector<uint32_t> &result, std::vector<uint32_t> &stack) const;
+
+        void VoxelizeColumn(VoxelGridBaseT<uint32_t> &grid, const std::vector<uint32_t> &shapes, glm::ivec2 column,
+                            std::vector<uint32_t> &values) const;
+
+        bool GetColumnSpan(const Shape &shape, glm::vec2 xz, float &y_min, float &y_max) const;
+
+        void RasterizeSpan(const Shape &shape, glm::vec2 xz, float y_offset, int y_begin, int y_end,
+                           uint32_t *values) const;
+
+        std::vector<Shape> m_shapes;
+        std::vector<uint32_t> m_order;
+        std::vector<Node> m_nodes;
+    };
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <lit/common/glm_ext/comparators.hpp>
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Undo and redo of the changes of a grid. Changes are grouped into transactions by <see cref="Commit"/>:
+    /// the first change of a chunk in a transaction keeps a copy of its previous voxels, the commit turns every
+    /// touched chunk into the run-length coded XOR of its previous and current voxels, so a transaction takes
+    /// a few bytes per run of changed voxels. Transactions are kept within a memory budget, the oldest ones are
+    /// dropped first. Undo and redo apply the deltas to whole chunks in batches, so grid listeners (LOD and GPU
+    /// managers) get one change per chunk. Writes through VoxelGridSparseT::GetChunkData and ShiftChunks are not
+    /// recorded, clear the history after them. The grid must outlive the history.
+    /// </summary>
+    class EditHistory {
+    public:
+        using VoxelGrid = VoxelGridSparseT<uint32_t>;
+
+        /// <summary>
+        /// Starts recording changes of @grid, committed transactions take at most @memory_budget bytes.
+        /// Copies of the chunks changed by the open transaction are not counted.
+        /// </summary>
+        EditHistory(VoxelGrid &grid, size_t memory_budget);
+
+        ~EditHistory();
+
+        EditHistory(const EditHistory &) = delete;
+
+        EditHistory &operator=(const EditHistory &) = delete;
+
+        /// <summary>
+        /// Closes the open transaction, it becomes the one undone next and the redo list is cleared.
+        /// Does nothing if the grid did not change.
+        /// </summary>
+        void Commit();
+
+        /// <summary>
+        /// Commits the open transaction and reverts the last one. Returns false if there is nothing to undo.
+        /// </summary>
+        bool Undo();
+
+        /// <summary>
+        /// Applies the last undone transaction again. Returns false if there is nothing to redo, changes since
+        /// the undo are committed first, so they clear the redo list.
+        /// </summary>
+        bool Redo();
+
+        size_t GetUndoCount() const {
+            return m_undo.size();
+        }
+
+        size_t GetRedoCount() const {
+            return m_redo.size();
+        }
+
+        /// <summary>
+        /// Bytes taken by the committed transactions.
+        /// </summary>
+        size_t GetMemoryUsage() const {
+            return m_memory_usage;
+        }
+
+        bool HasPendingChanges() const {
+            return !m_pending.empty();
+        }
+
+        /// <summary>
+        /// Drops all transactions, changes of the open transaction are not recorded either.
+        /// </summary>
+        void Clear();
+
+    private:
+        using ChunkData = VoxelGrid::ChunkData;
+
+        struct ChunkDelta {
+            glm::ivec3 position;
+            bool existed_before;
+            bool exists_after;
+            // Runs of XOR of the voxels before and after (missing chunks are zeros): varint length, varint value
+            std::vector<uint8_t> runs;
+        };
+
+        struct Transaction {
+            std::vector<ChunkDelta> chunks;
+            size_t size_bytes = 0;
+        };
+
+        void OnBeforeChange(const glm::ivec3 &position);
+
+        /// <summary>
+        /// Turns the chunks of @transaction from one state into the other, to the state before it if @undo.
+        /// </summary>
+        void Apply(const Transaction &transaction, bool undo);
+
+        void Evict();
+
+        static void EncodeDelta(const uint32_t *before, const uint32_t *after, std::vector<uint8_t> &out);
+
+        static void ApplyDelta(const std::vector<uint8_t> &runs, uint32_t *voxels);
+
+        VoxelGrid &m_grid;
+        size_t m_callback;
+        size_t m_memory_budget;
+        size_t m_memory_usage = 0;
+
+        // Voxels of the chunks touched by the open transaction before their first change, null for missing chunks
+        std::map<glm::ivec3, std::unique_ptr<ChunkData>, common::glm_ext::vec3_comparator<int>> m_pending;
+        bool m_applying = false;
+
+        std::deque<Transaction> m_undo;
+        std::deque<Transaction> m_redo;
+    };
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Read-only memory mapping of a whole file. Pages are read by the OS on the first access,
+    /// so mapping a large file is cheap and only the touched parts take memory.
+    /// </summary>
+    class MappedFile {
+    public:
+        /// <summary>
+        /// Maps @path, throws std::runtime_error if it can't be opened or mapped.
+        /// </summary>
+        explicit MappedFile(const std::string &path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const uint8_t *GetData() const {
+            return m_data;
+        }
+
+        /// <summary>
+        /// Size of the file when it was mapped, later appends are not visible.
+        /// </summary>
+        size_t GetSize() const {
+            return m_size;
+        }
+
+    private:
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+#if defined(_WIN32)
+        void *m_file = nullptr;
+        void *m_mapping = nullptr;
+#else
+        int m_file = -1;
+#endif
+    };
+
+}
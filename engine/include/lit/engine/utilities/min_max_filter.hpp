@@ -0,0 +1,122 @@
+#pragma once
+
+#include <lit/common/array.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Applies @op to windows of @radius along one axis of @lanes independent sequences of @count elements.
+    /// Element p of lane l is at @src[p * @stride + l], elements out of the sequence are @identity.
+    /// van Herk/Gil-Werman: the padded sequence is split into blocks of the window size, every window covers
+    /// a suffix of one block and a prefix of the next one, so it costs 3 applications of @op per element
+    /// for any radius. The lanes are the innermost loop, so it is vectorized across them.
+    /// @prefix and @suffix are scratch buffers, they are resized if needed.
+    /// </summary>
+    template<typename T, typename Op>
+    void SlidingWindowFilterLanes(const T* src, T* dst, size_t count, size_t stride, size_t lanes, int radius,
+                                  Op&& op, T identity, std::vector<T>& prefix, std::vector<T>& suffix) {
+        size_t window = 2 * (size_t) radius + 1;
+        size_t padded = (count + 2 * radius + window - 1) / window * window;
+        prefix.resize(padded * lanes);
+        suffix.resize(padded * lanes);
+
+        auto row = [&](size_t p) -> const T* {
+            return p >= (size_t) radius && p - radius < count ? src + (p - radius) * stride : nullptr;
+        };
+
+        for (size_t p = 0; p < padded; p++) {
+            const T* values = row(p);
+            T* g = prefix.data() + p * lanes;
+            const T* g_prev = g - lanes;
+            bool first = p % window == 0;
+            for (size_t l = 0; l < lanes; l++) {
+                T value = values ? values[l] : identity;
+                g[l] = first ? value : op(g_prev[l], value);
+            }
+        }
+
+        for (size_t p = padded; p-- > 0;) {
+            const T* values = row(p);
+            T* h = suffix.data() + p * lanes;
+            const T* h_next = h + lanes;
+            bool last = p % window == window - 1;
+            for (size_t l = 0; l < lanes; l++) {
+                T value = values ? values[l] : identity;
+                h[l] = last ? value : op(h_next[l], value);
+            }
+        }
+
+        // Window of the element i is [i, i + 2 * radius] in the padded sequence.
+        for (size_t i = 0; i < count; i++) {
+            const T* h = suffix.data() + i * lanes;
+            const T* g = prefix.data() + (i + 2 * radius) * lanes;
+            T* out = dst + i * stride;
+            for (size_t l = 0; l < lanes; l++) {
+                out[l] = op(h[l], g[l]);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Applies @op to every (2 * @radius + 1)^2 window of @src, windows are clipped at the borders.
+    /// @op must be associative, commutative and idempotent (min, max), @identity is its neutral element.
+    /// Separable filter, both passes are split into blocks of lines which run on @pool if it is not null.
+    /// </summary>
+    template<typename T, typename Op>
+    common::Array2D<T> SlidingWindowFilter(const common::Array2D<T>& src, int radius, Op&& op, T identity,
+                                           ThreadPool* pool = nullptr) {
+        const size_t BLOCK_SIZE = 64;
+
+        size_t width = src.GetWidth();
+        size_t height = src.GetHeight();
+        common::Array2D<T> tmp(width, height);
+        common::Array2D<T> res(width, height);
+
+        auto run = [&](size_t count, const std::function<void(size_t)>& func) {
+            if (pool) {
+                pool->ParallelFor(count, func);
+            } else {
+                for (size_t i = 0; i < count; i++) {
+                    func(i);
+                }
+            }
+        };
+
+        // Along y, elements of a column are contiguous, so every column is a single lane.
+        run((width + BLOCK_SIZE - 1) / BLOCK_SIZE, [&](size_t block) {
+            std::vector<T> prefix, suffix;
+            for (size_t x = block * BLOCK_SIZE; x < std::min(width, block * BLOCK_SIZE + BLOCK_SIZE); x++) {
+                SlidingWindowFilterLanes(src.data() + x * height, tmp.data() + x * height, height, 1, 1, radius,
+                                         op, identity, prefix, suffix);
+            }
+        });
+
+        // Along x, the lanes are BLOCK_SIZE neighbouring rows.
+        run((height + BLOCK_SIZE - 1) / BLOCK_SIZE, [&](size_t block) {
+            std::vector<T> prefix, suffix;
+            size_t y = block * BLOCK_SIZE;
+            size_t lanes = std::min(height, y + BLOCK_SIZE) - y;
+            SlidingWindowFilterLanes(tmp.data() + y, res.data() + y, width, height, lanes, radius, op, identity,
+                                     prefix, suffix);
+        });
+
+        return res;
+    }
+
+    template<typename T>
+    common::Array2D<T> SlidingWindowMin(const common::Array2D<T>& src, int radius, ThreadPool* pool = nullptr) {
+        return SlidingWindowFilter(src, radius, [](T a, T b) { return std::min(a, b); },
+                                   std::numeric_limits<T>::max(), pool);
+    }
+
+    template<typename T>
+    common::Array2D<T> SlidingWindowMax(const common::Array2D<T>& src, int radius, ThreadPool* pool = nullptr) {
+        return SlidingWindowFilter(src, radius, [](T a, T b) { return std::max(a, b); },
+                                   std::numeric_limits<T>::lowest(), pool);
+    }
+
+}
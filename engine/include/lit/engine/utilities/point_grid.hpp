@@ -0,0 +1,121 @@
+#pragma once
+
+#include <lit/common/glm_ext/comparators.hpp>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Incremental index of 3D points for nearest neighbour queries. Points are bucketed into cubic cells,
+    /// occupied cells are kept in an ordered map, so inserting a point costs O(log n).
+    /// The nearest point is searched in shells of cells of growing radius around the query, the search stops
+    /// as soon as no point of the next shell can be closer, so for points spread with a bounded density
+    /// (branch ends, props) a query visits only a few cells.
+    /// </summary>
+    class PointGrid {
+    public:
+        explicit PointGrid(double cell_size) : m_cell_size(cell_size) {}
+
+        /// <summary>
+        /// Adds @point, returns its index in the order of insertion.
+        /// </summary>
+        uint32_t Insert(const glm::dvec3& point) {
+            auto index = (uint32_t) m_points.size();
+            m_points.push_back(point);
+
+            glm::ivec3 cell = GetCell(point);
+            m_cells[cell].push_back(index);
+            if (m_points.size() == 1) {
+                m_min_cell = m_max_cell = cell;
+            } else {
+                m_min_cell = glm::min(m_min_cell, cell);
+                m_max_cell = glm::max(m_max_cell, cell);
+            }
+            return index;
+        }
+
+        /// <summary>
+        /// Index of the point nearest to @point, the first inserted one if several are at the same distance.
+        /// Empty if there are no points.
+        /// </summary>
+        std::optional<uint32_t> FindNearest(const glm::dvec3& point) const {
+            if (m_points.empty()) {
+                return std::nullopt;
+            }
+
+            glm::ivec3 center = GetCell(point);
+            // Shells beyond this radius contain no occupied cells
+            glm::ivec3 reach = glm::max(glm::abs(m_min_cell - center), glm::abs(m_max_cell - center));
+            int max_radius = std::max(reach.x, std::max(reach.y, reach.z));
+
+            uint32_t best = 0;
+            double best_distance = std::numeric_limits<double>::max();
+            for (int radius = 0; radius <= max_radius; radius++) {
+                ForEachShellCell(center, radius, [&](const std::vector<uint32_t>& indices) {
+                    for (uint32_t index: indices) {
+                        double distance = glm::length(m_points[index] - point);
+                        if (distance < best_distance || (distance == best_distance && index < best)) {
+                            best = index;
+                            best_distance = distance;
+                        }
+                    }
+                });
+                // Points of the shell (radius + 1) are at least radius * cell size away from the query
+                if (best_distance <= radius * m_cell_size) {
+                    break;
+                }
+            }
+            return best;
+        }
+
+        const glm::dvec3& GetPoint(uint32_t index) const {
+            return m_points[index];
+        }
+
+        size_t GetSize() const {
+            return m_points.size();
+        }
+
+        void Clear() {
+            m_points.clear();
+            m_cells.clear();
+        }
+
+    private:
+        glm::ivec3 GetCell(const glm::dvec3& point) const {
+            return glm::ivec3(glm::floor(point / m_cell_size));
+        }
+
+        template<typename Func>
+        void ForEachShellCell(const glm::ivec3& center, int radius, Func&& func) const {
+            for (int dx = -radius; dx <= radius; dx++) {
+                for (int dy = -radius; dy <= radius; dy++) {
+                    // Only the cells on the surface of the cube
+                    bool inner = std::abs(dx) != radius && std::abs(dy) != radius;
+                    for (int dz = -radius; dz <= radius; dz += inner ? 2 * radius : 1) {
+                        auto it = m_cells.find(center + glm::ivec3(dx, dy, dz));
+                        if (it != m_cells.end()) {
+                            func(it->second);
+                        }
+                        if (radius == 0) {
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        double m_cell_size;
+        std::vector<glm::dvec3> m_points;
+        std::map<glm::ivec3, std::vector<uint32_t>, common::glm_ext::vec3_comparator<int>> m_cells;
+        glm::ivec3 m_min_cell = glm::ivec3(0);
+        glm::ivec3 m_max_cell = glm::ivec3(0);
+    };
+
+}
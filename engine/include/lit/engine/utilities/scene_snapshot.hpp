@@ -0,0 +1,95 @@
+#pragma once
+
+#include <lit/engine/components/camera.hpp>
+#include <lit/engine/components/transform.hpp>
+#include <entt/entt.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Binary snapshot of the entities of a scene: tags, transforms, camera settings and voxel grids, which are kept
+    /// as the paths of their world files (WorldReferenceComponent), so a snapshot takes a few hundred bytes and grids
+    /// are restored by paging their chunks from the files. Systems and GL objects (frame buffers, sky boxes) are not
+    /// part of it, cameras get their frame buffers on the first redraw.
+    /// File: a header and the entities in the order of their creation, each one a fixed size record followed by
+    /// its tag and the path of its world file.
+    /// </summary>
+    class SceneSnapshot {
+    public:
+        struct Entity {
+            std::string tag;
+            TransformComponent transform;
+            // Set for entities with a camera
+            std::optional<CameraComponent::Settings> camera;
+            // World file of the voxel grid of the entity, empty if it has no grid
+            std::string world_path;
+            // Grid has VoxelGridSparseLodDataT
+            bool grid_lod = false;
+        };
+
+        inline static const uint32_t VERSION = 1;
+
+        inline static const uint32_t HAS_CAMERA = 1;
+        inline static const uint32_t HAS_GRID = 2;
+        inline static const uint32_t HAS_GRID_LOD = 4;
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint64_t entities_count;
+        };
+
+        struct EntityHeader {
+            uint32_t flags;
+            uint32_t tag_size;
+            uint32_t world_path_size;
+            uint32_t reserved;
+            glm::dvec3 translation;
+            // x, y, z, w
+            glm::dvec4 rotation;
+            double scale;
+            CameraComponent::Settings camera;
+        };
+
+        static_assert(sizeof(Header) == 16 && sizeof(EntityHeader) == 104);
+
+        /// <summary>
+        /// Takes all entities with a tag and a transform (every entity created by Scene). Grids must be saved to
+        /// their world files before, throws std::invalid_argument if a grid has no WorldReferenceComponent.
+        /// </summary>
+        static SceneSnapshot Capture(entt::registry &registry);
+
+        /// <summary>
+        /// Throws std::runtime_error if the file can't be read or is not a valid snapshot.
+        /// </summary>
+        static SceneSnapshot Load(const std::string &path);
+
+        /// <summary>
+        /// Writes the snapshot to a temporary file next to @path and renames it over @path, so an interrupted save
+        /// keeps the previous snapshot. Throws std::runtime_error if the file can't be written.
+        /// </summary>
+        void Save(const std::string &path) const;
+
+        /// <summary>
+        /// Creates the entities in @registry and returns them in the order of the snapshot. Entities, tags and
+        /// transforms are inserted in bulk, grids are attached to their world files (each file is opened once).
+        /// Files are opened before anything is created, so a missing world file throws std::runtime_error and leaves
+        /// the registry unchanged.
+        /// </summary>
+        std::vector<entt::entity> Restore(entt::registry &registry) const;
+
+        const std::vector<Entity> &GetEntities() const {
+            return m_entities;
+        }
+
+    private:
+        std::vector<Entity> m_entities;
+    };
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <lit/engine/components/transform.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <lit/engine/utilities/voxel_ray_caster.hpp>
+#include <lit/common/images/images.hpp>
+#include <spdlog/spdlog.h>
+#include <glm/vec2.hpp>
+#include <vector>
+
+namespace lit::engine {
+
+    class CameraComponent;
+
+    /// <summary>
+    /// Headless CPU renderer of the voxel world, reproduces SampleColor from main.glsl
+    /// (primary ray, Lambert term, shadow ray) followed by the filmic tone mapping from tone_mapping.glsl.
+    /// Viewport is split into square tiles that are rendered in parallel on a <see cref="ThreadPool"/>,
+    /// rays of a tile are traced in packets with <see cref="VoxelRayPacketCasterT"/>.
+    /// </summary>
+    /// <remarks>
+    /// Nothing here touches OpenGL, so it can be used for thumbnails and image comparisons on machines without GPU.
+    /// </remarks>
+    class SoftwareRenderer {
+    public:
+        inline static const int TILE_SIZE = 32;
+
+        inline static const int MAX_ITERATIONS = 200;
+
+        struct TileStats {
+            glm::ivec2 begin = glm::ivec2(0); // first pixel of the tile, (0, 0) is the bottom left corner as in OpenGL
+            glm::ivec2 end = glm::ivec2(0);
+            double time = 0.0; // seconds
+            size_t thread = 0; // index of the thread pool worker that rendered the tile
+            size_t rays = 0;
+            size_t iterations = 0; // total traversal iterations of primary and shadow rays
+        };
+
+        /// <summary>
+        /// Caster and pool are kept by reference and must outlive the renderer.
+        /// </summary>
+        SoftwareRenderer(const VoxelRayCaster& caster, ThreadPool& pool);
+
+        /// <summary>
+        /// Renders the world from the camera with transform @camera_transform (in object-space of the world).
+        /// Row 0 of the image is the top row of the viewport.
+        /// </summary>
+        common::Image<uint8_t, 3> Render(glm::uvec2 viewport, const TransformComponent& camera_transform);
+
+        common::Image<uint8_t, 3> Render(const CameraComponent& camera, const TransformComponent& camera_transform);
+
+        /// <summary>
+        /// Stats of the tiles from the last <see cref="Render"/> call, ordered by tile position.
+        /// </summary>
+        const std::vector<TileStats>& GetTileStats() const;
+
+        /// <summary>
+        /// Wall time of the last <see cref="Render"/> call in seconds.
+        /// </summary>
+        double GetRenderTime() const;
+
+        /// <summary>
+        /// Logs total time and @slowest_tiles_count slowest tiles, these are the traversal hotspots.
+        /// </summary>
+        void LogStats(spdlog::logger& logger, size_t slowest_tiles_count = 8) const;
+
+    private:
+        void RenderTile(glm::ivec2 begin, glm::ivec2 end, glm::uvec2 viewport, const glm::mat4& camera_matrix,
+                        common::Image<uint8_t, 3>& image, TileStats& stats) const;
+
+        static glm::vec3 FilmicToneMapping(glm::vec3 x);
+
+        const VoxelRayCaster& m_caster;
+
+        ThreadPool& m_pool;
+
+        std::vector<TileStats> m_tile_stats;
+
+        double m_render_time = 0.0;
+    };
+
+}
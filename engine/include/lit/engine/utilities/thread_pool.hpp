@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Fixed size pool of worker threads with work stealing.
+    /// Every worker owns a task queue: it takes tasks from the back of its own queue and,
+    /// when the queue is empty, steals from the front of the other queues.
+    /// </summary>
+    /// <remarks>
+    /// A thread that waits for <see cref="ParallelFor"/> executes pending tasks as well,
+    /// so it is safe to call ParallelFor from inside of a task.
+    /// </remarks>
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
+
+        /// <summary>
+        /// Creates pool with @threads_count workers, zero means number of hardware threads.
+        /// </summary>
+        explicit ThreadPool(size_t threads_count = 0);
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t GetThreadsCount() const;
+
+        /// <summary>
+        /// Schedules @task, it is executed by one of the workers.
+        /// </summary>
+        void Submit(Task task);
+
+        /// <summary>
+        /// Schedules @func and returns future with its result (or exception).
+        /// </summary>
+        template<typename F>
+        auto Async(F&& func) -> std::future<std::invoke_result_t<F>> {
+            using Result = std::invoke_result_t<F>;
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+            auto future = task->get_future();
+            Submit([task]() { (*task)(); });
+            return future;
+        }
+
+        /// <summary>
+        /// Calls @func(index) for every index in [0, @count) and waits until all calls are finished.
+        /// Indices are split into contiguous blocks between the worker queues, idle workers steal the rest.
+        /// First exception thrown by @func is rethrown to the caller.
+        /// </summary>
+        void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+        /// <summary>
+        /// Index of the current worker in [0, GetThreadsCount()), or GetThreadsCount() if called outside of the pool.
+        /// </summary>
+        size_t GetCurrentThreadIndex() const;
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void Push(size_t queue_index, Task task);
+
+        bool TryPop(size_t queue_index, Task& task);
+
+        bool TrySteal(size_t thief_index, Task& task);
+
+        bool TryRunPending(size_t thread_index);
+
+        void WorkerLoop(size_t thread_index);
+
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::atomic<size_t> m_queued_count = 0;
+        std::atomic<size_t> m_next_queue = 0;
+        bool m_stop = false;
+    };
+
+}
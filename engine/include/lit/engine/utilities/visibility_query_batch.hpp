@@ -0,0 +1,165 @@
+#pragma once
+
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <lit/engine/utilities/voxel_ray_caster.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Answers batches of line-of-sight queries (AI vision, audio occlusion) over a voxel grid.
+    /// Segments are sorted by the chunk of their start point, so neighbouring queries read the same chunks,
+    /// then split into blocks that are traversed in parallel with <see cref="VoxelRayCasterT::WorldSegmentCast"/>
+    /// (binary LOD pyramid, traversal stops at the segment end).
+    /// </summary>
+    /// <remarks>
+    /// Results do not depend on the number of threads: every query is traversed independently and written
+    /// to its own slot, stats are summed in a fixed order.
+    /// </remarks>
+    /// <typeparam name="VoxelType">Type of voxel data</typeparam>
+    template<typename VoxelType>
+    class VisibilityQueryBatchT {
+    public:
+        using RayCaster = VoxelRayCasterT<VoxelType>;
+
+        inline static const int DEFAULT_MAX_ITERATIONS = 1024;
+
+        /// <summary>
+        /// Number of queries in a block that is scheduled as one task.
+        /// </summary>
+        inline static const size_t BLOCK_SIZE = 64;
+
+        struct Result {
+            bool visible = false; // @to can be seen from @from
+            glm::ivec3 blocker = glm::ivec3(0); // voxel that blocks the segment, if not visible
+            float distance = 0.0f; // distance from @from to the blocker (object-space), segment length if visible
+            int iterations = 0;
+        };
+
+        struct Stats {
+            size_t queries = 0;
+            size_t visible = 0;
+            size_t iterations = 0;
+            double time = 0.0; // seconds
+
+            double GetRaysPerSecond() const {
+                return time > 0.0 ? (double) queries / time : 0.0;
+            }
+
+            double GetAverageIterations() const {
+                return queries > 0 ? (double) iterations / (double) queries : 0.0;
+            }
+        };
+
+        /// <summary>
+        /// Caster and pool are kept by reference and must outlive the batch.
+        /// </summary>
+        VisibilityQueryBatchT(const RayCaster& caster, ThreadPool& pool) : m_caster(caster), m_pool(pool) {}
+
+        /// <summary>
+        /// Checks visibility between @from[i] and @to[i] (object-space) for i in [0, @count), writes to @results[i].
+        /// A segment is blocked if it enters a non-empty voxel before reaching @to. Segments that run out of
+        /// @max_iterations are reported as not visible.
+        /// </summary>
+        void Execute(const glm::vec3* from, const glm::vec3* to, size_t count, Result* results,
+                     int max_iterations = DEFAULT_MAX_ITERATIONS) {
+            common::Timer timer;
+
+            SortByChunk(from, count);
+
+            size_t blocks_count = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            std::vector<size_t> block_iterations(blocks_count, 0);
+
+            m_pool.ParallelFor(blocks_count, [&](size_t block) {
+                size_t end = std::min(count, (block + 1) * BLOCK_SIZE);
+                for (size_t i = block * BLOCK_SIZE; i < end; i++) {
+                    size_t index = m_order[i];
+                    auto res = m_caster.WorldSegmentCast(from[index], to[index], max_iterations);
+
+                    Result& result = results[index];
+                    result.visible = !res.hit && res.iterations < max_iterations;
+                    result.blocker = res.cell;
+                    result.distance = result.visible ? glm::length(to[index] - from[index]) : res.depth;
+                    result.iterations = res.iterations;
+                    block_iterations[block] += res.iterations;
+                }
+            });
+
+            m_stats = Stats();
+            m_stats.queries = count;
+            m_stats.iterations = std::accumulate(block_iterations.begin(), block_iterations.end(), (size_t) 0);
+            m_stats.visible = std::count_if(results, results + count, [](const Result& r) { return r.visible; });
+            m_stats.time = timer.GetTime();
+        }
+
+        std::vector<Result> Execute(const std::vector<glm::vec3>& from, const std::vector<glm::vec3>& to,
+                                    int max_iterations = DEFAULT_MAX_ITERATIONS) {
+            assert(from.size() == to.size());
+            std::vector<Result> results(from.size());
+            Execute(from.data(), to.data(), from.size(), results.data(), max_iterations);
+            return results;
+        }
+
+        /// <summary>
+        /// Stats of the last <see cref="Execute"/> call.
+        /// </summary>
+        const Stats& GetStats() const {
+            return m_stats;
+        }
+
+        void LogStats(spdlog::logger& logger) const {
+            logger.info("Visibility queries: {} ({} visible), {:.2f} ms, {:.2f} Mrays/s, {:.2f} iterations per ray",
+                        m_stats.queries, m_stats.visible, m_stats.time * 1000.0, m_stats.GetRaysPerSecond() * 1e-6,
+                        m_stats.GetAverageIterations());
+        }
+
+    private:
+        /// <summary>
+        /// Fills m_order with query indices sorted by Morton code of the chunk that contains the segment start.
+        /// Ties are broken by index, so the order is deterministic.
+        /// </summary>
+        void SortByChunk(const glm::vec3* from, size_t count) {
+            glm::ivec3 world_size = m_caster.GetWorldSize();
+            glm::ivec3 max_chunk = (world_size >> RayCaster::CHUNK_MAX_LOD) - 1;
+
+            m_keys.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                glm::ivec3 cell = glm::ivec3(glm::floor(from[i] * RayCaster::VOXEL_SIZE_INV + glm::vec3(world_size) * 0.5f));
+                glm::ivec3 chunk = glm::clamp(cell >> RayCaster::CHUNK_MAX_LOD, glm::ivec3(0), max_chunk);
+                m_keys[i] = {MortonCode(chunk), i};
+            }
+            std::sort(m_keys.begin(), m_keys.end());
+
+            m_order.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                m_order[i] = m_keys[i].second;
+            }
+        }
+
+        static uint64_t MortonCode(glm::ivec3 pos) {
+            uint64_t code = 0;
+            for (int bit = 0; bit < 21; bit++) {
+                code |= (uint64_t) ((pos.x >> bit) & 1) << (3 * bit + 2);
+                code |= (uint64_t) ((pos.y >> bit) & 1) << (3 * bit + 1);
+                code |= (uint64_t) ((pos.z >> bit) & 1) << (3 * bit);
+            }
+            return code;
+        }
+
+        const RayCaster& m_caster;
+
+        ThreadPool& m_pool;
+
+        std::vector<std::pair<uint64_t, size_t>> m_keys;
+        std::vector<size_t> m_order;
+
+        Stats m_stats;
+    };
+
+    using VisibilityQueryBatch = VisibilityQueryBatchT<uint32_t>;
+
+}
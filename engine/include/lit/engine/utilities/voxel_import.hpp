@@ -0,0 +1,143 @@
+#pragma once
+
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/engine/utilities/mapped_file.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// MagicaVoxel .vox file: models (at most 256^3 voxels each, stored as lists of voxels with palette indices)
+    /// placed by the scene graph of nTRN/nGRP/nSHP nodes, files without scene graph place all models at the origin.
+    /// The file is mapped, so opening it only reads the structure. The .vox Z axis (up) becomes the grid Y axis,
+    /// a .vox point (x, y, z) goes to (x, z, -y). Palette colors are stored as 0xRRGGBB values.
+    /// </summary>
+    class VoxFile {
+    public:
+        using VoxelGrid = VoxelGridSparseT<uint32_t>;
+
+        /// <summary>
+        /// Maps the file at @path and reads its models, palette and scene graph.
+        /// Throws std::runtime_error if the file can't be opened or is malformed.
+        /// </summary>
+        static std::shared_ptr<VoxFile> Open(const std::string &path);
+
+        /// <summary>
+        /// Writes all chunks of @grid as models of up to 256^3 voxels. Files hold 255 colors, if the grid has more
+        /// of them, they are reduced by dropping low bits of the channels.
+        /// </summary>
+        static void Save(const std::string &path, VoxelGrid &grid);
+
+        /// <summary>
+        /// Minimum corner of the placed models, in grid axes.
+        /// </summary>
+        glm::ivec3 GetMin() const {
+            return m_min;
+        }
+
+        /// <summary>
+        /// Size of the box that contains all placed models, in grid axes.
+        /// </summary>
+        glm::ivec3 GetDimensions() const {
+            return m_max - m_min;
+        }
+
+        size_t GetModelsCount() const {
+            return m_models.size();
+        }
+
+        size_t GetInstancesCount() const {
+            return m_instances.size();
+        }
+
+        /// <summary>
+        /// Writes the voxels of all placed models into @grid, the minimum corner goes to @offset,
+        /// voxels outside of the grid are dropped. Models are written in parallel straight into chunk buffers,
+        /// so besides the chunks it only takes the mapping of the file. Touched chunks of @grid are replaced
+        /// by chunks with the merged voxels (chunk deleted and created callbacks are invoked).
+        /// </summary>
+        void Import(VoxelGrid &grid, const glm::ivec3 &offset) const;
+
+    private:
+        struct Model {
+            glm::ivec3 size;
+            // Groups of x, y, z and palette index bytes
+            const uint8_t *voxels;
+            uint32_t count;
+        };
+
+        /// <summary>
+        /// Rotations of .vox files only permute and flip axes: component i of the result is signs[i] * v[axes[i]].
+        /// </summary>
+        struct AxisRotation {
+            glm::ivec3 axes{0, 1, 2};
+            glm::ivec3 signs{1, 1, 1};
+
+            glm::ivec3 operator*(const glm::ivec3 &v) const {
+                return {signs.x * v[axes.x], signs.y * v[axes.y], signs.z * v[axes.z]};
+            }
+
+            AxisRotation operator*(const AxisRotation &other) const {
+                AxisRotation result;
+                for (int i = 0; i < 3; i++) {
+                    result.axes[i] = other.axes[axes[i]];
+                    result.signs[i] = signs[i] * other.signs[axes[i]];
+                }
+                return result;
+            }
+
+            /// <summary>
+            /// Rotation of nTRN frames: bits 0-1 and 2-3 are the columns of the non-zero entries of the first two
+            /// rows of the matrix, bits 4-6 are the signs of the rows.
+            /// </summary>
+            static AxisRotation Decode(uint8_t bits);
+        };
+
+        // Model voxel v goes to rotation * v + translation in grid axes
+        struct Instance {
+            uint32_t model;
+            AxisRotation rotation;
+            glm::ivec3 translation;
+            glm::ivec3 min;
+            glm::ivec3 max;
+        };
+
+        explicit VoxFile(const std::string &path);
+
+        std::unique_ptr<MappedFile> m_file;
+        std::vector<Model> m_models;
+        std::vector<Instance> m_instances;
+        std::array<uint32_t, 256> m_palette{};
+        glm::ivec3 m_min{};
+        glm::ivec3 m_max{};
+    };
+
+    /// <summary>
+    /// Layout of a raw voxel volume: values go along X first, then Y, then Z.
+    /// </summary>
+    struct RawVolumeFormat {
+        glm::ivec3 dimensions{};
+        // 1, 2 or 4 bytes per little-endian value, 0 for whitespace separated decimal values (text dumps)
+        int bytes_per_voxel = 1;
+        // If not empty, values are indices into the palette (values beyond it are empty), otherwise colors
+        std::vector<uint32_t> palette;
+    };
+
+    class RawVolume {
+    public:
+        using VoxelGrid = VoxelGridSparseT<uint32_t>;
+
+        /// <summary>
+        /// Reads the volume at @path row by row and writes its non-empty voxels into @grid with the volume origin
+        /// at @offset. Only chunks that receive voxels are allocated, so the volume is never held in memory densely.
+        /// Throws std::runtime_error if the file can't be read or is shorter than the volume.
+        /// </summary>
+        static void Import(const std::string &path, const RawVolumeFormat &format, VoxelGrid &grid,
+                           const glm::ivec3 &offset);
+    };
+
+}
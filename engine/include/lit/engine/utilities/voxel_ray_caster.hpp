@@ -0,0 +1,507 @@
+#pragma once
+
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse_lod_data.hpp>
+#include <glm/vec3.hpp>
+#include <algorithm>
+#include <vector>
+#include <bit>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// CPU implementation of the voxel world traversal from ray_tracing_voxel_world.glsl.
+    /// It walks the same chunk grid LOD pyramid and binary chunk LODs (see <see cref="VoxelGridSparseLodDataT"/>)
+    /// with the same hierarchical DDA, so results can be compared against the shader one to one.
+    /// Use it for picking and visibility queries on the CPU.
+    /// </summary>
+    /// <remarks>
+    /// All chunks are assumed to be stored with full resolution (bucket 0 on the GPU side).
+    /// LOD data must be committed (see <see cref="VoxelGridLodManager"/>) before the caster is created,
+    /// the caster keeps references to the grid and its LOD data and must not outlive them.
+    /// </remarks>
+    /// <typeparam name="VoxelType">Type of voxel data</typeparam>
+    template<typename VoxelType>
+    class VoxelRayCasterT {
+    public:
+        using VoxelGrid = VoxelGridSparseT<VoxelType>;
+        using VoxelGridLod = VoxelGridSparseLodDataT<VoxelType>;
+        using ChunkIndexType = typename VoxelGrid::ChunkIndexType;
+
+        inline static const float VOXEL_SIZE = 1.0f / 16.0f;
+        inline static const float VOXEL_SIZE_INV = 16.0f;
+
+        inline static const int CHUNK_MAX_LOD = VoxelGrid::CHUNK_SIZE_LOG;
+
+        /// <summary>
+        /// Mirrors RayCastResult from the shader. Position and depth are in object-space, cell is in voxels.
+        /// </summary>
+        struct RayCastResult {
+            bool hit = false; // has hit any non-zero voxel?
+            VoxelType voxel_data = 0;
+            glm::vec3 position = glm::vec3(0.0f); // hit position in object-space
+            glm::ivec3 cell = glm::ivec3(0); // coordinates of the voxel that was hit
+            float depth = 0.0f; // distance the ray traveled before the hit
+            glm::ivec3 normal = glm::ivec3(0);
+            int iterations = 0;
+        };
+
+        VoxelRayCasterT(const VoxelGrid& grid, const VoxelGridLod& grid_lod)
+            : m_grid(grid), m_grid_lod(grid_lod), m_world_size(grid.GetDimensions()) {
+            glm::ivec3 chunk_grid_dimensions = grid.GetChunkGridDimensions();
+
+            // Do not go above the level where the smallest axis of the chunk grid collapses to a single cell
+            m_max_lod = CHUNK_MAX_LOD + std::countr_zero((uint32_t)glm::compMin(chunk_grid_dimensions));
+            m_max_lod = std::min(m_max_lod, grid_lod.m_total_lod);
+
+            for (int lod = 0; lod <= m_max_lod - CHUNK_MAX_LOD; lod++) {
+                m_grid_lod_offset.push_back(GetLodTotalSize(chunk_grid_dimensions, 0, lod - 1));
+                m_grid_lod_dimensions.push_back(chunk_grid_dimensions >> lod);
+            }
+
+            for (int lod = 0; lod <= CHUNK_MAX_LOD; lod++) {
+                m_chunk_lod_bit_offset[lod] = GetLodTotalSize(VoxelGrid::GetChunkDimensions(), 0, lod - 1);
+            }
+            m_chunk_binary_size_dword = (GetLodTotalSize(VoxelGrid::GetChunkDimensions(), 0, CHUNK_MAX_LOD) + 31) / 32;
+
+            SetUseDistanceField(true);
+        }
+
+        /// <summary>
+        /// Skip empty space with the distance fields of the LOD data (if they were built, see
+        /// <see cref="VoxelGridSparseLodDataT::m_distance_field_enabled"/>). The same voxels are hit, only
+        /// the number of iterations changes.
+        /// </summary>
+        void SetUseDistanceField(bool use) {
+            m_use_distance_field = use && m_grid_lod.m_distance_field_enabled && !m_grid_lod.m_grid_distance_data.empty();
+        }
+
+        bool GetUseDistanceField() const {
+            return m_use_distance_field;
+        }
+
+        /// <summary>
+        /// Highest LOD the traversal starts from.
+        /// </summary>
+        int GetMaxLod() const {
+            return m_max_lod;
+        }
+
+        /// <summary>
+        /// Intersects ray with the bounding box of the world. Distance to the box is returned in object-space.
+        /// </summary>
+        bool WorldHitBox(glm::vec3 origin, glm::vec3 dir, float& distance) const {
+            glm::vec3 world_size = glm::vec3(m_world_size);
+            origin = origin * VOXEL_SIZE_INV + world_size * 0.5f;
+            glm::vec3 t1 = (-origin) / dir;
+            glm::vec3 t2 = (world_size - origin) / dir;
+            glm::vec3 tin = glm::min(t1, t2);
+            glm::vec3 tout = glm::max(t1, t2);
+            float tmin = glm::compMax(tin);
+            float tmax = glm::compMin(tout);
+            distance = std::max(tmin, 0.0f) * VOXEL_SIZE;
+            return tmax >= 0 && tmin <= tmax;
+        }
+
+        /// <summary>
+        /// Traversal state of a single ray. All vectors are in local world coordinates (voxels)
+        /// with axes inversed so that the ray direction is positive.
+        /// </summary>
+        struct RayState {
+            glm::vec3 origin = glm::vec3(0.0f);
+            glm::vec3 dir = glm::vec3(0.0f);
+            glm::vec3 ray_direction_inversed = glm::vec3(0.0f); // to speed up division
+            glm::vec3 shifted_ray_origin = glm::vec3(0.0f); // ray origin is shifted each step to reduce floating point errors
+            glm::vec3 time = glm::vec3(0.0f); // time when we can hit a plane (Y-0-Z, X-0-Z, Y-0-X planes)
+            glm::ivec3 cell = glm::ivec3(0);
+            glm::ivec3 axes_inversed = glm::ivec3(0);
+            VoxelType voxel_data = 0;
+            int lod = 0;
+            int iteration = 0;
+            bool hit = false;
+        };
+
+        /// <summary>
+        /// Casts a ray through the world, origin and direction are in object-space.
+        /// Traversal stops at the first non-empty voxel or after @max_iterations steps.
+        /// </summary>
+        RayCastResult WorldRayCast(glm::vec3 origin, glm::vec3 dir, int max_iterations) const {
+            RayState state = BeginRayCast(origin, dir);
+            for (; IsTraversing(state, max_iterations); state.iteration++) {
+                if (VisitCell(ApplyInverse(state.cell, state.axes_inversed), state.lod, state.voxel_data)) {
+                    state.hit = true;
+                    break;
+                }
+                AdvanceRay(state);
+            }
+            return FinishRayCast(state);
+        }
+
+        /// <summary>
+        /// Casts a ray from @from to @to (both in object-space), traversal stops as soon as the ray passes @to.
+        /// Hit is reported only for a voxel that the ray enters before @to, depth is measured from @from.
+        /// </summary>
+        RayCastResult WorldSegmentCast(glm::vec3 from, glm::vec3 to, int max_iterations) const {
+            RayCastResult res;
+            res.position = to;
+
+            float length = glm::length(to - from);
+            if (length <= 0.0f) {
+                return res;
+            }
+
+            glm::vec3 dir = (to - from) / length;
+            float distance;
+            if (!WorldHitBox(from, dir, distance) || distance >= length) {
+                res.depth = length;
+                return res;
+            }
+
+            RayState state = BeginRayCast(from + dir * (distance + 1e-6f), dir);
+            float max_distance = (length - distance) * VOXEL_SIZE_INV;
+            for (; IsTraversing(state, max_iterations) &&
+                   glm::dot(state.shifted_ray_origin - state.origin, state.dir) < max_distance; state.iteration++) {
+                if (VisitCell(ApplyInverse(state.cell, state.axes_inversed), state.lod, state.voxel_data)) {
+                    state.hit = true;
+                    break;
+                }
+                AdvanceRay(state);
+            }
+
+            res = FinishRayCast(state);
+            res.depth += distance;
+            return res;
+        }
+
+        /// <summary>
+        /// Transforms ray to local world coordinates and makes the first step if the origin is outside of the world.
+        /// </summary>
+        RayState BeginRayCast(glm::vec3 origin, glm::vec3 dir) const {
+            RayState state;
+
+            // Transform to local world coordinates!
+            origin = origin * VOXEL_SIZE_INV + glm::vec3(m_world_size) * 0.5f;
+
+            // ray_direction should be positive, inverse axes if needed
+            glm::ivec3 signs = glm::ivec3(glm::sign(dir));
+            // zero -> one
+            signs = (1 - glm::abs(signs)) + signs;
+            state.axes_inversed = (1 - signs) >> 1;
+
+            state.origin = ApplyInverse(origin, state.axes_inversed);
+            state.dir = glm::normalize(glm::abs(dir) + 1e-6f);
+
+            state.ray_direction_inversed = 1.0f / state.dir;
+            state.shifted_ray_origin = state.origin;
+            state.cell = glm::ivec3(glm::floor(state.origin));
+            state.lod = m_max_lod;
+
+            // first step, if we are outside of the boundaries
+            if (glm::any(glm::lessThan(state.cell, glm::ivec3(0)))) {
+                state.time = (glm::vec3((state.cell | ((1 << state.lod) - 1)) + 1) - state.shifted_ray_origin) *
+                             state.ray_direction_inversed;
+                state.shifted_ray_origin += (glm::compMin(state.time) + 1e-4f) * state.dir;
+                state.cell = glm::ivec3(glm::floor(state.shifted_ray_origin));
+            }
+
+            return state;
+        }
+
+        bool IsTraversing(const RayState& state, int max_iterations) const {
+            return state.iteration < max_iterations && glm::all(glm::lessThan(state.cell, m_world_size));
+        }
+
+        /// <summary>
+        /// Descends LODs at @cell_real (cell in non-inversed coordinates) while the region is non-empty.
+        /// Returns true and writes @voxel_data if the voxel itself is non-empty,
+        /// otherwise @lod is the level of the empty region the ray can skip.
+        /// </summary>
+        bool VisitCell(glm::ivec3 cell_real, int& lod, VoxelType& voxel_data) const {
+            while (lod >= CHUNK_MAX_LOD && HasChunk(cell_real, lod)) {
+                lod--;
+            }
+
+            if (lod < CHUNK_MAX_LOD) {
+                ChunkIndexType chunk_index = GetChunk(cell_real, CHUNK_MAX_LOD);
+                while (lod > 0 && HasVoxel(chunk_index, cell_real, lod)) {
+                    lod--;
+                }
+                if (lod == 0 && (voxel_data = GetVoxel(chunk_index, cell_real)) != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// Moves the ray to the next region of size 2^lod and picks LOD to start the next descent from.
+        /// </summary>
+        void AdvanceRay(RayState& state) const {
+            state.time = (glm::vec3((state.cell | ((1 << state.lod) - 1)) + 1) - state.shifted_ray_origin) *
+                         state.ray_direction_inversed;
+            if (m_use_distance_field) {
+                // Both regions are empty, so the ray can leave the one it stays in longer
+                glm::vec3 time = (glm::vec3(GetEmptyRegionEnd(state.cell, state.axes_inversed, state.lod)) -
+                                  state.shifted_ray_origin) * state.ray_direction_inversed;
+                if (glm::compMin(time) > glm::compMin(state.time)) {
+                    state.time = time;
+                }
+            }
+            state.shifted_ray_origin += (glm::compMin(state.time) + 1e-5f) * state.dir;
+
+            state.cell = glm::ivec3(glm::floor(state.shifted_ray_origin));
+
+            state.lod = std::clamp(std::max({FindLSB(state.cell.x), FindLSB(state.cell.y), FindLSB(state.cell.z)}),
+                                   0, m_max_lod);
+        }
+
+        RayCastResult FinishRayCast(const RayState& state) const {
+            const glm::vec3& time = state.time;
+            glm::ivec3 axes_inversed = state.axes_inversed;
+
+            RayCastResult res;
+            res.voxel_data = state.hit ? state.voxel_data : 0;
+            res.cell = ApplyInverse(state.cell, axes_inversed);
+            res.position = (ApplyInverse(state.shifted_ray_origin, axes_inversed) - glm::vec3(m_world_size) * 0.5f) *
+                           VOXEL_SIZE;
+            res.hit = state.hit;
+            res.depth = glm::dot(state.shifted_ray_origin - state.origin, state.dir) * VOXEL_SIZE;
+
+            // Normal compute
+            res.normal = glm::ivec3(glm::step(state.origin, YZX(state.origin)) * glm::step(state.origin, ZXY(state.origin)));
+
+            if (state.iteration > 0) {
+                res.normal = glm::ivec3(RStep(time, YZX(time)) * RStep(time, ZXY(time)));
+
+                // To remove on-edge artefacts
+                glm::ivec3 next = state.cell - res.normal;
+                glm::ivec3 next_real = ApplyInverse(next, axes_inversed);
+                if (IsInside(next_real)) {
+                    if (HasVoxel(GetChunk(next_real, CHUNK_MAX_LOD), next_real, 0)) {
+                        glm::vec3 second_normal = RStep(YZX(time), time) * RStep(time, ZXY(time)) +
+                                                  RStep(ZXY(time), time) * RStep(time, YZX(time));
+                        float tmin = glm::dot(glm::vec3(res.normal), time);
+                        float tnext = glm::dot(second_normal, time);
+                        if (tnext - tmin < 1e-3f && tmin < tnext) {
+                            res.normal = glm::ivec3(second_normal);
+                        }
+                    }
+                }
+            }
+
+            res.normal *= (2 * axes_inversed - 1);
+
+            res.iterations = state.iteration;
+            return res;
+        }
+
+        /// <summary>
+        /// Approximate distance along the cone to the first non-empty region, mirrors WorldConeCast from the shader.
+        /// @distance is the distance (in voxels) the cone has already traveled, @slope is the cone radius per unit.
+        /// </summary>
+        float WorldConeCast(glm::vec3 origin, glm::vec3 dir, float distance, float slope) const {
+            glm::vec3 world_size = glm::vec3(m_world_size);
+
+            // Transform to local world coordinates!
+            origin = origin * VOXEL_SIZE_INV + world_size * 0.5f;
+
+            float current_radius = std::max(1.0f, distance * slope * 1.5f);
+
+            glm::vec3 initial_origin = origin;
+
+            origin += dir * current_radius;
+
+            int lod = 0;
+
+            float dist_prev = 0.0f;
+
+            for (int iteration = 0; iteration < 256; iteration++) {
+                float dist = glm::dot(origin - initial_origin, dir);
+                glm::ivec3 cell0 = glm::ivec3(origin);
+
+                if (!IsInside(cell0)) {
+                    return glm::length(world_size);
+                }
+
+                while ((1 << lod) < current_radius * 2) {
+                    lod++;
+                }
+
+                glm::ivec3 axis_dirs = glm::ivec3(glm::sign(origin / (float) (1 << lod) - glm::vec3(cell0 >> lod) - 0.5f));
+
+                bool any = false;
+                for (int i = 0; i < 8 && !any; i++) {
+                    glm::ivec3 corner = glm::ivec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+                    any = HasVoxelSlow(((cell0 >> lod) + axis_dirs * corner) << lod, lod);
+                }
+
+                if (any) {
+                    return dist_prev - current_radius;
+                }
+
+                float d = (distance + dist) * slope;
+                float a = (slope * slope + 1);
+                float b = 2 * d * slope;
+                float c = d * d - current_radius * current_radius;
+                float d_sqr = b * b - 4 * a * c;
+                if (d_sqr < 0) {
+                    return 0.0f;
+                }
+                float x = (-b + std::sqrt(d_sqr)) / a;
+                float d2 = d + x * slope;
+                current_radius = std::max(current_radius, d2 * 1.2f);
+                float y = std::sqrt(current_radius * current_radius - d2 * d2);
+                current_radius = std::max(current_radius, (d2 + y * slope) * 1.2f);
+                origin += dir * (x + y);
+                dist_prev = dist;
+            }
+
+            return dist_prev;
+        }
+
+        /// <summary>
+        /// Index of the chunk that contains @cell, or zero chunk if there is no such chunk.
+        /// If @lod is higher than <see cref="CHUNK_MAX_LOD"/>, returns value of the chunk grid LOD.
+        /// Non-zero value at the chunk grid LOD means that there is at least one chunk in the region.
+        /// </summary>
+        ChunkIndexType GetChunk(glm::ivec3 cell, int lod) const {
+            if (!IsInside(cell)) {
+                return VoxelGrid::CHUNK_EMPTY;
+            }
+            int grid_lod = lod - CHUNK_MAX_LOD;
+            glm::ivec3 pos = cell >> lod;
+            glm::ivec3 dims = m_grid_lod_dimensions[grid_lod];
+            return m_grid_lod.m_grid_lod_data[m_grid_lod_offset[grid_lod] + ((size_t) pos.x * dims.y + pos.y) * dims.z + pos.z];
+        }
+
+        bool HasChunk(glm::ivec3 cell, int lod) const {
+            ChunkIndexType val = GetChunk(cell, lod);
+            return val != VoxelGrid::CHUNK_EMPTY && val != ~VoxelGrid::CHUNK_EMPTY;
+        }
+
+        /// <summary>
+        /// Checks bit of the binary LOD @lod of the chunk @chunk that covers @cell.
+        /// </summary>
+        bool HasVoxel(ChunkIndexType chunk, glm::ivec3 cell, int lod) const {
+            if (chunk == VoxelGrid::CHUNK_EMPTY) {
+                return false;
+            }
+            cell = (cell & (VoxelGrid::CHUNK_SIZE - 1)) >> lod;
+            int lod_size_log = CHUNK_MAX_LOD - lod;
+            size_t bit_index = m_chunk_lod_bit_offset[lod] +
+                               cell.z + (cell.y << lod_size_log) + (cell.x << (lod_size_log << 1));
+            size_t offset = m_chunk_binary_size_dword * chunk + (bit_index >> 5);
+            return (m_grid_lod.m_chunk_binary_lod_data[offset] >> (bit_index & 31)) & 1;
+        }
+
+        /// <summary>
+        /// Same as HasVoxel, but also looks up the chunk and checks the bounds.
+        /// </summary>
+        bool HasVoxelSlow(glm::ivec3 cell, int lod) const {
+            if (!IsInside(cell)) {
+                return false;
+            }
+            if (lod < CHUNK_MAX_LOD) {
+                return HasVoxel(GetChunk(cell, CHUNK_MAX_LOD), cell, lod);
+            }
+            return HasChunk(cell, std::min(lod, m_max_lod));
+        }
+
+        VoxelType GetVoxel(ChunkIndexType chunk, glm::ivec3 cell) const {
+            if (chunk == VoxelGrid::CHUNK_EMPTY) {
+                return 0;
+            }
+            return m_grid.GetChunkViewAsArray(chunk).At(cell & (VoxelGrid::CHUNK_SIZE - 1));
+        }
+
+        /// <summary>
+        /// End (exclusive, in inversed coordinates) of the empty cube around @cell (inversed coordinates)
+        /// from the distance fields, @lod is the level of the empty region found by <see cref="VisitCell"/>.
+        /// Above the chunk level the chunk grid distance field is used, otherwise the distance field of the chunk,
+        /// clipped by the chunk bounds. Returns cell + 1 if there is no empty cube around the cell.
+        /// </summary>
+        glm::ivec3 GetEmptyRegionEnd(glm::ivec3 cell, glm::ivec3 axes_inversed, int lod) const {
+            glm::ivec3 cell_real = ApplyInverse(cell, axes_inversed);
+            if (!IsInside(cell_real)) {
+                return cell + 1;
+            }
+
+            if (lod >= CHUNK_MAX_LOD) {
+                glm::ivec3 chunk = cell_real >> CHUNK_MAX_LOD;
+                glm::ivec3 dims = m_grid_lod_dimensions[0];
+                int distance = m_grid_lod.m_grid_distance_data[((size_t) chunk.x * dims.y + chunk.y) * dims.z + chunk.z];
+                if (distance == 0) {
+                    return cell + 1;
+                }
+                return ((cell >> CHUNK_MAX_LOD) + distance) << CHUNK_MAX_LOD;
+            }
+
+            const int df_lod = VoxelGridLod::DISTANCE_FIELD_LOD;
+            const int df_size_log = CHUNK_MAX_LOD - df_lod;
+            ChunkIndexType chunk_index = GetChunk(cell_real, CHUNK_MAX_LOD);
+            glm::ivec3 df_cell = (cell_real & (VoxelGrid::CHUNK_SIZE - 1)) >> df_lod;
+            size_t offset = chunk_index * VoxelGridLod::GetChunkDistanceSize() +
+                            ((df_cell.x << (df_size_log * 2)) | (df_cell.y << df_size_log) | df_cell.z);
+            int distance = m_grid_lod.m_chunk_distance_data[offset];
+            if (distance == 0) {
+                return cell + 1;
+            }
+            return glm::min(((cell >> df_lod) + distance) << df_lod, (cell | (VoxelGrid::CHUNK_SIZE - 1)) + 1);
+        }
+
+        bool IsInside(glm::ivec3 cell) const {
+            return glm::all(glm::greaterThanEqual(cell, glm::ivec3(0))) && glm::all(glm::lessThan(cell, m_world_size));
+        }
+
+        /// <summary>
+        /// Mirrors coordinates along the inversed axes, the operation is its own inverse.
+        /// </summary>
+        glm::ivec3 ApplyInverse(glm::ivec3 cell, glm::ivec3 inversed) const {
+            return cell * (1 - inversed) + ((m_world_size - 1) - cell) * inversed;
+        }
+
+        glm::vec3 ApplyInverse(glm::vec3 pos, glm::ivec3 inversed) const {
+            return pos + glm::vec3(inversed) * (glm::vec3(m_world_size) - pos * 2.0f);
+        }
+
+        glm::ivec3 GetWorldSize() const {
+            return m_world_size;
+        }
+
+    private:
+
+        // findLSB from GLSL, returns -1 for zero
+        static int FindLSB(int value) {
+            return value == 0 ? -1 : std::countr_zero((uint32_t) value);
+        }
+
+        static glm::vec3 RStep(glm::vec3 a, glm::vec3 b) {
+            return glm::step(-b, -a);
+        }
+
+        static glm::vec3 YZX(glm::vec3 v) {
+            return {v.y, v.z, v.x};
+        }
+
+        static glm::vec3 ZXY(glm::vec3 v) {
+            return {v.z, v.x, v.y};
+        }
+
+        const VoxelGrid& m_grid;
+        const VoxelGridLod& m_grid_lod;
+
+        glm::ivec3 m_world_size;
+        int m_max_lod = 0;
+
+        std::vector<size_t> m_grid_lod_offset;
+        std::vector<glm::ivec3> m_grid_lod_dimensions;
+
+        size_t m_chunk_lod_bit_offset[CHUNK_MAX_LOD + 1] = {};
+        size_t m_chunk_binary_size_dword = 0;
+
+        bool m_use_distance_field = false;
+    };
+
+    using VoxelRayCaster = VoxelRayCasterT<uint32_t>;
+
+}
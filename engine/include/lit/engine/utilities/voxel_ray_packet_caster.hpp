@@ -0,0 +1,232 @@
+#pragma once
+
+#include <lit/engine/utilities/voxel_ray_caster.hpp>
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Traces rays in packets of <see cref="PACKET_SIZE"/> on top of <see cref="VoxelRayCasterT"/>.
+    /// DDA stepping (plane distances, shift of the origin, next cell and its LOD) is done for all lanes at once
+    /// with AVX2, LOD descent is done per lane since every lane reads different chunks.
+    /// Lanes that hit something or leave the world are masked out. When the packet diverges and only a few lanes are
+    /// still active, remaining rays are finished one by one with the single ray traversal.
+    /// Results are the same as with <see cref="VoxelRayCasterT::WorldRayCast"/>.
+    /// </summary>
+    /// <typeparam name="VoxelType">Type of voxel data</typeparam>
+    template<typename VoxelType>
+    class VoxelRayPacketCasterT {
+    public:
+        using RayCaster = VoxelRayCasterT<VoxelType>;
+        using RayCastResult = typename RayCaster::RayCastResult;
+        using RayState = typename RayCaster::RayState;
+
+        inline static const int PACKET_SIZE = 8;
+
+        /// <summary>
+        /// Packet is traced with SIMD while it has more than this number of active lanes.
+        /// </summary>
+        inline static const int MIN_ACTIVE_LANES = 2;
+
+        explicit VoxelRayPacketCasterT(const RayCaster& caster) : m_caster(caster) {}
+
+        /// <summary>
+        /// Casts @count (at most <see cref="PACKET_SIZE"/>) rays, origins and directions are in object-space.
+        /// Rays in a packet should be coherent (e.g. neighbouring pixels) to benefit from SIMD.
+        /// </summary>
+        void WorldRayCastPacket(const glm::vec3* origins, const glm::vec3* dirs, int count, int max_iterations,
+                                RayCastResult* results) const {
+            assert(count <= PACKET_SIZE);
+
+            RayState states[PACKET_SIZE];
+            uint32_t active = 0;
+            for (int lane = 0; lane < count; lane++) {
+                states[lane] = m_caster.BeginRayCast(origins[lane], dirs[lane]);
+                active |= 1u << lane;
+            }
+
+#if defined(__AVX2__)
+            PacketState packet;
+            packet.Load(states, count);
+            const bool use_distance_field = m_caster.GetUseDistanceField();
+
+            while (std::popcount(active) > MIN_ACTIVE_LANES) {
+                for (uint32_t lanes = active; lanes; lanes &= lanes - 1) {
+                    int lane = std::countr_zero(lanes);
+                    glm::ivec3 cell = glm::ivec3(packet.cell[0][lane], packet.cell[1][lane], packet.cell[2][lane]);
+                    bool traversing = packet.iteration[lane] < max_iterations &&
+                                      glm::all(glm::lessThan(cell, m_caster.GetWorldSize()));
+                    if (!traversing) {
+                        active &= ~(1u << lane);
+                        continue;
+                    }
+                    if (m_caster.VisitCell(m_caster.ApplyInverse(cell, states[lane].axes_inversed), packet.lod[lane],
+                                           states[lane].voxel_data)) {
+                        states[lane].hit = true;
+                        active &= ~(1u << lane);
+                    } else if (use_distance_field) {
+                        glm::ivec3 end = m_caster.GetEmptyRegionEnd(cell, states[lane].axes_inversed, packet.lod[lane]);
+                        for (int axis = 0; axis < 3; axis++) {
+                            packet.region_end[axis][lane] = end[axis];
+                        }
+                    }
+                }
+                packet.Advance(active, m_caster.GetMaxLod(), use_distance_field);
+            }
+
+            packet.Store(states, count);
+#endif
+
+            for (int lane = 0; lane < count; lane++) {
+                RayState& state = states[lane];
+                if (active & (1u << lane)) {
+                    for (; m_caster.IsTraversing(state, max_iterations); state.iteration++) {
+                        if (m_caster.VisitCell(m_caster.ApplyInverse(state.cell, state.axes_inversed), state.lod,
+                                               state.voxel_data)) {
+                            state.hit = true;
+                            break;
+                        }
+                        m_caster.AdvanceRay(state);
+                    }
+                }
+                results[lane] = m_caster.FinishRayCast(state);
+            }
+        }
+
+        /// <summary>
+        /// Casts all rays, splitting them into consecutive packets.
+        /// </summary>
+        void WorldRayCast(const glm::vec3* origins, const glm::vec3* dirs, size_t count, int max_iterations,
+                          RayCastResult* results) const {
+            for (size_t i = 0; i < count; i += PACKET_SIZE) {
+                int packet_size = (int) std::min<size_t>(PACKET_SIZE, count - i);
+                WorldRayCastPacket(origins + i, dirs + i, packet_size, max_iterations, results + i);
+            }
+        }
+
+    private:
+
+#if defined(__AVX2__)
+        /// <summary>
+        /// Structure of arrays copy of the lane states that are changed by the DDA step.
+        /// </summary>
+        struct PacketState {
+            alignas(32) float shifted_ray_origin[3][PACKET_SIZE] = {};
+            alignas(32) float dir[3][PACKET_SIZE] = {};
+            alignas(32) float ray_direction_inversed[3][PACKET_SIZE] = {};
+            alignas(32) float time[3][PACKET_SIZE] = {};
+            alignas(32) int cell[3][PACKET_SIZE] = {};
+            alignas(32) int region_end[3][PACKET_SIZE] = {}; // end of the empty region from the distance fields
+            alignas(32) int lod[PACKET_SIZE] = {};
+            alignas(32) int iteration[PACKET_SIZE] = {};
+
+            void Load(const RayState* states, int count) {
+                for (int lane = 0; lane < count; lane++) {
+                    for (int axis = 0; axis < 3; axis++) {
+                        shifted_ray_origin[axis][lane] = states[lane].shifted_ray_origin[axis];
+                        dir[axis][lane] = states[lane].dir[axis];
+                        ray_direction_inversed[axis][lane] = states[lane].ray_direction_inversed[axis];
+                        time[axis][lane] = states[lane].time[axis];
+                        cell[axis][lane] = states[lane].cell[axis];
+                    }
+                    lod[lane] = states[lane].lod;
+                    iteration[lane] = states[lane].iteration;
+                }
+            }
+
+            void Store(RayState* states, int count) const {
+                for (int lane = 0; lane < count; lane++) {
+                    for (int axis = 0; axis < 3; axis++) {
+                        states[lane].shifted_ray_origin[axis] = shifted_ray_origin[axis][lane];
+                        states[lane].time[axis] = time[axis][lane];
+                        states[lane].cell[axis] = cell[axis][lane];
+                    }
+                    states[lane].lod = lod[lane];
+                    states[lane].iteration = iteration[lane];
+                }
+            }
+
+            /// <summary>
+            /// Same as <see cref="VoxelRayCasterT::AdvanceRay"/> for all lanes in @active mask.
+            /// Plain mul + add is used on purpose (no FMA) to keep results equal to the scalar traversal, which in turn
+            /// must be built without floating point contraction (the MSVC default, -ffp-contract=off for GCC/Clang).
+            /// </summary>
+            void Advance(uint32_t active, int max_lod, bool use_distance_field) {
+                const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+                const __m256i active_mask = _mm256_cmpeq_epi32(
+                        _mm256_and_si256(_mm256_set1_epi32((int) active), lane_bits), lane_bits);
+                const __m256i one = _mm256_set1_epi32(1);
+                const __m256 epsilon = _mm256_set1_ps(1e-5f);
+
+                __m256i lod_v = _mm256_load_si256((const __m256i*) lod);
+                __m256i lod_mask = _mm256_sub_epi32(_mm256_sllv_epi32(one, lod_v), one);
+
+                __m256 t[3];
+                for (int axis = 0; axis < 3; axis++) {
+                    __m256i c = _mm256_load_si256((const __m256i*) cell[axis]);
+                    __m256 plane = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_or_si256(c, lod_mask), one));
+                    t[axis] = _mm256_mul_ps(_mm256_sub_ps(plane, _mm256_load_ps(shifted_ray_origin[axis])),
+                                            _mm256_load_ps(ray_direction_inversed[axis]));
+                }
+                __m256 t_min = _mm256_min_ps(t[0], _mm256_min_ps(t[1], t[2]));
+
+                if (use_distance_field) {
+                    __m256 t_region[3];
+                    for (int axis = 0; axis < 3; axis++) {
+                        __m256 plane = _mm256_cvtepi32_ps(_mm256_load_si256((const __m256i*) region_end[axis]));
+                        t_region[axis] = _mm256_mul_ps(_mm256_sub_ps(plane, _mm256_load_ps(shifted_ray_origin[axis])),
+                                                       _mm256_load_ps(ray_direction_inversed[axis]));
+                    }
+                    __m256 t_region_min = _mm256_min_ps(t_region[0], _mm256_min_ps(t_region[1], t_region[2]));
+                    __m256 further = _mm256_cmp_ps(t_region_min, t_min, _CMP_GT_OQ);
+                    for (int axis = 0; axis < 3; axis++) {
+                        t[axis] = _mm256_blendv_ps(t[axis], t_region[axis], further);
+                    }
+                    t_min = _mm256_blendv_ps(t_min, t_region_min, further);
+                }
+
+                __m256 step = _mm256_add_ps(t_min, epsilon);
+
+                __m256i next_lod = _mm256_set1_epi32(-1);
+                for (int axis = 0; axis < 3; axis++) {
+                    __m256 origin = _mm256_load_ps(shifted_ray_origin[axis]);
+                    __m256 shifted = _mm256_add_ps(origin, _mm256_mul_ps(step, _mm256_load_ps(dir[axis])));
+                    __m256i c = _mm256_cvttps_epi32(_mm256_floor_ps(shifted));
+
+                    _mm256_store_ps(shifted_ray_origin[axis], _mm256_blendv_ps(origin, shifted, _mm256_castsi256_ps(active_mask)));
+                    _mm256_store_ps(time[axis], _mm256_blendv_ps(_mm256_load_ps(time[axis]), t[axis], _mm256_castsi256_ps(active_mask)));
+                    _mm256_store_si256((__m256i*) cell[axis], _mm256_blendv_epi8(
+                            _mm256_load_si256((const __m256i*) cell[axis]), c, active_mask));
+
+                    next_lod = _mm256_max_epi32(next_lod, FindLSB(c));
+                }
+
+                next_lod = _mm256_min_epi32(_mm256_max_epi32(next_lod, _mm256_setzero_si256()), _mm256_set1_epi32(max_lod));
+                _mm256_store_si256((__m256i*) lod, _mm256_blendv_epi8(lod_v, next_lod, active_mask));
+
+                __m256i iteration_v = _mm256_load_si256((const __m256i*) iteration);
+                _mm256_store_si256((__m256i*) iteration, _mm256_sub_epi32(iteration_v, active_mask));
+            }
+
+            /// <summary>
+            /// Index of the lowest set bit, negative for zero. The lowest bit is isolated and converted to float,
+            /// so its index is the exponent of the float.
+            /// </summary>
+            static __m256i FindLSB(__m256i value) {
+                __m256i lowest = _mm256_and_si256(value, _mm256_sub_epi32(_mm256_setzero_si256(), value));
+                __m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(lowest)), 23);
+                return _mm256_sub_epi32(exponent, _mm256_set1_epi32(127));
+            }
+        };
+#endif
+
+        const RayCaster& m_caster;
+    };
+
+    using VoxelRayPacketCaster = VoxelRayPacketCasterT<uint32_t>;
+
+}
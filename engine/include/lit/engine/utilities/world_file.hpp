@@ -0,0 +1,215 @@
+#pragma once
+
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse_lod_data.hpp>
+#include <lit/engine/utilities/mapped_file.hpp>
+#include <lit/common/glm_ext/comparators.hpp>
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Encoding of a chunk payload in a world file.
+    /// </summary>
+    enum class ChunkEncoding : uint32_t {
+        Raw = 0,
+        // (length, value) pairs of runs of equal voxels in the memory order of ChunkData
+        RunLength = 1,
+        // Palette and run-length or bit-packed indices in Morton order, see ChunkCodec
+        Palette = 2
+    };
+
+    /// <summary>
+    /// World file: a header, chunk payloads and a chunk directory. The file is append-only: an incremental save appends
+    /// payloads of the changed chunks and a new directory, then points the header to it, so payloads referenced by
+    /// older directories (and grids paging from them) stay valid. Old payloads are dropped by a full save.
+    /// Payloads are Palette encoded by default, the encoding is stored per chunk so older payloads stay readable.
+    /// Every chunk may have a block of precomputed LODs (levels 1 to CHUNK_SIZE_LOG of VoxelGridSparseLodDataT)
+    /// stored right after its payload with the same encoding.
+    /// </summary>
+    class WorldFile : public std::enable_shared_from_this<WorldFile> {
+    public:
+        using VoxelGrid = VoxelGridSparseT<uint32_t>;
+        using VoxelGridLod = VoxelGridSparseLodDataT<uint32_t>;
+
+        /// <summary>
+        /// Chunk payload and LOD block encoded for a world file, ready to be written.
+        /// </summary>
+        struct EncodedChunk {
+            glm::ivec3 position;
+            ChunkEncoding encoding;
+            std::vector<uint8_t> payload;
+            // Empty if the chunk has no LODs
+            std::vector<uint8_t> lod;
+        };
+
+        inline static const uint32_t VERSION = 1;
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            glm::ivec3 dimensions;
+            uint32_t reserved;
+            glm::dvec3 anchor;
+            uint64_t directory_offset;
+            uint64_t directory_size;
+        };
+
+        struct ChunkEntry {
+            glm::ivec3 position;
+            ChunkEncoding encoding;
+            uint64_t offset;
+            uint32_t size;
+            // Encoded size of the LOD block after the payload, zero if there is none
+            uint32_t lod_size;
+        };
+
+        static_assert(sizeof(Header) == 64 && sizeof(ChunkEntry) == 32);
+
+        /// <summary>
+        /// Maps the file and reads its directory, chunk payloads are not read.
+        /// Throws std::runtime_error if the file can't be mapped or is not a valid world file, including directories
+        /// with chunks outside of the grid or several chunks at the same position.
+        /// </summary>
+        static std::shared_ptr<WorldFile> Open(const std::string &path);
+
+        glm::ivec3 GetDimensions() const {
+            return m_header.dimensions;
+        }
+
+        glm::dvec3 GetAnchor() const {
+            return m_header.anchor;
+        }
+
+        const std::vector<ChunkEntry> &GetChunks() const {
+            return m_chunks;
+        }
+
+        void ReadChunk(const ChunkEntry &entry, VoxelGrid::ChunkData &data) const;
+
+        /// <summary>
+        /// Reads the LOD block of the chunk into @data (in the layout of VoxelGridSparseLodDataT::m_chunk_lod_data
+        /// for one chunk), returns false if the chunk has no LODs.
+        /// </summary>
+        bool ReadChunkLod(const ChunkEntry &entry, std::vector<uint32_t> &data) const;
+
+        /// <summary>
+        /// Adds all chunks of the file to @grid as paged chunks, they are read from the mapping on the first access,
+        /// the file stays mapped while the grid has any of them. @grid must have the dimensions of the file
+        /// and no chunks at the positions of the file.
+        /// </summary>
+        void AttachTo(VoxelGrid &grid);
+
+        /// <summary>
+        /// Writes all chunks of @grid (and their LODs if @lod is given) to a new file at @path.
+        /// Throws std::runtime_error if the file can't be written.
+        /// </summary>
+        static void Save(const std::string &path, VoxelGrid &grid, VoxelGridLod *lod = nullptr,
+                         ChunkEncoding encoding = ChunkEncoding::Palette);
+
+        /// <summary>
+        /// Appends chunks at @changed positions to an existing file at @path: chunks of @grid are written again,
+        /// positions without a chunk are removed from the directory, other chunks keep their old payloads.
+        /// </summary>
+        static void SaveIncremental(const std::string &path, VoxelGrid &grid,
+                                    const std::vector<glm::ivec3> &changed, VoxelGridLod *lod = nullptr,
+                                    ChunkEncoding encoding = ChunkEncoding::Palette);
+
+        static void Encode(const uint32_t *voxels, size_t count, ChunkEncoding encoding, std::vector<uint8_t> &out);
+
+        /// <summary>
+        /// Encodes the chunk at @position, @lod is null or the LOD block of the chunk (levels 1 to CHUNK_SIZE_LOG).
+        /// Doesn't touch any grid, so chunks can be encoded on any thread.
+        /// </summary>
+        static EncodedChunk EncodeChunk(glm::ivec3 position, const VoxelGrid::ChunkData &data, const uint32_t *lod,
+                                        ChunkEncoding encoding = ChunkEncoding::Palette);
+
+        /// <summary>
+        /// LOD block of the chunk in @lod, null if @lod is null or has no LODs of the chunk yet.
+        /// </summary>
+        static const uint32_t *GetChunkLod(const VoxelGridLod *lod, VoxelGrid::ChunkIndexType index);
+
+        /// <summary>
+        /// Decodes exactly @count voxels, throws std::runtime_error on malformed payloads.
+        /// </summary>
+        static void Decode(const uint8_t *payload, size_t size, ChunkEncoding encoding, uint32_t *voxels, size_t count);
+
+    private:
+        WorldFile() = default;
+
+        std::unique_ptr<MappedFile> m_file;
+        Header m_header{};
+        std::vector<ChunkEntry> m_chunks;
+    };
+
+    /// <summary>
+    /// Writes encoded chunks to a world file. Every Write is a single write of all its chunks at the end of the file,
+    /// the directory and the header are written by Finish, so the file keeps its previous state until then.
+    /// Throws std::runtime_error if the file can't be read or written.
+    /// </summary>
+    class WorldFileWriter {
+    public:
+        /// <summary>
+        /// Creates a new empty world file at @path.
+        /// </summary>
+        static std::unique_ptr<WorldFileWriter> Create(const std::string &path, glm::ivec3 dimensions, glm::dvec3 anchor);
+
+        /// <summary>
+        /// Opens an existing world file at @path, its chunks are kept unless they are written again or removed.
+        /// </summary>
+        static std::unique_ptr<WorldFileWriter> Append(const std::string &path, glm::ivec3 dimensions);
+
+        void Write(const std::vector<WorldFile::EncodedChunk> &chunks);
+
+        void Remove(glm::ivec3 position);
+
+        /// <summary>
+        /// Writes the new directory and points the header to it.
+        /// </summary>
+        void Finish();
+
+    private:
+        WorldFileWriter(const std::string &path, std::ios::openmode mode);
+
+        std::string m_path;
+        std::fstream m_file;
+        WorldFile::Header m_header{};
+        uint64_t m_offset = 0;
+        std::map<glm::ivec3, WorldFile::ChunkEntry, common::glm_ext::vec3_comparator<int>> m_chunks;
+        std::vector<uint8_t> m_buffer;
+    };
+
+    /// <summary>
+    /// Collects positions of the chunks of a grid that were created, changed or deleted, for
+    /// <see cref="WorldFile::SaveIncremental"/>. Writes through VoxelGridSparseT::GetChunkData are not reported
+    /// by the grid, so they are not tracked either. The grid must outlive the tracker.
+    /// </summary>
+    class DirtyChunkTracker {
+    public:
+        explicit DirtyChunkTracker(WorldFile::VoxelGrid &grid);
+
+        ~DirtyChunkTracker();
+
+        DirtyChunkTracker(const DirtyChunkTracker &) = delete;
+
+        DirtyChunkTracker &operator=(const DirtyChunkTracker &) = delete;
+
+        /// <summary>
+        /// Positions changed since the previous call, sorted.
+        /// </summary>
+        std::vector<glm::ivec3> TakeChanged();
+
+    private:
+        WorldFile::VoxelGrid &m_grid;
+        size_t m_callback;
+        std::set<glm::ivec3, common::glm_ext::vec3_comparator<int>> m_changed;
+    };
+
+}
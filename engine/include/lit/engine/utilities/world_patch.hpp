@@ -0,0 +1,115 @@
+#pragma once
+
+#include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Difference between two versions of a grid: created, changed and deleted chunks. Chunks are compared by
+    /// their content hashes (VoxelGridSparseT::GetChunkHash), so only chunks with different hashes are read,
+    /// and a changed chunk is stored as the XOR of both versions encoded by ChunkCodec (mostly zeros, so it takes
+    /// a few bytes per changed region). Every entry keeps the hash of the chunk it applies to, a patch is only
+    /// applied to the version it was computed from.
+    /// File: a header and the entries with their payloads in the order of the chunk grid, so patches are
+    /// written and applied as streams.
+    /// </summary>
+    class WorldPatch {
+    public:
+        using VoxelGrid = VoxelGridSparseT<uint32_t>;
+
+        enum class ChunkChange : uint32_t {
+            // Payload is the new chunk
+            Created = 0,
+            // Payload is the XOR of the old and the new chunk
+            Changed = 1,
+            // No payload
+            Deleted = 2
+        };
+
+        struct Entry {
+            glm::ivec3 position;
+            ChunkChange change;
+            // Hash of the chunk the entry applies to, zero for created chunks
+            uint64_t base_hash;
+            // Hash of the resulting chunk, zero for deleted chunks
+            uint64_t hash;
+            std::vector<uint8_t> payload;
+        };
+
+        inline static const uint32_t VERSION = 1;
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            glm::ivec3 dimensions;
+            uint32_t reserved;
+            uint64_t entries_count;
+        };
+
+        struct EntryHeader {
+            glm::ivec3 position;
+            ChunkChange change;
+            uint32_t payload_size;
+            uint32_t reserved;
+            uint64_t base_hash;
+            uint64_t hash;
+        };
+
+        static_assert(sizeof(Header) == 32 && sizeof(EntryHeader) == 40);
+
+        /// <summary>
+        /// Changes that turn @from into @to, grids must have equal dimensions. Chunk grids are scanned on the calling
+        /// thread, hashing and encoding of the chunks run on @pool.
+        /// </summary>
+        static WorldPatch Diff(VoxelGrid &from, VoxelGrid &to, ThreadPool &pool);
+
+        /// <summary>
+        /// Reads a patch file written by <see cref="Save"/>.
+        /// Throws std::runtime_error if the file can't be read or is not a valid patch.
+        /// </summary>
+        static WorldPatch Load(const std::string &path);
+
+        void Save(const std::string &path) const;
+
+        /// <summary>
+        /// Applies all entries to @grid in batches: every batch is decoded on @pool and applied with one DeleteChunk
+        /// per deleted chunk, one InsertChunks and one UpdateChunks call, so listeners get one notification per chunk.
+        /// All entries are checked against the chunk hashes and all payloads are decoded once before the first batch,
+        /// so std::runtime_error is thrown before changing the grid if it is not the version the patch was computed
+        /// from, two entries have the same position or a payload is malformed.
+        /// </summary>
+        void Apply(VoxelGrid &grid, ThreadPool &pool) const;
+
+        /// <summary>
+        /// Applies the patch file at @path as <see cref="Apply"/>, reading one batch of entries at a time.
+        /// Batches are checked one by one, so a mismatch, a repeated position or a malformed payload leaves
+        /// the batches before it applied.
+        /// </summary>
+        static void ApplyFile(const std::string &path, VoxelGrid &grid, ThreadPool &pool);
+
+        glm::ivec3 GetDimensions() const {
+            return m_dimensions;
+        }
+
+        const std::vector<Entry> &GetEntries() const {
+            return m_entries;
+        }
+
+        /// <summary>
+        /// Bytes of all payloads.
+        /// </summary>
+        size_t GetPayloadSize() const;
+
+    private:
+        inline static const size_t BATCH_SIZE = 256;
+
+        glm::ivec3 m_dimensions{};
+        std::vector<Entry> m_entries;
+    };
+
+}
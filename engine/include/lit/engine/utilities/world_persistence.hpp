@@ -0,0 +1,174 @@
+#pragma once
+
+#include <lit/engine/utilities/world_file.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lit::engine {
+
+    /// <summary>
+    /// Chunks of the unfinished jobs of <see cref="WorldPersistence"/>.
+    /// </summary>
+    struct WorldIoProgress {
+        size_t jobs = 0;
+        size_t chunks_total = 0;
+        size_t chunks_done = 0;
+    };
+
+    /// <summary>
+    /// Saves and loads world files in the background, so the thread that owns the grid (the frame loop) only takes
+    /// a snapshot of the chunks to save and inserts loaded chunks.
+    /// Saving: changed chunks are copied in parallel, encoded by the workers in batches and the batches are written
+    /// by a dedicated I/O thread (one write per batch), jobs are written in the order they were started.
+    /// Loading: chunks are decoded in batches by the workers, decoded batches are inserted by <see cref="Update"/>
+    /// with VoxelGridSparseT::InsertChunks, so the world appears gradually.
+    /// Jobs on the same path run in the order they were started: a save is written and a load is started only
+    /// after the previous job on its path is finished, so a file is never rewritten while it is being read.
+    /// Callbacks are invoked by Update with an empty string on success or with the error message.
+    /// Grids must outlive the jobs that use them.
+    /// </summary>
+    class WorldPersistence {
+    public:
+        using VoxelGrid = WorldFile::VoxelGrid;
+        using VoxelGridLod = WorldFile::VoxelGridLod;
+        using Callback = std::function<void(const std::string &error)>;
+
+        /// <summary>
+        /// Creates pool with @threads_count workers for encoding and decoding, zero means number of hardware threads.
+        /// </summary>
+        explicit WorldPersistence(size_t threads_count = 0);
+
+        /// <summary>
+        /// Waits for all jobs, callbacks of the jobs that were not reported by Update are not invoked.
+        /// </summary>
+        ~WorldPersistence();
+
+        WorldPersistence(const WorldPersistence &) = delete;
+
+        WorldPersistence &operator=(const WorldPersistence &) = delete;
+
+        /// <summary>
+        /// Writes all chunks of @grid (and their LODs if @lod is given) to a new file at @path.
+        /// </summary>
+        void SaveAsync(const std::string &path, VoxelGrid &grid, const VoxelGridLod *lod, Callback callback);
+
+        /// <summary>
+        /// Appends chunks at @changed positions to an existing file, as <see cref="WorldFile::SaveIncremental"/>.
+        /// </summary>
+        void SaveIncrementalAsync(const std::string &path, VoxelGrid &grid, const std::vector<glm::ivec3> &changed,
+                                  const VoxelGridLod *lod, Callback callback);
+
+        /// <summary>
+        /// Loads all chunks of the file at @path into @grid, which must have the dimensions of the file.
+        /// Chunks of @grid at the positions of loaded chunks are replaced.
+        /// </summary>
+        void LoadAsync(const std::string &path, VoxelGrid &grid, Callback callback);
+
+        /// <summary>
+        /// Inserts decoded chunks and invokes callbacks of finished jobs, call it from the thread that owns the grids.
+        /// </summary>
+        void Update();
+
+        /// <summary>
+        /// Waits until all jobs are finished and reported by Update.
+        /// </summary>
+        void Wait();
+
+        bool IsBusy() const;
+
+        WorldIoProgress GetProgress() const;
+
+    private:
+        struct Snapshot {
+            glm::ivec3 position;
+            std::unique_ptr<VoxelGrid::ChunkData> data;
+            std::vector<uint32_t> lod;
+        };
+
+        struct DecodedBatch {
+            std::vector<glm::ivec3> positions;
+            std::vector<std::unique_ptr<VoxelGrid::ChunkData>> data;
+        };
+
+        struct Job {
+            std::string path;
+            Callback callback;
+            std::atomic<size_t> chunks_total = 0;
+            std::atomic<size_t> chunks_done = 0;
+            std::atomic<bool> finished = false;
+            // Previous unreported job on the same path, reset once this job may touch the file
+            std::shared_ptr<Job> previous;
+            // Set once by the thread that failed
+            std::mutex mutex;
+            std::string error;
+
+            // Saving, batches are guarded by m_io_mutex
+            bool append = false;
+            glm::ivec3 dimensions{};
+            glm::dvec3 anchor{};
+            std::vector<glm::ivec3> removed;
+            size_t batches_total = 0;
+            size_t batches_written = 0;
+            std::deque<std::vector<WorldFile::EncodedChunk>> batches;
+
+            // Loading, decoded batches are guarded by mutex
+            VoxelGrid *grid = nullptr;
+            // Decoded batches and DecodeFile itself, the one that counts last releases the file
+            std::atomic<size_t> batches_decoded = 0;
+            std::vector<DecodedBatch> decoded;
+
+            void Fail(const std::string &message);
+        };
+
+        /// <summary>
+        /// Last unreported job on @path, null if there is none.
+        /// </summary>
+        std::shared_ptr<Job> FindLastJob(const std::string &path) const;
+
+        /// <summary>
+        /// Marks @job finished and starts the loads that waited for it, call it with m_io_mutex locked.
+        /// </summary>
+        void Finish(Job &job);
+
+        void StartSave(const std::shared_ptr<Job> &job, VoxelGrid &grid,
+                       const std::vector<VoxelGrid::ChunkIndexType> &indices, const VoxelGridLod *lod);
+
+        void EncodeBatch(const std::shared_ptr<Job> &job, std::vector<Snapshot> snapshots);
+
+        void DecodeFile(const std::shared_ptr<Job> &job);
+
+        void InsertDecoded(Job &job);
+
+        void IoLoop();
+
+        static const size_t BATCH_SIZE = 64;
+
+        // Snapshot buffers are reused by later saves, fresh allocations cost more than the copies
+        static const size_t MAX_SPARE_CHUNKS = 256;
+
+        std::vector<std::shared_ptr<Job>> m_jobs;
+
+        std::vector<std::unique_ptr<VoxelGrid::ChunkData>> m_spare_chunks;
+        std::mutex m_spare_mutex;
+
+        // Save jobs in the order they are written by the I/O thread
+        std::deque<std::shared_ptr<Job>> m_save_queue;
+        // Load jobs waiting for the previous job on their path
+        std::vector<std::shared_ptr<Job>> m_waiting_loads;
+        std::mutex m_io_mutex;
+        std::condition_variable m_io_condition;
+        bool m_stop = false;
+
+        ThreadPool m_pool;
+        std::thread m_io_thread;
+    };
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace lit {
 
     struct DebugOptions {
@@ -9,6 +11,15 @@ namespace lit {
         bool update_chunks = true;
         bool phase0 = true;
         bool phase1 = true;
+        bool save_world = false;
+        bool load_world = false;
+        bool undo_edit = false;
+        bool redo_edit = false;
+        // VoxelGridSparseT::SetDeduplication of the world
+        bool deduplicate_chunks = false;
+        // Chunks of the unfinished world saves and loads
+        size_t world_io_done = 0;
+        size_t world_io_total = 0;
         
         static DebugOptions & Instance() {
             static DebugOptions options;
@@ -16,8 +16,18 @@ CameraComponent::CameraComponent(glm::uvec2 viewport)
                 .attachments={Attachment::RGBA32F, Attachment::R32F}
         })) {}
 
+CameraComponent::CameraComponent(const Settings &settings)
+        : m_frame_buffer(OpenglFrameBuffer::Default()),
+          m_z_near(settings.z_near),
+          m_z_far(settings.z_far),
+          m_field_of_view(settings.field_of_view) {}
+
+CameraComponent::Settings CameraComponent::GetSettings() const {
+    return {m_z_near, m_z_far, m_field_of_view};
+}
+
 void CameraComponent::SetViewport(glm::uvec2 viewport) {
-    if (viewport != GetViewport()) {
+    if (viewport != GetViewport() || m_frame_buffer.IsDefault()) {
         m_frame_buffer = OpenglFrameBuffer::Create(
                 {
                         .width=viewport.x,
@@ -0,0 +1,224 @@
+#include <lit/engine/generators/gradient_noise.hpp>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace lit::engine;
+
+inline float fade(float t) {
+    return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+}
+
+GradientNoise::GradientNoise(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    // Uniform directions: points in the unit ball, normalized
+    for (int i = 0; i < PERIOD; i++) {
+        glm::vec2 v;
+        do {
+            v = {distribution(rng), distribution(rng)};
+        } while (glm::dot(v, v) > 1.0f || glm::dot(v, v) == 0.0f);
+        m_gradients_2d[i] = v / std::sqrt(glm::dot(v, v));
+    }
+    for (int i = 0; i < PERIOD; i++) {
+        glm::vec3 v;
+        do {
+            v = {distribution(rng), distribution(rng), distribution(rng)};
+        } while (glm::dot(v, v) > 1.0f || glm::dot(v, v) == 0.0f);
+        m_gradients_3d[i] = v / std::sqrt(glm::dot(v, v));
+    }
+
+    // Fisher-Yates with the raw generator output, the same table on every standard library
+    for (int i = 0; i < PERIOD; i++) {
+        m_permutation[i] = (uint8_t) i;
+    }
+    for (int i = PERIOD - 1; i > 0; i--) {
+        std::swap(m_permutation[i], m_permutation[rng() % (i + 1)]);
+    }
+    for (int i = 0; i < PERIOD; i++) {
+        m_permutation[PERIOD + i] = m_permutation[i];
+    }
+}
+
+float GradientNoise::GetNoise(glm::vec2 p) const {
+    glm::ivec2 p0 = glm::floor(p);
+    glm::ivec2 p1 = p0 + glm::ivec2(1, 0);
+    glm::ivec2 p2 = p0 + glm::ivec2(0, 1);
+    glm::ivec2 p3 = p0 + glm::ivec2(1, 1);
+
+    glm::vec2 g0 = m_gradients_2d[Hash(p0.x, p0.y)];
+    glm::vec2 g1 = m_gradients_2d[Hash(p1.x, p1.y)];
+    glm::vec2 g2 = m_gradients_2d[Hash(p2.x, p2.y)];
+    glm::vec2 g3 = m_gradients_2d[Hash(p3.x, p3.y)];
+
+    float fadeX = fade(p.x - p0.x);
+    float fadeY = fade(p.y - p0.y);
+
+    float p0p1 = (1.0f - fadeX) * glm::dot(g0, p - glm::vec2(p0)) + fadeX * glm::dot(g1, p - glm::vec2(p1));
+    float p2p3 = (1.0f - fadeX) * glm::dot(g2, p - glm::vec2(p2)) + fadeX * glm::dot(g3, p - glm::vec2(p3));
+
+    return (1.0f - fadeY) * p0p1 + fadeY * p2p3;
+}
+
+float GradientNoise::GetNoise(glm::vec3 p) const {
+    glm::ivec3 p0 = glm::floor(p);
+    glm::ivec3 p1 = p0 + glm::ivec3(1, 0, 0);
+    glm::ivec3 p2 = p0 + glm::ivec3(0, 1, 0);
+    glm::ivec3 p3 = p0 + glm::ivec3(1, 1, 0);
+    glm::ivec3 p4 = p0 + glm::ivec3(0, 0, 1);
+    glm::ivec3 p5 = p0 + glm::ivec3(1, 0, 1);
+    glm::ivec3 p6 = p0 + glm::ivec3(0, 1, 1);
+    glm::ivec3 p7 = p0 + glm::ivec3(1, 1, 1);
+
+    glm::vec3 g0 = m_gradients_3d[Hash(p0.x, p0.y, p0.z)];
+    glm::vec3 g1 = m_gradients_3d[Hash(p1.x, p1.y, p1.z)];
+    glm::vec3 g2 = m_gradients_3d[Hash(p2.x, p2.y, p2.z)];
+    glm::vec3 g3 = m_gradients_3d[Hash(p3.x, p3.y, p3.z)];
+    glm::vec3 g4 = m_gradients_3d[Hash(p4.x, p4.y, p4.z)];
+    glm::vec3 g5 = m_gradients_3d[Hash(p5.x, p5.y, p5.z)];
+    glm::vec3 g6 = m_gradients_3d[Hash(p6.x, p6.y, p6.z)];
+    glm::vec3 g7 = m_gradients_3d[Hash(p7.x, p7.y, p7.z)];
+
+    float fadeX = fade(p.x - p0.x);
+    float fadeY = fade(p.y - p0.y);
+    float fadeZ = fade(p.z - p0.z);
+
+    float p0p1 = (1.0f - fadeX) * glm::dot(g0, p - glm::vec3(p0)) + fadeX * glm::dot(g1, p - glm::vec3(p1));
+    float p2p3 = (1.0f - fadeX) * glm::dot(g2, p - glm::vec3(p2)) + fadeX * glm::dot(g3, p - glm::vec3(p3));
+    float p4p5 = (1.0f - fadeX) * glm::dot(g4, p - glm::vec3(p4)) + fadeX * glm::dot(g5, p - glm::vec3(p5));
+    float p6p7 = (1.0f - fadeX) * glm::dot(g6, p - glm::vec3(p6)) + fadeX * glm::dot(g7, p - glm::vec3(p7));
+
+    float p01p23 = (1.0f - fadeY) * p0p1 + fadeY * p2p3;
+    float p45p67 = (1.0f - fadeY) * p4p5 + fadeY * p6p7;
+
+    return (1.0f - fadeZ) * p01p23 + fadeZ * p45p67;
+}
+
+float GradientNoise::GetFractalNoise(glm::vec2 p, float wavelength, int levels) const {
+    float result = 0.0f;
+    for (int i = 0; i < levels; i++) {
+        auto pow = (float) (1 << i);
+        result += GetNoise(p * pow / wavelength) / pow;
+    }
+    return glm::clamp(result, -1.0f, 1.0f);
+}
+
+float GradientNoise::GetFractalNoise(glm::vec3 p, float wavelength, int levels) const {
+    float result = 0.0f;
+    for (int i = 0; i < levels; i++) {
+        auto pow = (float) (1 << i);
+        result += GetNoise(p * pow / wavelength) / pow;
+    }
+    return glm::clamp(result, -1.0f, 1.0f);
+}
+
+namespace {
+    /**
+     * Lattice coordinates of the points of one axis of the grid in one octave,
+     * cells are relative to the first cell, so they index the lattice cache directly.
+     */
+    struct AxisLattice {
+        int first_cell = 0;
+        int cells_count = 0;
+        std::vector<int> cell;
+        std::vector<float> offset0;
+        std::vector<float> offset1;
+        std::vector<float> fade;
+
+        void Compute(int origin, int size, float pow, float wavelength) {
+            cell.resize(size);
+            offset0.resize(size);
+            offset1.resize(size);
+            fade.resize(size);
+            for (int i = 0; i < size; i++) {
+                // The same operations as the point by point evaluation, so the results match
+                float p = (float) (origin + i) * pow / wavelength;
+                int c = (int) std::floor(p);
+                if (i == 0) {
+                    first_cell = c;
+                }
+                cell[i] = c - first_cell;
+                offset0[i] = p - (float) c;
+                offset1[i] = p - (float) (c + 1);
+                fade[i] = ::fade(offset0[i]);
+            }
+            // Points grow along the axis, so the last one is in the last cell
+            cells_count = size > 0 ? cell[size - 1] + 1 : 0;
+        }
+    };
+}
+
+void GradientNoise::GetFractalNoiseGrid(glm::ivec3 origin, glm::ivec3 size, float wavelength, int levels,
+                                        float *out) const {
+    size_t count = (size_t) size.x * size.y * size.z;
+    std::fill(out, out + count, 0.0f);
+
+    AxisLattice latticeX, latticeY, latticeZ;
+    // Gradients of the lattice points of the box in the current octave, (a * pointsY + b) * pointsZ + c
+    std::vector<glm::vec3> gradients;
+    for (int level = 0; level < levels; level++) {
+        auto pow = (float) (1 << level);
+        latticeX.Compute(origin.x, size.x, pow, wavelength);
+        latticeY.Compute(origin.y, size.y, pow, wavelength);
+        latticeZ.Compute(origin.z, size.z, pow, wavelength);
+
+        int pointsX = latticeX.cells_count + 1;
+        int pointsY = latticeY.cells_count + 1;
+        int pointsZ = latticeZ.cells_count + 1;
+        gradients.resize((size_t) pointsX * pointsY * pointsZ);
+        for (int a = 0; a < pointsX; a++) {
+            for (int b = 0; b < pointsY; b++) {
+                int hash = Hash(latticeX.first_cell + a, latticeY.first_cell + b);
+                glm::vec3 *row = gradients.data() + ((size_t) a * pointsY + b) * pointsZ;
+                for (int c = 0; c < pointsZ; c++) {
+                    row[c] = m_gradients_3d[m_permutation[hash + ((latticeZ.first_cell + c) & (PERIOD - 1))]];
+                }
+            }
+        }
+        size_t strideX = (size_t) pointsY * pointsZ;
+        size_t strideY = pointsZ;
+
+        for (int i = 0; i < size.x; i++) {
+            float dx0 = latticeX.offset0[i];
+            float dx1 = latticeX.offset1[i];
+            float fadeX = latticeX.fade[i];
+
+            for (int j = 0; j < size.y; j++) {
+                float dy0 = latticeY.offset0[j];
+                float dy1 = latticeY.offset1[j];
+                float fadeY = latticeY.fade[j];
+
+                const glm::vec3 *cell = gradients.data() + latticeX.cell[i] * strideX + latticeY.cell[j] * strideY;
+                float *row = out + ((size_t) i * size.y + j) * size.z;
+                for (int k = 0; k < size.z; k++) {
+                    const glm::vec3 *g = cell + latticeZ.cell[k];
+                    float dz0 = latticeZ.offset0[k];
+                    float dz1 = latticeZ.offset1[k];
+                    float fadeZ = latticeZ.fade[k];
+
+                    auto dot = [&](const glm::vec3 &gradient, float dx, float dy, float dz) {
+                        return gradient.x * dx + gradient.y * dy + gradient.z * dz;
+                    };
+                    float p0p1 = (1.0f - fadeX) * dot(g[0], dx0, dy0, dz0) + fadeX * dot(g[strideX], dx1, dy0, dz0);
+                    float p2p3 = (1.0f - fadeX) * dot(g[strideY], dx0, dy1, dz0) +
+                                 fadeX * dot(g[strideX + strideY], dx1, dy1, dz0);
+                    float p4p5 = (1.0f - fadeX) * dot(g[1], dx0, dy0, dz1) + fadeX * dot(g[strideX + 1], dx1, dy0, dz1);
+                    float p6p7 = (1.0f - fadeX) * dot(g[strideY + 1], dx0, dy1, dz1) +
+                                 fadeX * dot(g[strideX + strideY + 1], dx1, dy1, dz1);
+
+                    float p01p23 = (1.0f - fadeY) * p0p1 + fadeY * p2p3;
+                    float p45p67 = (1.0f - fadeY) * p4p5 + fadeY * p6p7;
+
+                    row[k] += ((1.0f - fadeZ) * p01p23 + fadeZ * p45p67) / pow;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        out[i] = glm::clamp(out[i], -1.0f, 1.0f);
+    }
+}
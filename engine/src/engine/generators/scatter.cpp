@@ -0,0 +1,139 @@
+#include <lit/engine/generators/scatter.hpp>
+#include <lit/common/random.hpp>
+#include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+/**
+ * splitmix64 of the seed and the tile index, so neighbouring tiles get unrelated streams.
+ */
+uint64_t tileSeed(uint64_t seed, uint64_t tile) {
+    uint64_t z = seed + (tile + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+std::vector<ScatterPlacement> PoissonScatter::Scatter(const Array2D<int> &heights, const ScatterSettings &settings,
+                                                      const Mask &mask, ThreadPool &pool) {
+    int width = (int) heights.GetWidth();
+    int depth = (int) heights.GetHeight();
+    double radius = settings.min_distance;
+    double radius2 = radius * radius;
+
+    // A tile reads cells up to 3 cells (2.12 radius) away from its points, so tiles of one phase never touch
+    // the same cells if they are at least 3 radius wide.
+    int tileSize = std::max(settings.tile_size, (int) std::ceil(3.0 * radius));
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesZ = (depth + tileSize - 1) / tileSize;
+
+    // Background grid of Bridson's algorithm, a cell is small enough to hold at most one point.
+    double cellSize = radius / std::sqrt(2.0);
+    int cellsX = (int) std::ceil(width / cellSize);
+    int cellsZ = (int) std::ceil(depth / cellSize);
+    Array2D<glm::dvec2> cells(cellsX, cellsZ);
+    std::fill(cells.data(), cells.data() + cellsX * cellsZ, glm::dvec2(-1.0));
+
+    auto fits = [&](glm::dvec2 p) {
+        int ci = (int) (p.x / cellSize);
+        int cj = (int) (p.y / cellSize);
+        for (int i = std::max(ci - 2, 0); i <= std::min(ci + 2, cellsX - 1); i++) {
+            for (int j = std::max(cj - 2, 0); j <= std::min(cj + 2, cellsZ - 1); j++) {
+                glm::dvec2 other = cells.at(i, j);
+                if (other.x >= 0 && glm::dot(other - p, other - p) < radius2) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    auto height = [&](int x, int z) {
+        return heights.at(std::clamp(x, 0, width - 1), std::clamp(z, 0, depth - 1));
+    };
+
+    std::vector<std::vector<ScatterPlacement>> tilePlacements(tilesX * tilesZ);
+
+    auto sampleTile = [&](int tx, int tz) {
+        int tile = tx * tilesZ + tz;
+        RandomGen rng(tileSeed(settings.seed, tile));
+        glm::dvec2 begin(tx * tileSize, tz * tileSize);
+        glm::dvec2 end(std::min((tx + 1) * tileSize, width), std::min((tz + 1) * tileSize, depth));
+        auto inside = [&](glm::dvec2 p) {
+            return p.x >= begin.x && p.y >= begin.y && p.x < end.x && p.y < end.y;
+        };
+
+        std::vector<glm::dvec2> points;
+        std::vector<glm::dvec2> active;
+        auto add = [&](glm::dvec2 p) {
+            cells.at((int) (p.x / cellSize), (int) (p.y / cellSize)) = p;
+            points.push_back(p);
+            active.push_back(p);
+        };
+
+        // The first point may hit points of the neighbours, try a few times
+        for (int i = 0; i < settings.attempts && active.empty(); i++) {
+            glm::dvec2 p(rng.get_double(begin.x, end.x), rng.get_double(begin.y, end.y));
+            if (inside(p) && fits(p)) {
+                add(p);
+            }
+        }
+
+        while (!active.empty()) {
+            size_t index = rng.get_int((int64_t) active.size() - 1);
+            glm::dvec2 p = active[index];
+            bool found = false;
+            for (int i = 0; i < settings.attempts; i++) {
+                double angle = rng.get_double(0.0, 2.0 * glm::pi<double>());
+                double distance = rng.get_double(radius, 2.0 * radius);
+                glm::dvec2 candidate = p + glm::dvec2(std::cos(angle), std::sin(angle)) * distance;
+                if (inside(candidate) && fits(candidate)) {
+                    add(candidate);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                active[index] = active.back();
+                active.pop_back();
+            }
+        }
+
+        for (auto &p: points) {
+            int x = (int) p.x;
+            int z = (int) p.y;
+            double slope = std::max(std::abs(height(x + 1, z) - height(x - 1, z)),
+                                    std::abs(height(x, z + 1) - height(x, z - 1))) * 0.5;
+            // Both numbers are drawn for every point, so a mask does not shift the stream of the others
+            double keep = rng.get_double();
+            auto variant = (uint32_t) rng.get();
+            if (slope > settings.max_slope || (mask && keep >= mask(x, z))) {
+                continue;
+            }
+            tilePlacements[tile].push_back(ScatterPlacement{glm::ivec3(x, height(x, z), z), variant});
+        }
+    };
+
+    for (int phase = 0; phase < 4; phase++) {
+        std::vector<glm::ivec2> tiles;
+        for (int tx = phase / 2; tx < tilesX; tx += 2) {
+            for (int tz = phase % 2; tz < tilesZ; tz += 2) {
+                tiles.emplace_back(tx, tz);
+            }
+        }
+        pool.ParallelFor(tiles.size(), [&](size_t i) {
+            sampleTile(tiles[i].x, tiles[i].y);
+        });
+    }
+
+    std::vector<ScatterPlacement> placements;
+    for (auto &tile: tilePlacements) {
+        placements.insert(placements.end(), tile.begin(), tile.end());
+    }
+    return placements;
+}
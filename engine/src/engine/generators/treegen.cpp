@@ -14,64 +14,40 @@ glm::dvec3 randomVec3(RandomGen &rng) {
     return v;
 }
 
-TreeGen::TreeGen(int seed) : rng(seed) {}
+TreeGen::TreeGen(uint64_t seed) : rng(seed), branchEnds(8.0) {}
+
+std::vector<VoxelGridPtr> TreeGen::GenerateTrees(uint64_t seed, size_t count, ThreadPool &pool) {
+    std::vector<VoxelGridPtr> trees(count);
+    pool.ParallelFor(count, [&](size_t i) {
+        // splitmix64 of the tree index, neighbouring streams of mt19937 are not correlated
+        uint64_t z = seed + (i + 1) * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        trees[i] = TreeGen(z ^ (z >> 31)).GenerateTreeAny();
+    });
+    return trees;
+}
 
 VoxelGridPtr TreeGen::GenerateTreeAny() {
     auto grid = std::make_shared<VoxelGridDenseT<uint32_t>>(glm::ivec3(128, 128, 128), glm::dvec3(64, 0, 64));
 
     auto graph = GenerateTreeGraphAny();
 
-    PlaceBranch(graph, grid);
+    // All branches are voxelized in one pass
+    std::vector<RoundCone> cones;
+    CollectBranches(graph, cones);
+    ConeVoxelizer(std::move(cones)).Voxelize(*grid);
 
     return grid;
 }
 
-void TreeGen::PlaceBranch(const TreeGen::Branch &branch, const VoxelGridPtr &grid) {
-    auto dims = grid->GetDimensions();
-    auto anchor = grid->GetAnchor();
-
-    glm::ivec3 min = grid->GetDimensions();
-    glm::ivec3 max = glm::ivec3();
-
-    min = glm::ivec3(glm::min(branch.origin + branch.direction * branch.length + anchor, branch.origin + anchor) -
-                     (branch.radiusBegin + 2));
-    max = glm::ivec3(glm::max(branch.origin + branch.direction * branch.length + anchor, branch.origin + anchor) +
-                     (branch.radiusBegin + 2));
-
-    for (int i = std::max(0, min.x); i < std::min(dims.x, max.x); i++) {
-        for (int j = std::max(0, min.y); j < std::min(dims.y, max.y); j++) {
-            for (int k = std::max(0, min.z); k < std::min(dims.z, max.z); k++) {
-                glm::dvec3 v = glm::dvec3{i + 0.5, j + 0.5, k + 0.5} - anchor;
-
-                double dotA = glm::dot(v - branch.origin, branch.direction);
-                double dotB = glm::dot(v - branch.direction * branch.length - branch.origin, -branch.direction);
-                if (dotA >= 0 && dotB >= 0) {
-                    double dist = glm::length(glm::cross(v - branch.origin, branch.direction));
-                    double w =
-                            branch.radiusBegin * (1 - dotA / branch.length) + branch.radiusEnd * dotA / branch.length;
-                    if (dist <= w) {
-                        //grid->SetVoxel({i, j, k}, 0x4a301a);
-                        grid->SetVoxel({i, j, k}, 0xFFFFFF);
-                    }
-                } else if (dotA < 0) {
-                    if (glm::length(v - branch.origin) <= branch.radiusBegin) {
-                        //grid->SetVoxel({i, j, k}, 0x4a301a);
-                        grid->SetVoxel({i, j, k}, 0xFFFFFF);
-                    }
-                } else {
-                    if (glm::length(v - branch.direction * branch.length - branch.origin) <= branch.radiusEnd) {
-                        //grid->SetVoxel({i, j, k}, 0x4a301a);
-                        grid->SetVoxel({i, j, k}, 0xFFFFFF);
-                    }
-                }
-            }
-        }
-    }
+void TreeGen::CollectBranches(const TreeGen::Branch &branch, std::vector<RoundCone> &cones) {
+    cones.push_back(RoundCone{branch.origin, branch.getEnd(), (float) branch.radiusBegin, (float) branch.radiusEnd,
+                              0xFFFFFF});
 
     for (auto &child: branch.childBranches) {
-        PlaceBranch(child, grid);
+        CollectBranches(child, cones);
     }
-
 }
 
 TreeGen::Branch TreeGen::GenerateTreeGraphAny() {
@@ -82,12 +58,14 @@ TreeGen::Branch TreeGen::GenerateTreeGraphAny() {
     trunk.radiusBegin = rng.get_double(4, 6);
     trunk.radiusEnd = trunk.radiusBegin * 0.8;
 
-    GenerateTreeGraphRecursive(trunk, trunk);
+    branchEnds.Clear();
+    branchEnds.Insert(trunk.getEnd());
+    GenerateTreeGraphRecursive(trunk);
 
     return trunk;
 }
 
-void TreeGen::GenerateTreeGraphRecursive(TreeGen::Branch &root, TreeGen::Branch &branch, int depth) {
+void TreeGen::GenerateTreeGraphRecursive(TreeGen::Branch &branch, int depth) {
     if (branch.length < 9 || branch.radiusBegin < 2) {
         return;
     }
@@ -108,34 +86,29 @@ void TreeGen::GenerateTreeGraphRecursive(TreeGen::Branch &root, TreeGen::Branch
         newBranch.radiusBegin = branch.radiusEnd * rng.get_double(0.7, 1.0);
         newBranch.radiusEnd = newBranch.radiusBegin * rng.get_double(0.6, 0.8);
 
-        auto &nearest = FindNearest(root, newBranch);
+        auto nearest = FindNearest(newBranch);
 
         if (glm::dot(glm::dvec3(0, 1, 0), newBranch.direction) < -0.4) continue;
-        if (glm::length(nearest.getEnd() - newBranch.getEnd()) < newBranch.length * 0.7) continue;
+        if (glm::length(nearest - newBranch.getEnd()) < newBranch.length * 0.7) continue;
         bool anyNear = false;
         for(auto & other : branch.childBranches) {
             if (glm::dot(other.direction, newBranch.direction) > 0.6) anyNear = true;
         }
         if (anyNear) continue;
 
-        branch.childBranches.push_back(newBranch);
+        AddBranch(branch, newBranch);
     }
 
     for (auto &child: branch.childBranches) {
-        GenerateTreeGraphRecursive(root, child, depth + 1);
+        GenerateTreeGraphRecursive(child, depth + 1);
     }
 }
 
-TreeGen::Branch &TreeGen::FindNearest(TreeGen::Branch &root, TreeGen::Branch &branch) {
-    Branch &res = root;
-    std::function<void(Branch & )> findRecursive;
-    findRecursive = [&](Branch &current) {
-        if (glm::length(current.getEnd() - branch.getEnd()) < glm::length(res.getEnd() - branch.getEnd())) {
-            res = current;
-        }
-        for (auto &child: current.childBranches) {
-            findRecursive(child);
-        }
-    };
-    return res;
+glm::dvec3 TreeGen::FindNearest(const TreeGen::Branch &branch) const {
+    return branchEnds.GetPoint(*branchEnds.FindNearest(branch.getEnd()));
+}
+
+void TreeGen::AddBranch(TreeGen::Branch &parent, const TreeGen::Branch &branch) {
+    parent.childBranches.push_back(branch);
+    branchEnds.Insert(branch.getEnd());
 }
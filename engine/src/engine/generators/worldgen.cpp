@@ -1,145 +1,439 @@
 #include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/generators/treegen.hpp>
 #include <lit/engine/generators/fnl.hpp>
+#include <lit/engine/generators/fnl_batch.hpp>
 #include <lit/engine/components/voxel_grid/voxel_grid_sparse.hpp>
+#include <lit/engine/utilities/cone_voxelizer.hpp>
+#include <lit/engine/utilities/min_max_filter.hpp>
 #include <lit/common/array.hpp>
+#include <lit/common/images/images.hpp>
+#include <lit/common/time_utils.hpp>
+#include <deque>
 
 using namespace lit::engine;
 using namespace lit::common;
 
-Array2D<int> computeMinOrMaxInWindow(const Array2D<int> &height, int windowRadius, bool computeMin) {
-    auto res = height;
-    std::vector<std::deque<std::pair<int, int>>> queues(height.GetWidth());
+glm::dvec3 randomVec33(RandomGen &rng) {
+    glm::dvec3 v{rng.get_double(-1, 1), rng.get_double(-1, 1), rng.get_double(-1, 1)};
 
-    auto compare = [&computeMin](int a, int b) {
-        return computeMin ? a < b : a > b;
-    };
+    while (glm::dot(v, v) >= 1.0) {
+        v = {rng.get_double(-1, 1), rng.get_double(-1, 1), rng.get_double(-1, 1)};
+    }
+    return v;
+}
 
-    auto push = [&compare](std::deque<std::pair<int, int>> &q, int index, int value) {
-        while (!q.empty() && !compare(q.back().second, value)) {
-            q.pop_back();
-        }
-        q.emplace_back(index, value);
-    };
+/**
+ * Noise generators of the terrain height. GetNoise changes the state of FastNoiseLite,
+ * so every job has its own instance.
+ */
+class HeightNoise {
+public:
+    explicit HeightNoise(int seed) : noiseMountains(seed + 2), noisePlanes(seed + 3), noiseMix(seed + 4) {
+        noiseMountains.SetFractalOctaves(10);
+        noisePlanes.SetFractalOctaves(6);
+        noiseMix.SetFractalOctaves(4);
+    }
 
-    auto pop = [](std::deque<std::pair<int, int>> &q, int index) {
-        while (!q.empty() && q.front().first <= index) {
-            q.pop_front();
-        }
-    };
+    /**
+     * Heights of the tile [x0, x0 + sizeX) x [z0, z0 + sizeZ), written to heightMap which starts at mapOrigin.
+     * Terrain sinks towards the borders of an island of islandSize, zero size makes the terrain unbounded.
+     * Noise is evaluated for the whole tile at once with FastNoiseLiteBatch.
+     */
+    void GetHeights(int x0, int z0, int sizeX, int sizeZ, glm::ivec2 islandSize, Array2D<int> &heightMap,
+                    glm::ivec2 mapOrigin) {
+        size_t count = sizeX * sizeZ;
+        mountainsFBm.resize(count);
+        mountainsBase.resize(count);
+        planes.resize(count);
+        mix.resize(count);
+
+        getNoiseGrid(noiseMountains, 8192.0f, FastNoiseLite::FractalType::FractalType_FBm, x0, z0, sizeX, sizeZ,
+                     mountainsFBm);
+        getNoiseGrid(noiseMountains, 8192.0f, FastNoiseLite::FractalType::FractalType_None, x0, z0, sizeX, sizeZ,
+                     mountainsBase);
+        getNoiseGrid(noisePlanes, 8192.0f, FastNoiseLite::FractalType::FractalType_FBm, x0, z0, sizeX, sizeZ, planes);
+        getNoiseGrid(noiseMix, 3192.0f, FastNoiseLite::FractalType::FractalType_FBm, x0, z0, sizeX, sizeZ, mix);
+
+        for (int i = 0; i < sizeX; i++) {
+            for (int j = 0; j < sizeZ; j++) {
+                size_t k = i * sizeZ + j;
+                auto xf = static_cast<float>(x0 + i);
+                auto zf = static_cast<float>(z0 + j);
+
+                float mountainsHeight = (mountainsFBm[k] - mountainsBase[k] * 0.2f) * 1300 + 200.0f;
+
+                float planesHeight = planes[k] * 260.0f + 30;
+
+                float mixFactor = mix[k];
+                //mix = mix > 0 ? sqrt(mix) : -sqrt(-mix);
+                mixFactor = mixFactor * 6.2f - 1;
+                //mix = std::max(0.0f, std::min(mix, 1.0f));
+                mixFactor = 1 / (1 + expf(-mixFactor));
+
+                float drop = 0.0f;
+                if (islandSize != glm::ivec2(0)) {
+                    float dx = ((xf / (float) islandSize.x) - 0.5f) * 2;
+                    float dz = ((zf / (float) islandSize.y) - 0.5f) * 2;
+                    float distFromCenter = dx * dx + dz * dz;
+                    drop = powf(distFromCenter + 0.1f, 4) * 300;
+                }
 
-    for (int i = 0; i < height.GetWidth(); i++) {
-        for (int j = 0; j < windowRadius; j++) {
-            push(queues[i], j, height.at(i, j));
+                heightMap.at(x0 + i - mapOrigin.x, z0 + j - mapOrigin.y) =
+                        static_cast<int>((mixFactor) * mountainsHeight + (1 - mixFactor) * planesHeight - drop);
+            }
         }
     }
 
-    for (int j = 0; j < height.GetHeight(); j++) {
-        for (int i = 0; i < height.GetWidth(); i++) {
-            if (j + windowRadius < height.GetHeight()) {
-                push(queues[i], j + windowRadius, height.at(i, j + windowRadius));
-            }
-            pop(queues[i], j - windowRadius - 1);
-        }
-        std::deque<std::pair<int, int>> q;
-        for (int i = 0; i < windowRadius; i++) {
-            push(q, i, queues[i].front().second);
-        }
+private:
+    static void getNoiseGrid(FastNoiseLite &noise, float wavelength, FastNoiseLite::FractalType fractalType,
+                             int x0, int z0, int sizeX, int sizeZ, std::vector<float> &out) {
+        noise.SetFrequency(1 / wavelength);
+        noise.SetFractalType(fractalType);
+        FastNoiseLiteBatch::GetNoiseGrid(noise, (float) x0, (float) z0, 1.0f, sizeX, sizeZ, out.data());
+    }
 
-        for (int i = 0; i < height.GetWidth(); i++) {
-            if (i + windowRadius < height.GetWidth()) {
-                push(q, i + windowRadius, queues[i + windowRadius].front().second);
+    FastNoiseLite noiseMountains;
+    FastNoiseLite noisePlanes;
+    FastNoiseLite noiseMix;
+
+    std::vector<float> mountainsFBm;
+    std::vector<float> mountainsBase;
+    std::vector<float> planes;
+    std::vector<float> mix;
+};
+
+const int TILE_SIZE = VoxelGridSparseT<uint32_t>::CHUNK_SIZE;
+const int FLATNESS_RADIUS = 12;
+const int NO_GRASS = -1;
+const uint32_t STONE_COLOR = 0x6d6e6d;
+const uint32_t GRASS_COLOR = 0x31a312;
+
+/**
+ * Terrain of every (x, z) column: stone in [bottom, min(height, world height)), grass at the grass height.
+ */
+struct TerrainColumns {
+    Array2D<int> height;
+    Array2D<int> bottom;
+    Array2D<int> grass;
+
+    TerrainColumns(size_t width, size_t depth) : height(width, depth), bottom(width, depth), grass(width, depth) {}
+};
+
+/**
+ * Computes stone and grass spans of sizeX x sizeZ columns starting at (x0, z0) of columns.
+ * heightMap holds heights of these columns, starting at (offsetX, offsetZ), with a halo of FLATNESS_RADIUS around them
+ * (clipped at the borders of the map). Windows of the tile cells never cross the halo, so results match the whole map filter.
+ * Marks the chunks of the column that are not empty in used.
+ */
+void computeTerrainColumns(const Array2D<int> &heightMap, int offsetX, int offsetZ, int x0, int z0, int sizeX, int sizeZ,
+                           int worldHeight, TerrainColumns &columns, std::vector<bool> &used) {
+    auto minW = SlidingWindowMin(heightMap, FLATNESS_RADIUS);
+    auto maxW = SlidingWindowMax(heightMap, FLATNESS_RADIUS);
+    auto minHeight = SlidingWindowMax(heightMap, 1);
+
+    for (int i = 0; i < sizeX; i++) {
+        for (int j = 0; j < sizeZ; j++) {
+            int lx = offsetX + i;
+            int lz = offsetZ + j;
+            int height = heightMap.at(lx, lz);
+            int bottom = std::max(0, std::min(minHeight.at(lx, lz) - 1, height - 2));
+            int top = std::min(height, worldHeight);
+            int grass = maxW.at(lx, lz) - minW.at(lx, lz) < FLATNESS_RADIUS && height >= 0 && height < worldHeight
+                        ? height : NO_GRASS;
+
+            columns.height.at(x0 + i, z0 + j) = height;
+            columns.bottom.at(x0 + i, z0 + j) = bottom;
+            columns.grass.at(x0 + i, z0 + j) = grass;
+
+            for (int y = bottom; y < top; y += TILE_SIZE - (y % TILE_SIZE)) {
+                used[y / TILE_SIZE] = true;
+            }
+            if (grass != NO_GRASS) {
+                used[grass / TILE_SIZE] = true;
             }
-            pop(q, i - windowRadius - 1);
-            res.at(i, j) = q.front().second;
         }
     }
-
-    return res;
 }
 
-glm::dvec3 randomVec33(RandomGen &rng) {
-    glm::dvec3 v{rng.get_double(-1, 1), rng.get_double(-1, 1), rng.get_double(-1, 1)};
-
-    while (glm::dot(v, v) >= 1.0) {
-        v = {rng.get_double(-1, 1), rng.get_double(-1, 1), rng.get_double(-1, 1)};
+/**
+ * Calls fillSpan(begin, end, color) for the stone and grass runs of the column clipped to [yBegin, yEnd).
+ */
+template<typename FillSpan>
+void fillTerrainColumn(const TerrainColumns &columns, int x, int z, int yBegin, int yEnd, FillSpan &&fillSpan) {
+    int bottom = std::max(columns.bottom.at(x, z), yBegin);
+    int top = std::min(columns.height.at(x, z), yEnd);
+    if (bottom < top) {
+        fillSpan(bottom, top, STONE_COLOR);
+    }
+    int grass = columns.grass.at(x, z);
+    if (grass != NO_GRASS && grass >= yBegin && grass < yEnd) {
+        fillSpan(grass, grass + 1, GRASS_COLOR);
     }
-    return v;
 }
 
-Array2D<int> generateHeightMap(size_t width, size_t height, size_t maxHeight) {
-
-    FastNoiseLite noiseMountains(2);
-    FastNoiseLite noisePlanes(3);
-    FastNoiseLite noiseMix(4);
-
-    noiseMountains.SetFractalOctaves(10);
-    noisePlanes.SetFractalOctaves(6);
-    noiseMix.SetFractalOctaves(4);
-
-    Array2D<int> heightMap(width, height);
-
-    for (int x = 0; x < width; x++) {
-        for (int z = 0; z < height; z++) {
-            auto xf = static_cast<float>(x);
-            auto zf = static_cast<float>(z);
-
-            float mountains = (noiseMountains.GetNoise(xf, zf, 8192.0f, FastNoiseLite::FractalType::FractalType_FBm) -
-                               noiseMountains.GetNoise(xf, zf, 8192.0f, FastNoiseLite::FractalType::FractalType_None) *
-                               0.2f)
-                              * 1300 + 200.0f;
-
-            float planes =
-                    noisePlanes.GetNoise(xf, zf, 8192.0f, FastNoiseLite::FractalType::FractalType_FBm) * 260.0f + 30;
-
-            float mix = noiseMix.GetNoise(xf, zf, 3192.0f, FastNoiseLite::FractalType::FractalType_FBm);
-            //mix = mix > 0 ? sqrt(mix) : -sqrt(-mix);
-            mix = mix * 6.2f - 1;
-            //mix = std::max(0.0f, std::min(mix, 1.0f));
-            mix = 1 / (1 + expf(-mix));
-
-            float dx = ((xf / (float) width) - 0.5f) * 2;
-            float dz = ((zf / (float) height) - 0.5f) * 2;
-            float distFromCenter = dx * dx + dz * dz;
-            float drop = powf(distFromCenter + 0.1f, 4) * 300;
-
-            heightMap.at(x, z) = static_cast<int>((mix) * mountains + (1 - mix) * planes - drop);
-            //height[x][z] = static_cast<int>(400 * mix + 10);
+/**
+ * Fills chunk with the terrain of columns, origin is the position of the chunk corner in columns (y is the world height).
+ */
+void fillTerrainChunk(const TerrainColumns &columns, glm::ivec3 origin, VoxelGridSparseT<uint32_t>::ChunkData &chunk) {
+    for (int x = 0; x < TILE_SIZE; x++) {
+        for (int z = 0; z < TILE_SIZE; z++) {
+            fillTerrainColumn(columns, origin.x + x, origin.z + z, origin.y, origin.y + TILE_SIZE,
+                              [&](int begin, int end, uint32_t color) {
+                                  VoxelGridSparseT<uint32_t>::FillChunkColumn(chunk, {x, begin - origin.y, z},
+                                                                             end - begin, color);
+                              });
         }
     }
+}
 
-    return heightMap;
+/**
+ * Heights of all columns of a world of @dimensions, tiles are computed in parallel.
+ */
+Array2D<int> generateHeights(int seed, glm::ivec3 dimensions, ThreadPool &pool) {
+    int tiles_x = (dimensions.x + TILE_SIZE - 1) / TILE_SIZE;
+    int tiles_z = (dimensions.z + TILE_SIZE - 1) / TILE_SIZE;
+    auto tileBegin = [](int tile) { return tile * TILE_SIZE; };
+    auto tileEnd = [](int tile, int size) { return std::min(tile * TILE_SIZE + TILE_SIZE, size); };
+
+    Array2D<int> heights(dimensions.x, dimensions.z);
+    pool.ParallelFor(tiles_x * tiles_z, [&](size_t tile) {
+        int tx = (int) tile / tiles_z;
+        int tz = (int) tile % tiles_z;
+        HeightNoise noise(seed);
+        noise.GetHeights(tileBegin(tx), tileBegin(tz), tileEnd(tx, dimensions.x) - tileBegin(tx),
+                         tileEnd(tz, dimensions.z) - tileBegin(tz), glm::ivec2(dimensions.x, dimensions.z),
+                         heights, glm::ivec2(0));
+    });
+    return heights;
 }
 
 void WorldGen::Generate(VoxelGridBaseT<uint32_t> &world, spdlog::logger &logger) {
+    ThreadPool pool;
+    Generate(world, logger, pool);
+}
+
+void WorldGen::Generate(VoxelGridBaseT<uint32_t> &world, spdlog::logger &logger, ThreadPool &pool) {
     logger.trace("Worldgen started");
+    Timer timer;
 
     auto dimensions = world.GetDimensions();
+    int tiles_x = (dimensions.x + TILE_SIZE - 1) / TILE_SIZE;
+    int tiles_z = (dimensions.z + TILE_SIZE - 1) / TILE_SIZE;
+    int tiles_y = (dimensions.y + TILE_SIZE - 1) / TILE_SIZE;
+
+    auto tileBegin = [](int tile) { return tile * TILE_SIZE; };
+    auto tileEnd = [](int tile, int size) { return std::min(tile * TILE_SIZE + TILE_SIZE, size); };
+
+    Array2D<int> heights = generateHeights(m_seed, dimensions, pool);
+    m_timings = Timings();
+    m_timings.height_map = timer.GetTimeAndReset();
+    logger.trace("Height map generated in {:.2f}s", m_timings.height_map);
+
+    // Stone and grass spans of every column, each tile reads heights of its neighbours in a halo of FLATNESS_RADIUS.
+    TerrainColumns columns(dimensions.x, dimensions.z);
+    std::vector<std::vector<int>> tile_chunks(tiles_x * tiles_z);
+    pool.ParallelFor(tiles_x * tiles_z, [&](size_t tile) {
+        int tx = (int) tile / tiles_z;
+        int tz = (int) tile % tiles_z;
+        int x0 = std::max(tileBegin(tx) - FLATNESS_RADIUS, 0);
+        int z0 = std::max(tileBegin(tz) - FLATNESS_RADIUS, 0);
+        int x1 = std::min(tileEnd(tx, dimensions.x) + FLATNESS_RADIUS, dimensions.x);
+        int z1 = std::min(tileEnd(tz, dimensions.z) + FLATNESS_RADIUS, dimensions.z);
+
+        Array2D<int> heightMap(x1 - x0, z1 - z0);
+        for (int x = x0; x < x1; x++) {
+            for (int z = z0; z < z1; z++) {
+                heightMap.at(x - x0, z - z0) = heights.at(x, z);
+            }
+        }
+
+        std::vector<bool> used(tiles_y, false);
+        computeTerrainColumns(heightMap, tileBegin(tx) - x0, tileBegin(tz) - z0, tileBegin(tx), tileBegin(tz),
+                              tileEnd(tx, dimensions.x) - tileBegin(tx), tileEnd(tz, dimensions.z) - tileBegin(tz),
+                              dimensions.y, columns, used);
+
+        for (int ty = 0; ty < tiles_y; ty++) {
+            if (used[ty]) {
+                tile_chunks[tile].push_back(ty);
+            }
+        }
+    });
+    m_timings.terrain_columns = timer.GetTimeAndReset();
+    logger.trace("Terrain columns computed in {:.2f}s", m_timings.terrain_columns);
+
+    auto sparse = dynamic_cast<VoxelGridSparseT<uint32_t> *>(&world);
+    if (!sparse) {
+        for (int x = 0; x < dimensions.x; x++) {
+            for (int z = 0; z < dimensions.z; z++) {
+                fillTerrainColumn(columns, x, z, 0, dimensions.y, [&](int begin, int end, uint32_t color) {
+                    world.FillColumn({x, begin, z}, end - begin, color);
+                });
+            }
+        }
+        m_timings.voxels = timer.GetTimeAndReset();
+        logger.trace("Voxels written in {:.2f}s", m_timings.voxels);
+        return;
+    }
 
-    auto heightMap = generateHeightMap(dimensions.x, dimensions.z, dimensions.y);
+    // Chunks are registered in the tile order, so chunk indices do not depend on the number of threads either.
+    std::vector<glm::ivec3> chunk_positions;
+    for (int tile = 0; tile < tiles_x * tiles_z; tile++) {
+        for (int ty: tile_chunks[tile]) {
+            chunk_positions.emplace_back(tile / tiles_z, ty, tile % tiles_z);
+        }
+    }
 
-    auto minW = computeMinOrMaxInWindow(heightMap, 12, true);
-    auto maxW = computeMinOrMaxInWindow(heightMap, 12, false);
+    sparse->CreateChunks(chunk_positions, [&](const std::vector<VoxelGridSparseT<uint32_t>::ChunkIndexType> &indices) {
+        pool.ParallelFor(indices.size(), [&](size_t i) {
+            fillTerrainChunk(columns, chunk_positions[i] * TILE_SIZE, sparse->GetChunkData(indices[i]));
+        });
+    });
+    m_timings.voxels = timer.GetTimeAndReset();
+    logger.trace("Chunks filled in {:.2f}s", m_timings.voxels);
 
+    logger.trace("Chunks created: {}", sparse->GetChunksNum());
+    logger.trace("World memory size: {}", sparse->GetSizeBytes());
+}
 
-    auto minHeight = computeMinOrMaxInWindow(heightMap, 1, false);
+void WorldGen::GenerateFromHeightMap(VoxelGridSparseT<uint32_t> &world, const std::string &path, int max_height,
+                                     spdlog::logger &logger, ThreadPool &pool) {
+    logger.trace("Worldgen from {} started", path);
+    Timer timer;
 
-    for (int x = 0; x < dimensions.x; x++) {
-        for (int z = 0; z < dimensions.z; z++) {
-            for (int y = std::max(0, std::min(minHeight.at(x, z) - 1, heightMap.at(x, z) - 2));
-                 y < std::min(heightMap.at(x, z), dimensions.y); y++) {
-                world.SetVoxel({x, y, z}, 0x6d6e6d);
+    auto dimensions = world.GetDimensions();
+    int tiles_y = (dimensions.y + TILE_SIZE - 1) / TILE_SIZE;
+    int width = 0;
+    int depth = 0;
+
+    // Heights of the rows [first_row, first_row + rows.size()), the rows above the halo of the next band are dropped
+    std::deque<std::vector<int>> rows;
+    int first_row = 0;
+    int next_band = 0;
+
+    auto generateBand = [&](int z0) {
+        int z1 = std::min(z0 + TILE_SIZE, depth);
+        int halo_z0 = std::max(z0 - FLATNESS_RADIUS, 0);
+        int halo_z1 = std::min(z1 + FLATNESS_RADIUS, depth);
+        int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+
+        // Columns of whole chunks, the ones past the end of the image stay empty
+        TerrainColumns columns(tiles_x * TILE_SIZE, TILE_SIZE);
+        std::fill(columns.grass.data(), columns.grass.data() + tiles_x * TILE_SIZE * TILE_SIZE, NO_GRASS);
+        std::vector<std::vector<bool>> used(tiles_x, std::vector<bool>(tiles_y, false));
+        pool.ParallelFor(tiles_x, [&](size_t tx) {
+            int tile_x0 = (int) tx * TILE_SIZE;
+            int tile_x1 = std::min(tile_x0 + TILE_SIZE, width);
+            int x0 = std::max(tile_x0 - FLATNESS_RADIUS, 0);
+            int x1 = std::min(tile_x1 + FLATNESS_RADIUS, width);
+
+            Array2D<int> heightMap(x1 - x0, halo_z1 - halo_z0);
+            for (int z = halo_z0; z < halo_z1; z++) {
+                auto &row = rows[z - first_row];
+                for (int x = x0; x < x1; x++) {
+                    heightMap.at(x - x0, z - halo_z0) = row[x];
+                }
+            }
+            computeTerrainColumns(heightMap, tile_x0 - x0, z0 - halo_z0, tile_x0, 0, tile_x1 - tile_x0, z1 - z0,
+                                  dimensions.y, columns, used[tx]);
+        });
+
+        std::vector<glm::ivec3> chunk_positions;
+        for (int tx = 0; tx < tiles_x; tx++) {
+            for (int ty = 0; ty < tiles_y; ty++) {
+                if (used[tx][ty]) {
+                    chunk_positions.emplace_back(tx, ty, z0 / TILE_SIZE);
+                }
             }
+        }
+        world.CreateChunks(chunk_positions, [&](const std::vector<VoxelGridSparseT<uint32_t>::ChunkIndexType> &indices) {
+            pool.ParallelFor(indices.size(), [&](size_t i) {
+                glm::ivec3 origin(chunk_positions[i].x * TILE_SIZE, chunk_positions[i].y * TILE_SIZE, 0);
+                fillTerrainChunk(columns, origin, world.GetChunkData(indices[i]));
+            });
+        });
+
+        int keep_from = std::max(z1 - FLATNESS_RADIUS, 0);
+        while (first_row < keep_from && !rows.empty()) {
+            rows.pop_front();
+            first_row++;
+        }
+    };
 
-            if (maxW.at(x, z) - minW.at(x, z) < 12) {
-                world.SetVoxel({x, heightMap.at(x, z), z}, 0x31a312);
+    ReadPNG_Rows<uint16_t, 1>(path, TILE_SIZE, [&](uint32_t band_row, const Image<uint16_t, 1> &band) {
+        if (band_row == 0) {
+            width = std::min((int) band.GetWidth(), dimensions.x);
+        }
+        for (uint32_t y = 0; y < band.GetHeight() && (int) (band_row + y) < dimensions.z; y++) {
+            const uint16_t *values = band.GetDataPointer() + (size_t) y * band.GetWidth();
+            std::vector<int> &row = rows.emplace_back(width);
+            for (int x = 0; x < width; x++) {
+                row[x] = (int) (((int64_t) values[x] * max_height + 32767) / 65535);
             }
+            depth++;
+        }
+        // Bands are generated as soon as the rows of their halo are read
+        while (next_band + TILE_SIZE + FLATNESS_RADIUS <= depth) {
+            generateBand(next_band);
+            next_band += TILE_SIZE;
         }
+    });
+    while (next_band < depth) {
+        generateBand(next_band);
+        next_band += TILE_SIZE;
     }
 
-    auto w = (VoxelGridSparseT<uint32_t> *) &world;
+    logger.trace("Terrain of {}x{} height map generated in {:.2f}s", width, depth, timer.GetTime());
+    logger.trace("Chunks created: {}", world.GetChunksNum());
+}
 
-    logger.trace("Chunks created: {}", w->GetChunksNum());
-    logger.trace("World memory size: {}", w->GetSizeBytes());
+std::vector<WorldGen::GeneratedChunk> WorldGen::GenerateChunkColumn(glm::ivec2 column, int world_height) const {
+    // Heights of the column with the halo, the terrain is unbounded, so nothing is clipped.
+    int size = TILE_SIZE + 2 * FLATNESS_RADIUS;
+    glm::ivec2 origin = column * TILE_SIZE - FLATNESS_RADIUS;
+    Array2D<int> heightMap(size, size);
+    HeightNoise noise(m_seed);
+    noise.GetHeights(origin.x, origin.y, size, size, glm::ivec2(0), heightMap, origin);
+
+    TerrainColumns columns(TILE_SIZE, TILE_SIZE);
+    int chunks_y = (world_height + TILE_SIZE - 1) / TILE_SIZE;
+    std::vector<bool> used(chunks_y, false);
+    computeTerrainColumns(heightMap, FLATNESS_RADIUS, FLATNESS_RADIUS, 0, 0, TILE_SIZE, TILE_SIZE, world_height,
+                          columns, used);
+
+    std::vector<GeneratedChunk> chunks;
+    for (int y = 0; y < chunks_y; y++) {
+        if (used[y]) {
+            auto data = std::make_unique<ChunkData>();
+            fillTerrainChunk(columns, glm::ivec3(0, y * TILE_SIZE, 0), *data);
+            chunks.push_back(GeneratedChunk{y, std::move(data)});
+        }
+    }
+    return chunks;
+}
+
+void WorldGen::ScatterTrees(VoxelGridBaseT<uint32_t> &world, const ScatterSettings &settings, size_t variants,
+                            spdlog::logger &logger, ThreadPool &pool) {
+    Timer timer;
+    auto dimensions = world.GetDimensions();
+    Array2D<int> heights = generateHeights(m_seed, dimensions, pool);
+
+    // Only columns whose surface is inside the world, the sea floor past the island border is dropped
+    auto mask = [&](int x, int z) {
+        int height = heights.at(x, z);
+        return height >= 0 && height < dimensions.y ? 1.0 : 0.0;
+    };
+    auto placements = PoissonScatter::Scatter(heights, settings, mask, pool);
+    // Trees grow from the voxel above the grass
+    for (auto &placement: placements) {
+        placement.position.y++;
+    }
+    auto trees = TreeGen::GenerateTrees(settings.seed, variants, pool);
+    m_timings.trees_scatter = timer.GetTimeAndReset();
+    logger.trace("{} trees scattered in {:.2f}s", placements.size(), m_timings.trees_scatter);
+
+    PlaceObjects(world, trees, placements);
+    m_timings.trees_placement = timer.GetTimeAndReset();
+    logger.trace("Trees placed in {:.2f}s", m_timings.trees_placement);
 }
 
 void WorldGen::ResetTestWorld(VoxelGridBaseT<uint32_t> &world) {
@@ -172,42 +466,74 @@ void WorldGen::PlaceObject(VoxelGridBaseT<uint32_t> &world, const VoxelGridBaseT
     }
 }
 
-std::shared_ptr<lit::engine::VoxelGridBaseT<uint32_t>> GenerateTrunk(RandomGen & rng) {
-    auto trunk = std::make_shared<lit::engine::VoxelGridSparseT<uint32_t>>(glm::ivec3(64, 90, 64),
-                                                                           glm::dvec3(32, 0, 32));
-    auto dimensions = trunk->GetDimensions();
-    auto anchor = trunk->GetAnchor();
+/**
+ * Vertical run of equal non-empty voxels of an object, start is relative to the anchor of the object.
+ */
+struct ObjectRun {
+    glm::ivec3 start;
+    int length;
+    uint32_t value;
+};
 
-    auto placeBranch = [&](glm::dvec3 origin, glm::dvec3 direction, double length, double width) {
-        width /= 2;
-        double highWidth = 0.7 * width;
-
-        for (int i = 0; i < dimensions.x; i++) {
-            for (int k = 0; k < dimensions.z; k++) {
-                for (int j = 0; j < dimensions.y; j++) {
-                    glm::dvec3 v = glm::dvec3{i + 0.5, j + 0.5, k + 0.5} - anchor;
-
-                    double dotA = glm::dot(v - origin, direction);
-                    double dotB = glm::dot(v - direction * length - origin, -direction);
-                    if (dotA >= 0 && dotB >= 0) {
-                        double dist = glm::length(glm::cross(v - origin, direction));
-                        double w = width * (1 - dotA / length) + highWidth * dotA / length;
-                        if (dist <= w) {
-                            trunk->SetVoxel({i, j, k}, 0xFFFFFF);
-                        }
-                    } else if (dotA < 0) {
-                        if (glm::length(v - origin) <= width) {
-                            trunk->SetVoxel({i, j, k}, 0xFFFFFF);
-                        }
-                    } else {
-                        if (glm::length(v - direction * length - origin) <= highWidth) {
-                            trunk->SetVoxel({i, j, k}, 0xFFFFFF);
-                        }
-                    }
+std::vector<ObjectRun> collectObjectRuns(const VoxelGridBaseT<uint32_t> &object) {
+    auto dimensions = object.GetDimensions();
+    glm::ivec3 anchor = glm::ivec3(glm::floor(object.GetAnchor()));
+    std::vector<ObjectRun> runs;
+    for (int i = 0; i < dimensions.x; i++) {
+        for (int k = 0; k < dimensions.z; k++) {
+            for (int j = 0; j < dimensions.y;) {
+                uint32_t value = object.GetVoxel({i, j, k});
+                int end = j + 1;
+                while (end < dimensions.y && object.GetVoxel({i, end, k}) == value) {
+                    end++;
+                }
+                if (value) {
+                    runs.push_back(ObjectRun{glm::ivec3(i, j, k) - anchor, end - j, value});
                 }
+                j = end;
+            }
+        }
+    }
+    return runs;
+}
+
+void WorldGen::PlaceObjects(VoxelGridBaseT<uint32_t> &world,
+                            const std::vector<std::shared_ptr<VoxelGridBaseT<uint32_t>>> &objects,
+                            const std::vector<ScatterPlacement> &placements) {
+    if (objects.empty()) {
+        return;
+    }
+
+    std::vector<std::vector<ObjectRun>> runs;
+    runs.reserve(objects.size());
+    for (auto &object: objects) {
+        runs.push_back(collectObjectRuns(*object));
+    }
+
+    auto dimensions = world.GetDimensions();
+    for (auto &placement: placements) {
+        for (auto &run: runs[placement.variant % objects.size()]) {
+            glm::ivec3 start = placement.position + run.start;
+            if (start.x < 0 || start.z < 0 || start.x >= dimensions.x || start.z >= dimensions.z) {
+                continue;
+            }
+            int begin = std::max(start.y, 0);
+            int end = std::min(start.y + run.length, dimensions.y);
+            if (begin < end) {
+                world.FillColumn({start.x, begin, start.z}, end - begin, run.value);
             }
         }
+    }
+}
 
+std::shared_ptr<lit::engine::VoxelGridBaseT<uint32_t>> GenerateTrunk(RandomGen & rng) {
+    auto trunk = std::make_shared<lit::engine::VoxelGridSparseT<uint32_t>>(glm::ivec3(64, 90, 64),
+                                                                           glm::dvec3(32, 0, 32));
+    std::vector<RoundCone> branches;
+    auto placeBranch = [&](glm::dvec3 origin, glm::dvec3 direction, double length, double width) {
+        width /= 2;
+        branches.push_back(RoundCone{origin, origin + direction * length, (float) width, (float) (0.7 * width),
+                                     0xFFFFFF});
     };
 
     double trunkHeight = rng.get_double(20, 40);
@@ -221,6 +547,7 @@ std::shared_ptr<lit::engine::VoxelGridBaseT<uint32_t>> GenerateTrunk(RandomGen &
         auto u = glm::normalize(v - glm::dot(v, dir) * dir);
         placeBranch(dir * trunkHeight, glm::normalize(dir + u), trunkHeight * 0.9, trunkWidth * 0.6);
     }
+    ConeVoxelizer(std::move(branches)).Voxelize(*trunk);
 
 
     return trunk;
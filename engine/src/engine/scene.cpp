@@ -52,6 +52,15 @@ EntityView Scene::CreteEntity(const std::string &name) {
     return {ent, this};
 }
 
+EntityView Scene::FindEntity(const std::string &name) {
+    for (auto ent: m_registry.view<TagComponent>()) {
+        if (m_registry.get<TagComponent>(ent).tag == name) {
+            return {ent, this};
+        }
+    }
+    return {};
+}
+
 lit::engine::EntityView::EntityView(entt::entity entity, Scene* scene):m_entity(entity), m_scene(scene)
 {
 }
@@ -17,6 +17,8 @@ using VoxelGridLod = VoxelGridSparseLodDataT<uint32_t>;
 
 RandomGen rng(0);
 
+const size_t EDIT_HISTORY_BUDGET = 64 << 20;
+
 void DebugSystem::Update(double dt) {
 
     auto & world = m_registry.get<VoxelGrid>(m_registry.view<VoxelGrid>()[0]);
@@ -35,5 +37,28 @@ void DebugSystem::Update(double dt) {
         Merge(world, *tree, MERGE_KEEP_SECOND, glm::dvec3{0.,0.,44.});
 
         DebugOptions::Instance().regenerate_tree = false;
+
+        // Voxel edits do not merge chunks, the test world is mostly identical ground chunks
+        if (world.IsDeduplicationEnabled()) {
+            world.DeduplicateChunks();
+        }
+    }
+    if (DebugOptions::Instance().deduplicate_chunks != world.IsDeduplicationEnabled()) {
+        world.SetDeduplication(DebugOptions::Instance().deduplicate_chunks);
+    }
+
+    // Created after the first regeneration, which clears the generated world
+    if (!m_history) {
+        m_history = std::make_unique<EditHistory>(world, EDIT_HISTORY_BUDGET);
+        return;
+    }
+    if (DebugOptions::Instance().undo_edit) {
+        m_history->Undo();
+        DebugOptions::Instance().undo_edit = false;
+    }
+    if (DebugOptions::Instance().redo_edit) {
+        m_history->Redo();
+        DebugOptions::Instance().redo_edit = false;
     }
+    m_history->Commit();
 }
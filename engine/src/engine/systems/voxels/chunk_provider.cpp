@@ -0,0 +1,324 @@
+#include <lit/engine/systems/voxels/chunk_provider.hpp>
+#include <lit/engine/components/transform.hpp>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace lit::engine;
+
+ChunkProvider::ChunkProvider(entt::registry &registry, entt::entity observer, ChunkProviderSettings settings)
+        : System(registry), m_observer(observer), m_settings(std::move(settings)), m_pool(m_settings.threads_count) {
+    if (!m_settings.save_directory.empty()) {
+        std::filesystem::create_directories(m_settings.save_directory);
+    }
+}
+
+ChunkProvider::~ChunkProvider() {
+    if (m_world != entt::null && m_registry.valid(m_world) && m_registry.all_of<VoxelGrid>(m_world)) {
+        GetWorld().RemoveOnChunkAnyChangeCallback(m_callback_handle);
+        if (!m_settings.save_directory.empty()) {
+            auto edited = m_edited;
+            for (auto column: edited) {
+                if (m_loaded.count(column)) {
+                    EvictColumn(column);
+                }
+            }
+        }
+    }
+
+    for (auto &[column, job]: m_pending) {
+        job.wait();
+    }
+    for (auto &[column, job]: m_saving) {
+        job.wait();
+    }
+}
+
+void ChunkProvider::Update(double) {
+    if (m_world == entt::null) {
+        for (auto ent: m_registry.view<VoxelGrid>()) {
+            m_world = ent;
+            break;
+        }
+        if (m_world == entt::null) {
+            return;
+        }
+        m_callback_handle = GetWorld().AddOnChunkAnyChangeCallback([this](auto args) {
+            // only edits count, chunks created by the provider can be generated again
+            if (std::holds_alternative<VoxelGrid::ChunkChangedArgs>(args)) {
+                glm::ivec3 position = std::get<VoxelGrid::ChunkChangedArgs>(args).chunk_grid_position;
+                m_edited.insert(glm::ivec2(position.x, position.z) + m_origin);
+            }
+        });
+    }
+
+    for (auto it = m_saving.begin(); it != m_saving.end();) {
+        if (it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            it->second.get();
+            it = m_saving.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    glm::ivec2 observer_column = GetObserverColumn();
+    Recenter(observer_column);
+    observer_column = GetObserverColumn();
+
+    EvictDistantColumns(observer_column);
+    InsertFinishedColumns(false);
+    RequestColumns(observer_column);
+}
+
+void ChunkProvider::Flush() {
+    Update(0.0);
+    // Evicted columns can be loaded back only once they are saved
+    for (auto &[column, job]: m_saving) {
+        job.get();
+    }
+    m_saving.clear();
+    RequestColumns(GetObserverColumn());
+    while (!m_pending.empty()) {
+        InsertFinishedColumns(true);
+        RequestColumns(GetObserverColumn());
+    }
+}
+
+glm::ivec2 ChunkProvider::GetOrigin() const {
+    return m_origin;
+}
+
+size_t ChunkProvider::GetLoadedColumnsCount() const {
+    return m_loaded.size();
+}
+
+size_t ChunkProvider::GetPendingJobsCount() const {
+    return m_pending.size();
+}
+
+ChunkProvider::VoxelGrid &ChunkProvider::GetWorld() {
+    return m_registry.get<VoxelGrid>(m_world);
+}
+
+glm::ivec2 ChunkProvider::GetObserverColumn() {
+    // Same transformation as in WorldRayCast: the grid is centered at the origin of the scene.
+    glm::dvec3 position = m_registry.get<TransformComponent>(m_observer).translation / VOXEL_SIZE +
+                          glm::dvec3(GetWorld().GetDimensions()) * 0.5;
+    glm::ivec3 chunk = glm::ivec3(glm::floor(position / (double) VoxelGrid::CHUNK_SIZE));
+    return glm::ivec2(chunk.x, chunk.z) + m_origin;
+}
+
+void ChunkProvider::Recenter(glm::ivec2 observer_column) {
+    glm::ivec3 grid_dims = GetWorld().GetChunkGridDimensions();
+    glm::ivec2 center = m_origin + glm::ivec2(grid_dims.x, grid_dims.z) / 2;
+    glm::ivec2 delta = observer_column - center;
+    glm::ivec2 threshold = glm::max(glm::ivec2(grid_dims.x, grid_dims.z) / 4, 1);
+    if (glm::abs(delta.x) < threshold.x && glm::abs(delta.y) < threshold.y) {
+        return;
+    }
+
+    // Columns that leave the window are evicted at the old origin first, so their edits are saved.
+    glm::ivec2 origin = m_origin + delta;
+    auto loaded = m_loaded;
+    for (auto column: loaded) {
+        if (!IsInsideWindow(column, origin)) {
+            EvictColumn(column);
+        }
+    }
+
+    m_origin = origin;
+    GetWorld().ShiftChunks(glm::ivec3(-delta.x, 0, -delta.y));
+    m_registry.get<TransformComponent>(m_observer).translation -=
+            glm::dvec3(delta.x, 0, delta.y) * (double) VoxelGrid::CHUNK_SIZE * VOXEL_SIZE;
+}
+
+void ChunkProvider::EvictDistantColumns(glm::ivec2 observer_column) {
+    double unload_radius = m_settings.unload_radius;
+    auto loaded = m_loaded;
+    for (auto column: loaded) {
+        if (glm::length(glm::dvec2(column - observer_column)) > unload_radius) {
+            EvictColumn(column);
+        }
+    }
+}
+
+void ChunkProvider::EvictColumn(glm::ivec2 column) {
+    auto &world = GetWorld();
+    glm::ivec2 grid_column = column - m_origin;
+    bool save = !m_settings.save_directory.empty() && m_edited.count(column);
+
+    ColumnChunks chunks;
+    for (int y = 0; y < world.GetChunkGridDimensions().y; y++) {
+        glm::ivec3 position(grid_column.x, y, grid_column.y);
+        VoxelGrid::ChunkIndexType index = world.GetChunkGridView().At(position);
+        if (index == VoxelGrid::CHUNK_EMPTY) {
+            continue;
+        }
+        if (save) {
+            chunks.push_back(WorldGen::GeneratedChunk{y, std::make_unique<VoxelGrid::ChunkData>(world.GetChunkData(index))});
+        }
+        world.DeleteChunk(position);
+    }
+
+    if (save) {
+        auto path = GetColumnPath(column);
+        auto shared_chunks = std::make_shared<ColumnChunks>(std::move(chunks));
+        m_saving[column] = m_pool.Async([path, shared_chunks]() {
+            SaveColumn(path, *shared_chunks);
+        });
+    }
+    m_edited.erase(column);
+    m_loaded.erase(column);
+}
+
+void ChunkProvider::InsertFinishedColumns(bool wait) {
+    auto &world = GetWorld();
+    double unload_radius = m_settings.unload_radius;
+    glm::ivec2 observer_column = GetObserverColumn();
+
+    std::vector<glm::ivec3> positions;
+    std::vector<VoxelGrid::ChunkData *> data;
+    std::vector<ColumnChunks> finished;
+
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (wait) {
+            it->second.wait();
+        } else if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        glm::ivec2 column = it->first;
+        ColumnChunks chunks;
+        try {
+            chunks = it->second.get();
+        } catch (const std::exception &e) {
+            spdlog::default_logger()->error("Chunk column ({}, {}) failed: {}", column.x, column.y, e.what());
+        }
+        it = m_pending.erase(it);
+
+        // The observer could go away while the column was generated.
+        if (!IsInsideWindow(column) || glm::length(glm::dvec2(column - observer_column)) > unload_radius) {
+            continue;
+        }
+
+        glm::ivec2 grid_column = column - m_origin;
+        for (auto &chunk: chunks) {
+            glm::ivec3 position(grid_column.x, chunk.y, grid_column.y);
+            if (chunk.y < world.GetChunkGridDimensions().y &&
+                world.GetChunkGridView().At(position) == VoxelGrid::CHUNK_EMPTY) {
+                positions.push_back(position);
+                data.push_back(chunk.data.get());
+            }
+        }
+        m_loaded.insert(column);
+        finished.push_back(std::move(chunks));
+    }
+
+    if (positions.empty()) {
+        return;
+    }
+
+    world.CreateChunks(positions, [&](const std::vector<VoxelGrid::ChunkIndexType> &indices) {
+        m_pool.ParallelFor(indices.size(), [&](size_t i) {
+            world.GetChunkData(indices[i]) = *data[i];
+        });
+    });
+}
+
+void ChunkProvider::RequestColumns(glm::ivec2 observer_column) {
+    if (m_pending.size() >= m_settings.max_pending_jobs) {
+        return;
+    }
+
+    glm::dvec3 forward = glm::rotate(m_registry.get<TransformComponent>(m_observer).rotation, glm::dvec3(0, 0, 1));
+    glm::dvec2 forward_xz(forward.x, forward.z);
+    if (glm::length(forward_xz) > 1e-6) {
+        forward_xz = glm::normalize(forward_xz);
+    }
+
+    // Columns are requested in the order of distance, weighted by the angle to the view direction.
+    std::vector<std::pair<double, glm::ivec2>> candidates;
+    int radius = m_settings.load_radius;
+    for (int dx = -radius; dx <= radius; dx++) {
+        for (int dz = -radius; dz <= radius; dz++) {
+            glm::dvec2 offset(dx, dz);
+            double distance = glm::length(offset);
+            glm::ivec2 column = observer_column + glm::ivec2(dx, dz);
+            if (distance > radius || m_loaded.count(column) || m_pending.count(column) || m_saving.count(column) ||
+                !IsInsideWindow(column)) {
+                continue;
+            }
+            double cos_angle = distance > 0 ? glm::dot(offset / distance, forward_xz) : 1.0;
+            candidates.emplace_back(distance * (1.0 + m_settings.view_direction_weight * (1.0 - cos_angle) * 0.5),
+                                    column);
+        }
+    }
+
+    size_t count = std::min(candidates.size(), m_settings.max_pending_jobs - m_pending.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [](const auto &a, const auto &b) {
+                          return a.first != b.first ? a.first < b.first : ColumnComparator()(a.second, b.second);
+                      });
+
+    int world_height = GetWorld().GetDimensions().y;
+    for (size_t i = 0; i < count; i++) {
+        glm::ivec2 column = candidates[i].second;
+        std::string path = m_settings.save_directory.empty() ? std::string() : GetColumnPath(column);
+        WorldGen generator = m_generator;
+        m_pending[column] = m_pool.Async([generator, column, world_height, path]() {
+            if (!path.empty() && std::filesystem::exists(path)) {
+                return LoadColumn(path);
+            }
+            return generator.GenerateChunkColumn(column, world_height);
+        });
+    }
+}
+
+bool ChunkProvider::IsInsideWindow(glm::ivec2 column) {
+    return IsInsideWindow(column, m_origin);
+}
+
+bool ChunkProvider::IsInsideWindow(glm::ivec2 column, glm::ivec2 origin) {
+    glm::ivec3 grid_dims = GetWorld().GetChunkGridDimensions();
+    glm::ivec2 grid_column = column - origin;
+    return grid_column.x >= 0 && grid_column.y >= 0 && grid_column.x < grid_dims.x && grid_column.y < grid_dims.z;
+}
+
+std::string ChunkProvider::GetColumnPath(glm::ivec2 column) const {
+    return (std::filesystem::path(m_settings.save_directory) /
+            ("column_" + std::to_string(column.x) + "_" + std::to_string(column.y) + ".bin")).string();
+}
+
+// Column file: number of chunks, then y and raw voxels of every chunk.
+
+ChunkProvider::ColumnChunks ChunkProvider::LoadColumn(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    int32_t count = 0;
+    file.read((char *) &count, sizeof(count));
+
+    ColumnChunks chunks;
+    for (int32_t i = 0; i < count && file; i++) {
+        WorldGen::GeneratedChunk chunk{0, std::make_unique<VoxelGrid::ChunkData>()};
+        file.read((char *) &chunk.y, sizeof(chunk.y));
+        file.read((char *) chunk.data.get(), sizeof(VoxelGrid::ChunkData));
+        chunks.push_back(std::move(chunk));
+    }
+    if (!file) {
+        throw std::runtime_error("can't read " + path);
+    }
+    return chunks;
+}
+
+void ChunkProvider::SaveColumn(const std::string &path, const ColumnChunks &chunks) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    auto count = (int32_t) chunks.size();
+    file.write((const char *) &count, sizeof(count));
+    for (auto &chunk: chunks) {
+        file.write((const char *) &chunk.y, sizeof(chunk.y));
+        file.write((const char *) chunk.data.get(), sizeof(VoxelGrid::ChunkData));
+    }
+    if (!file) {
+        spdlog::default_logger()->error("Can't save chunk column to {}", path);
+    }
+}
@@ -60,45 +60,47 @@ void lit::engine::VoxelGridGpuDataManager::ProcessAllChangesForEntity(entt::enti
     if (chunk_grid_updated) {
         memcpy(m_chunk_grid_data_buffer.GetHostPtr(), grid_lod.m_grid_lod_data.data(),
                sizeof(uint32_t) * grid_lod.m_grid_lod_data.size());
+
+        m_distance_field_enabled = grid_lod.m_distance_field_enabled;
+        if (m_distance_field_enabled) {
+            ReserveDistanceBuffers(grid_lod);
+            memcpy(m_grid_distance_buffer->GetHostPtr(), grid_lod.m_grid_distance_data.data(),
+                   grid_lod.m_grid_distance_data.size());
+        }
     }
 
-    std::unordered_set<VoxelGrid::ChunkIndexType> chunks_to_update;
+    std::unordered_set<VoxelGrid::ChunkIndexType> touched_chunks;
 
     typename VoxelGrid::ChunkIndexType max_index = 0;
 
     // Determine which chunks need to be updated.
     for (auto &change: changes) {
-        if (std::holds_alternative<ChunkCreatedArgs>(change)) {
-            auto index = std::get<ChunkCreatedArgs>(change).index;
-            chunks_to_update.insert(index);
-            max_index = std::max(max_index, index);
-            m_sorted_chunk_indices.push_back(index);
-
-            if (m_chunk_bucket.size() <= max_index) {
-                m_chunk_bucket.resize(max_index + 1);
-            }
-            if (m_chunk_address.size() <= max_index) {
-                m_chunk_address.resize(max_index + 1);
-            }
-
-            // Put new chunk to the least detailed bucket.
-            // It will find the right bucket later.
-            // TODO: handle error in case if there is no space to allocate new chunk
-            // TODO: this should not really happen, but can happen if world is too sparse and big
-            m_chunk_bucket.at(index) = BUCKET_NUM - 1;
-            m_chunk_address.at(index) = m_allocator[m_chunk_bucket.at(index)].Allocate();
-        } else if (std::holds_alternative<ChunkChangedArgs>(change)) {
-            chunks_to_update.insert(std::get<ChunkChangedArgs>(change).index);
-        } else if (std::holds_alternative<ChunkDeletedArgs>(change)) {
-            auto index = std::get<ChunkDeletedArgs>(change).index;
-            auto it = chunks_to_update.find(index);
-            if (it != chunks_to_update.end()) {
-                chunks_to_update.erase(it);
-            }
-
-            m_allocator[m_chunk_bucket.at(index)].Free(m_chunk_address.at(index));
-            m_sorted_chunk_indices.erase(
-                    std::find(m_sorted_chunk_indices.begin(), m_sorted_chunk_indices.end(), index));
+        std::visit([&](const auto &args) {
+            touched_chunks.insert(args.index);
+            max_index = std::max(max_index, args.index);
+        }, change);
+    }
+    ExpandVectorToSize(m_chunk_bucket, max_index + 1);
+    ExpandVectorToSize(m_chunk_address, max_index + 1);
+    ExpandVectorToSize(m_chunk_owner, max_index + 1);
+    ExpandVectorToSize(m_chunk_storage, max_index + 1);
+
+    // Chunks that were deleted or got other voxels (created or shared) give up their data first,
+    // so new chunks only share data of chunks whose voxels are current
+    std::vector<VoxelGrid::ChunkIndexType> chunks_to_update;
+    for (auto index: touched_chunks) {
+        bool exists = grid.GetChunkGridView().At(grid.GetChunkGridPos(index)) == index;
+        const VoxelGrid::ChunkData *storage = exists ? grid.GetChunkStorage(index) : nullptr;
+        if (m_chunk_storage.at(index) != storage) {
+            ReleaseChunkData(index);
+        }
+        if (exists) {
+            chunks_to_update.push_back(index);
+        }
+    }
+    for (auto index: chunks_to_update) {
+        if (!m_chunk_storage.at(index)) {
+            AcquireChunkData(index, grid.GetChunkStorage(index));
         }
     }
 
@@ -116,18 +118,20 @@ void lit::engine::VoxelGridGpuDataManager::ProcessAllChangesForEntity(entt::enti
                grid_lod.m_chunk_binary_lod_data.data() + offset_elements_begin,
                (offset_elements_end - offset_elements_begin) * sizeof(uint32_t));
 
-        if (m_chunk_bucket.at(index) == 0) {
-            memcpy((uint32_t *) m_chunk_data_buffer.GetHostPtr() + GetGlobalAddress(index),
-                   grid.GetChunkViewAsArray(index).Data(),
-                   (GetChunkLodSizeDword(m_chunk_bucket.at(index))) * sizeof(uint32_t));
-        } else {
-            memcpy((uint32_t *) m_chunk_data_buffer.GetHostPtr() + GetGlobalAddress(index),
-                   grid_lod.GetChunkViewAtLod(index, m_chunk_bucket.at(index)).Data(),
-                   (GetChunkLodSizeDword(m_chunk_bucket.at(index))) * sizeof(uint32_t));
+        if (m_distance_field_enabled) {
+            size_t distance_size = VoxelGridLod::GetChunkDistanceSize();
+            memcpy((uint8_t *) m_chunk_distance_buffer->GetHostPtr() + index * distance_size,
+                   grid_lod.m_chunk_distance_data.data() + index * distance_size, distance_size);
         }
 
-        ((ChunkInfo *) m_chunk_info_buffer.GetHostPtr())[index] = ChunkInfo{GetGlobalAddress(index),
-                                                                            m_chunk_bucket.at(index)};
+        // Shared data is uploaded by its owner
+        uint32_t owner = m_chunk_owner.at(index);
+        if (owner == index) {
+            UploadChunkData(grid, grid_lod, index);
+        } else {
+            ((ChunkInfo *) m_chunk_info_buffer.GetHostPtr())[index] = ChunkInfo{GetGlobalAddress(owner),
+                                                                                m_chunk_bucket.at(owner)};
+        }
         //((ChunkInfo*)m_chunk_info_buffer.GetHostPtr())[index] = ChunkInfo{ 0, 0 };
         //((ChunkInfo*)m_chunk_info_buffer.GetHostPtr())[index] = ChunkInfo{ 0, m_chunk_bucket.at(index) };
     }
@@ -224,6 +228,12 @@ void VoxelGridGpuDataManager::CommitChanges(glm::dvec3 observer_position) {
         distance.at(i) = glm::length(
                 glm::dvec3(glm::dvec3(grid.GetChunkGridPos(i) * VoxelGrid::CHUNK_SIZE) - observer_position));
     }
+    // Shared data is as detailed as the nearest chunk that uses it needs
+    for (auto &[owner, members]: m_chunk_members) {
+        for (auto member: members) {
+            distance.at(owner) = std::min(distance.at(owner), distance.at(member));
+        }
+    }
 
     // Something like a shell sort.
     // It sorts an array ~approximately~, we do not need precise sort on each step here.
@@ -281,18 +291,7 @@ void VoxelGridGpuDataManager::CommitChanges(glm::dvec3 observer_position) {
             m_allocator[old_bucket].Free(m_chunk_address.at(index));
             m_chunk_address.at(index) = m_allocator[m_current_bucket].Allocate();
 
-            if (m_chunk_bucket.at(index) == 0) {
-                memcpy((uint32_t *) m_chunk_data_buffer.GetHostPtr() + GetGlobalAddress(index),
-                       grid.GetChunkViewAsArray(index).Data(),
-                       (GetChunkLodSizeDword(m_chunk_bucket.at(index))) * sizeof(uint32_t));
-            } else {
-                memcpy((uint32_t *) m_chunk_data_buffer.GetHostPtr() + GetGlobalAddress(index),
-                       grid_lod.GetChunkViewAtLod(index, m_chunk_bucket.at(index)).Data(),
-                       (GetChunkLodSizeDword(m_chunk_bucket.at(index))) * sizeof(uint32_t));
-            }
-
-            ((ChunkInfo *) m_chunk_info_buffer.GetHostPtr())[index] = ChunkInfo{GetGlobalAddress(index),
-                                                                                m_chunk_bucket.at(index)};
+            UploadChunkData(grid, grid_lod, index);
 
             m_chunks_in_current_bucket++;
         }
@@ -305,6 +304,91 @@ uint32_t VoxelGridGpuDataManager::GetGlobalAddress(uint32_t index) const {
            GetChunkLodSizeDword(m_chunk_bucket.at(index)) * m_chunk_address.at(index);
 }
 
+void VoxelGridGpuDataManager::AcquireChunkData(uint32_t index, const VoxelGrid::ChunkData *storage) {
+    m_chunk_storage.at(index) = storage;
+    auto [it, inserted] = m_storage_owner.try_emplace(storage, index);
+    if (!inserted) {
+        m_chunk_owner.at(index) = it->second;
+        m_chunk_members[it->second].push_back(index);
+        return;
+    }
+
+    m_chunk_owner.at(index) = index;
+    m_sorted_chunk_indices.push_back(index);
+
+    // Put new chunk to the least detailed bucket.
+    // It will find the right bucket later.
+    // TODO: handle error in case if there is no space to allocate new chunk
+    // TODO: this should not really happen, but can happen if world is too sparse and big
+    m_chunk_bucket.at(index) = BUCKET_NUM - 1;
+    m_chunk_address.at(index) = m_allocator[m_chunk_bucket.at(index)].Allocate();
+}
+
+void VoxelGridGpuDataManager::ReleaseChunkData(uint32_t index) {
+    const VoxelGrid::ChunkData *storage = m_chunk_storage.at(index);
+    if (!storage) {
+        return;
+    }
+    m_chunk_storage.at(index) = nullptr;
+
+    uint32_t owner = m_chunk_owner.at(index);
+    if (owner != index) {
+        auto &members = m_chunk_members.at(owner);
+        members.erase(std::find(members.begin(), members.end(), index));
+        if (members.empty()) {
+            m_chunk_members.erase(owner);
+        }
+        return;
+    }
+
+    auto sorted = std::find(m_sorted_chunk_indices.begin(), m_sorted_chunk_indices.end(), index);
+    auto it = m_chunk_members.find(index);
+    if (it == m_chunk_members.end()) {
+        m_allocator[m_chunk_bucket.at(index)].Free(m_chunk_address.at(index));
+        m_sorted_chunk_indices.erase(sorted);
+        m_storage_owner.erase(storage);
+        return;
+    }
+
+    // Another chunk with the same voxels takes the data over, it is already uploaded
+    std::vector<uint32_t> members = std::move(it->second);
+    m_chunk_members.erase(it);
+    uint32_t new_owner = members.back();
+    members.pop_back();
+    m_chunk_bucket.at(new_owner) = m_chunk_bucket.at(index);
+    m_chunk_address.at(new_owner) = m_chunk_address.at(index);
+    m_chunk_owner.at(new_owner) = new_owner;
+    for (auto member: members) {
+        m_chunk_owner.at(member) = new_owner;
+    }
+    if (!members.empty()) {
+        m_chunk_members[new_owner] = std::move(members);
+    }
+    m_storage_owner.at(storage) = new_owner;
+    *sorted = new_owner;
+}
+
+void VoxelGridGpuDataManager::UploadChunkData(VoxelGrid &grid, VoxelGridLod &grid_lod, uint32_t index) {
+    if (m_chunk_bucket.at(index) == 0) {
+        memcpy((uint32_t *) m_chunk_data_buffer.GetHostPtr() + GetGlobalAddress(index),
+               grid.GetChunkViewAsArray(index).Data(),
+               (GetChunkLodSizeDword(m_chunk_bucket.at(index))) * sizeof(uint32_t));
+    } else {
+        memcpy((uint32_t *) m_chunk_data_buffer.GetHostPtr() + GetGlobalAddress(index),
+               grid_lod.GetChunkViewAtLod(index, m_chunk_bucket.at(index)).Data(),
+               (GetChunkLodSizeDword(m_chunk_bucket.at(index))) * sizeof(uint32_t));
+    }
+
+    ChunkInfo info{GetGlobalAddress(index), m_chunk_bucket.at(index)};
+    ((ChunkInfo *) m_chunk_info_buffer.GetHostPtr())[index] = info;
+    auto it = m_chunk_members.find(index);
+    if (it != m_chunk_members.end()) {
+        for (auto member: it->second) {
+            ((ChunkInfo *) m_chunk_info_buffer.GetHostPtr())[member] = info;
+        }
+    }
+}
+
 UniformBuffer &VoxelGridGpuDataManager::GetChunkGridDataBuffer() {
     return m_chunk_grid_data_buffer;
 }
@@ -356,6 +440,43 @@ UniformBuffer &VoxelGridGpuDataManager::GetChunkInfoBuffer() {
     return m_chunk_info_buffer;
 }
 
+UniformBuffer *VoxelGridGpuDataManager::GetGridDistanceBuffer() {
+    return m_grid_distance_buffer ? &*m_grid_distance_buffer : nullptr;
+}
+
+UniformBuffer *VoxelGridGpuDataManager::GetChunkDistanceBuffer() {
+    return m_chunk_distance_buffer ? &*m_chunk_distance_buffer : nullptr;
+}
+
+void VoxelGridGpuDataManager::ReserveDistanceBuffers(const VoxelGridLod &grid_lod) {
+    uint64_t grid_size = std::max<uint64_t>(grid_lod.m_grid_distance_data.size(), 1);
+    if (!m_grid_distance_buffer || m_grid_distance_buffer->m_size < grid_size) {
+        m_grid_distance_buffer = UniformBuffer::Create({.size = grid_size});
+    }
+
+    // Grows by half, so a growing world recreates the buffer a logarithmic number of times
+    uint64_t chunks_size = std::max<uint64_t>(grid_lod.m_chunk_distance_data.size(), 1);
+    if (!m_chunk_distance_buffer || m_chunk_distance_buffer->m_size < chunks_size) {
+        uint64_t size = chunks_size;
+        if (m_chunk_distance_buffer) {
+            size = std::max(size, m_chunk_distance_buffer->m_size * 3 / 2);
+        }
+        size = std::min(size, CHUNK_DISTANCE_BUFFER_MAX_SIZE_BYTES);
+        if (size < chunks_size) {
+            throw std::runtime_error("chunk distance fields don't fit into " +
+                                     std::to_string(CHUNK_DISTANCE_BUFFER_MAX_SIZE_BYTES / MEGABYTE) + " MB");
+        }
+        m_chunk_distance_buffer = UniformBuffer::Create({.size = size});
+        memcpy(m_chunk_distance_buffer->GetHostPtr(), grid_lod.m_chunk_distance_data.data(),
+               grid_lod.m_chunk_distance_data.size());
+        spdlog::default_logger()->debug("Chunk distance buffer of {:.1f} MB created", size / (double) MEGABYTE);
+    }
+}
+
+bool VoxelGridGpuDataManager::IsDistanceFieldEnabled() const {
+    return m_distance_field_enabled;
+}
+
 uint64_t VoxelGridGpuDataManager::GetBucketOffsetDword(uint32_t bucket) const {
     uint64_t res = 0;
     for (uint32_t i = 0; i < bucket; i++) {
@@ -75,6 +75,12 @@ void VoxelRenderer::Redraw(double dt) {
     m_shader.Bind();
 
     m_shader.SetUniform("uni_time", timee);
+    m_shader.SetUniform("uni_use_distance_field", (int) m_voxel_grid_gpu_data_manager.IsDistanceFieldEnabled());
+    // Distance buffers are created and recreated with the grid, so they are bound every frame
+    if (m_voxel_grid_gpu_data_manager.IsDistanceFieldEnabled()) {
+        m_voxel_grid_gpu_data_manager.GetGridDistanceBuffer()->Bind(20);
+        m_voxel_grid_gpu_data_manager.GetChunkDistanceBuffer()->Bind(21);
+    }
 
     m_shader.Dispatch(glm::ivec3(camera.GetViewport().x, camera.GetViewport().y, 1));
     timee += timer.GetTimeAndReset() * 1000;
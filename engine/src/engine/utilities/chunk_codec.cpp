@@ -0,0 +1,450 @@
+#include <lit/engine/utilities/chunk_codec.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+using namespace lit::engine;
+
+namespace {
+    const int SIZE_LOG = ChunkCodec::VoxelGrid::CHUNK_SIZE_LOG;
+    const int SIZE = ChunkCodec::VoxelGrid::CHUNK_SIZE;
+
+    const uint8_t FLAG_PARENT = 1;
+    const uint8_t FLAG_PACKED = 2;
+
+    const size_t HEADER_SIZE = sizeof(uint8_t) + sizeof(uint16_t);
+
+    // Runs are never longer than a chunk, so their Exp-Golomb codes have at most MAX_RUN_LOG leading zeros
+    const int MAX_RUN_LOG = 3 * SIZE_LOG;
+
+    const size_t BLOCK_VOXELS = 64;
+
+    const size_t WRITER_PADDING = sizeof(uint64_t);
+
+    const size_t LOOKUP_SIZE = ChunkCodec::CHUNK_VOXELS * 2;
+
+    /**
+     * Linear index in ChunkData of every Morton code, bits of x, y and z are interleaved starting from z.
+     */
+    const std::array<uint16_t, ChunkCodec::CHUNK_VOXELS> &GetMortonToLinear() {
+        static const auto table = [] {
+            std::array<uint16_t, ChunkCodec::CHUNK_VOXELS> result{};
+            for (uint32_t m = 0; m < result.size(); m++) {
+                uint32_t x = 0, y = 0, z = 0;
+                for (int bit = 0; bit < SIZE_LOG; bit++) {
+                    z |= ((m >> (3 * bit)) & 1u) << bit;
+                    y |= ((m >> (3 * bit + 1)) & 1u) << bit;
+                    x |= ((m >> (3 * bit + 2)) & 1u) << bit;
+                }
+                result[m] = (uint16_t) ((x << (2 * SIZE_LOG)) | (y << SIZE_LOG) | z);
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    inline uint32_t GetParentIndex(uint32_t linear) {
+        uint32_t x = linear >> (2 * SIZE_LOG + 1);
+        uint32_t y = (linear >> (SIZE_LOG + 1)) & (SIZE / 2 - 1);
+        uint32_t z = (linear >> 1) & (SIZE / 2 - 1);
+        return (x << (2 * SIZE_LOG - 2)) | (y << (SIZE_LOG - 1)) | z;
+    }
+
+    inline int GetBitsCount(size_t symbols) {
+        return symbols <= 1 ? 0 : (int) std::bit_width(symbols - 1);
+    }
+
+    inline int GetRunBitsCount(uint32_t length) {
+        return 2 * ((int) std::bit_width(length) - 1) + 1;
+    }
+
+    /**
+     * Writes to memory of a known size (the stream size is computed before writing) with
+     * WRITER_PADDING bytes after it, so every write stores a whole word without branches.
+     */
+    class BitWriter {
+    public:
+        explicit BitWriter(uint8_t *data) : m_data(data) {}
+
+        /**
+         * Writes up to 56 bits.
+         */
+        void Write(uint64_t value, int bits) {
+            m_buffer |= value << m_bits;
+            m_bits += bits;
+            std::memcpy(m_data, &m_buffer, sizeof(m_buffer));
+            m_data += m_bits >> 3;
+            m_buffer >>= m_bits & ~7;
+            m_bits &= 7;
+        }
+
+        /**
+         * Palette index and Exp-Golomb code of @length > 0: k zero bits, a one bit and k low bits of @length,
+         * k = log2(@length).
+         */
+        void WriteRun(uint32_t symbol, int bits, uint32_t length) {
+            int k = (int) std::bit_width(length) - 1;
+            uint64_t code = (1u << k) | ((uint64_t) (length - (1u << k)) << (k + 1));
+            Write(symbol | (code << bits), bits + 2 * k + 1);
+        }
+
+        void Flush() {
+            for (; m_bits > 0; m_bits -= 8) {
+                *m_data++ = (uint8_t) m_buffer;
+                m_buffer >>= 8;
+            }
+            m_bits = 0;
+        }
+
+    private:
+        uint8_t *m_data;
+        uint64_t m_buffer = 0;
+        int m_bits = 0;
+    };
+
+    class BitReader {
+    public:
+        BitReader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+        uint32_t Read(int bits) {
+            if (m_bits < bits) {
+                Refill();
+            }
+            auto value = (uint32_t) (m_buffer & ((1ull << bits) - 1));
+            m_buffer >>= bits;
+            m_bits -= bits;
+            return value;
+        }
+
+        uint32_t ReadRun() {
+            if (m_bits <= 2 * MAX_RUN_LOG) {
+                Refill();
+            }
+            int k = std::countr_zero(m_buffer);
+            if (k > MAX_RUN_LOG) {
+                throw std::runtime_error("chunk payload has a malformed run");
+            }
+            m_buffer >>= k + 1;
+            m_bits -= k + 1;
+            return (1u << k) | Read(k);
+        }
+
+        /**
+         * Bytes consumed so far, bits past the end of the data are read as zeros and counted too.
+         */
+        size_t GetConsumedBytes() const {
+            return (m_position * 8 - m_bits + 7) / 8;
+        }
+
+    private:
+        // Tops the buffer up to at least 56 bits, it must have at most 56 bits
+        void Refill() {
+            if (m_position + sizeof(uint64_t) <= m_size) {
+                uint64_t word;
+                std::memcpy(&word, m_data + m_position, sizeof(word));
+                m_buffer |= word << m_bits;
+                int bytes = (63 - m_bits) >> 3;
+                m_position += bytes;
+                m_bits += bytes * 8;
+            } else {
+                for (; m_bits <= 56; m_bits += 8, m_position++) {
+                    uint64_t byte = m_position < m_size ? m_data[m_position] : 0;
+                    m_buffer |= byte << m_bits;
+                }
+            }
+        }
+
+        const uint8_t *m_data;
+        size_t m_size;
+        size_t m_position = 0;
+        uint64_t m_buffer = 0;
+        int m_bits = 0;
+    };
+
+    /**
+     * Writes decoded runs to a chunk. A run that covers an aligned block of 8^k Morton codes is a cube with side 2^k,
+     * so it is filled by rows instead of voxel by voxel.
+     */
+    class MortonWriter {
+    public:
+        MortonWriter(uint32_t *voxels, const uint32_t *parent) : m_voxels(voxels), m_parent(parent),
+                                                                 m_morton_to_linear(GetMortonToLinear()) {}
+
+        template<bool FromParent>
+        void Fill(size_t start, size_t count, uint32_t value) {
+            while (count > 0) {
+                int k = std::min(start ? std::countr_zero(start) / 3 : SIZE_LOG, ((int) std::bit_width(count) - 1) / 3);
+                if (k < 2) {
+                    // Blocks smaller than 4^3 are not worth the loops, voxels up to the next block are set one by one
+                    size_t end = start + std::min(count, BLOCK_VOXELS - (start & (BLOCK_VOXELS - 1)));
+                    for (size_t i = start; i < end; i++) {
+                        Set<FromParent>(i, value);
+                    }
+                    count -= end - start;
+                    start = end;
+                    continue;
+                }
+                uint32_t linear = m_morton_to_linear[start];
+                int side = 1 << k;
+                for (int i = 0; i < side; i++) {
+                    for (int j = 0; j < side; j++) {
+                        uint32_t row = linear + (i << (2 * SIZE_LOG)) + (j << SIZE_LOG);
+                        if constexpr (FromParent) {
+                            for (int l = 0; l < side; l++) {
+                                m_voxels[row + l] = m_parent[GetParentIndex(row + l)];
+                            }
+                        } else {
+                            std::fill_n(m_voxels + row, side, value);
+                        }
+                    }
+                }
+                start += (size_t) 1 << (3 * k);
+                count -= (size_t) 1 << (3 * k);
+            }
+        }
+
+        template<bool FromParent>
+        void Set(size_t index, uint32_t value) {
+            uint32_t linear = m_morton_to_linear[index];
+            m_voxels[linear] = FromParent ? m_parent[GetParentIndex(linear)] : value;
+        }
+
+    private:
+        uint32_t *m_voxels;
+        const uint32_t *m_parent;
+        const std::array<uint16_t, ChunkCodec::CHUNK_VOXELS> &m_morton_to_linear;
+    };
+
+    class LinearWriter {
+    public:
+        explicit LinearWriter(uint32_t *values) : m_values(values) {}
+
+        template<bool FromParent>
+        void Fill(size_t start, size_t count, uint32_t value) {
+            std::fill_n(m_values + start, count, value);
+        }
+
+        template<bool FromParent>
+        void Set(size_t index, uint32_t value) {
+            m_values[index] = value;
+        }
+
+    private:
+        uint32_t *m_values;
+    };
+
+    /**
+     * Bits of @values from @begin to @end (at most 64 values) that start a run: the value or its prediction from
+     * the parent differ from the previous ones. Comparisons are independent and vectorized, so short runs don't
+     * cost branch mispredictions.
+     */
+    template<bool Delta>
+    uint64_t GetRunStarts(const uint32_t *values, const uint32_t *parent, size_t begin, size_t end) {
+        uint8_t starts[64] = {};
+        for (size_t i = std::max<size_t>(begin, 1); i < end; i++) {
+            bool start = values[i] != values[i - 1];
+            if constexpr (Delta) {
+                start |= (values[i] == parent[i >> 3]) != (values[i - 1] == parent[(i - 1) >> 3]);
+            }
+            starts[i - begin] = start;
+        }
+        starts[0] |= begin == 0;
+        // Multiplication moves bytes of 0 or 1 to the bits of the top byte
+        uint64_t mask = 0;
+        for (int i = 0; i < 64; i += 8) {
+            uint64_t bytes;
+            std::memcpy(&bytes, starts + i, sizeof(bytes));
+            mask |= ((bytes * 0x0102040810204080ull) >> 56) << i;
+        }
+        return mask;
+    }
+
+    template<typename Writer>
+    size_t DecodeSymbols(const uint8_t *payload, size_t size, bool has_parent, size_t count, Writer writer) {
+        if (size < HEADER_SIZE) {
+            throw std::runtime_error("chunk payload is truncated");
+        }
+        uint8_t flags = payload[0];
+        uint16_t palette_size;
+        std::memcpy(&palette_size, payload + 1, sizeof(palette_size));
+        bool delta = (flags & FLAG_PARENT) != 0;
+        if (delta && !has_parent) {
+            throw std::runtime_error("chunk payload needs the parent LOD");
+        }
+        size_t palette_end = HEADER_SIZE + palette_size * sizeof(uint32_t);
+        if (size < palette_end) {
+            throw std::runtime_error("chunk payload is truncated");
+        }
+
+        // Symbol 0 of delta coded chunks takes the value of the parent
+        std::vector<uint32_t> palette(palette_size + delta);
+        std::memcpy(palette.data() + delta, payload + HEADER_SIZE, palette_size * sizeof(uint32_t));
+        auto symbols = (uint32_t) palette.size();
+        int bits = GetBitsCount(symbols);
+
+        BitReader reader(payload + palette_end, size - palette_end);
+        if (flags & FLAG_PACKED) {
+            for (size_t i = 0; i < count; i++) {
+                uint32_t symbol = reader.Read(bits);
+                if (symbol >= symbols) {
+                    throw std::runtime_error("chunk payload has a malformed index");
+                }
+                if (delta && symbol == 0) {
+                    writer.template Set<true>(i, 0);
+                } else {
+                    writer.template Set<false>(i, palette[symbol]);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < count;) {
+                uint32_t symbol = reader.Read(bits);
+                uint32_t length = reader.ReadRun();
+                if (symbol >= symbols || length > count - i) {
+                    throw std::runtime_error("chunk payload has a malformed run");
+                }
+                if (delta && symbol == 0) {
+                    writer.template Fill<true>(i, length, 0);
+                } else {
+                    writer.template Fill<false>(i, length, palette[symbol]);
+                }
+                i += length;
+            }
+        }
+
+        size_t consumed = palette_end + reader.GetConsumedBytes();
+        if (consumed > size) {
+            throw std::runtime_error("chunk payload is truncated");
+        }
+        return consumed;
+    }
+}
+
+uint32_t ChunkCodec::GetPaletteIndex(uint32_t value) {
+    size_t slot = (value * 2654435761u) & (LOOKUP_SIZE - 1);
+    while (m_lookup_stamps[slot] == m_stamp) {
+        if (m_lookup_keys[slot] == value) {
+            return m_lookup_indices[slot];
+        }
+        slot = (slot + 1) & (LOOKUP_SIZE - 1);
+    }
+    // One less than UINT16_MAX, so that indices of delta coded chunks fit into symbols too
+    if (m_palette.size() >= UINT16_MAX) {
+        throw std::invalid_argument("too many distinct values to encode");
+    }
+    m_lookup_stamps[slot] = m_stamp;
+    m_lookup_keys[slot] = value;
+    m_lookup_indices[slot] = (uint16_t) m_palette.size();
+    m_palette.push_back(value);
+    return m_lookup_indices[slot];
+}
+
+void ChunkCodec::EncodeSymbols(const uint32_t *values, const uint32_t *parent, size_t count,
+                               std::vector<uint8_t> &out) {
+    if (m_lookup_stamps.empty()) {
+        m_lookup_keys.resize(LOOKUP_SIZE);
+        m_lookup_indices.resize(LOOKUP_SIZE);
+        m_lookup_stamps.resize(LOOKUP_SIZE);
+    }
+    if (++m_stamp == 0) {
+        std::fill(m_lookup_stamps.begin(), m_lookup_stamps.end(), 0);
+        m_stamp = 1;
+    }
+    m_palette.clear();
+    m_runs.clear();
+
+    // Palette indices are found once per run, values that are always predicted are not added to the palette
+    const bool delta = parent != nullptr;
+    auto add = [&](size_t start, size_t end) {
+        uint32_t value = values[start];
+        auto symbol = (uint16_t) (delta && value == parent[start >> 3] ? 0 : GetPaletteIndex(value) + delta);
+        if (!m_runs.empty() && m_runs.back().symbol == symbol) {
+            m_runs.back().length += (uint32_t) (end - start);
+        } else {
+            m_runs.push_back({symbol, (uint32_t) (end - start)});
+        }
+    };
+    size_t run_start = 0;
+    for (size_t begin = 0; begin < count; begin += 64) {
+        size_t end = std::min(count, begin + 64);
+        uint64_t starts = delta ? GetRunStarts<true>(values, parent, begin, end) :
+                          GetRunStarts<false>(values, parent, begin, end);
+        for (; starts; starts &= starts - 1) {
+            size_t start = begin + std::countr_zero(starts);
+            if (start > run_start) {
+                add(run_start, start);
+                run_start = start;
+            }
+        }
+    }
+    if (count > 0) {
+        add(run_start, count);
+    }
+
+    size_t symbols = m_palette.size() + delta;
+    int bits = GetBitsCount(symbols);
+    size_t runs_bits = 0;
+    for (auto &run: m_runs) {
+        runs_bits += bits + GetRunBitsCount(run.length);
+    }
+    bool packed = bits * count < runs_bits;
+    size_t stream_bytes = ((packed ? bits * count : runs_bits) + 7) / 8;
+
+    auto palette_size = (uint16_t) m_palette.size();
+    size_t header = out.size();
+    size_t palette_end = header + HEADER_SIZE + m_palette.size() * sizeof(uint32_t);
+    out.resize(palette_end + stream_bytes + WRITER_PADDING);
+    out[header] = (uint8_t) ((delta ? FLAG_PARENT : 0) | (packed ? FLAG_PACKED : 0));
+    std::memcpy(out.data() + header + 1, &palette_size, sizeof(palette_size));
+    std::memcpy(out.data() + header + HEADER_SIZE, m_palette.data(), m_palette.size() * sizeof(uint32_t));
+
+    BitWriter writer(out.data() + palette_end);
+    for (auto &run: m_runs) {
+        if (packed) {
+            for (uint32_t i = 0; i < run.length; i++) {
+                writer.Write(run.symbol, bits);
+            }
+        } else {
+            writer.WriteRun(run.symbol, bits, run.length);
+        }
+    }
+    writer.Flush();
+    out.resize(palette_end + stream_bytes);
+}
+
+void ChunkCodec::Encode(const ChunkData &data, const uint32_t *parent, std::vector<uint8_t> &out) {
+    auto &morton_to_linear = GetMortonToLinear();
+    const uint32_t *voxels = &data[0][0][0];
+    m_values.resize(CHUNK_VOXELS);
+    if (parent) {
+        // Parent of Morton code m is the parent cell with Morton code m / 8
+        m_parent.resize(PARENT_VOXELS);
+        for (size_t i = 0; i < PARENT_VOXELS; i++) {
+            m_parent[i] = parent[GetParentIndex(morton_to_linear[i * 8])];
+        }
+    }
+    // Morton codes 2k and 2k + 1 differ only in the lowest bit of z, so voxels are copied in pairs
+    for (size_t i = 0; i < CHUNK_VOXELS; i += 2) {
+        std::memcpy(&m_values[i], voxels + morton_to_linear[i], 2 * sizeof(uint32_t));
+    }
+    EncodeSymbols(m_values.data(), parent ? m_parent.data() : nullptr, CHUNK_VOXELS, out);
+}
+
+void ChunkCodec::EncodeValues(const uint32_t *values, size_t count, std::vector<uint8_t> &out) {
+    if (count > CHUNK_VOXELS) {
+        throw std::invalid_argument("too many values to encode");
+    }
+    EncodeSymbols(values, nullptr, count, out);
+}
+
+size_t ChunkCodec::Decode(const uint8_t *payload, size_t size, const uint32_t *parent, ChunkData &data) {
+    return DecodeSymbols(payload, size, parent != nullptr, CHUNK_VOXELS, MortonWriter(&data[0][0][0], parent));
+}
+
+size_t ChunkCodec::DecodeValues(const uint8_t *payload, size_t size, uint32_t *values, size_t count) {
+    if (count > CHUNK_VOXELS) {
+        throw std::invalid_argument("too many values to decode");
+    }
+    return DecodeSymbols(payload, size, false, count, LinearWriter(values));
+}
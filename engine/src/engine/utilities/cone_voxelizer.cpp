@@ -0,0 +1,300 @@
+#include <lit/engine/utilities/cone_voxelizer.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace lit::engine;
+
+ConeVoxelizer::ConeVoxelizer(std::vector<RoundCone> cones) {
+    for (auto &cone: cones) {
+        Shape shape;
+        shape.begin = cone.begin;
+        shape.end = cone.end;
+        shape.length = glm::length(cone.end - cone.begin);
+        // Degenerate cone is the sphere at its begin
+        shape.direction = shape.length > 1e-6f ? (cone.end - cone.begin) / shape.length : glm::vec3(0, 1, 0);
+        shape.radius_begin = cone.radius_begin;
+        shape.radius_end = cone.radius_end;
+        shape.slope = shape.length > 1e-6f ? (cone.radius_end - cone.radius_begin) / shape.length : 0.0f;
+        shape.bounding_radius = std::max(cone.radius_begin, cone.radius_end);
+        shape.value = cone.value;
+        // Bounding box of a cone is the bounding box of its end spheres
+        shape.min = glm::min(cone.begin - cone.radius_begin, cone.end - cone.radius_end);
+        shape.max = glm::max(cone.begin + cone.radius_begin, cone.end + cone.radius_end);
+        m_shapes.push_back(shape);
+    }
+
+    m_order.resize(m_shapes.size());
+    for (uint32_t i = 0; i < m_order.size(); i++) {
+        m_order[i] = i;
+    }
+    if (!m_shapes.empty()) {
+        Build(0, (uint32_t) m_shapes.size());
+    }
+}
+
+bool ConeVoxelizer::IsVectorized() {
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t ConeVoxelizer::Build(uint32_t begin, uint32_t end) {
+    auto index = (uint32_t) m_nodes.size();
+    Node node{glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()), begin,
+              end - begin};
+    glm::vec3 centers_min(std::numeric_limits<float>::max());
+    glm::vec3 centers_max(std::numeric_limits<float>::lowest());
+    for (uint32_t i = begin; i < end; i++) {
+        node.min = glm::min(node.min, m_shapes[m_order[i]].min);
+        node.max = glm::max(node.max, m_shapes[m_order[i]].max);
+        glm::vec3 center = (m_shapes[m_order[i]].min + m_shapes[m_order[i]].max) * 0.5f;
+        centers_min = glm::min(centers_min, center);
+        centers_max = glm::max(centers_max, center);
+    }
+    m_nodes.push_back(node);
+
+    if (end - begin <= LEAF_SIZE) {
+        return index;
+    }
+
+    // Columns are vertical, so only x and z are split
+    int axis = centers_max.x - centers_min.x >= centers_max.z - centers_min.z ? 0 : 2;
+    uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(m_order.begin() + begin, m_order.begin() + middle, m_order.begin() + end,
+                     [&](uint32_t a, uint32_t b) {
+                         return m_shapes[a].min[axis] + m_shapes[a].max[axis] < m_shapes[b].min[axis] + m_shapes[b].max[axis];
+                     });
+
+    Build(begin, middle);
+    uint32_t right = Build(middle, end);
+    m_nodes[index].first = right;
+    m_nodes[index].count = 0;
+    return index;
+}
+
+void ConeVoxelizer::QueryTile(glm::vec2 min, glm::vec2 max, std::vector<uint32_t> &result,
+                              std::vector<uint32_t> &stack) const {
+    result.clear();
+    stack.assign(1, 0);
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        auto &node = m_nodes[index];
+        stack.pop_back();
+        if (max.x < node.min.x || min.x > node.max.x || max.y < node.min.z || min.y > node.max.z) {
+            continue;
+        }
+        if (node.count > 0) {
+            result.insert(result.end(), m_order.begin() + node.first, m_order.begin() + node.first + node.count);
+        } else {
+            stack.push_back(index + 1);
+            stack.push_back(node.first);
+        }
+    }
+}
+
+bool ConeVoxelizer::GetColumnSpan(const Shape &shape, glm::vec2 xz, float &y_min, float &y_max) const {
+    // Intersection of the vertical line with the capsule of the bounding radius, the capsule is convex,
+    // so the union of the intersections with its end spheres and its cylinder is a single segment.
+    float r2 = shape.bounding_radius * shape.bounding_radius;
+    y_min = std::numeric_limits<float>::max();
+    y_max = std::numeric_limits<float>::lowest();
+
+    auto addSphere = [&](glm::vec3 center) {
+        float dx = xz.x - center.x;
+        float dz = xz.y - center.z;
+        float s = r2 - dx * dx - dz * dz;
+        if (s >= 0) {
+            float half = std::sqrt(s);
+            y_min = std::min(y_min, center.y - half);
+            y_max = std::max(y_max, center.y + half);
+        }
+    };
+    addSphere(shape.begin);
+    addSphere(shape.end);
+
+    // u = y - begin.y, distance to the axis: |w|^2 - (w, d)^2 <= r^2, a * u^2 + b * u + c <= 0
+    glm::vec3 d = shape.direction;
+    float wx = xz.x - shape.begin.x;
+    float wz = xz.y - shape.begin.z;
+    float h = wx * d.x + wz * d.z;
+    float a = 1.0f - d.y * d.y;
+    float b = -2.0f * h * d.y;
+    float c = wx * wx + wz * wz - h * h - r2;
+
+    float u_min, u_max;
+    if (a < 1e-6f) {
+        if (c > 0) {
+            return y_min <= y_max;
+        }
+        u_min = std::numeric_limits<float>::lowest();
+        u_max = std::numeric_limits<float>::max();
+    } else {
+        float discriminant = b * b - 4 * a * c;
+        if (discriminant < 0) {
+            return y_min <= y_max;
+        }
+        float root = std::sqrt(discriminant);
+        u_min = (-b - root) / (2 * a);
+        u_max = (-b + root) / (2 * a);
+    }
+
+    // Projection to the axis t = h + u * d.y must be in [0, length]
+    if (std::abs(d.y) > 1e-6f) {
+        float t0 = -h / d.y;
+        float t1 = (shape.length - h) / d.y;
+        u_min = std::max(u_min, std::min(t0, t1));
+        u_max = std::min(u_max, std::max(t0, t1));
+    } else if (h < 0 || h > shape.length) {
+        return y_min <= y_max;
+    }
+
+    if (u_min <= u_max) {
+        y_min = std::min(y_min, u_min + shape.begin.y);
+        y_max = std::max(y_max, u_max + shape.begin.y);
+    }
+    return y_min <= y_max;
+}
+
+void ConeVoxelizer::RasterizeSpan(const Shape &shape, glm::vec2 xz, float y_offset, int y_begin, int y_end,
+                                  uint32_t *values) const {
+    glm::vec3 d = shape.direction;
+    float wx = xz.x - shape.begin.x;
+    float wz = xz.y - shape.begin.z;
+    float h = wx * d.x + wz * d.z;
+    float q_begin = wx * wx + wz * wz;
+    float q_end = (xz.x - shape.end.x) * (xz.x - shape.end.x) + (xz.y - shape.end.z) * (xz.y - shape.end.z);
+    float end_dy = shape.begin.y - shape.end.y;
+    float radius_begin2 = shape.radius_begin * shape.radius_begin;
+    float radius_end2 = shape.radius_end * shape.radius_end;
+
+    int j = y_begin;
+#if defined(__AVX2__)
+    const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i lane_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 length = _mm256_set1_ps(shape.length);
+    const __m256i value = _mm256_set1_epi32((int) shape.value);
+    for (; j < y_end; j += 8) {
+        // u = y - begin.y for the centers of 8 voxels
+        __m256 u = _mm256_add_ps(_mm256_set1_ps((float) j + y_offset - shape.begin.y), lane);
+        __m256 t = _mm256_add_ps(_mm256_mul_ps(u, _mm256_set1_ps(d.y)), _mm256_set1_ps(h));
+        __m256 dist_begin = _mm256_add_ps(_mm256_mul_ps(u, u), _mm256_set1_ps(q_begin));
+        __m256 u_end = _mm256_add_ps(u, _mm256_set1_ps(end_dy));
+        __m256 dist_end = _mm256_add_ps(_mm256_mul_ps(u_end, u_end), _mm256_set1_ps(q_end));
+        __m256 radius = _mm256_add_ps(_mm256_mul_ps(t, _mm256_set1_ps(shape.slope)), _mm256_set1_ps(shape.radius_begin));
+        __m256 axis_dist = _mm256_sub_ps(dist_begin, _mm256_mul_ps(t, t));
+
+        __m256 in_cone = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GE_OQ), _mm256_cmp_ps(t, length, _CMP_LE_OQ)),
+                _mm256_cmp_ps(axis_dist, _mm256_mul_ps(radius, radius), _CMP_LE_OQ));
+        __m256 in_begin = _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_LT_OQ),
+                                        _mm256_cmp_ps(dist_begin, _mm256_set1_ps(radius_begin2), _CMP_LE_OQ));
+        __m256 in_end = _mm256_and_ps(_mm256_cmp_ps(t, length, _CMP_GT_OQ),
+                                      _mm256_cmp_ps(dist_end, _mm256_set1_ps(radius_end2), _CMP_LE_OQ));
+        __m256i inside = _mm256_castps_si256(_mm256_or_ps(in_cone, _mm256_or_ps(in_begin, in_end)));
+        inside = _mm256_and_si256(inside, _mm256_cmpgt_epi32(_mm256_set1_epi32(y_end - j), lane_index));
+        _mm256_maskstore_epi32((int *) (values + j), inside, value);
+    }
+#endif
+    for (; j < y_end; j++) {
+        float u = (float) j + y_offset - shape.begin.y;
+        float t = h + u * d.y;
+        float dist_begin = q_begin + u * u;
+        bool inside;
+        if (t < 0) {
+            inside = dist_begin <= radius_begin2;
+        } else if (t > shape.length) {
+            inside = q_end + (u + end_dy) * (u + end_dy) <= radius_end2;
+        } else {
+            float radius = shape.radius_begin + shape.slope * t;
+            inside = dist_begin - t * t <= radius * radius;
+        }
+        if (inside) {
+            values[j] = shape.value;
+        }
+    }
+}
+
+void ConeVoxelizer::Voxelize(VoxelGridBaseT<uint32_t> &grid) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    glm::ivec3 dims = grid.GetDimensions();
+    glm::vec3 anchor = grid.GetAnchor();
+
+    // Voxels whose centers can be inside of the root box
+    glm::ivec3 begin = glm::max(glm::ivec3(glm::floor(m_nodes[0].min + anchor - 0.5f)), 0);
+    glm::ivec3 end = glm::min(glm::ivec3(glm::ceil(m_nodes[0].max + anchor - 0.5f)) + 1, dims);
+
+    // Values of the current column, padded for the masked stores of the last 8 voxels
+    std::vector<uint32_t> values(dims.y + 8, 0);
+    std::vector<uint32_t> shapes, stack;
+    for (int tile_x = begin.x; tile_x < end.x; tile_x += TILE_SIZE) {
+        for (int tile_z = begin.z; tile_z < end.z; tile_z += TILE_SIZE) {
+            // One BVH query per tile of columns, shapes are in the original order, so later cones overwrite earlier ones
+            int tile_end_x = std::min(tile_x + TILE_SIZE, end.x);
+            int tile_end_z = std::min(tile_z + TILE_SIZE, end.z);
+            QueryTile(glm::vec2((float) tile_x + 0.5f - anchor.x, (float) tile_z + 0.5f - anchor.z),
+                      glm::vec2((float) tile_end_x - 0.5f - anchor.x, (float) tile_end_z - 0.5f - anchor.z),
+                      shapes, stack);
+            if (shapes.empty()) {
+                continue;
+            }
+            std::sort(shapes.begin(), shapes.end());
+
+            for (int i = tile_x; i < tile_end_x; i++) {
+                for (int k = tile_z; k < tile_end_z; k++) {
+                    VoxelizeColumn(grid, shapes, glm::ivec2(i, k), values);
+                }
+            }
+        }
+    }
+}
+
+void ConeVoxelizer::VoxelizeColumn(VoxelGridBaseT<uint32_t> &grid, const std::vector<uint32_t> &shapes,
+                                   glm::ivec2 column, std::vector<uint32_t> &values) const {
+    int height = grid.GetDimensions().y;
+    glm::vec3 anchor = grid.GetAnchor();
+    glm::vec2 xz((float) column.x + 0.5f - anchor.x, (float) column.y + 0.5f - anchor.z);
+
+    int column_begin = height;
+    int column_end = 0;
+    for (uint32_t index: shapes) {
+        auto &shape = m_shapes[index];
+        float y_min, y_max;
+        if (xz.x < shape.min.x || xz.x > shape.max.x || xz.y < shape.min.z || xz.y > shape.max.z ||
+            !GetColumnSpan(shape, xz, y_min, y_max)) {
+            continue;
+        }
+        int j_begin = std::max((int) std::floor(y_min + anchor.y - 0.5f), 0);
+        int j_end = std::min((int) std::ceil(y_max + anchor.y - 0.5f) + 1, height);
+        if (j_begin >= j_end) {
+            continue;
+        }
+        RasterizeSpan(shape, xz, 0.5f - anchor.y, j_begin, j_end, values.data());
+        column_begin = std::min(column_begin, j_begin);
+        column_end = std::max(column_end, j_end);
+    }
+
+    for (int j = column_begin; j < column_end;) {
+        uint32_t value = values[j];
+        int run_end = j + 1;
+        while (run_end < column_end && values[run_end] == value) {
+            run_end++;
+        }
+        if (value) {
+            grid.FillColumn({column.x, j, column.y}, run_end - j, value);
+        }
+        j = run_end;
+    }
+    std::fill(values.begin() + std::min(column_begin, column_end), values.begin() + column_end, 0);
+}
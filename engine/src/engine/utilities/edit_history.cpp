@@ -0,0 +1,207 @@
+#include <lit/engine/utilities/edit_history.hpp>
+#include <cstring>
+
+using namespace lit::engine;
+
+using VoxelGrid = EditHistory::VoxelGrid;
+
+namespace {
+    const size_t CHUNK_VOXELS = (size_t) 1 << (3 * VoxelGrid::CHUNK_SIZE_LOG);
+
+    // Voxels of missing chunks
+    const VoxelGrid::ChunkData EMPTY_CHUNK{};
+
+    void writeVarint(uint32_t value, std::vector<uint8_t> &out) {
+        while (value >= 0x80) {
+            out.push_back(uint8_t(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(uint8_t(value));
+    }
+
+    uint32_t readVarint(const uint8_t *&data) {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t byte = *data++;
+            value |= uint32_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    const uint32_t *voxelsOf(const VoxelGrid::ChunkData &data) {
+        return &data[0][0][0];
+    }
+}
+
+EditHistory::EditHistory(VoxelGrid &grid, size_t memory_budget) : m_grid(grid), m_memory_budget(memory_budget) {
+    m_callback = grid.AddOnChunkBeforeChangeCallback([this](const glm::ivec3 &position) {
+        OnBeforeChange(position);
+    });
+}
+
+EditHistory::~EditHistory() {
+    m_grid.RemoveOnChunkBeforeChangeCallback(m_callback);
+}
+
+void EditHistory::OnBeforeChange(const glm::ivec3 &position) {
+    if (m_applying || m_pending.contains(position)) {
+        return;
+    }
+    VoxelGrid::ChunkIndexType index = m_grid.GetChunkGridView().At(position);
+    if (index == VoxelGrid::CHUNK_EMPTY) {
+        m_pending.emplace(position, nullptr);
+        return;
+    }
+    auto copy = std::make_unique_for_overwrite<ChunkData>();
+    *copy = m_grid.GetChunkData(index);
+    m_pending.emplace(position, std::move(copy));
+}
+
+void EditHistory::EncodeDelta(const uint32_t *before, const uint32_t *after, std::vector<uint8_t> &out) {
+    for (size_t i = 0; i < CHUNK_VOXELS;) {
+        uint32_t value = before[i] ^ after[i];
+        size_t end = i + 1;
+        while (end < CHUNK_VOXELS && (before[end] ^ after[end]) == value) {
+            end++;
+        }
+        writeVarint(uint32_t(end - i), out);
+        writeVarint(value, out);
+        i = end;
+    }
+}
+
+void EditHistory::ApplyDelta(const std::vector<uint8_t> &runs, uint32_t *voxels) {
+    const uint8_t *data = runs.data();
+    const uint8_t *end = data + runs.size();
+    size_t i = 0;
+    while (data < end) {
+        size_t length = readVarint(data);
+        uint32_t value = readVarint(data);
+        if (value != 0) {
+            for (size_t j = i; j < i + length; j++) {
+                voxels[j] ^= value;
+            }
+        }
+        i += length;
+    }
+}
+
+void EditHistory::Commit() {
+    if (m_pending.empty()) {
+        return;
+    }
+
+    Transaction transaction;
+    for (auto &[position, before]: m_pending) {
+        VoxelGrid::ChunkIndexType index = m_grid.GetChunkGridView().At(position);
+        bool exists = index != VoxelGrid::CHUNK_EMPTY;
+        const uint32_t *before_voxels = voxelsOf(before ? *before : EMPTY_CHUNK);
+        const uint32_t *after_voxels = voxelsOf(exists ? m_grid.GetChunkData(index) : EMPTY_CHUNK);
+        // Chunks that were changed back
+        if ((before != nullptr) == exists && std::memcmp(before_voxels, after_voxels, sizeof(ChunkData)) == 0) {
+            continue;
+        }
+
+        ChunkDelta delta{position, before != nullptr, exists, {}};
+        EncodeDelta(before_voxels, after_voxels, delta.runs);
+        delta.runs.shrink_to_fit();
+        transaction.size_bytes += sizeof(ChunkDelta) + delta.runs.capacity();
+        transaction.chunks.push_back(std::move(delta));
+    }
+    m_pending.clear();
+    if (transaction.chunks.empty()) {
+        return;
+    }
+
+    for (auto &undone: m_redo) {
+        m_memory_usage -= undone.size_bytes;
+    }
+    m_redo.clear();
+    m_memory_usage += transaction.size_bytes;
+    m_undo.push_back(std::move(transaction));
+    Evict();
+}
+
+void EditHistory::Apply(const Transaction &transaction, bool undo) {
+    std::vector<glm::ivec3> created;
+    std::vector<std::unique_ptr<ChunkData>> created_data;
+    std::vector<glm::ivec3> updated;
+    std::vector<const std::vector<uint8_t> *> updated_runs;
+    std::vector<glm::ivec3> deleted;
+
+    for (auto &delta: transaction.chunks) {
+        bool target = undo ? delta.existed_before : delta.exists_after;
+        bool current = m_grid.GetChunkGridView().At(delta.position) != VoxelGrid::CHUNK_EMPTY;
+        if (!target) {
+            if (current) {
+                deleted.push_back(delta.position);
+            }
+        } else if (!current) {
+            // Voxels of a missing chunk are zeros, so the delta gives the target voxels
+            auto data = std::make_unique<ChunkData>();
+            ApplyDelta(delta.runs, &(*data)[0][0][0]);
+            created.push_back(delta.position);
+            created_data.push_back(std::move(data));
+        } else {
+            updated.push_back(delta.position);
+            updated_runs.push_back(&delta.runs);
+        }
+    }
+
+    m_applying = true;
+    for (auto &position: deleted) {
+        m_grid.DeleteChunk(position);
+    }
+    m_grid.InsertChunks(created, std::move(created_data));
+    m_grid.UpdateChunks(updated, [&](const std::vector<VoxelGrid::ChunkIndexType> &indices) {
+        for (size_t i = 0; i < indices.size(); i++) {
+            ApplyDelta(*updated_runs[i], &m_grid.GetChunkData(indices[i])[0][0][0]);
+        }
+    });
+    m_applying = false;
+}
+
+bool EditHistory::Undo() {
+    Commit();
+    if (m_undo.empty()) {
+        return false;
+    }
+    Transaction transaction = std::move(m_undo.back());
+    m_undo.pop_back();
+    Apply(transaction, true);
+    m_redo.push_back(std::move(transaction));
+    return true;
+}
+
+bool EditHistory::Redo() {
+    Commit();
+    if (m_redo.empty()) {
+        return false;
+    }
+    Transaction transaction = std::move(m_redo.back());
+    m_redo.pop_back();
+    Apply(transaction, false);
+    m_undo.push_back(std::move(transaction));
+    return true;
+}
+
+void EditHistory::Evict() {
+    // Oldest transactions first, then the undone ones farthest from the current state
+    while (m_memory_usage > m_memory_budget && !m_undo.empty()) {
+        m_memory_usage -= m_undo.front().size_bytes;
+        m_undo.pop_front();
+    }
+    while (m_memory_usage > m_memory_budget && !m_redo.empty()) {
+        m_memory_usage -= m_redo.front().size_bytes;
+        m_redo.pop_front();
+    }
+}
+
+void EditHistory::Clear() {
+    m_pending.clear();
+    m_undo.clear();
+    m_redo.clear();
+    m_memory_usage = 0;
+}
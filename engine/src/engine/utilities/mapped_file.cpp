@@ -0,0 +1,101 @@
+#include <lit/engine/utilities/mapped_file.hpp>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace lit::engine;
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string &path) {
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        throw std::runtime_error("can't open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size)) {
+        CloseHandle(m_file);
+        throw std::runtime_error("can't get size of " + path);
+    }
+    m_size = (size_t) size.QuadPart;
+    if (m_size == 0) {
+        // Empty files can't be mapped
+        return;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping) {
+        m_data = static_cast<const uint8_t *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!m_data) {
+        if (m_mapping) {
+            CloseHandle(m_mapping);
+        }
+        CloseHandle(m_file);
+        throw std::runtime_error("can't map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file) {
+        CloseHandle(m_file);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path) {
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file < 0) {
+        throw std::runtime_error("can't open " + path);
+    }
+
+    struct stat info{};
+    if (fstat(m_file, &info) != 0) {
+        close(m_file);
+        throw std::runtime_error("can't get size of " + path);
+    }
+    m_size = (size_t) info.st_size;
+    if (m_size == 0) {
+        // Empty files can't be mapped
+        return;
+    }
+
+    void *data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_file, 0);
+    if (data == MAP_FAILED) {
+        close(m_file);
+        throw std::runtime_error("can't map " + path);
+    }
+    // Chunks are read in no particular order
+    madvise(data, m_size, MADV_RANDOM);
+    m_data = static_cast<const uint8_t *>(data);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+    if (m_file >= 0) {
+        close(m_file);
+    }
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include <lit/engine/utilities/scene_snapshot.hpp>
+#include <lit/engine/utilities/world_file.hpp>
+#include <lit/engine/components/tag.hpp>
+#include <lit/engine/components/world_reference.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+using namespace lit::engine;
+
+using VoxelGrid = WorldFile::VoxelGrid;
+using VoxelGridLod = WorldFile::VoxelGridLod;
+
+namespace {
+    const char MAGIC[4] = {'L', 'I', 'T', 'S'};
+
+    void append(std::vector<uint8_t> &out, const void *data, size_t size) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    /**
+     * Reads @size bytes from the position of @data and advances it, throws if the buffer ends before.
+     */
+    const uint8_t *take(const uint8_t *&data, const uint8_t *end, size_t size, const std::string &path) {
+        if ((size_t) (end - data) < size) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        const uint8_t *result = data;
+        data += size;
+        return result;
+    }
+}
+
+SceneSnapshot SceneSnapshot::Capture(entt::registry &registry) {
+    std::vector<entt::entity> entities;
+    for (auto ent: registry.view<TagComponent, TransformComponent>()) {
+        entities.push_back(ent);
+    }
+    // Views don't keep the order of creation
+    std::sort(entities.begin(), entities.end(), [](entt::entity a, entt::entity b) {
+        return static_cast<uint32_t>(a) < static_cast<uint32_t>(b);
+    });
+
+    SceneSnapshot snapshot;
+    snapshot.m_entities.reserve(entities.size());
+    for (auto ent: entities) {
+        Entity entity{registry.get<TagComponent>(ent).tag, registry.get<TransformComponent>(ent), std::nullopt, {},
+                      false};
+        if (auto camera = registry.try_get<CameraComponent>(ent)) {
+            entity.camera = camera->GetSettings();
+        }
+        if (registry.try_get<VoxelGrid>(ent)) {
+            auto reference = registry.try_get<WorldReferenceComponent>(ent);
+            if (!reference || reference->path.empty()) {
+                throw std::invalid_argument("voxel grid of " + entity.tag + " has no world file");
+            }
+            entity.world_path = reference->path;
+            entity.grid_lod = registry.try_get<VoxelGridLod>(ent) != nullptr;
+        }
+        snapshot.m_entities.push_back(std::move(entity));
+    }
+    return snapshot;
+}
+
+void SceneSnapshot::Save(const std::string &path) const {
+    std::vector<uint8_t> data;
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entities_count = m_entities.size();
+    append(data, &header, sizeof(header));
+
+    for (auto &entity: m_entities) {
+        EntityHeader entity_header{};
+        entity_header.flags = (entity.camera ? HAS_CAMERA : 0) | (entity.world_path.empty() ? 0 : HAS_GRID) |
+                              (entity.grid_lod ? HAS_GRID_LOD : 0);
+        entity_header.tag_size = (uint32_t) entity.tag.size();
+        entity_header.world_path_size = (uint32_t) entity.world_path.size();
+        entity_header.translation = entity.transform.translation;
+        auto &rotation = entity.transform.rotation;
+        entity_header.rotation = glm::dvec4(rotation.x, rotation.y, rotation.z, rotation.w);
+        entity_header.scale = entity.transform.scale;
+        entity_header.camera = entity.camera.value_or(CameraComponent::Settings());
+        append(data, &entity_header, sizeof(entity_header));
+        append(data, entity.tag.data(), entity.tag.size());
+        append(data, entity.world_path.data(), entity.world_path.size());
+    }
+
+    // Written next to the previous snapshot and renamed over it, so it is replaced by a complete one or not at all
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()), (std::streamsize) data.size());
+        if (!file) {
+            throw std::runtime_error("failed to write " + temp_path);
+        }
+    }
+    std::filesystem::rename(temp_path, path);
+}
+
+SceneSnapshot SceneSnapshot::Load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("failed to open " + path);
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const uint8_t *data = bytes.data();
+    const uint8_t *end = data + bytes.size();
+
+    Header header{};
+    std::memcpy(&header, take(data, end, sizeof(header), path), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not a scene snapshot");
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error(path + " has unsupported version " + std::to_string(header.version));
+    }
+
+    SceneSnapshot snapshot;
+    for (uint64_t i = 0; i < header.entities_count; i++) {
+        EntityHeader entity_header{};
+        std::memcpy(&entity_header, take(data, end, sizeof(entity_header), path), sizeof(entity_header));
+        Entity entity;
+        entity.tag.assign((const char *) take(data, end, entity_header.tag_size, path), entity_header.tag_size);
+        entity.world_path.assign((const char *) take(data, end, entity_header.world_path_size, path),
+                                 entity_header.world_path_size);
+        entity.transform.translation = entity_header.translation;
+        auto &rotation = entity_header.rotation;
+        entity.transform.rotation = glm::dquat(rotation.w, rotation.x, rotation.y, rotation.z);
+        entity.transform.scale = entity_header.scale;
+        if (entity_header.flags & HAS_CAMERA) {
+            entity.camera = entity_header.camera;
+        }
+        if ((entity_header.flags & HAS_GRID) && entity.world_path.empty()) {
+            throw std::runtime_error(path + " has a grid without a world file");
+        }
+        entity.grid_lod = (entity_header.flags & HAS_GRID_LOD) != 0;
+        snapshot.m_entities.push_back(std::move(entity));
+    }
+    return snapshot;
+}
+
+std::vector<entt::entity> SceneSnapshot::Restore(entt::registry &registry) const {
+    std::map<std::string, std::shared_ptr<WorldFile>> worlds;
+    for (auto &entity: m_entities) {
+        if (!entity.world_path.empty() && !worlds.contains(entity.world_path)) {
+            worlds.emplace(entity.world_path, WorldFile::Open(entity.world_path));
+        }
+    }
+
+    std::vector<entt::entity> entities(m_entities.size());
+    registry.create(entities.begin(), entities.end());
+    std::vector<TagComponent> tags;
+    std::vector<TransformComponent> transforms;
+    tags.reserve(m_entities.size());
+    transforms.reserve(m_entities.size());
+    for (auto &entity: m_entities) {
+        tags.push_back(TagComponent{entity.tag});
+        transforms.push_back(entity.transform);
+    }
+    registry.insert<TagComponent>(entities.begin(), entities.end(), tags.begin());
+    registry.insert<TransformComponent>(entities.begin(), entities.end(), transforms.begin());
+
+    for (size_t i = 0; i < m_entities.size(); i++) {
+        const Entity &entity = m_entities[i];
+        if (entity.camera) {
+            registry.emplace<CameraComponent>(entities[i], *entity.camera);
+        }
+        if (!entity.world_path.empty()) {
+            auto &file = worlds.at(entity.world_path);
+            auto &grid = registry.emplace<VoxelGrid>(entities[i], file->GetDimensions(), file->GetAnchor());
+            file->AttachTo(grid);
+            registry.emplace<WorldReferenceComponent>(entities[i], WorldReferenceComponent{entity.world_path});
+            if (entity.grid_lod) {
+                registry.emplace<VoxelGridLod>(entities[i]);
+            }
+        }
+    }
+    return entities;
+}
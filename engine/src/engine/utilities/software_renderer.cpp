@@ -0,0 +1,165 @@
+#include <lit/engine/utilities/software_renderer.hpp>
+#include <lit/engine/utilities/voxel_ray_packet_caster.hpp>
+#include <lit/engine/components/camera.hpp>
+#include <lit/common/time_utils.hpp>
+#include <algorithm>
+#include <numeric>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using RayCastResult = VoxelRayCaster::RayCastResult;
+
+SoftwareRenderer::SoftwareRenderer(const VoxelRayCaster& caster, ThreadPool& pool) : m_caster(caster), m_pool(pool) {}
+
+Image<uint8_t, 3> SoftwareRenderer::Render(const CameraComponent& camera, const TransformComponent& camera_transform) {
+    return Render(camera.GetViewport(), camera_transform);
+}
+
+Image<uint8_t, 3> SoftwareRenderer::Render(glm::uvec2 viewport, const TransformComponent& camera_transform) {
+    Timer timer;
+
+    Image<uint8_t, 3> image(viewport.x, viewport.y);
+    glm::mat4 camera_matrix = glm::mat4(camera_transform.Matrix());
+
+    glm::ivec2 tiles = (glm::ivec2(viewport) + TILE_SIZE - 1) / TILE_SIZE;
+    m_tile_stats.assign(tiles.x * tiles.y, TileStats());
+
+    m_pool.ParallelFor(m_tile_stats.size(), [&](size_t index) {
+        glm::ivec2 begin = glm::ivec2(index % tiles.x, index / tiles.x) * TILE_SIZE;
+        glm::ivec2 end = glm::min(begin + TILE_SIZE, glm::ivec2(viewport));
+        RenderTile(begin, end, viewport, camera_matrix, image, m_tile_stats[index]);
+    });
+
+    m_render_time = timer.GetTime();
+    return image;
+}
+
+void SoftwareRenderer::RenderTile(glm::ivec2 begin, glm::ivec2 end, glm::uvec2 viewport, const glm::mat4& camera_matrix,
+                                  Image<uint8_t, 3>& image, TileStats& stats) const {
+    Timer timer;
+    VoxelRayPacketCaster packet_caster(m_caster);
+
+    // Same as GetCameraOrigin and GetCameraRayDirection from camera.glsl, with pixel offset (0.25, 0.25)
+    const glm::vec3 camera_origin = glm::vec3(camera_matrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    const glm::vec2 pixel_offset = glm::vec2(0.25f);
+    const glm::vec3 light = glm::normalize(glm::vec3(1.3f, 1.0f, 0.35f));
+
+    // Pixels are visited in 4x2 blocks, so every packet covers neighbouring pixels
+    std::vector<glm::ivec2> pixels;
+    std::vector<glm::vec3> origins;
+    std::vector<glm::vec3> dirs;
+    for (int block_y = begin.y; block_y < end.y; block_y += 2) {
+        for (int block_x = begin.x; block_x < end.x; block_x += 4) {
+            for (int lane = 0; lane < VoxelRayPacketCaster::PACKET_SIZE; lane++) {
+                glm::ivec2 pixel = glm::ivec2(block_x + (lane & 3), block_y + (lane >> 2));
+                if (pixel.x >= end.x || pixel.y >= end.y) {
+                    continue;
+                }
+
+                glm::vec2 normalized_coords = (2.0f * glm::vec2(pixel) - glm::vec2(viewport) + pixel_offset * 2.0f) /
+                                              (float) viewport.y;
+                glm::vec3 dir = glm::normalize(glm::vec3(normalized_coords, 1.0f));
+                dir = glm::vec3(camera_matrix * glm::vec4(dir, 0.0f));
+
+                float distance;
+                if (!m_caster.WorldHitBox(camera_origin, dir, distance)) {
+                    continue;
+                }
+                pixels.push_back(pixel);
+                origins.push_back(camera_origin + dir * (distance + 1e-6f));
+                dirs.push_back(dir);
+            }
+        }
+    }
+
+    std::vector<RayCastResult> results(pixels.size());
+    packet_caster.WorldRayCast(origins.data(), dirs.data(), pixels.size(), MAX_ITERATIONS, results.data());
+
+    std::vector<size_t> shadow_indices;
+    std::vector<glm::vec3> shadow_origins;
+    for (size_t i = 0; i < results.size(); i++) {
+        stats.iterations += results[i].iterations;
+        if (results[i].hit) {
+            shadow_indices.push_back(i);
+            shadow_origins.push_back(results[i].position + glm::vec3(results[i].normal) * 1e-5f);
+        }
+    }
+    std::vector<glm::vec3> shadow_dirs(shadow_indices.size(), light);
+    std::vector<RayCastResult> shadow_results(shadow_indices.size());
+    packet_caster.WorldRayCast(shadow_origins.data(), shadow_dirs.data(), shadow_indices.size(), MAX_ITERATIONS,
+                               shadow_results.data());
+
+    // Pixels without hit keep the cleared (black) color, tone mapping keeps black as is
+    for (size_t i = 0; i < shadow_indices.size(); i++) {
+        const RayCastResult& res = results[shadow_indices[i]];
+        stats.iterations += shadow_results[i].iterations;
+
+        float r = float((res.voxel_data & 0xFF0000u) >> 16) / 255.0f;
+        float g = float((res.voxel_data & 0x00FF00u) >> 8) / 255.0f;
+        float b = float(res.voxel_data & 0x0000FFu) / 255.0f;
+
+        glm::vec3 color;
+        if (shadow_results[i].hit) {
+            color = glm::vec3(r, g, b) * 0.2f;
+        } else {
+            float l = std::max(0.0f, glm::dot(light, glm::vec3(res.normal))) * 0.7f + 0.3f;
+            color = glm::vec3(r, g, b) * l;
+        }
+
+        glm::ivec2 pixel = pixels[shadow_indices[i]];
+        glm::vec3 mapped = FilmicToneMapping(color) * 255.0f + 0.5f;
+        image.SetPixel(pixel.x, viewport.y - 1 - pixel.y, Image<uint8_t, 3>::pixel_t(mapped));
+    }
+
+    stats.begin = begin;
+    stats.end = end;
+    stats.rays = results.size() + shadow_results.size();
+    stats.thread = m_pool.GetCurrentThreadIndex();
+    stats.time = timer.GetTime();
+}
+
+glm::vec3 SoftwareRenderer::FilmicToneMapping(glm::vec3 x) {
+    const float a = 2.51f;
+    const float b = 0.03f;
+    const float c = 2.43f;
+    const float d = 0.59f;
+    const float e = 0.14f;
+    return glm::clamp((x * (a * x + b)) / (x * (c * x + d) + e), 0.0f, 1.0f);
+}
+
+const std::vector<SoftwareRenderer::TileStats>& SoftwareRenderer::GetTileStats() const {
+    return m_tile_stats;
+}
+
+double SoftwareRenderer::GetRenderTime() const {
+    return m_render_time;
+}
+
+void SoftwareRenderer::LogStats(spdlog::logger& logger, size_t slowest_tiles_count) const {
+    size_t rays = 0;
+    double tiles_time = 0.0;
+    for (auto& tile: m_tile_stats) {
+        rays += tile.rays;
+        tiles_time += tile.time;
+    }
+    logger.info("Software render: {:.2f} ms, {} tiles, {} rays, {:.2f} Mrays/s, {} threads",
+                m_render_time * 1000.0, m_tile_stats.size(), rays, (double) rays / std::max(m_render_time, 1e-9) * 1e-6,
+                m_pool.GetThreadsCount());
+
+    std::vector<size_t> order(m_tile_stats.size());
+    std::iota(order.begin(), order.end(), 0);
+    slowest_tiles_count = std::min(slowest_tiles_count, order.size());
+    std::partial_sort(order.begin(), order.begin() + slowest_tiles_count, order.end(), [this](size_t a, size_t b) {
+        return m_tile_stats[a].time > m_tile_stats[b].time;
+    });
+
+    double average_time = tiles_time / (double) std::max<size_t>(m_tile_stats.size(), 1);
+    for (size_t i = 0; i < slowest_tiles_count; i++) {
+        auto& tile = m_tile_stats[order[i]];
+        logger.info("Tile [{}, {}]-[{}, {}]: {:.3f} ms ({:.1f}x average), {} rays, {:.1f} iterations per ray, thread {}",
+                    tile.begin.x, tile.begin.y, tile.end.x, tile.end.y, tile.time * 1000.0,
+                    tile.time / std::max(average_time, 1e-12), tile.rays,
+                    (double) tile.iterations / (double) std::max<size_t>(tile.rays, 1), tile.thread);
+    }
+}
@@ -0,0 +1,163 @@
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <algorithm>
+#include <chrono>
+
+using namespace lit::engine;
+
+namespace {
+    thread_local const ThreadPool* current_pool = nullptr;
+    thread_local size_t current_thread_index = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads_count) {
+    if (threads_count == 0) {
+        threads_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads_count; i++) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < threads_count; i++) {
+        m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (auto& thread: m_threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::GetThreadsCount() const {
+    return m_threads.size();
+}
+
+size_t ThreadPool::GetCurrentThreadIndex() const {
+    return current_pool == this ? current_thread_index : GetThreadsCount();
+}
+
+void ThreadPool::Submit(Task task) {
+    size_t thread_index = GetCurrentThreadIndex();
+    size_t queue_index = thread_index < GetThreadsCount() ? thread_index : m_next_queue++ % m_queues.size();
+    Push(queue_index, std::move(task));
+    m_condition.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+
+    // Counter is only changed under the mutex, so the last task is done with the state before the caller sees
+    // zero and destroys it
+    struct State {
+        size_t remaining;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr exception;
+    } state;
+    state.remaining = count;
+
+    size_t queues_count = m_queues.size();
+    size_t block_size = (count + queues_count - 1) / queues_count;
+    size_t first_queue = m_next_queue++;
+    for (size_t index = 0; index < count; index++) {
+        Push((first_queue + index / block_size) % queues_count, [&state, &func, index]() {
+            std::exception_ptr exception;
+            try {
+                func(index);
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            std::lock_guard lock(state.mutex);
+            if (exception && !state.exception) {
+                state.exception = exception;
+            }
+            if (--state.remaining == 0) {
+                state.finished.notify_all();
+            }
+        });
+    }
+    m_condition.notify_all();
+
+    size_t thread_index = GetCurrentThreadIndex();
+    std::unique_lock lock(state.mutex);
+    while (state.remaining > 0) {
+        lock.unlock();
+        bool ran = TryRunPending(thread_index);
+        lock.lock();
+        if (!ran) {
+            state.finished.wait_for(lock, std::chrono::milliseconds(1), [&state]() { return state.remaining == 0; });
+        }
+    }
+
+    if (state.exception) {
+        std::rethrow_exception(state.exception);
+    }
+}
+
+void ThreadPool::Push(size_t queue_index, Task task) {
+    // Counted before the task becomes visible, so a thief can never decrement the counter below zero
+    {
+        std::lock_guard lock(m_mutex);
+        m_queued_count++;
+    }
+    std::lock_guard lock(m_queues[queue_index]->mutex);
+    m_queues[queue_index]->tasks.push_back(std::move(task));
+}
+
+bool ThreadPool::TryPop(size_t queue_index, Task& task) {
+    auto& queue = *m_queues[queue_index];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    m_queued_count--;
+    return true;
+}
+
+bool ThreadPool::TrySteal(size_t thief_index, Task& task) {
+    size_t queues_count = m_queues.size();
+    for (size_t i = 1; i <= queues_count; i++) {
+        auto& queue = *m_queues[(thief_index + i) % queues_count];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            m_queued_count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::TryRunPending(size_t thread_index) {
+    Task task;
+    if ((thread_index < m_queues.size() && TryPop(thread_index, task)) || TrySteal(thread_index, task)) {
+        task();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(size_t thread_index) {
+    current_pool = this;
+    current_thread_index = thread_index;
+
+    while (true) {
+        if (TryRunPending(thread_index)) {
+            continue;
+        }
+        std::unique_lock lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_stop || m_queued_count > 0; });
+        if (m_stop && m_queued_count == 0) {
+            return;
+        }
+    }
+}
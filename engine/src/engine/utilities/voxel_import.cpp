@@ -0,0 +1,690 @@
+#include <lit/engine/utilities/voxel_import.hpp>
+#include <lit/engine/utilities/thread_pool.hpp>
+#include <lit/common/glm_ext/comparators.hpp>
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = VoxFile::VoxelGrid;
+
+namespace {
+    // Models can't be larger than 256 voxels (coordinates are bytes), exported models are 8^3 chunks at most
+    const int MODEL_SIZE = 256;
+    const int MODEL_SIZE_LOG = 8;
+    const int MAX_GRAPH_DEPTH = 256;
+
+    /**
+     * Bounds checked little-endian reader of a mapped file.
+     */
+    class Reader {
+    public:
+        Reader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+        const uint8_t *Skip(size_t size) {
+            if (size > m_size - m_position) {
+                throw std::runtime_error("vox file is truncated");
+            }
+            const uint8_t *data = m_data + m_position;
+            m_position += size;
+            return data;
+        }
+
+        template<typename T>
+        T Read() {
+            T value;
+            std::memcpy(&value, Skip(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string ReadString() {
+            auto size = Read<uint32_t>();
+            auto data = reinterpret_cast<const char *>(Skip(size));
+            return {data, data + size};
+        }
+
+        std::map<std::string, std::string> ReadDict() {
+            std::map<std::string, std::string> dict;
+            auto count = Read<uint32_t>();
+            for (uint32_t i = 0; i < count; i++) {
+                std::string key = ReadString();
+                dict[key] = ReadString();
+            }
+            return dict;
+        }
+
+        size_t GetPosition() const {
+            return m_position;
+        }
+
+    private:
+        const uint8_t *m_data;
+        size_t m_size;
+        size_t m_position = 0;
+    };
+
+    template<typename T>
+    void Append(std::vector<uint8_t> &out, const T &value) {
+        size_t size = out.size();
+        out.resize(size + sizeof(T));
+        std::memcpy(out.data() + size, &value, sizeof(T));
+    }
+
+    void AppendString(std::vector<uint8_t> &out, const std::string &value) {
+        Append(out, (uint32_t) value.size());
+        out.insert(out.end(), value.begin(), value.end());
+    }
+
+    void AppendChunk(std::vector<uint8_t> &out, const char *id, const std::vector<uint8_t> &content) {
+        out.insert(out.end(), id, id + 4);
+        Append(out, (uint32_t) content.size());
+        Append(out, (uint32_t) 0);
+        out.insert(out.end(), content.begin(), content.end());
+    }
+
+    /**
+     * MagicaVoxel palette used by files without RGBA chunk: the 6^3 color cube without black,
+     * then ramps of blue, green, red and gray.
+     */
+    std::array<uint32_t, 256> GetDefaultPalette() {
+        const uint32_t cube[6] = {0xFF, 0xCC, 0x99, 0x66, 0x33, 0x00};
+        const uint32_t ramp[10] = {0xEE, 0xDD, 0xBB, 0xAA, 0x88, 0x77, 0x55, 0x44, 0x22, 0x11};
+        std::array<uint32_t, 256> palette{};
+        size_t index = 1;
+        for (uint32_t r: cube) {
+            for (uint32_t g: cube) {
+                for (uint32_t b: cube) {
+                    if (r | g | b) {
+                        palette[index++] = (r << 16) | (g << 8) | b;
+                    }
+                }
+            }
+        }
+        for (int shift: {0, 8, 16}) {
+            for (uint32_t value: ramp) {
+                palette[index++] = value << shift;
+            }
+        }
+        for (uint32_t value: ramp) {
+            palette[index++] = value * 0x010101u;
+        }
+        return palette;
+    }
+
+    uint32_t ToColor(uint32_t rgba) {
+        uint32_t color = ((rgba & 0xFF) << 16) | (rgba & 0xFF00) | ((rgba >> 16) & 0xFF);
+        // Zero is an empty voxel
+        return std::max(color, 1u);
+    }
+
+    /**
+     * Chunks being filled on behalf of a grid: every chunk gets a buffer (a copy of the grid chunk if there is one)
+     * and the buffers replace the grid chunks in one batch.
+     */
+    class ChunkAssembler {
+    public:
+        explicit ChunkAssembler(VoxelGrid &grid) : m_grid(grid),
+                                                   m_slots(glm::compMul(grid.GetChunkGridDimensions()), UINT32_MAX) {}
+
+        /**
+         * Buffer of the chunk at @position, created on the first call. Not thread safe.
+         */
+        VoxelGrid::ChunkData &Reserve(const glm::ivec3 &position) {
+            uint32_t &slot = m_slots[GetSlotIndex(position)];
+            if (slot == UINT32_MAX) {
+                slot = (uint32_t) m_data.size();
+                m_positions.push_back(position);
+                VoxelGrid::ChunkIndexType index = m_grid.GetChunkGridView().At(position);
+                if (index == VoxelGrid::CHUNK_EMPTY) {
+                    m_data.push_back(std::make_unique<VoxelGrid::ChunkData>());
+                } else {
+                    m_data.push_back(std::make_unique_for_overwrite<VoxelGrid::ChunkData>());
+                    *m_data.back() = m_grid.GetChunkData(index);
+                }
+            }
+            return *m_data[slot];
+        }
+
+        /**
+         * Buffer of a reserved chunk, safe to call from many threads.
+         */
+        VoxelGrid::ChunkData &Get(const glm::ivec3 &position) const {
+            return *m_data[m_slots[GetSlotIndex(position)]];
+        }
+
+        void Commit() {
+            for (auto &position: m_positions) {
+                m_grid.DeleteChunk(position);
+            }
+            m_grid.InsertChunks(m_positions, std::move(m_data));
+            m_positions.clear();
+            m_data.clear();
+        }
+
+    private:
+        size_t GetSlotIndex(const glm::ivec3 &position) const {
+            glm::ivec3 dims = m_grid.GetChunkGridDimensions();
+            return ((size_t) position.x * dims.y + position.y) * dims.z + position.z;
+        }
+
+        VoxelGrid &m_grid;
+        std::vector<uint32_t> m_slots;
+        std::vector<glm::ivec3> m_positions;
+        std::vector<std::unique_ptr<VoxelGrid::ChunkData>> m_data;
+    };
+}
+
+VoxFile::AxisRotation VoxFile::AxisRotation::Decode(uint8_t bits) {
+    AxisRotation rotation;
+    rotation.axes = {bits & 3, (bits >> 2) & 3, 0};
+    rotation.axes.z = 3 - rotation.axes.x - rotation.axes.y;
+    if (rotation.axes.x > 2 || rotation.axes.y > 2 || rotation.axes.x == rotation.axes.y) {
+        throw std::runtime_error("vox file has invalid rotation");
+    }
+    for (int i = 0; i < 3; i++) {
+        rotation.signs[i] = (bits >> (4 + i)) & 1 ? -1 : 1;
+    }
+    return rotation;
+}
+
+VoxFile::VoxFile(const std::string &path) : m_file(std::make_unique<MappedFile>(path)) {
+    struct Node {
+        enum class Type {
+            Transform, Group, Shape
+        } type;
+        bool hidden = false;
+        AxisRotation rotation;
+        glm::ivec3 translation{0};
+        std::vector<int32_t> children;
+        std::vector<uint32_t> models;
+    };
+
+    Reader reader(m_file->GetData(), m_file->GetSize());
+    if (std::memcmp(reader.Skip(4), "VOX ", 4) != 0) {
+        throw std::runtime_error("not a vox file: " + path);
+    }
+    reader.Read<uint32_t>();
+    if (std::memcmp(reader.Skip(4), "MAIN", 4) != 0) {
+        throw std::runtime_error("vox file has no MAIN chunk: " + path);
+    }
+    reader.Skip(reader.Read<uint32_t>() + sizeof(uint32_t));
+
+    m_palette = GetDefaultPalette();
+    std::unordered_map<int32_t, Node> nodes;
+    glm::ivec3 size{0};
+    while (reader.GetPosition() < m_file->GetSize()) {
+        auto id = reinterpret_cast<const char *>(reader.Skip(4));
+        auto content_size = reader.Read<uint32_t>();
+        auto children_size = reader.Read<uint32_t>();
+        Reader content(reader.Skip(content_size), content_size);
+        reader.Skip(children_size);
+
+        if (std::memcmp(id, "SIZE", 4) == 0) {
+            size = {content.Read<int32_t>(), content.Read<int32_t>(), content.Read<int32_t>()};
+            if (glm::any(glm::lessThan(size, glm::ivec3(1))) || glm::any(glm::greaterThan(size, glm::ivec3(MODEL_SIZE)))) {
+                throw std::runtime_error("vox file has invalid model size");
+            }
+        } else if (std::memcmp(id, "XYZI", 4) == 0) {
+            if (size == glm::ivec3(0)) {
+                throw std::runtime_error("vox file has model without SIZE chunk");
+            }
+            auto count = content.Read<uint32_t>();
+            if (count > content_size / 4) {
+                throw std::runtime_error("vox file has invalid voxels count");
+            }
+            m_models.push_back(Model{size, content.Skip((size_t) count * 4), count});
+        } else if (std::memcmp(id, "RGBA", 4) == 0) {
+            for (int i = 1; i < 256; i++) {
+                m_palette[i] = ToColor(content.Read<uint32_t>());
+            }
+        } else if (std::memcmp(id, "nTRN", 4) == 0) {
+            auto node_id = content.Read<int32_t>();
+            Node &node = nodes[node_id];
+            node.type = Node::Type::Transform;
+            node.hidden = content.ReadDict()["_hidden"] == "1";
+            node.children.push_back(content.Read<int32_t>());
+            content.Read<int32_t>();
+            content.Read<int32_t>();
+            if (content.Read<uint32_t>() > 0) {
+                auto frame = content.ReadDict();
+                if (frame.count("_t")) {
+                    std::istringstream(frame["_t"]) >> node.translation.x >> node.translation.y >> node.translation.z;
+                }
+                if (frame.count("_r")) {
+                    int bits = 0;
+                    std::istringstream(frame["_r"]) >> bits;
+                    node.rotation = AxisRotation::Decode((uint8_t) bits);
+                }
+            }
+        } else if (std::memcmp(id, "nGRP", 4) == 0) {
+            auto node_id = content.Read<int32_t>();
+            Node &node = nodes[node_id];
+            node.type = Node::Type::Group;
+            node.hidden = content.ReadDict()["_hidden"] == "1";
+            auto count = content.Read<uint32_t>();
+            for (uint32_t i = 0; i < count; i++) {
+                node.children.push_back(content.Read<int32_t>());
+            }
+        } else if (std::memcmp(id, "nSHP", 4) == 0) {
+            auto node_id = content.Read<int32_t>();
+            Node &node = nodes[node_id];
+            node.type = Node::Type::Shape;
+            content.ReadDict();
+            auto count = content.Read<uint32_t>();
+            for (uint32_t i = 0; i < count; i++) {
+                node.models.push_back(content.Read<uint32_t>());
+                content.ReadDict();
+            }
+        }
+    }
+
+    // .vox Z is up: (x, y, z) goes to (x, z, -y)
+    AxisRotation to_grid{{0, 2, 1}, {1, 1, -1}};
+
+    // Model voxel v is placed at rotation * (v - size / 2) + translation of the accumulated transforms
+    auto add_instance = [&](uint32_t model_index, const AxisRotation &rotation, const glm::ivec3 &translation) {
+        if (model_index >= m_models.size()) {
+            throw std::runtime_error("vox file references missing model");
+        }
+        const Model &model = m_models[model_index];
+        Instance instance{model_index, to_grid * rotation, to_grid * (translation - rotation * (model.size / 2)),
+                          glm::ivec3(INT_MAX), glm::ivec3(INT_MIN)};
+        for (int corner = 0; corner < 8; corner++) {
+            glm::ivec3 v = glm::ivec3(corner & 1, (corner >> 1) & 1, corner >> 2) * (model.size - 1);
+            glm::ivec3 p = instance.rotation * v + instance.translation;
+            instance.min = glm::min(instance.min, p);
+            instance.max = glm::max(instance.max, p + 1);
+        }
+        m_instances.push_back(instance);
+    };
+
+    std::function<void(int32_t, const AxisRotation &, const glm::ivec3 &, int)> traverse;
+    traverse = [&](int32_t node_id, const AxisRotation &rotation, const glm::ivec3 &translation, int depth) {
+        auto it = nodes.find(node_id);
+        if (it == nodes.end() || depth > MAX_GRAPH_DEPTH) {
+            throw std::runtime_error("vox file has invalid scene graph");
+        }
+        const Node &node = it->second;
+        if (node.hidden) {
+            return;
+        }
+        switch (node.type) {
+            case Node::Type::Transform:
+                traverse(node.children[0], rotation * node.rotation, rotation * node.translation + translation,
+                         depth + 1);
+                break;
+            case Node::Type::Group:
+                for (auto child: node.children) {
+                    traverse(child, rotation, translation, depth + 1);
+                }
+                break;
+            case Node::Type::Shape:
+                for (auto model: node.models) {
+                    add_instance(model, rotation, translation);
+                }
+                break;
+        }
+    };
+
+    if (nodes.empty()) {
+        // Old files: models are not transformed
+        for (uint32_t i = 0; i < m_models.size(); i++) {
+            add_instance(i, AxisRotation(), m_models[i].size / 2);
+        }
+    } else {
+        traverse(0, AxisRotation(), glm::ivec3(0), 0);
+    }
+
+    if (!m_instances.empty()) {
+        m_min = glm::ivec3(INT_MAX);
+        m_max = glm::ivec3(INT_MIN);
+        for (auto &instance: m_instances) {
+            m_min = glm::min(m_min, instance.min);
+            m_max = glm::max(m_max, instance.max);
+        }
+    }
+}
+
+std::shared_ptr<VoxFile> VoxFile::Open(const std::string &path) {
+    return std::shared_ptr<VoxFile>(new VoxFile(path));
+}
+
+void VoxFile::Import(VoxelGrid &grid, const glm::ivec3 &offset) const {
+    glm::ivec3 shift = offset - m_min;
+    glm::ivec3 grid_dimensions = grid.GetDimensions();
+    glm::ivec3 chunk_grid_dimensions = grid.GetChunkGridDimensions();
+
+    // Boxes of chunks covered by the instances, clipped by the grid (empty if min > max)
+    std::vector<std::pair<glm::ivec3, glm::ivec3>> boxes;
+    for (auto &instance: m_instances) {
+        boxes.emplace_back(glm::max((instance.min + shift) >> VoxelGrid::CHUNK_SIZE_LOG, glm::ivec3(0)),
+                           glm::min((instance.max - 1 + shift) >> VoxelGrid::CHUNK_SIZE_LOG, chunk_grid_dimensions - 1));
+    }
+
+    // Grid position @p of a voxel, false if it is empty or outside of its model or the grid
+    auto place = [&](const Instance &instance, const uint8_t *voxel, glm::ivec3 &p) {
+        glm::ivec3 v(voxel[0], voxel[1], voxel[2]);
+        if (voxel[3] == 0 || glm::any(glm::greaterThanEqual(v, m_models[instance.model].size))) {
+            return false;
+        }
+        p = instance.rotation * v + instance.translation + shift;
+        return glm::all(glm::greaterThanEqual(p, glm::ivec3(0))) && glm::all(glm::lessThan(p, grid_dimensions));
+    };
+
+    // Chunks that get voxels, found in parallel and allocated afterwards
+    ThreadPool pool;
+    std::vector<std::vector<glm::ivec3>> touched(m_instances.size());
+    pool.ParallelFor(m_instances.size(), [&](size_t i) {
+        auto [box_min, box_max] = boxes[i];
+        if (glm::any(glm::greaterThan(box_min, box_max))) {
+            return;
+        }
+        glm::ivec3 box_size = box_max - box_min + 1;
+        std::vector<uint8_t> marks(glm::compMul(box_size));
+        const Instance &instance = m_instances[i];
+        const Model &model = m_models[instance.model];
+        glm::ivec3 p;
+        for (uint32_t v = 0; v < model.count; v++) {
+            if (!place(instance, model.voxels + v * 4, p)) {
+                continue;
+            }
+            glm::ivec3 c = (p >> VoxelGrid::CHUNK_SIZE_LOG) - box_min;
+            marks[(c.x * box_size.y + c.y) * box_size.z + c.z] = 1;
+        }
+        for (int x = 0; x < box_size.x; x++) {
+            for (int y = 0; y < box_size.y; y++) {
+                for (int z = 0; z < box_size.z; z++) {
+                    if (marks[(x * box_size.y + y) * box_size.z + z]) {
+                        touched[i].push_back(box_min + glm::ivec3(x, y, z));
+                    }
+                }
+            }
+        }
+    });
+
+    ChunkAssembler assembler(grid);
+    for (auto &positions: touched) {
+        for (auto &position: positions) {
+            assembler.Reserve(position);
+        }
+    }
+
+    // Instances that share chunks go to different waves, later instances (which overwrite earlier ones) to later waves
+    std::vector<std::vector<size_t>> waves;
+    std::vector<size_t> wave_of(m_instances.size(), 0);
+    for (size_t i = 0; i < m_instances.size(); i++) {
+        if (touched[i].empty()) {
+            continue;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (!touched[j].empty() && glm::all(glm::lessThanEqual(boxes[i].first, boxes[j].second)) &&
+                glm::all(glm::lessThanEqual(boxes[j].first, boxes[i].second))) {
+                wave_of[i] = std::max(wave_of[i], wave_of[j] + 1);
+            }
+        }
+        waves.resize(std::max(waves.size(), wave_of[i] + 1));
+        waves[wave_of[i]].push_back(i);
+    }
+
+    for (auto &wave: waves) {
+        pool.ParallelFor(wave.size(), [&](size_t w) {
+            const Instance &instance = m_instances[wave[w]];
+            const Model &model = m_models[instance.model];
+            glm::ivec3 p;
+            for (uint32_t v = 0; v < model.count; v++) {
+                const uint8_t *voxel = model.voxels + v * 4;
+                if (place(instance, voxel, p)) {
+                    glm::ivec3 r = p & (VoxelGrid::CHUNK_SIZE - 1);
+                    assembler.Get(p >> VoxelGrid::CHUNK_SIZE_LOG)[r.x][r.y][r.z] = m_palette[voxel[3]];
+                }
+            }
+        });
+    }
+
+    assembler.Commit();
+}
+
+void VoxFile::Save(const std::string &path, VoxelGrid &grid) {
+    // Every model is a 256^3 region of the grid, cut to the box of its chunks
+    std::map<glm::ivec3, std::vector<VoxelGrid::ChunkIndexType>, glm_ext::vec3_comparator<int>> regions;
+    grid.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        regions[chunk.GetChunkGridPosition() >> (MODEL_SIZE_LOG - VoxelGrid::CHUNK_SIZE_LOG)].push_back(chunk.GetIndex());
+    });
+
+    // Distinct colors of non-empty voxels
+    std::unordered_set<uint32_t> colors;
+    for (auto &[region, chunks]: regions) {
+        for (auto index: chunks) {
+            const uint32_t *voxels = &grid.GetChunkData(index)[0][0][0];
+            uint32_t previous = 0;
+            for (size_t i = 0; i < VoxelGrid::CHUNK_SIZE * VoxelGrid::CHUNK_SIZE * VoxelGrid::CHUNK_SIZE; i++) {
+                if (voxels[i] != previous) {
+                    previous = voxels[i];
+                    colors.insert(previous);
+                }
+            }
+        }
+    }
+    colors.erase(0);
+
+    // The whole set is quantized with 0 to 7 low bits of every channel dropped, the smallest loss that fits is used
+    int shift = 0;
+    uint32_t mask;
+    std::unordered_set<uint32_t> keys;
+    do {
+        mask = ((0xFFu << shift) & 0xFFu) * 0x010101u;
+        keys.clear();
+        for (uint32_t color: colors) {
+            keys.insert(color & mask);
+        }
+    } while (keys.size() > 255 && ++shift < 8);
+
+    std::unordered_map<uint32_t, uint8_t> palette_indices;
+    std::vector<uint8_t> rgba(256 * 4);
+    for (uint32_t key: keys) {
+        // Keys of dark colors can be zero, colors are taken from the middle of their buckets
+        uint8_t index = (uint8_t) (palette_indices.size() + 1);
+        palette_indices[key] = index;
+        uint32_t color = key | (((1u << shift) >> 1) * 0x010101u);
+        uint32_t abgr = 0xFF000000u | ((color & 0xFF) << 16) | (color & 0xFF00) | ((color >> 16) & 0xFF);
+        std::memcpy(rgba.data() + (index - 1) * 4, &abgr, 4);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("can't create vox file " + path);
+    }
+    std::vector<uint8_t> out;
+    out.insert(out.end(), {'V', 'O', 'X', ' '});
+    Append(out, (uint32_t) 200);
+    out.insert(out.end(), {'M', 'A', 'I', 'N'});
+    Append(out, (uint32_t) 0);
+    Append(out, (uint32_t) 0);
+    file.write(reinterpret_cast<const char *>(out.data()), (std::streamsize) out.size());
+    size_t children_size = 0;
+
+    std::vector<glm::ivec3> translations;
+    std::vector<uint8_t> xyzi;
+    for (auto &[region, chunks]: regions) {
+        glm::ivec3 box_min(INT_MAX);
+        glm::ivec3 box_max(INT_MIN);
+        for (auto index: chunks) {
+            glm::ivec3 position = grid.GetChunkGridPos(index) * VoxelGrid::CHUNK_SIZE;
+            box_min = glm::min(box_min, position);
+            box_max = glm::max(box_max, position + VoxelGrid::CHUNK_SIZE);
+        }
+        glm::ivec3 size = box_max - box_min;
+
+        // Grid (x, y, z) is .vox (x, -z, y)
+        xyzi.assign(4, 0);
+        for (auto index: chunks) {
+            glm::ivec3 base = grid.GetChunkGridPos(index) * VoxelGrid::CHUNK_SIZE - box_min;
+            auto &data = grid.GetChunkData(index);
+            for (int x = 0; x < VoxelGrid::CHUNK_SIZE; x++) {
+                for (int y = 0; y < VoxelGrid::CHUNK_SIZE; y++) {
+                    for (int z = 0; z < VoxelGrid::CHUNK_SIZE; z++) {
+                        if (data[x][y][z] != 0) {
+                            glm::ivec3 l = base + glm::ivec3(x, y, z);
+                            xyzi.insert(xyzi.end(), {(uint8_t) l.x, (uint8_t) (size.z - 1 - l.z), (uint8_t) l.y,
+                                                     palette_indices.at(data[x][y][z] & mask)});
+                        }
+                    }
+                }
+            }
+        }
+        uint32_t count = (uint32_t) (xyzi.size() / 4 - 1);
+        if (count == 0) {
+            continue;
+        }
+        std::memcpy(xyzi.data(), &count, 4);
+
+        glm::ivec3 vox_size(size.x, size.z, size.y);
+        glm::ivec3 vox_min(box_min.x, -(box_max.z - 1), box_min.y);
+        translations.push_back(vox_min + vox_size / 2);
+
+        out.clear();
+        std::vector<uint8_t> content;
+        Append(content, vox_size);
+        AppendChunk(out, "SIZE", content);
+        AppendChunk(out, "XYZI", xyzi);
+        file.write(reinterpret_cast<const char *>(out.data()), (std::streamsize) out.size());
+        children_size += out.size();
+    }
+
+    // Root transform, group of all models, transform and shape of every model
+    out.clear();
+    auto append_transform = [&](int32_t id, int32_t child, int32_t layer, const std::string &translation) {
+        std::vector<uint8_t> content;
+        Append(content, id);
+        Append(content, (uint32_t) 0);
+        Append(content, child);
+        Append(content, (int32_t) -1);
+        Append(content, layer);
+        Append(content, (uint32_t) 1);
+        if (translation.empty()) {
+            Append(content, (uint32_t) 0);
+        } else {
+            Append(content, (uint32_t) 1);
+            AppendString(content, "_t");
+            AppendString(content, translation);
+        }
+        AppendChunk(out, "nTRN", content);
+    };
+    append_transform(0, 1, -1, "");
+    std::vector<uint8_t> group;
+    Append(group, (int32_t) 1);
+    Append(group, (uint32_t) 0);
+    Append(group, (uint32_t) translations.size());
+    for (size_t i = 0; i < translations.size(); i++) {
+        Append(group, (int32_t) (2 + 2 * i));
+    }
+    AppendChunk(out, "nGRP", group);
+    for (size_t i = 0; i < translations.size(); i++) {
+        auto &t = translations[i];
+        append_transform((int32_t) (2 + 2 * i), (int32_t) (3 + 2 * i), 0,
+                         std::to_string(t.x) + " " + std::to_string(t.y) + " " + std::to_string(t.z));
+        std::vector<uint8_t> shape;
+        Append(shape, (int32_t) (3 + 2 * i));
+        Append(shape, (uint32_t) 0);
+        Append(shape, (uint32_t) 1);
+        Append(shape, (uint32_t) i);
+        Append(shape, (uint32_t) 0);
+        AppendChunk(out, "nSHP", shape);
+    }
+    AppendChunk(out, "RGBA", rgba);
+    file.write(reinterpret_cast<const char *>(out.data()), (std::streamsize) out.size());
+    children_size += out.size();
+
+    // Size of the MAIN children is known only now
+    file.seekp(16);
+    auto children_size32 = (uint32_t) children_size;
+    file.write(reinterpret_cast<const char *>(&children_size32), sizeof(children_size32));
+    if (!file) {
+        throw std::runtime_error("can't write vox file " + path);
+    }
+}
+
+void RawVolume::Import(const std::string &path, const RawVolumeFormat &format, VoxelGrid &grid,
+                       const glm::ivec3 &offset) {
+    int bytes = format.bytes_per_voxel;
+    if (bytes != 0 && bytes != 1 && bytes != 2 && bytes != 4) {
+        throw std::invalid_argument("raw volume voxels must have 0, 1, 2 or 4 bytes");
+    }
+    if (glm::any(glm::lessThan(format.dimensions, glm::ivec3(1)))) {
+        throw std::invalid_argument("raw volume dimensions must be positive");
+    }
+    std::ifstream file(path, bytes == 0 ? std::ios::in : std::ios::in | std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("can't open raw volume " + path);
+    }
+
+    glm::ivec3 grid_dimensions = grid.GetDimensions();
+    ChunkAssembler assembler(grid);
+    std::vector<uint8_t> row((size_t) format.dimensions.x * bytes);
+    std::vector<uint32_t> values(format.dimensions.x);
+    for (int z = 0; z < format.dimensions.z; z++) {
+        for (int y = 0; y < format.dimensions.y; y++) {
+            if (bytes == 0) {
+                for (auto &value: values) {
+                    file >> value;
+                }
+            } else {
+                file.read(reinterpret_cast<char *>(row.data()), (std::streamsize) row.size());
+                switch (bytes) {
+                    case 1:
+                        std::copy(row.begin(), row.end(), values.begin());
+                        break;
+                    case 2:
+                        for (size_t x = 0; x < values.size(); x++) {
+                            values[x] = row[2 * x] | (row[2 * x + 1] << 8);
+                        }
+                        break;
+                    default:
+                        std::memcpy(values.data(), row.data(), row.size());
+                        break;
+                }
+            }
+            if (!file) {
+                throw std::runtime_error("raw volume is shorter than its dimensions: " + path);
+            }
+
+            glm::ivec3 p = offset + glm::ivec3(0, y, z);
+            if (p.y < 0 || p.z < 0 || p.y >= grid_dimensions.y || p.z >= grid_dimensions.z) {
+                continue;
+            }
+            if (!format.palette.empty()) {
+                for (auto &value: values) {
+                    value = value < format.palette.size() ? format.palette[value] : 0;
+                }
+            }
+
+            // The row is cut by the chunks, chunks are looked up only for pieces with voxels
+            int x_begin = std::max(0, -offset.x);
+            int x_end = std::min(format.dimensions.x, grid_dimensions.x - offset.x);
+            glm::ivec3 r = p & (VoxelGrid::CHUNK_SIZE - 1);
+            for (int x = x_begin; x < x_end;) {
+                p.x = offset.x + x;
+                int piece_end = std::min(x_end, x + VoxelGrid::CHUNK_SIZE - (p.x & (VoxelGrid::CHUNK_SIZE - 1)));
+                if (std::any_of(values.begin() + x, values.begin() + piece_end, [](uint32_t v) { return v != 0; })) {
+                    auto &chunk = assembler.Reserve(p >> VoxelGrid::CHUNK_SIZE_LOG);
+                    for (int i = x; i < piece_end; i++) {
+                        if (values[i] != 0) {
+                            chunk[(p.x + i - x) & (VoxelGrid::CHUNK_SIZE - 1)][r.y][r.z] = values[i];
+                        }
+                    }
+                }
+                x = piece_end;
+            }
+        }
+    }
+    assembler.Commit();
+}
@@ -0,0 +1,329 @@
+#include <lit/engine/utilities/world_file.hpp>
+#include <lit/engine/utilities/chunk_codec.hpp>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace lit::engine;
+using namespace lit::common;
+
+using VoxelGrid = WorldFile::VoxelGrid;
+using VoxelGridLod = WorldFile::VoxelGridLod;
+
+namespace {
+    const char MAGIC[4] = {'L', 'I', 'T', 'W'};
+
+    const size_t CHUNK_VOXELS = VoxelGrid::CHUNK_SIZE * VoxelGrid::CHUNK_SIZE * VoxelGrid::CHUNK_SIZE;
+
+    // LODs 1 to CHUNK_SIZE_LOG of one chunk, as in VoxelGridSparseLodDataT::m_chunk_lod_data
+    const size_t CHUNK_LOD_VOXELS = GetLodTotalSize(VoxelGrid::GetChunkDimensions(), 1, VoxelGrid::CHUNK_SIZE_LOG);
+
+    template<typename T>
+    void Append(std::vector<uint8_t> &out, const T &value) {
+        size_t size = out.size();
+        out.resize(size + sizeof(T));
+        std::memcpy(out.data() + size, &value, sizeof(T));
+    }
+}
+
+void WorldFile::Encode(const uint32_t *voxels, size_t count, ChunkEncoding encoding, std::vector<uint8_t> &out) {
+    out.clear();
+    switch (encoding) {
+        case ChunkEncoding::Raw:
+            out.resize(count * sizeof(uint32_t));
+            std::memcpy(out.data(), voxels, out.size());
+            break;
+        case ChunkEncoding::RunLength:
+            for (size_t i = 0; i < count;) {
+                size_t end = i + 1;
+                while (end < count && voxels[end] == voxels[i]) {
+                    end++;
+                }
+                Append(out, (uint32_t) (end - i));
+                Append(out, voxels[i]);
+                i = end;
+            }
+            break;
+        case ChunkEncoding::Palette: {
+            // Encoder keeps its scratch buffers between chunks
+            thread_local ChunkCodec codec;
+            if (count == CHUNK_VOXELS) {
+                codec.Encode(*reinterpret_cast<const VoxelGrid::ChunkData *>(voxels), nullptr, out);
+            } else {
+                codec.EncodeValues(voxels, count, out);
+            }
+            break;
+        }
+        default:
+            throw std::invalid_argument("unknown chunk encoding");
+    }
+}
+
+void WorldFile::Decode(const uint8_t *payload, size_t size, ChunkEncoding encoding, uint32_t *voxels, size_t count) {
+    switch (encoding) {
+        case ChunkEncoding::Raw:
+            if (size != count * sizeof(uint32_t)) {
+                throw std::runtime_error("raw chunk payload has wrong size");
+            }
+            std::memcpy(voxels, payload, size);
+            return;
+        case ChunkEncoding::RunLength: {
+            size_t filled = 0;
+            for (size_t i = 0; i + 2 * sizeof(uint32_t) <= size; i += 2 * sizeof(uint32_t)) {
+                uint32_t length, value;
+                std::memcpy(&length, payload + i, sizeof(length));
+                std::memcpy(&value, payload + i + sizeof(length), sizeof(value));
+                if (length > count - filled) {
+                    throw std::runtime_error("run-length chunk payload is too long");
+                }
+                std::fill_n(voxels + filled, length, value);
+                filled += length;
+            }
+            if (filled != count || size % (2 * sizeof(uint32_t)) != 0) {
+                throw std::runtime_error("run-length chunk payload is truncated");
+            }
+            return;
+        }
+        case ChunkEncoding::Palette: {
+            size_t consumed = count == CHUNK_VOXELS ?
+                              ChunkCodec::Decode(payload, size, nullptr, *reinterpret_cast<VoxelGrid::ChunkData *>(voxels)) :
+                              ChunkCodec::DecodeValues(payload, size, voxels, count);
+            if (consumed != size) {
+                throw std::runtime_error("palette chunk payload has wrong size");
+            }
+            return;
+        }
+        default:
+            throw std::runtime_error("unknown chunk encoding");
+    }
+}
+
+std::shared_ptr<WorldFile> WorldFile::Open(const std::string &path) {
+    std::shared_ptr<WorldFile> world(new WorldFile());
+    world->m_file = std::make_unique<MappedFile>(path);
+
+    const uint8_t *data = world->m_file->GetData();
+    size_t size = world->m_file->GetSize();
+    if (size < sizeof(Header)) {
+        throw std::runtime_error(path + " is not a world file");
+    }
+    std::memcpy(&world->m_header, data, sizeof(Header));
+    Header &header = world->m_header;
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not a world file");
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error(path + " has unsupported version " + std::to_string(header.version));
+    }
+    if (header.directory_offset > size ||
+        header.directory_size > (size - header.directory_offset) / sizeof(ChunkEntry)) {
+        throw std::runtime_error(path + " has a truncated directory");
+    }
+
+    world->m_chunks.resize(header.directory_size);
+    std::memcpy(world->m_chunks.data(), data + header.directory_offset, header.directory_size * sizeof(ChunkEntry));
+    glm::ivec3 grid_dimensions = header.dimensions >> VoxelGrid::CHUNK_SIZE_LOG;
+    std::set<glm::ivec3, glm_ext::vec3_comparator<int>> positions;
+    for (auto &entry: world->m_chunks) {
+        if (entry.offset > size || (uint64_t) entry.size + entry.lod_size > size - entry.offset) {
+            throw std::runtime_error(path + " has a chunk outside of the file");
+        }
+        if (!glm::all(glm::greaterThanEqual(entry.position, glm::ivec3(0))) ||
+            !glm::all(glm::lessThan(entry.position, grid_dimensions))) {
+            throw std::runtime_error(path + " has a chunk outside of the grid");
+        }
+        if (!positions.insert(entry.position).second) {
+            throw std::runtime_error(path + " has several chunks at the same position");
+        }
+    }
+    return world;
+}
+
+void WorldFile::ReadChunk(const ChunkEntry &entry, VoxelGrid::ChunkData &data) const {
+    Decode(m_file->GetData() + entry.offset, entry.size, entry.encoding, &data[0][0][0], CHUNK_VOXELS);
+}
+
+bool WorldFile::ReadChunkLod(const ChunkEntry &entry, std::vector<uint32_t> &data) const {
+    if (entry.lod_size == 0) {
+        return false;
+    }
+    data.resize(CHUNK_LOD_VOXELS);
+    Decode(m_file->GetData() + entry.offset + entry.size, entry.lod_size, entry.encoding, data.data(), data.size());
+    return true;
+}
+
+void WorldFile::AttachTo(VoxelGrid &grid) {
+    if (grid.GetDimensions() != m_header.dimensions) {
+        throw std::invalid_argument("grid dimensions differ from the world file");
+    }
+
+    std::vector<glm::ivec3> positions;
+    std::vector<uint64_t> keys;
+    positions.reserve(m_chunks.size());
+    keys.reserve(m_chunks.size());
+    for (size_t i = 0; i < m_chunks.size(); i++) {
+        positions.push_back(m_chunks[i].position);
+        keys.push_back(i);
+    }
+
+    grid.AddPagedChunks(positions, keys, [self = shared_from_this()](uint64_t key, VoxelGrid::ChunkData &data) {
+        self->ReadChunk(self->m_chunks[key], data);
+    });
+}
+
+WorldFile::EncodedChunk WorldFile::EncodeChunk(glm::ivec3 position, const VoxelGrid::ChunkData &data,
+                                               const uint32_t *lod, ChunkEncoding encoding) {
+    EncodedChunk chunk{position, encoding, {}, {}};
+    Encode(&data[0][0][0], CHUNK_VOXELS, encoding, chunk.payload);
+    if (lod) {
+        Encode(lod, CHUNK_LOD_VOXELS, encoding, chunk.lod);
+    }
+    return chunk;
+}
+
+const uint32_t *WorldFile::GetChunkLod(const VoxelGridLod *lod, VoxelGrid::ChunkIndexType index) {
+    if (!lod || (index + 1) * CHUNK_LOD_VOXELS > lod->m_chunk_lod_data.size()) {
+        return nullptr;
+    }
+    return lod->m_chunk_lod_data.data() + index * CHUNK_LOD_VOXELS;
+}
+
+void WorldFile::Save(const std::string &path, VoxelGrid &grid, VoxelGridLod *lod, ChunkEncoding encoding) {
+    auto writer = WorldFileWriter::Create(path, grid.GetDimensions(), grid.GetAnchor());
+    std::vector<EncodedChunk> chunks(1);
+    grid.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        auto index = chunk.GetIndex();
+        chunks[0] = EncodeChunk(grid.GetChunkGridPos(index), grid.GetChunkData(index), GetChunkLod(lod, index),
+                                encoding);
+        writer->Write(chunks);
+    });
+    writer->Finish();
+}
+
+void WorldFile::SaveIncremental(const std::string &path, VoxelGrid &grid, const std::vector<glm::ivec3> &changed,
+                                VoxelGridLod *lod, ChunkEncoding encoding) {
+    auto writer = WorldFileWriter::Append(path, grid.GetDimensions());
+    std::vector<EncodedChunk> chunks(1);
+    glm::ivec3 grid_dimensions = grid.GetChunkGridDimensions();
+    for (auto &position: changed) {
+        bool valid = glm::all(glm::greaterThanEqual(position, glm::ivec3(0))) &&
+                     glm::all(glm::lessThan(position, grid_dimensions));
+        VoxelGrid::ChunkIndexType index = valid ? grid.GetChunkGridView().At(position) : VoxelGrid::CHUNK_EMPTY;
+        if (index == VoxelGrid::CHUNK_EMPTY) {
+            writer->Remove(position);
+            continue;
+        }
+        chunks[0] = EncodeChunk(position, grid.GetChunkData(index), GetChunkLod(lod, index), encoding);
+        writer->Write(chunks);
+    }
+    writer->Finish();
+}
+
+WorldFileWriter::WorldFileWriter(const std::string &path, std::ios::openmode mode) : m_path(path),
+                                                                                     m_file(path, mode) {
+    if (!m_file) {
+        throw std::runtime_error("can't open " + path + " for writing");
+    }
+}
+
+std::unique_ptr<WorldFileWriter> WorldFileWriter::Create(const std::string &path, glm::ivec3 dimensions,
+                                                         glm::dvec3 anchor) {
+    std::unique_ptr<WorldFileWriter> writer(
+            new WorldFileWriter(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc));
+    WorldFile::Header &header = writer->m_header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = WorldFile::VERSION;
+    header.dimensions = dimensions;
+    header.anchor = anchor;
+    // Points to an empty directory until Finish
+    writer->m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writer->m_offset = sizeof(header);
+    return writer;
+}
+
+std::unique_ptr<WorldFileWriter> WorldFileWriter::Append(const std::string &path, glm::ivec3 dimensions) {
+    std::unique_ptr<WorldFileWriter> writer(new WorldFileWriter(path, std::ios::binary | std::ios::in | std::ios::out));
+    std::fstream &file = writer->m_file;
+    WorldFile::Header &header = writer->m_header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != WorldFile::VERSION) {
+        throw std::runtime_error(path + " is not a world file");
+    }
+    if (header.dimensions != dimensions) {
+        throw std::invalid_argument("grid dimensions differ from the world file");
+    }
+
+    std::vector<WorldFile::ChunkEntry> chunks(header.directory_size);
+    file.seekg((std::streamoff) header.directory_offset);
+    file.read(reinterpret_cast<char *>(chunks.data()), (std::streamsize) (chunks.size() * sizeof(WorldFile::ChunkEntry)));
+    if (!file) {
+        throw std::runtime_error(path + " has a truncated directory");
+    }
+    for (auto &entry: chunks) {
+        writer->m_chunks[entry.position] = entry;
+    }
+
+    file.seekp(0, std::ios::end);
+    writer->m_offset = (uint64_t) file.tellp();
+    return writer;
+}
+
+void WorldFileWriter::Write(const std::vector<WorldFile::EncodedChunk> &chunks) {
+    m_buffer.clear();
+    for (auto &chunk: chunks) {
+        WorldFile::ChunkEntry entry{chunk.position, chunk.encoding, m_offset + m_buffer.size(),
+                                    (uint32_t) chunk.payload.size(), (uint32_t) chunk.lod.size()};
+        m_buffer.insert(m_buffer.end(), chunk.payload.begin(), chunk.payload.end());
+        m_buffer.insert(m_buffer.end(), chunk.lod.begin(), chunk.lod.end());
+        m_chunks[chunk.position] = entry;
+    }
+    m_file.write(reinterpret_cast<const char *>(m_buffer.data()), (std::streamsize) m_buffer.size());
+    m_offset += m_buffer.size();
+    if (!m_file) {
+        throw std::runtime_error("failed to write " + m_path);
+    }
+}
+
+void WorldFileWriter::Remove(glm::ivec3 position) {
+    m_chunks.erase(position);
+}
+
+void WorldFileWriter::Finish() {
+    std::vector<WorldFile::ChunkEntry> directory;
+    directory.reserve(m_chunks.size());
+    for (auto &[position, entry]: m_chunks) {
+        directory.push_back(entry);
+    }
+    m_file.write(reinterpret_cast<const char *>(directory.data()),
+                 (std::streamsize) (directory.size() * sizeof(WorldFile::ChunkEntry)));
+    m_header.directory_offset = m_offset;
+    m_header.directory_size = directory.size();
+    m_offset += directory.size() * sizeof(WorldFile::ChunkEntry);
+    // The header is updated last, so an interrupted save leaves the previous directory in effect
+    m_file.flush();
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+    m_file.flush();
+    m_file.seekp(0, std::ios::end);
+    if (!m_file) {
+        throw std::runtime_error("failed to write " + m_path);
+    }
+}
+
+DirtyChunkTracker::DirtyChunkTracker(WorldFile::VoxelGrid &grid) : m_grid(grid) {
+    m_callback = grid.AddOnChunkAnyChangeCallback([this](const auto &args) {
+        std::visit([this](const auto &change) {
+            m_changed.insert(change.chunk_grid_position);
+        }, args);
+    });
+}
+
+DirtyChunkTracker::~DirtyChunkTracker() {
+    m_grid.RemoveOnChunkAnyChangeCallback(m_callback);
+}
+
+std::vector<glm::ivec3> DirtyChunkTracker::TakeChanged() {
+    std::vector<glm::ivec3> changed(m_changed.begin(), m_changed.end());
+    m_changed.clear();
+    return changed;
+}
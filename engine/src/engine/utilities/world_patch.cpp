@@ -0,0 +1,301 @@
+#include <lit/engine/utilities/world_patch.hpp>
+#include <lit/engine/utilities/chunk_codec.hpp>
+#include <lit/common/glm_ext/comparators.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+
+using namespace lit::engine;
+
+using VoxelGrid = WorldPatch::VoxelGrid;
+using ChunkData = VoxelGrid::ChunkData;
+
+namespace {
+    const char MAGIC[4] = {'L', 'I', 'T', 'D'};
+
+    const size_t CHUNK_VOXELS = ChunkCodec::CHUNK_VOXELS;
+
+    using PositionSet = std::set<glm::ivec3, lit::common::glm_ext::vec3_comparator<int>>;
+
+    uint32_t *voxelsOf(ChunkData &data) {
+        return &data[0][0][0];
+    }
+
+    const uint32_t *voxelsOf(const ChunkData &data) {
+        return &data[0][0][0];
+    }
+
+    std::string positionText(const glm::ivec3 &position) {
+        return std::to_string(position.x) + ", " + std::to_string(position.y) + ", " + std::to_string(position.z);
+    }
+
+    bool isValidPosition(const VoxelGrid &grid, const glm::ivec3 &position) {
+        return glm::all(glm::greaterThanEqual(position, glm::ivec3(0))) &&
+               glm::all(glm::lessThan(position, grid.GetChunkGridDimensions()));
+    }
+
+    /**
+     * Throws if an entry does not apply to the current chunk at its position or its position is already in
+     * @positions (the entries checked before), adds the positions of the entries to @positions.
+     */
+    void checkEntries(const WorldPatch::Entry *entries, size_t count, VoxelGrid &grid, PositionSet &positions) {
+        for (size_t i = 0; i < count; i++) {
+            const WorldPatch::Entry &entry = entries[i];
+            if (!isValidPosition(grid, entry.position)) {
+                throw std::runtime_error("patch chunk " + positionText(entry.position) + " is outside of the grid");
+            }
+            if (!positions.insert(entry.position).second) {
+                throw std::runtime_error("patch has several entries for chunk " + positionText(entry.position));
+            }
+            VoxelGrid::ChunkIndexType index = grid.GetChunkGridView().At(entry.position);
+            bool matches = entry.change == WorldPatch::ChunkChange::Created ? index == VoxelGrid::CHUNK_EMPTY :
+                           index != VoxelGrid::CHUNK_EMPTY && grid.GetChunkHash(index) == entry.base_hash;
+            if (!matches) {
+                throw std::runtime_error("patch does not match the grid at chunk " + positionText(entry.position));
+            }
+        }
+    }
+
+    void decodePayload(const WorldPatch::Entry &entry, ChunkData &data) {
+        if (ChunkCodec::Decode(entry.payload.data(), entry.payload.size(), nullptr, data) != entry.payload.size()) {
+            throw std::runtime_error("patch chunk " + positionText(entry.position) + " has wrong payload size");
+        }
+    }
+
+    std::unique_ptr<ChunkData> decodePayload(const WorldPatch::Entry &entry) {
+        auto data = std::make_unique_for_overwrite<ChunkData>();
+        decodePayload(entry, *data);
+        return data;
+    }
+
+    /**
+     * Throws if a payload is malformed. Payloads are decoded into a scratch chunk per thread and dropped,
+     * so a whole patch can be checked without keeping its chunks in memory.
+     */
+    void checkPayloads(const WorldPatch::Entry *entries, size_t count, ThreadPool &pool) {
+        pool.ParallelFor(count, [&](size_t i) {
+            if (entries[i].change != WorldPatch::ChunkChange::Deleted) {
+                thread_local auto scratch = std::make_unique_for_overwrite<ChunkData>();
+                decodePayload(entries[i], *scratch);
+            }
+        });
+    }
+
+    /**
+     * Decodes the payloads before the grid is changed, so malformed entries leave it as it was before the batch.
+     */
+    void applyEntries(const WorldPatch::Entry *entries, size_t count, VoxelGrid &grid, ThreadPool &pool) {
+        std::vector<std::unique_ptr<ChunkData>> decoded(count);
+        pool.ParallelFor(count, [&](size_t i) {
+            if (entries[i].change != WorldPatch::ChunkChange::Deleted) {
+                decoded[i] = decodePayload(entries[i]);
+            }
+        });
+
+        std::vector<glm::ivec3> created;
+        std::vector<std::unique_ptr<ChunkData>> created_data;
+        std::vector<glm::ivec3> changed;
+        std::vector<const ChunkData *> changed_data;
+        for (size_t i = 0; i < count; i++) {
+            switch (entries[i].change) {
+                case WorldPatch::ChunkChange::Created:
+                    created.push_back(entries[i].position);
+                    created_data.push_back(std::move(decoded[i]));
+                    break;
+                case WorldPatch::ChunkChange::Changed:
+                    changed.push_back(entries[i].position);
+                    changed_data.push_back(decoded[i].get());
+                    break;
+                case WorldPatch::ChunkChange::Deleted:
+                    grid.DeleteChunk(entries[i].position);
+                    break;
+            }
+        }
+        grid.InsertChunks(created, std::move(created_data));
+        grid.UpdateChunks(changed, [&](const std::vector<VoxelGrid::ChunkIndexType> &indices) {
+            pool.ParallelFor(indices.size(), [&](size_t i) {
+                uint32_t *voxels = voxelsOf(grid.GetChunkData(indices[i]));
+                const uint32_t *delta = voxelsOf(*changed_data[i]);
+                for (size_t j = 0; j < CHUNK_VOXELS; j++) {
+                    voxels[j] ^= delta[j];
+                }
+            });
+        });
+    }
+
+    WorldPatch::Header readHeader(std::ifstream &file, const std::string &path) {
+        WorldPatch::Header header{};
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!file || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error(path + " is not a world patch");
+        }
+        if (header.version != WorldPatch::VERSION) {
+            throw std::runtime_error(path + " has unsupported version " + std::to_string(header.version));
+        }
+        return header;
+    }
+
+    /**
+     * Reads the entry at the current position of @file, the payload must fit into the rest of the @file_size bytes.
+     */
+    WorldPatch::Entry readEntry(std::ifstream &file, uint64_t file_size, const std::string &path) {
+        WorldPatch::EntryHeader header{};
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!file || (uint32_t) header.change > (uint32_t) WorldPatch::ChunkChange::Deleted) {
+            throw std::runtime_error(path + " has a malformed entry");
+        }
+        if (header.payload_size > file_size - (uint64_t) file.tellg()) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        WorldPatch::Entry entry{header.position, header.change, header.base_hash, header.hash, {}};
+        entry.payload.resize(header.payload_size);
+        file.read(reinterpret_cast<char *>(entry.payload.data()), (std::streamsize) entry.payload.size());
+        if (!file) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        return entry;
+    }
+}
+
+WorldPatch WorldPatch::Diff(VoxelGrid &from, VoxelGrid &to, ThreadPool &pool) {
+    if (from.GetDimensions() != to.GetDimensions()) {
+        throw std::invalid_argument("grids have different dimensions");
+    }
+
+    struct Candidate {
+        glm::ivec3 position;
+        VoxelGrid::ChunkIndexType from;
+        VoxelGrid::ChunkIndexType to;
+    };
+    std::vector<Candidate> candidates;
+    auto &from_grid = from.GetChunkGridView();
+    auto &to_grid = to.GetChunkGridView();
+    glm::ivec3 dimensions = from.GetChunkGridDimensions();
+    for (int x = 0; x < dimensions.x; x++) {
+        for (int y = 0; y < dimensions.y; y++) {
+            for (int z = 0; z < dimensions.z; z++) {
+                VoxelGrid::ChunkIndexType a = from_grid.At(x, y, z);
+                VoxelGrid::ChunkIndexType b = to_grid.At(x, y, z);
+                if (a != VoxelGrid::CHUNK_EMPTY || b != VoxelGrid::CHUNK_EMPTY) {
+                    candidates.push_back({{x, y, z}, a, b});
+                }
+            }
+        }
+    }
+
+    // Entries stay in the order of the candidates, chunks with equal hashes get no entry
+    std::vector<Entry> entries(candidates.size());
+    std::vector<char> differs(candidates.size(), 0);
+    pool.ParallelFor(candidates.size(), [&](size_t i) {
+        const Candidate &candidate = candidates[i];
+        Entry &entry = entries[i];
+        entry.position = candidate.position;
+        entry.base_hash = candidate.from != VoxelGrid::CHUNK_EMPTY ? from.GetChunkHash(candidate.from) : 0;
+        entry.hash = candidate.to != VoxelGrid::CHUNK_EMPTY ? to.GetChunkHash(candidate.to) : 0;
+        if (entry.base_hash == entry.hash) {
+            return;
+        }
+        differs[i] = 1;
+
+        // Encoder keeps its scratch buffers between chunks
+        thread_local ChunkCodec codec;
+        if (candidate.to == VoxelGrid::CHUNK_EMPTY) {
+            entry.change = ChunkChange::Deleted;
+        } else if (candidate.from == VoxelGrid::CHUNK_EMPTY) {
+            entry.change = ChunkChange::Created;
+            codec.Encode(to.GetChunkData(candidate.to), nullptr, entry.payload);
+        } else {
+            entry.change = ChunkChange::Changed;
+            thread_local auto delta = std::make_unique_for_overwrite<ChunkData>();
+            const uint32_t *a = voxelsOf(from.GetChunkData(candidate.from));
+            const uint32_t *b = voxelsOf(to.GetChunkData(candidate.to));
+            uint32_t *d = voxelsOf(*delta);
+            for (size_t j = 0; j < CHUNK_VOXELS; j++) {
+                d[j] = a[j] ^ b[j];
+            }
+            codec.Encode(*delta, nullptr, entry.payload);
+        }
+    });
+
+    WorldPatch patch;
+    patch.m_dimensions = from.GetDimensions();
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (differs[i]) {
+            patch.m_entries.push_back(std::move(entries[i]));
+        }
+    }
+    return patch;
+}
+
+size_t WorldPatch::GetPayloadSize() const {
+    size_t size = 0;
+    for (auto &entry: m_entries) {
+        size += entry.payload.size();
+    }
+    return size;
+}
+
+void WorldPatch::Save(const std::string &path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.dimensions = m_dimensions;
+    header.entries_count = m_entries.size();
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (auto &entry: m_entries) {
+        EntryHeader entry_header{entry.position, entry.change, (uint32_t) entry.payload.size(), 0,
+                                 entry.base_hash, entry.hash};
+        file.write(reinterpret_cast<const char *>(&entry_header), sizeof(entry_header));
+        file.write(reinterpret_cast<const char *>(entry.payload.data()), (std::streamsize) entry.payload.size());
+    }
+    if (!file) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+WorldPatch WorldPatch::Load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    Header header = readHeader(file, path);
+    uint64_t file_size = std::filesystem::file_size(path);
+    WorldPatch patch;
+    patch.m_dimensions = header.dimensions;
+    for (uint64_t i = 0; i < header.entries_count; i++) {
+        patch.m_entries.push_back(readEntry(file, file_size, path));
+    }
+    return patch;
+}
+
+void WorldPatch::Apply(VoxelGrid &grid, ThreadPool &pool) const {
+    if (grid.GetDimensions() != m_dimensions) {
+        throw std::invalid_argument("grid dimensions differ from the patch");
+    }
+    PositionSet positions;
+    checkEntries(m_entries.data(), m_entries.size(), grid, positions);
+    checkPayloads(m_entries.data(), m_entries.size(), pool);
+    for (size_t begin = 0; begin < m_entries.size(); begin += BATCH_SIZE) {
+        applyEntries(m_entries.data() + begin, std::min(BATCH_SIZE, m_entries.size() - begin), grid, pool);
+    }
+}
+
+void WorldPatch::ApplyFile(const std::string &path, VoxelGrid &grid, ThreadPool &pool) {
+    std::ifstream file(path, std::ios::binary);
+    Header header = readHeader(file, path);
+    if (grid.GetDimensions() != header.dimensions) {
+        throw std::invalid_argument("grid dimensions differ from the patch");
+    }
+    uint64_t file_size = std::filesystem::file_size(path);
+    PositionSet positions;
+    std::vector<Entry> batch;
+    for (uint64_t i = 0; i < header.entries_count; i += BATCH_SIZE) {
+        batch.clear();
+        for (uint64_t j = i; j < std::min<uint64_t>(header.entries_count, i + BATCH_SIZE); j++) {
+            batch.push_back(readEntry(file, file_size, path));
+        }
+        checkEntries(batch.data(), batch.size(), grid, positions);
+        applyEntries(batch.data(), batch.size(), grid, pool);
+    }
+}
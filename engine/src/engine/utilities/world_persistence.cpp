@@ -0,0 +1,382 @@
+#include <lit/engine/utilities/world_persistence.hpp>
+#include <algorithm>
+
+using namespace lit::engine;
+
+using VoxelGrid = WorldPersistence::VoxelGrid;
+
+namespace {
+    const size_t CHUNK_LOD_VOXELS = GetLodTotalSize(VoxelGrid::GetChunkDimensions(), 1, VoxelGrid::CHUNK_SIZE_LOG);
+}
+
+void WorldPersistence::Job::Fail(const std::string &message) {
+    std::lock_guard lock(mutex);
+    if (error.empty()) {
+        error = message.empty() ? "unknown error" : message;
+    }
+}
+
+WorldPersistence::WorldPersistence(size_t threads_count) : m_pool(threads_count),
+                                                          m_io_thread([this]() { IoLoop(); }) {}
+
+WorldPersistence::~WorldPersistence() {
+    {
+        std::unique_lock lock(m_io_mutex);
+        m_io_condition.wait(lock, [this]() {
+            return std::all_of(m_jobs.begin(), m_jobs.end(), [](const auto &job) { return job->finished.load(); });
+        });
+        m_stop = true;
+    }
+    m_io_condition.notify_all();
+    m_io_thread.join();
+}
+
+std::shared_ptr<WorldPersistence::Job> WorldPersistence::FindLastJob(const std::string &path) const {
+    for (auto it = m_jobs.rbegin(); it != m_jobs.rend(); ++it) {
+        if ((*it)->path == path) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+void WorldPersistence::Finish(Job &job) {
+    job.finished = true;
+    for (auto it = m_waiting_loads.begin(); it != m_waiting_loads.end();) {
+        if ((*it)->previous.get() != &job) {
+            ++it;
+            continue;
+        }
+        auto load = std::move(*it);
+        it = m_waiting_loads.erase(it);
+        load->previous.reset();
+        m_pool.Submit([this, load]() {
+            DecodeFile(load);
+        });
+    }
+    m_io_condition.notify_all();
+}
+
+void WorldPersistence::SaveAsync(const std::string &path, VoxelGrid &grid, const VoxelGridLod *lod,
+                                 Callback callback) {
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->callback = std::move(callback);
+
+    std::vector<VoxelGrid::ChunkIndexType> indices;
+    grid.InvokeForAllChunks([&](const VoxelGrid::ChunkView &chunk) {
+        indices.push_back(chunk.GetIndex());
+    });
+    StartSave(job, grid, indices, lod);
+}
+
+void WorldPersistence::SaveIncrementalAsync(const std::string &path, VoxelGrid &grid,
+                                            const std::vector<glm::ivec3> &changed, const VoxelGridLod *lod,
+                                            Callback callback) {
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->callback = std::move(callback);
+    job->append = true;
+
+    std::vector<VoxelGrid::ChunkIndexType> indices;
+    glm::ivec3 grid_dimensions = grid.GetChunkGridDimensions();
+    for (auto &position: changed) {
+        bool valid = glm::all(glm::greaterThanEqual(position, glm::ivec3(0))) &&
+                     glm::all(glm::lessThan(position, grid_dimensions));
+        VoxelGrid::ChunkIndexType index = valid ? grid.GetChunkGridView().At(position) : VoxelGrid::CHUNK_EMPTY;
+        if (index == VoxelGrid::CHUNK_EMPTY) {
+            job->removed.push_back(position);
+        } else {
+            indices.push_back(index);
+        }
+    }
+    StartSave(job, grid, indices, lod);
+}
+
+void WorldPersistence::StartSave(const std::shared_ptr<Job> &job, VoxelGrid &grid,
+                                 const std::vector<VoxelGrid::ChunkIndexType> &indices, const VoxelGridLod *lod) {
+    job->dimensions = grid.GetDimensions();
+    job->anchor = grid.GetAnchor();
+    job->previous = FindLastJob(job->path);
+    job->chunks_total = indices.size();
+    job->batches_total = std::max<size_t>(1, (indices.size() + BATCH_SIZE - 1) / BATCH_SIZE);
+
+    // The only part that runs on the calling thread: copies of the chunks, so the grid can be changed right away
+    std::vector<Snapshot> snapshots(indices.size());
+    {
+        std::lock_guard lock(m_spare_mutex);
+        for (size_t i = 0; i < snapshots.size() && !m_spare_chunks.empty(); i++) {
+            snapshots[i].data = std::move(m_spare_chunks.back());
+            m_spare_chunks.pop_back();
+        }
+    }
+    m_pool.ParallelFor(indices.size(), [&](size_t i) {
+        snapshots[i].position = grid.GetChunkGridPos(indices[i]);
+        if (!snapshots[i].data) {
+            snapshots[i].data = std::make_unique_for_overwrite<VoxelGrid::ChunkData>();
+        }
+        *snapshots[i].data = grid.GetChunkData(indices[i]);
+        if (const uint32_t *chunk_lod = WorldFile::GetChunkLod(lod, indices[i])) {
+            snapshots[i].lod.assign(chunk_lod, chunk_lod + CHUNK_LOD_VOXELS);
+        }
+    });
+
+    m_jobs.push_back(job);
+    {
+        std::lock_guard lock(m_io_mutex);
+        m_save_queue.push_back(job);
+        if (snapshots.empty()) {
+            job->batches.emplace_back();
+        }
+    }
+    m_io_condition.notify_all();
+
+    for (size_t begin = 0; begin < snapshots.size(); begin += BATCH_SIZE) {
+        // Tasks must be copyable, so the snapshots are shared
+        auto batch = std::make_shared<std::vector<Snapshot>>();
+        size_t end = std::min(snapshots.size(), begin + BATCH_SIZE);
+        batch->insert(batch->end(), std::make_move_iterator(snapshots.begin() + begin),
+                      std::make_move_iterator(snapshots.begin() + end));
+        m_pool.Submit([this, job, batch]() {
+            EncodeBatch(job, std::move(*batch));
+        });
+    }
+}
+
+void WorldPersistence::EncodeBatch(const std::shared_ptr<Job> &job, std::vector<Snapshot> snapshots) {
+    std::vector<WorldFile::EncodedChunk> encoded;
+    try {
+        encoded.reserve(snapshots.size());
+        for (auto &snapshot: snapshots) {
+            encoded.push_back(WorldFile::EncodeChunk(snapshot.position, *snapshot.data,
+                                                     snapshot.lod.empty() ? nullptr : snapshot.lod.data()));
+        }
+    } catch (const std::exception &e) {
+        job->Fail(e.what());
+        encoded.clear();
+    }
+    {
+        std::lock_guard lock(m_spare_mutex);
+        for (auto &snapshot: snapshots) {
+            if (m_spare_chunks.size() < MAX_SPARE_CHUNKS) {
+                m_spare_chunks.push_back(std::move(snapshot.data));
+            }
+        }
+    }
+
+    // Failed batches are still counted, so the job finishes
+    std::lock_guard lock(m_io_mutex);
+    job->batches.push_back(std::move(encoded));
+    m_io_condition.notify_all();
+}
+
+void WorldPersistence::IoLoop() {
+    std::unique_ptr<WorldFileWriter> writer;
+    std::unique_lock lock(m_io_mutex);
+    while (true) {
+        // Earlier saves are finished before, so only a load of the same file can hold the job back
+        m_io_condition.wait(lock, [this]() {
+            if (m_stop) {
+                return true;
+            }
+            if (m_save_queue.empty() || m_save_queue.front()->batches.empty()) {
+                return false;
+            }
+            auto &previous = m_save_queue.front()->previous;
+            return !previous || previous->finished;
+        });
+        if (m_stop) {
+            return;
+        }
+
+        // Jobs are written one after another, later jobs may append to the file of the current one
+        std::shared_ptr<Job> job = m_save_queue.front();
+        job->previous.reset();
+        std::vector<WorldFile::EncodedChunk> batch = std::move(job->batches.front());
+        job->batches.pop_front();
+        lock.unlock();
+
+        try {
+            if (!writer) {
+                writer = job->append ? WorldFileWriter::Append(job->path, job->dimensions) :
+                         WorldFileWriter::Create(job->path, job->dimensions, job->anchor);
+            }
+            writer->Write(batch);
+            job->chunks_done += batch.size();
+        } catch (const std::exception &e) {
+            job->Fail(e.what());
+        }
+
+        bool last = ++job->batches_written == job->batches_total;
+        if (last) {
+            try {
+                // The header is not rewritten after a failure, so the file keeps its previous state
+                if (writer && job->error.empty()) {
+                    for (auto &position: job->removed) {
+                        writer->Remove(position);
+                    }
+                    writer->Finish();
+                }
+            } catch (const std::exception &e) {
+                job->Fail(e.what());
+            }
+            writer.reset();
+        }
+
+        lock.lock();
+        if (last) {
+            m_save_queue.pop_front();
+            Finish(*job);
+        }
+    }
+}
+
+void WorldPersistence::LoadAsync(const std::string &path, VoxelGrid &grid, Callback callback) {
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->callback = std::move(callback);
+    job->grid = &grid;
+    job->dimensions = grid.GetDimensions();
+    job->previous = FindLastJob(path);
+    m_jobs.push_back(job);
+    {
+        std::lock_guard lock(m_io_mutex);
+        if (job->previous && !job->previous->finished) {
+            m_waiting_loads.push_back(job);
+            return;
+        }
+        job->previous.reset();
+    }
+    m_pool.Submit([this, job]() {
+        DecodeFile(job);
+    });
+}
+
+void WorldPersistence::DecodeFile(const std::shared_ptr<Job> &job) {
+    std::shared_ptr<WorldFile> file;
+    try {
+        file = WorldFile::Open(job->path);
+        if (file->GetDimensions() != job->dimensions) {
+            throw std::invalid_argument("grid dimensions differ from the world file");
+        }
+    } catch (const std::exception &e) {
+        job->Fail(e.what());
+    }
+
+    size_t chunks_count = file && job->error.empty() ? file->GetChunks().size() : 0;
+    job->chunks_total = chunks_count;
+    job->batches_total = (chunks_count + BATCH_SIZE - 1) / BATCH_SIZE;
+    for (size_t begin = 0; begin < chunks_count; begin += BATCH_SIZE) {
+        size_t end = std::min(chunks_count, begin + BATCH_SIZE);
+        m_pool.Submit([this, job, file, begin, end]() mutable {
+            DecodedBatch batch;
+            try {
+                for (size_t i = begin; i < end; i++) {
+                    auto &entry = file->GetChunks()[i];
+                    batch.positions.push_back(entry.position);
+                    batch.data.push_back(std::make_unique_for_overwrite<VoxelGrid::ChunkData>());
+                    file->ReadChunk(entry, *batch.data.back());
+                }
+            } catch (const std::exception &e) {
+                job->Fail(e.what());
+                batch = {};
+            }
+            {
+                std::lock_guard lock(job->mutex);
+                job->decoded.push_back(std::move(batch));
+            }
+            // The file is unmapped before the job is finished, so the next save may rewrite it
+            file.reset();
+            if (++job->batches_decoded == job->batches_total + 1) {
+                std::lock_guard lock(m_io_mutex);
+                Finish(*job);
+            }
+        });
+    }
+
+    // This reference is counted as one more batch
+    file.reset();
+    if (++job->batches_decoded == job->batches_total + 1) {
+        std::lock_guard lock(m_io_mutex);
+        Finish(*job);
+    }
+}
+
+void WorldPersistence::InsertDecoded(Job &job) {
+    std::vector<DecodedBatch> decoded;
+    {
+        std::lock_guard lock(job.mutex);
+        decoded.swap(job.decoded);
+    }
+
+    VoxelGrid &grid = *job.grid;
+    glm::ivec3 grid_dimensions = grid.GetChunkGridDimensions();
+    for (auto &batch: decoded) {
+        std::vector<glm::ivec3> positions;
+        std::vector<std::unique_ptr<VoxelGrid::ChunkData>> data;
+        for (size_t i = 0; i < batch.positions.size(); i++) {
+            glm::ivec3 position = batch.positions[i];
+            if (glm::any(glm::lessThan(position, glm::ivec3(0))) ||
+                glm::any(glm::greaterThanEqual(position, grid_dimensions))) {
+                continue;
+            }
+            grid.DeleteChunk(position);
+            positions.push_back(position);
+            data.push_back(std::move(batch.data[i]));
+        }
+        grid.InsertChunks(positions, std::move(data));
+        job.chunks_done += batch.positions.size();
+    }
+}
+
+void WorldPersistence::Update() {
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        Job &job = **it;
+        if (job.grid) {
+            InsertDecoded(job);
+        }
+        if (!job.finished) {
+            ++it;
+            continue;
+        }
+        // Batches decoded after InsertDecoded are inserted on the next update
+        if (job.grid) {
+            std::lock_guard lock(job.mutex);
+            if (!job.decoded.empty()) {
+                ++it;
+                continue;
+            }
+        }
+
+        auto finished = *it;
+        it = m_jobs.erase(it);
+        if (finished->callback) {
+            finished->callback(finished->error);
+        }
+    }
+}
+
+void WorldPersistence::Wait() {
+    Update();
+    while (!m_jobs.empty()) {
+        {
+            std::unique_lock lock(m_io_mutex);
+            m_io_condition.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        Update();
+    }
+}
+
+bool WorldPersistence::IsBusy() const {
+    return !m_jobs.empty();
+}
+
+WorldIoProgress WorldPersistence::GetProgress() const {
+    WorldIoProgress progress;
+    for (auto &job: m_jobs) {
+        progress.jobs++;
+        progress.chunks_total += job->chunks_total;
+        progress.chunks_done += job->chunks_done;
+    }
+    return progress;
+}
@@ -85,6 +85,26 @@ void DebugUI::Redraw() {
     if (ImGui::Button("Regenerate Tree")) {
         dbg.regenerate_tree = true;
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Undo")) {
+        dbg.undo_edit = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Redo")) {
+        dbg.redo_edit = true;
+    }
+
+    if (ImGui::Button("Save World")) {
+        dbg.save_world = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load World")) {
+        dbg.load_world = true;
+    }
+    ImGui::Checkbox("Deduplicate Chunks", &dbg.deduplicate_chunks);
+    if (dbg.world_io_total > 0) {
+        ImGui::Text("World I/O: %zu / %zu chunks", dbg.world_io_done, dbg.world_io_total);
+    }
 
     /*
 
@@ -8,6 +8,12 @@
 #include <omp.h>
 #include <lit/engine/systems/voxels/voxel_world_generator.hpp>
 #include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/utilities/world_persistence.hpp>
+#include <lit/engine/utilities/scene_snapshot.hpp>
+#include <lit/engine/components/world_reference.hpp>
+#include <lit/rendering/opengl/shader.hpp>
+#include <filesystem>
+#include <lit/viewer/debug_options.hpp>
 
 using namespace lit::application;
 using namespace lit::common;
@@ -32,11 +38,16 @@ void EnableGlDebug() {
     glDebugMessageCallback(MessageCallback, nullptr);
 }
 
-void InitScene(Scene& scene, const spdlog::logger_ptr& logger) {
+const char* WORLD_PATH = "world.litw";
+const char* SCENE_PATH = "scene.lits";
+const char* SHADER_CACHE_PATH = "shader_cache";
+
+VoxelGridSparseT<uint32_t>& InitScene(Scene& scene, const spdlog::logger_ptr& logger) {
     auto ent = scene.CreteEntity("world");
 
     auto& world = ent.AddComponent<VoxelGridSparseT<uint32_t>>(glm::ivec3{ 128, 128, 128 }, glm::dvec3{ 64.0, 0.0, 64.0 });
     ent.AddComponent<VoxelGridSparseLodDataT<uint32_t>>();
+    ent.AddComponent<WorldReferenceComponent>(WorldReferenceComponent{ WORLD_PATH });
 
     WorldGen worldGen;
 
@@ -59,6 +70,33 @@ void InitScene(Scene& scene, const spdlog::logger_ptr& logger) {
     Timer timer;
     //world = VoxelWorldGenerator::Generate();
 
+    return world;
+}
+
+/**
+ * Warm start: restores the scene of the previous run, its world is paged from the world file.
+ * Returns null if there is no snapshot or it can't be restored.
+ */
+VoxelGridSparseT<uint32_t>* RestoreScene(Scene& scene, const spdlog::logger_ptr& logger) {
+    if (!std::filesystem::exists(SCENE_PATH)) {
+        return nullptr;
+    }
+    try {
+        Timer timer;
+        auto entities = SceneSnapshot::Load(SCENE_PATH).Restore(scene.GetRegistry());
+        auto ent = scene.FindEntity("world");
+        if (!ent || !ent.HasComponent<VoxelGridSparseT<uint32_t>>()) {
+            logger->error("Scene snapshot {} has no world", SCENE_PATH);
+            // The scene is initialized from scratch instead
+            scene.GetRegistry().destroy(entities.begin(), entities.end());
+            return nullptr;
+        }
+        logger->info("Scene restored from {} in {:.1f}ms", SCENE_PATH, timer.GetTime() * 1e3);
+        return &ent.GetComponent<VoxelGridSparseT<uint32_t>>();
+    } catch (const std::exception& e) {
+        logger->error("Scene snapshot {} not restored: {}", SCENE_PATH, e.what());
+        return nullptr;
+    }
 }
 
 void ViewerApp::StartApp(const spdlog::logger_ptr& logger) {
@@ -72,8 +110,17 @@ void ViewerApp::StartApp(const spdlog::logger_ptr& logger) {
     Application app;
     app.Init();
 
+    // Programs with unchanged sources are loaded from binaries instead of being compiled
+    lit::rendering::opengl::ComputeShader::SetBinaryStorage(
+            std::make_shared<lit::rendering::DirectoryProgramBinaryStorage>(SHADER_CACHE_PATH));
+
     Scene scene;
-    InitScene(scene, logger);
+    auto* restored_world = RestoreScene(scene, logger);
+    auto& world = restored_world ? *restored_world : InitScene(scene, logger);
+    // The debug system would replace the restored world with the test world
+    if (restored_world) {
+        DebugOptions::Instance().regenerate_tree = false;
+    }
 
     WindowInfo game_window;
     game_window.title = "VoxelViewer (" + compiler + " " + architecture + " " + config + ")";
@@ -86,6 +133,34 @@ void ViewerApp::StartApp(const spdlog::logger_ptr& logger) {
     app.CreateWindow(game_window, { window, debug}, {debug, window});
     EnableGlDebug();
 
+    // Saves and loads run in the background, the first save writes the whole world, later ones only changed chunks
+    WorldPersistence persistence;
+    DirtyChunkTracker tracker(world);
+    // A restored world is paged from its file, so it is only saved incrementally
+    bool world_saved = restored_world != nullptr;
+    auto report = [logger](const std::string& action) {
+        return [logger, action](const std::string& error) {
+            if (error.empty()) {
+                logger->info("World {} {}", action, WORLD_PATH);
+            } else {
+                logger->error("World {} failed: {}", action, error);
+            }
+        };
+    };
+    // Saves are incremental once a full save has succeeded, until then changes are covered by the next full save
+    auto save_world = [&]() {
+        if (world_saved) {
+            persistence.SaveIncrementalAsync(WORLD_PATH, world, tracker.TakeChanged(), nullptr, report("saved to"));
+            return;
+        }
+        tracker.TakeChanged();
+        auto saved = report("saved to");
+        persistence.SaveAsync(WORLD_PATH, world, nullptr, [&world_saved, saved](const std::string& error) {
+            world_saved = world_saved || error.empty();
+            saved(error);
+        });
+    };
+
     Timer timer;
 
     /**
@@ -97,6 +172,30 @@ void ViewerApp::StartApp(const spdlog::logger_ptr& logger) {
     while (app.AnyWindowAlive()) {
         app.PollEvents();
         scene.OnUpdate(timer.GetTimeAndReset());
+
+        auto& dbg = DebugOptions::Instance();
+        if (dbg.save_world) {
+            dbg.save_world = false;
+            save_world();
+        }
+        if (dbg.load_world) {
+            dbg.load_world = false;
+            persistence.LoadAsync(WORLD_PATH, world, report("loaded from"));
+        }
+        persistence.Update();
+        auto progress = persistence.GetProgress();
+        dbg.world_io_done = progress.chunks_done;
+        dbg.world_io_total = progress.chunks_total;
+
         app.Redraw();
     }
+
+    // The snapshot refers to the world file, so the world is saved first
+    save_world();
+    persistence.Wait();
+    try {
+        SceneSnapshot::Capture(scene.GetRegistry()).Save(SCENE_PATH);
+    } catch (const std::exception& e) {
+        logger->error("Scene snapshot {} not saved: {}", SCENE_PATH, e.what());
+    }
 }
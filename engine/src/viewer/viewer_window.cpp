@@ -14,8 +14,14 @@ lit::viewer::ViewerWindow::ViewerWindow(Scene &scene)
         : m_scene(scene) {}
 
 bool lit::viewer::ViewerWindow::Init() {
-    m_observer = m_scene.CreteEntity("observer");
-    m_observer.AddComponent<CameraComponent>(glm::uvec2(1280, 720));
+    // The observer may be restored from a scene snapshot
+    m_observer = m_scene.FindEntity("observer");
+    if (!m_observer) {
+        m_observer = m_scene.CreteEntity("observer");
+    }
+    if (!m_observer.HasComponent<CameraComponent>()) {
+        m_observer.AddComponent<CameraComponent>(glm::uvec2(1280, 720));
+    }
     m_observer.AddComponent<SkyBoxComponent>(ResourcesManager::GetAssetPath("sky_boxes/standard"));
 
     m_scene.AddSystem<CameraPreRenderer>();
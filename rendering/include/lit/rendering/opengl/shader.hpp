@@ -1,5 +1,7 @@
 #pragma once
 
+#include <lit/rendering/program_binary_storage.hpp>
+#include <lit/rendering/shader_preprocessor.hpp>
 #include <optional>
 #include <vector>
 #include <unordered_map>
@@ -12,8 +14,19 @@ namespace lit::rendering::opengl {
     public:
         static ComputeShader Create(const std::string &shader_path);
 
+        /// <summary>
+        /// Preprocesses the shader with the shared preprocessor and loads the program from the binary storage if it
+        /// has a binary of the same source for the current driver, otherwise compiles it and stores the binary.
+        /// </summary>
         static std::optional<ComputeShader> TryCreate(const std::string &shader_path);
 
+        static ShaderPreprocessor &GetPreprocessor();
+
+        /// <summary>
+        /// Linked programs are loaded from and stored to @storage, null disables the binary cache (the default).
+        /// </summary>
+        static void SetBinaryStorage(std::shared_ptr<ProgramBinaryStorage> storage);
+
         ComputeShader(ComputeShader &&) = default;
 
         ComputeShader &operator=(ComputeShader &&) = default;
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lit::rendering {
+
+    /// <summary>
+    /// Storage of linked program binaries by key, see ComputeShader::SetBinaryStorage.
+    /// Stored data is not validated, the driver rejects binaries which don't match it.
+    /// </summary>
+    class ProgramBinaryStorage {
+    public:
+        virtual ~ProgramBinaryStorage() = default;
+
+        /// <summary>
+        /// Returns false if nothing is stored for @key.
+        /// </summary>
+        virtual bool Load(const std::string &key, std::vector<uint8_t> &data) = 0;
+
+        virtual void Store(const std::string &key, const std::vector<uint8_t> &data) = 0;
+    };
+
+    /// <summary>
+    /// Keeps binaries for the lifetime of the storage.
+    /// </summary>
+    class MemoryProgramBinaryStorage : public ProgramBinaryStorage {
+    public:
+        bool Load(const std::string &key, std::vector<uint8_t> &data) override;
+
+        void Store(const std::string &key, const std::vector<uint8_t> &data) override;
+
+    private:
+        std::unordered_map<std::string, std::vector<uint8_t>> m_binaries;
+    };
+
+    /// <summary>
+    /// One file per key in a directory, which is created on the first store. Files are written under a temporary
+    /// name and renamed, so an interrupted store leaves no partial binary. Throws std::runtime_error if a file can't
+    /// be written.
+    /// </summary>
+    class DirectoryProgramBinaryStorage : public ProgramBinaryStorage {
+    public:
+        explicit DirectoryProgramBinaryStorage(std::filesystem::path directory);
+
+        bool Load(const std::string &key, std::vector<uint8_t> &data) override;
+
+        void Store(const std::string &key, const std::vector<uint8_t> &data) override;
+
+    private:
+        std::filesystem::path GetPath(const std::string &key) const;
+
+        std::filesystem::path m_directory;
+    };
+
+}
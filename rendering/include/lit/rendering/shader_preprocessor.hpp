@@ -0,0 +1,97 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lit::rendering {
+
+    /// <summary>
+    /// Resolves #include "path" directives of GLSL files: paths are relative to the including file and #version of
+    /// included files is skipped. Parsed files and preprocessed sources are cached, a file is read again only if its
+    /// modification time or size changed, and a source is assembled again only if the content hash of one of its
+    /// files changed, so unchanged shaders cost a few file stats. Doesn't use GL.
+    /// </summary>
+    class ShaderPreprocessor {
+    public:
+        inline static const int MAX_DEPTH = 10;
+
+        struct Source {
+            std::string text;
+            // Hash of the text, changes whenever the shader or one of its includes changes
+            uint64_t hash = 0;
+            // All files of the source in the order of inclusion, the shader first
+            std::vector<std::string> dependencies;
+        };
+
+        struct Stats {
+            // Files read from the disk
+            size_t files_read = 0;
+            // Sources assembled from parsed files
+            size_t sources_built = 0;
+        };
+
+        /// <summary>
+        /// Returns the preprocessed source of the shader at @path, valid until the next call.
+        /// Throws std::runtime_error if a file can't be read, an include is malformed or nested deeper than MAX_DEPTH.
+        /// </summary>
+        const Source &Preprocess(const std::string &path);
+
+        void Clear();
+
+        const Stats &GetStats() const {
+            return m_stats;
+        }
+
+        static uint64_t Hash(const void *data, size_t size);
+
+    private:
+        enum class SegmentType {
+            Text,
+            Version,
+            Include
+        };
+
+        struct Segment {
+            SegmentType type;
+            // Lines of text with their line breaks, or the normalized path of the included file
+            std::string text;
+        };
+
+        struct File {
+            std::filesystem::file_time_type time{};
+            uintmax_t size = 0;
+            uint64_t hash = 0;
+            // Shared, so a file changed while it is being included (by itself) keeps the segments being appended
+            std::shared_ptr<const std::vector<Segment>> segments;
+        };
+
+        struct CachedSource {
+            Source source;
+            // Hashes of the files of source.dependencies at the time of preprocessing
+            std::vector<uint64_t> dependency_hashes;
+        };
+
+        /// <summary>
+        /// Returns the cached file, reads it again if it changed on the disk, returns null if it can't be read.
+        /// </summary>
+        const File *FindFile(const std::string &path);
+
+        const File &GetFile(const std::string &path);
+
+        bool IsUpToDate(const CachedSource &cached);
+
+        void Append(const std::string &path, int depth, CachedSource &cached);
+
+        static std::vector<Segment> Parse(const std::string &content, const std::string &path);
+
+        static std::string NormalizePath(const std::filesystem::path &path);
+
+        std::unordered_map<std::string, File> m_files;
+        std::unordered_map<std::string, CachedSource> m_sources;
+        Stats m_stats;
+    };
+
+}
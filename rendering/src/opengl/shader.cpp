@@ -1,38 +1,96 @@
 #include <lit/rendering/opengl/shader.hpp>
 #include <spdlog/spdlog.h>
 #include <GL/glew.h>
-#include <fstream>
+#include <cstring>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/mat4x4.hpp>
 #include <lit/rendering/opengl/utils.hpp>
 
+using namespace lit::rendering;
 using namespace lit::rendering::opengl;
 
-std::string RunPreprocessor(const std::string &shader_path, int depth = 0) {
-    if (depth > 10) {
-        return "";
+namespace {
+    ShaderPreprocessor preprocessor;
+    std::shared_ptr<ProgramBinaryStorage> binary_storage;
+
+    struct BinaryHeader {
+        uint32_t format;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(BinaryHeader) == 8);
+
+    bool IsBinaryCacheEnabled() {
+        if (!binary_storage) {
+            return false;
+        }
+        static const bool supported = [] {
+            GLint formats = 0;
+            GL_CALL(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+            return formats > 0;
+        }();
+        return supported;
+    }
+
+    /**
+     * Binaries are specific to the driver, so the key also covers its vendor, renderer and version.
+     */
+    std::string GetBinaryKey(uint64_t source_hash) {
+        static const uint64_t driver_hash = [] {
+            std::string driver;
+            for (GLenum name: {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+                GL_CALL(auto value = glGetString(name));
+                driver += value ? reinterpret_cast<const char *>(value) : "";
+                driver += '\n';
+            }
+            return ShaderPreprocessor::Hash(driver.data(), driver.size());
+        }();
+        return fmt::format("{:016x}", source_hash ^ driver_hash);
     }
 
-    std::ifstream fin(shader_path);
-    std::string shader_sources;
-    std::string root_path = shader_path.substr(0, shader_path.find_last_of('/'));
-
-    std::string line;
-    while (std::getline(fin, line))
-    {
-        if (line.starts_with("#include")) {
-            std::string path = line.substr(line.find_first_of('"') + 1, line.find_last_of('"') - line.find_first_of('"') - 1);
-            shader_sources += RunPreprocessor(root_path + "/" + path, depth + 1);
-            continue;
+    /**
+     * Returns a linked program or 0 if the storage has no binary for @key or the driver rejects it.
+     */
+    uint32_t LoadBinary(const std::string &key) {
+        std::vector<uint8_t> data;
+        if (!binary_storage->Load(key, data) || data.size() <= sizeof(BinaryHeader)) {
+            return 0;
         }
-        if (line.starts_with("#version") && depth > 0) {
-            // skip all included version declarations
-            continue;
+        BinaryHeader header{};
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        auto program_id = GL_CALL(glCreateProgram());
+        GL_CALL(glProgramBinary(program_id, header.format, data.data() + sizeof(header),
+                                (GLsizei) (data.size() - sizeof(header))));
+        GLint is_linked = 0;
+        GL_CALL(glGetProgramiv(program_id, GL_LINK_STATUS, &is_linked));
+        if (is_linked == GL_FALSE) {
+            spdlog::default_logger()->debug("Program binary {} was rejected by the driver", key);
+            GL_CALL(glDeleteProgram(program_id));
+            return 0;
+        }
+        return program_id;
+    }
+
+    void StoreBinary(uint32_t program_id, const std::string &key) {
+        GLint length = 0;
+        GL_CALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length));
+        if (length <= 0) {
+            return;
+        }
+        std::vector<uint8_t> data(sizeof(BinaryHeader) + length);
+        GLenum format = 0;
+        GL_CALL(glGetProgramBinary(program_id, length, &length, &format, data.data() + sizeof(BinaryHeader)));
+        BinaryHeader header{format, 0};
+        std::memcpy(data.data(), &header, sizeof(header));
+        data.resize(sizeof(BinaryHeader) + length);
+        try {
+            binary_storage->Store(key, data);
+        } catch (const std::exception &e) {
+            spdlog::default_logger()->warn("Program binary {} not stored: {}", key, e.what());
         }
-        shader_sources += line + "\n";
     }
-    return shader_sources;
 }
 
 ComputeShader::ComputeShader(uint32_t program_id) : m_program_id(std::make_unique<uint32_t>(program_id)) {
@@ -40,11 +98,28 @@ ComputeShader::ComputeShader(uint32_t program_id) : m_program_id(std::make_uniqu
 }
 
 std::optional<ComputeShader> ComputeShader::TryCreate(const std::string &shader_path) {
-    auto program_id = GL_CALL(glCreateProgram());
+    const ShaderPreprocessor::Source *source;
+    try {
+        source = &preprocessor.Preprocess(shader_path);
+    } catch (const std::runtime_error &e) {
+        spdlog::default_logger()->error(e.what());
+        return std::nullopt;
+    }
+
+    std::string binary_key;
+    if (IsBinaryCacheEnabled()) {
+        binary_key = GetBinaryKey(source->hash);
+        if (uint32_t program_id = LoadBinary(binary_key)) {
+            spdlog::default_logger()->trace("Compute shader loaded from binary {}", binary_key);
+            return ComputeShader(program_id);
+        }
+    }
 
-    std::ifstream fin(shader_path);
-    std::string shader_sources = RunPreprocessor(shader_path);
-    auto shader_sources_c_str = shader_sources.c_str();
+    auto program_id = GL_CALL(glCreateProgram());
+    if (!binary_key.empty()) {
+        GL_CALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+    auto shader_sources_c_str = source->text.c_str();
 
     GL_CALL(auto shader_id = glCreateShader(GL_COMPUTE_SHADER));
 
@@ -80,9 +155,20 @@ std::optional<ComputeShader> ComputeShader::TryCreate(const std::string &shader_
 
     GL_CALL(glDeleteShader(shader_id));
 
+    if (!binary_key.empty()) {
+        StoreBinary(program_id, binary_key);
+    }
     return ComputeShader(program_id);
 }
 
+ShaderPreprocessor &ComputeShader::GetPreprocessor() {
+    return preprocessor;
+}
+
+void ComputeShader::SetBinaryStorage(std::shared_ptr<ProgramBinaryStorage> storage) {
+    binary_storage = std::move(storage);
+}
+
 ComputeShader::~ComputeShader() {
     if (m_program_id) {
         GL_CALL(glDeleteProgram(*m_program_id));
@@ -452,8 +452,14 @@ TextureCube TextureCube::Create(const std::filesystem::path &path) {
     GL_CALL(glGenTextures(1, &texture_id));
     GL_CALL(glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id));
     std::vector<std::string> names = {"right.png", "left.png", "up.png", "down.png", "back.png", "front.png"};
+    std::vector<std::string> paths;
+    for (auto &name: names) {
+        paths.push_back((path / name).string());
+    }
+    // Sides are decoded in parallel, uploads stay on the thread of the context
+    auto images = common::ReadPNGs_RGB(paths);
     for (unsigned int i = 0; i < names.size(); i++) {
-        auto image = common::ReadPNG_RGB((path / names[i]).string());
+        auto &image = images[i];
         GL_CALL(glTexImage2D(
                 GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
                 0, GL_RGBA8, image.GetWidth(), image.GetHeight(), 0, GL_RGB, GL_UNSIGNED_BYTE, image.GetDataPointer()
@@ -0,0 +1,50 @@
+#include <lit/rendering/program_binary_storage.hpp>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace lit::rendering;
+
+bool MemoryProgramBinaryStorage::Load(const std::string &key, std::vector<uint8_t> &data) {
+    auto it = m_binaries.find(key);
+    if (it == m_binaries.end()) {
+        return false;
+    }
+    data = it->second;
+    return true;
+}
+
+void MemoryProgramBinaryStorage::Store(const std::string &key, const std::vector<uint8_t> &data) {
+    m_binaries[key] = data;
+}
+
+DirectoryProgramBinaryStorage::DirectoryProgramBinaryStorage(std::filesystem::path directory)
+        : m_directory(std::move(directory)) {}
+
+bool DirectoryProgramBinaryStorage::Load(const std::string &key, std::vector<uint8_t> &data) {
+    std::ifstream file(GetPath(key), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !data.empty();
+}
+
+void DirectoryProgramBinaryStorage::Store(const std::string &key, const std::vector<uint8_t> &data) {
+    std::filesystem::create_directories(m_directory);
+    auto path = GetPath(key);
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()), (std::streamsize) data.size());
+        if (!file) {
+            throw std::runtime_error("failed to write " + temp_path.string());
+        }
+    }
+    std::filesystem::rename(temp_path, path);
+}
+
+std::filesystem::path DirectoryProgramBinaryStorage::GetPath(const std::string &key) const {
+    return m_directory / (key + ".bin");
+}
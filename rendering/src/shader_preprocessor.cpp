@@ -0,0 +1,155 @@
+#include <lit/rendering/shader_preprocessor.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace lit::rendering;
+
+const ShaderPreprocessor::Source &ShaderPreprocessor::Preprocess(const std::string &path) {
+    std::string key = NormalizePath(path);
+    auto it = m_sources.find(key);
+    if (it != m_sources.end() && IsUpToDate(it->second)) {
+        return it->second.source;
+    }
+
+    CachedSource cached;
+    Append(key, 0, cached);
+    cached.source.hash = Hash(cached.source.text.data(), cached.source.text.size());
+    m_stats.sources_built++;
+    return (m_sources[key] = std::move(cached)).source;
+}
+
+void ShaderPreprocessor::Clear() {
+    m_files.clear();
+    m_sources.clear();
+}
+
+uint64_t ShaderPreprocessor::Hash(const void *data, size_t size) {
+    // FNV-1a
+    auto bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+const ShaderPreprocessor::File *ShaderPreprocessor::FindFile(const std::string &path) {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(path, error);
+    uintmax_t size = error ? 0 : std::filesystem::file_size(path, error);
+    if (error) {
+        return nullptr;
+    }
+
+    File &file = m_files[path];
+    if (file.segments && file.time == time && file.size == size) {
+        return &file;
+    }
+
+    std::ifstream fin(path);
+    if (!fin) {
+        return nullptr;
+    }
+    std::string content((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+    m_stats.files_read++;
+    uint64_t hash = Hash(content.data(), content.size());
+    // A touched file keeps its segments
+    if (!file.segments || file.hash != hash) {
+        file.segments = std::make_shared<const std::vector<Segment>>(Parse(content, path));
+        file.hash = hash;
+    }
+    file.time = time;
+    file.size = size;
+    return &file;
+}
+
+const ShaderPreprocessor::File &ShaderPreprocessor::GetFile(const std::string &path) {
+    auto file = FindFile(path);
+    if (!file) {
+        throw std::runtime_error("failed to read shader " + path);
+    }
+    return *file;
+}
+
+bool ShaderPreprocessor::IsUpToDate(const CachedSource &cached) {
+    // The shader goes first, so a removed include is not checked once the file which included it changed
+    for (size_t i = 0; i < cached.source.dependencies.size(); i++) {
+        auto file = FindFile(cached.source.dependencies[i]);
+        if (!file || file->hash != cached.dependency_hashes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ShaderPreprocessor::Append(const std::string &path, int depth, CachedSource &cached) {
+    if (depth > MAX_DEPTH) {
+        throw std::runtime_error("includes of " + path + " are nested deeper than " + std::to_string(MAX_DEPTH));
+    }
+
+    const File &file = GetFile(path);
+    auto &dependencies = cached.source.dependencies;
+    if (std::find(dependencies.begin(), dependencies.end(), path) == dependencies.end()) {
+        dependencies.push_back(path);
+        cached.dependency_hashes.push_back(file.hash);
+    }
+
+    auto segments = file.segments;
+    for (auto &segment: *segments) {
+        switch (segment.type) {
+            case SegmentType::Text:
+                cached.source.text += segment.text;
+                break;
+            case SegmentType::Version:
+                // Only the shader declares the version
+                if (depth == 0) {
+                    cached.source.text += segment.text;
+                }
+                break;
+            case SegmentType::Include:
+                Append(segment.text, depth + 1, cached);
+                break;
+        }
+    }
+}
+
+std::vector<ShaderPreprocessor::Segment> ShaderPreprocessor::Parse(const std::string &content, const std::string &path) {
+    std::filesystem::path root_path = std::filesystem::path(path).parent_path();
+    std::vector<Segment> segments;
+    auto text = [&]() -> std::string & {
+        if (segments.empty() || segments.back().type != SegmentType::Text) {
+            segments.push_back({SegmentType::Text, {}});
+        }
+        return segments.back().text;
+    };
+
+    size_t line_number = 1;
+    for (size_t begin = 0; begin < content.size(); line_number++) {
+        size_t end = std::min(content.find('\n', begin), content.size());
+        std::string_view line(content.data() + begin, end - begin);
+        begin = end + 1;
+
+        if (line.starts_with("#include")) {
+            size_t first = line.find_first_of('"');
+            size_t last = line.find_last_of('"');
+            if (first == std::string_view::npos || first == last) {
+                throw std::runtime_error("malformed #include in " + path + ":" + std::to_string(line_number));
+            }
+            segments.push_back({SegmentType::Include,
+                                NormalizePath(root_path / std::string(line.substr(first + 1, last - first - 1)))});
+        } else if (line.starts_with("#version")) {
+            segments.push_back({SegmentType::Version, std::string(line) + "\n"});
+        } else {
+            auto &out = text();
+            out += line;
+            out += '\n';
+        }
+    }
+    return segments;
+}
+
+std::string ShaderPreprocessor::NormalizePath(const std::filesystem::path &path) {
+    return path.lexically_normal().generic_string();
+}
@@ -31,6 +31,19 @@ layout (std430, binding = 19) buffer ChunkInfoBuffer {
     ChunkInfo buf_chunk_info[];
 };
 
+// Chebyshev distance fields, one byte per cell packed into uints
+layout (std430, binding = 20) buffer GridDistanceBuffer {
+    uint buf_grid_distance[];
+};
+
+layout (std430, binding = 21) buffer ChunkDistanceBuffer {
+    uint buf_chunk_distance[];
+};
+
+uniform int uni_use_distance_field;
+
+const int DISTANCE_FIELD_LOD = 1;
+
 const float VOXEL_SIZE = 1.0 / 16.0;
 const float VOXEL_SIZE_INV = 16.0;
 
@@ -105,6 +118,31 @@ bool _HasVoxelSlow(ivec3 cell, int lod) {
     return _HasChunk(cell, lod);
 }
 
+uint _GetByte(uint word, uint index) {
+    return (word >> ((index & 3u) << 3)) & 0xFFu;
+}
+
+// Returns the corner of the empty cube around the cell, the ray can jump to it in one step.
+// Chunk distance field is stored at LOD1, so it is only valid for chunks rendered at bucket 0 or 1.
+ivec3 _GetEmptyRegionEnd(ivec3 cell, ivec3 cell_real, int lod, int bucket) {
+    if (lod >= CHUNK_MAX_LOD) {
+        ivec3 chunk = cell_real >> CHUNK_MAX_LOD;
+        uint index = uint((chunk.x << (WORLD_SIZE_LOG.y + WORLD_SIZE_LOG.z - CHUNK_MAX_LOD * 2)) + (chunk.y << (WORLD_SIZE_LOG.z - CHUNK_MAX_LOD)) + chunk.z);
+        int distance = int(_GetByte(buf_grid_distance[index >> 2], index));
+        return distance == 0 ? cell + 1 : ((cell >> CHUNK_MAX_LOD) + distance) << CHUNK_MAX_LOD;
+    }
+    if (bucket > DISTANCE_FIELD_LOD) {
+        return cell + 1;
+    }
+
+    int size_log = CHUNK_MAX_LOD - DISTANCE_FIELD_LOD;
+    uint chunk_index = _GetChunk(cell_real, CHUNK_MAX_LOD);
+    ivec3 df_cell = (cell_real & ((1 << CHUNK_MAX_LOD) - 1)) >> DISTANCE_FIELD_LOD;
+    uint index = (chunk_index << (size_log * 3)) + uint((df_cell.x << (size_log * 2)) | (df_cell.y << size_log) | df_cell.z);
+    int distance = int(_GetByte(buf_chunk_distance[index >> 2], index));
+    return distance == 0 ? cell + 1 : min(((cell >> DISTANCE_FIELD_LOD) + distance) << DISTANCE_FIELD_LOD, (cell | ((1 << CHUNK_MAX_LOD) - 1)) + 1);
+}
+
 bool WorldHitBox(vec3 origin, vec3 dir, out float distance) {
     origin = origin * VOXEL_SIZE_INV + WORLD_SIZE / 2;
     vec3 t1 = (-origin) / dir;
@@ -231,6 +269,7 @@ RayCastResult WorldRayCast(vec3 origin, vec3 dir, int max_iterations) {
     int min_bucket = 0;
     for (; iteration < max_iterations && all(lessThan(cell, WORLD_SIZE)); iteration++) {
         ivec3 cell_real = _ApplyInverse(cell, WORLD_SIZE, axes_inversed);
+        int bucket = min_bucket;
 
         //while (lod >= CHUNK_MAX_LOD && _HasChunk(cell_real, lod)) lod--;
         lod -= int(lod - 3 >= CHUNK_MAX_LOD && _HasChunk(cell_real, lod - 3)) << 2;
@@ -240,6 +279,7 @@ RayCastResult WorldRayCast(vec3 origin, vec3 dir, int max_iterations) {
         if (lod < CHUNK_MAX_LOD) {
             uint chunk_index = _GetChunk(cell_real, CHUNK_MAX_LOD);
             ChunkInfo chunk_info = buf_chunk_info[chunk_index];
+            bucket = max(min_bucket, int(chunk_info.bucket));
             lod = max(lod, max(min_bucket, int(chunk_info.bucket)));
             while (lod > max(chunk_info.bucket, min_bucket) && _HasVoxel(chunk_index, cell_real, lod)) {
                 lod--;
@@ -260,6 +300,13 @@ RayCastResult WorldRayCast(vec3 origin, vec3 dir, int max_iterations) {
         }
 
         time = ((cell | ((1 << lod) - 1)) + 1 - shifted_ray_origin) * ray_direction_inversed;
+        if (uni_use_distance_field != 0) {
+            // jump over the whole empty region if it lets the ray travel further
+            vec3 region_time = (_GetEmptyRegionEnd(cell, cell_real, lod, bucket) - shifted_ray_origin) * ray_direction_inversed;
+            if (min(region_time.x, min(region_time.y, region_time.z)) > min(time.x, min(time.y, time.z))) {
+                time = region_time;
+            }
+        }
         shifted_ray_origin += ((min(time.x, min(time.y, time.z))) + 1e-5f) * dir;
 
         cell = ivec3(floor(shifted_ray_origin));
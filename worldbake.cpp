@@ -0,0 +1,153 @@
+#include <lit/engine/generators/worldgen.hpp>
+#include <lit/engine/systems/voxels/voxel_grid_lod_manager.hpp>
+#include <lit/engine/utilities/world_file.hpp>
+#include <lit/common/time_utils.hpp>
+#include <spdlog/spdlog.h>
+#include <string>
+
+using namespace lit::common;
+using namespace lit::engine;
+
+using VoxelGridLod = VoxelGridSparseLodDataT<uint32_t>;
+
+// Minimum distance between two trees and the number of different trees of --trees
+const double TREES_DISTANCE = 48.0;
+const size_t TREE_VARIANTS = 8;
+
+struct BakeOptions {
+    int seed = 0;
+    glm::ivec3 size = glm::ivec3(2048, 512, 2048);
+    size_t threads = 0;
+    bool lod = true;
+    bool trees = false;
+    std::string output = "world.litw";
+};
+
+void PrintUsage(spdlog::logger &logger) {
+    logger.info("Usage: lit_worldbake [--seed N] [--size X Y Z] [--threads N] [--trees] [--no-lod] [--out FILE]");
+}
+
+bool ParseOptions(int argc, char **argv, BakeOptions &options, spdlog::logger &logger) {
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("missing value of " + arg);
+                }
+                return argv[++i];
+            };
+            if (arg == "--seed") {
+                options.seed = std::stoi(next());
+            } else if (arg == "--size") {
+                options.size.x = std::stoi(next());
+                options.size.y = std::stoi(next());
+                options.size.z = std::stoi(next());
+            } else if (arg == "--threads") {
+                options.threads = std::stoul(next());
+            } else if (arg == "--trees") {
+                options.trees = true;
+            } else if (arg == "--no-lod") {
+                options.lod = false;
+            } else if (arg == "--out") {
+                options.output = next();
+            } else {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+        }
+    } catch (const std::exception &e) {
+        logger.error("Invalid arguments: {}", e.what());
+        return false;
+    }
+    if (glm::any(glm::lessThanEqual(options.size, glm::ivec3(0)))) {
+        logger.error("World size must be positive");
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+size_t GetVectorBytes(const std::vector<T> &v) {
+    return v.capacity() * sizeof(T);
+}
+
+/**
+ * Generates a world with WorldGen without a window, builds its LODs, writes it to a file
+ * and prints the duration of every stage and the memory of the result.
+ */
+int main(int argc, char **argv) {
+    auto logger = spdlog::default_logger();
+
+    BakeOptions options;
+    if (!ParseOptions(argc, argv, options, *logger)) {
+        PrintUsage(*logger);
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool(options.threads);
+    logger->info("Baking world {}x{}x{}, seed {}, {} threads", options.size.x, options.size.y, options.size.z,
+                 options.seed, pool.GetThreadsCount());
+
+    Timer total;
+    Timer timer;
+    entt::registry registry;
+    auto ent = registry.create();
+    auto &world = registry.emplace<VoxelGridSparseT<uint32_t>>(ent, options.size,
+                                                               glm::dvec3(options.size.x / 2, 0, options.size.z / 2));
+    double allocation_time = timer.GetTimeAndReset();
+
+    WorldGen generator(options.seed);
+    generator.Generate(world, *logger, pool);
+    double generation_time = timer.GetTimeAndReset();
+    logger->info("[1/3] Terrain generated in {:.2f}s", generation_time);
+    if (options.trees) {
+        ScatterSettings settings;
+        settings.min_distance = TREES_DISTANCE;
+        settings.seed = options.seed;
+        generator.ScatterTrees(world, settings, TREE_VARIANTS, *logger, pool);
+        logger->info("[1/3] Trees placed in {:.2f}s", timer.GetTimeAndReset());
+    }
+
+    double lod_time = 0.0;
+    size_t lod_bytes = 0;
+    if (options.lod) {
+        auto &lod = registry.emplace<VoxelGridLod>(ent);
+        VoxelGridLodManager<uint32_t> lod_manager(registry);
+        lod_manager.CommitChanges();
+        lod_time = timer.GetTimeAndReset();
+        lod_bytes = GetVectorBytes(lod.m_grid_lod_data) + GetVectorBytes(lod.m_chunk_lod_data) +
+                    GetVectorBytes(lod.m_chunk_binary_lod_data) + GetVectorBytes(lod.m_grid_distance_data) +
+                    GetVectorBytes(lod.m_chunk_distance_data);
+        logger->info("[2/3] LODs built in {:.2f}s", lod_time);
+    } else {
+        logger->info("[2/3] LODs skipped");
+    }
+
+    try {
+        WorldFile::Save(options.output, world, options.lod ? &registry.get<VoxelGridLod>(ent) : nullptr);
+    } catch (const std::exception &e) {
+        logger->error("Failed to save the world: {}", e.what());
+        return EXIT_FAILURE;
+    }
+    double write_time = timer.GetTimeAndReset();
+    logger->info("[3/3] Written to {} in {:.2f}s", options.output, write_time);
+
+    auto &timings = generator.GetTimings();
+    logger->info("Timings:");
+    logger->info("  allocation       {:8.3f}s", allocation_time);
+    logger->info("  height map       {:8.3f}s", timings.height_map);
+    logger->info("  window filters   {:8.3f}s", timings.terrain_columns);
+    logger->info("  voxel fill       {:8.3f}s", timings.voxels);
+    logger->info("  tree scatter     {:8.3f}s", timings.trees_scatter);
+    logger->info("  tree placement   {:8.3f}s", timings.trees_placement);
+    logger->info("  lod build        {:8.3f}s", lod_time);
+    logger->info("  write            {:8.3f}s", write_time);
+    logger->info("  total            {:8.3f}s", total.GetTime());
+
+    logger->info("Memory:");
+    logger->info("  chunks           {:8}", world.GetChunksNum());
+    logger->info("  voxel grid       {:8.1f} MB", world.GetSizeBytes() / 1048576.0);
+    logger->info("  lod data         {:8.1f} MB", lod_bytes / 1048576.0);
+
+    return EXIT_SUCCESS;
+}